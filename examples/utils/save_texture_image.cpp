@@ -9,6 +9,7 @@
 #include "config.hpp"
 #include "crc32_hash.hpp"
 #include <vector>
+#include <cstring> // std::memcpy
 #include <filesystem>
 #include <stb_image_write.h>
 
@@ -51,63 +52,34 @@ static void unpack_r5g6b5(uint16_t data, uint8_t rgb[3])
 	temp =  (data & 0x001F)        * 255 + 16;
 	rgb[2] = static_cast<uint8_t>((temp / 32 + temp) / 32);
 }
-static void unpack_bc1_value(const uint8_t color_0[3], const uint8_t color_1[3], uint32_t color_index, uint8_t result[4], bool not_degenerate = true)
+// Decoding a block computes all colors its indices can refer to once, so that every texel is just a lookup
+static void build_bc1_palette(const uint8_t color_0[3], const uint8_t color_1[3], uint8_t palette[4][4], bool four_color_mode = true)
 {
-	switch (color_index)
+	for (int c = 0; c < 3; ++c)
 	{
-	case 0:
-		for (int c = 0; c < 3; ++c)
-			result[c] = color_0[c];
-		result[3] = 255;
-		break;
-	case 1:
-		for (int c = 0; c < 3; ++c)
-			result[c] = color_1[c];
-		result[3] = 255;
-		break;
-	case 2:
-		for (int c = 0; c < 3; ++c)
-			result[c] = not_degenerate ? (2 * color_0[c] + color_1[c]) / 3 : (color_0[c] + color_1[c]) / 2;
-		result[3] = 255;
-		break;
-	case 3:
-		for (int c = 0; c < 3; ++c)
-			result[c] = not_degenerate ? (color_0[c] + 2 * color_1[c]) / 3 : 0;
-		result[3] = not_degenerate ? 255 : 0;
-		break;
+		palette[0][c] = color_0[c];
+		palette[1][c] = color_1[c];
+		palette[2][c] = four_color_mode ? (2 * color_0[c] + color_1[c]) / 3 : (color_0[c] + color_1[c]) / 2;
+		palette[3][c] = four_color_mode ? (color_0[c] + 2 * color_1[c]) / 3 : 0;
 	}
+
+	palette[0][3] = 255;
+	palette[1][3] = 255;
+	palette[2][3] = 255;
+	palette[3][3] = four_color_mode ? 255 : 0;
 }
-static void unpack_bc4_value(uint8_t alpha_0, uint8_t alpha_1, uint32_t alpha_index, uint8_t *result)
+static void build_bc4_palette(uint8_t alpha_0, uint8_t alpha_1, uint8_t palette[8])
 {
 	const bool interpolation_type = alpha_0 > alpha_1;
 
-	switch (alpha_index)
-	{
-	case 0:
-		*result = alpha_0;
-		break;
-	case 1:
-		*result = alpha_1;
-		break;
-	case 2:
-		*result = interpolation_type ? (6 * alpha_0 + 1 * alpha_1) / 7 : (4 * alpha_0 + 1 * alpha_1) / 5;
-		break;
-	case 3:
-		*result = interpolation_type ? (5 * alpha_0 + 2 * alpha_1) / 7 : (3 * alpha_0 + 2 * alpha_1) / 5;
-		break;
-	case 4:
-		*result = interpolation_type ? (4 * alpha_0 + 3 * alpha_1) / 7 : (2 * alpha_0 + 3 * alpha_1) / 5;
-		break;
-	case 5:
-		*result = interpolation_type ? (3 * alpha_0 + 4 * alpha_1) / 7 : (1 * alpha_0 + 4 * alpha_1) / 5;
-		break;
-	case 6:
-		*result = interpolation_type ? (2 * alpha_0 + 5 * alpha_1) / 7 : 0;
-		break;
-	case 7:
-		*result = interpolation_type ? (1 * alpha_0 + 6 * alpha_1) / 7 : 255;
-		break;
-	}
+	palette[0] = alpha_0;
+	palette[1] = alpha_1;
+	palette[2] = interpolation_type ? (6 * alpha_0 + 1 * alpha_1) / 7 : (4 * alpha_0 + 1 * alpha_1) / 5;
+	palette[3] = interpolation_type ? (5 * alpha_0 + 2 * alpha_1) / 7 : (3 * alpha_0 + 2 * alpha_1) / 5;
+	palette[4] = interpolation_type ? (4 * alpha_0 + 3 * alpha_1) / 7 : (2 * alpha_0 + 3 * alpha_1) / 5;
+	palette[5] = interpolation_type ? (3 * alpha_0 + 4 * alpha_1) / 7 : (1 * alpha_0 + 4 * alpha_1) / 5;
+	palette[6] = interpolation_type ? (2 * alpha_0 + 5 * alpha_1) / 7 : 0;
+	palette[7] = interpolation_type ? (1 * alpha_0 + 6 * alpha_1) / 7 : 255;
 }
 
 bool save_texture_image(const resource_desc &desc, const subresource_data &data)
@@ -286,7 +258,8 @@ bool save_texture_image(const resource_desc &desc, const subresource_data &data)
 				unpack_r5g6b5(color_0, color_0_rgb);
 				uint8_t color_1_rgb[3];
 				unpack_r5g6b5(color_1, color_1_rgb);
-				const bool degenerate = color_0 > color_1;
+				uint8_t color_palette[4][4];
+				build_bc1_palette(color_0_rgb, color_1_rgb, color_palette, color_0 > color_1);
 
 				for (int y = 0; y < 4; ++y)
 				{
@@ -294,7 +267,7 @@ bool save_texture_image(const resource_desc &desc, const subresource_data &data)
 					{
 						uint8_t *const dst = rgba_pixel_data.data() + ((block_y * 4 + y) * desc.texture.width + (block_x * 4 + x)) * 4;
 
-						unpack_bc1_value(color_0_rgb, color_1_rgb, (color_i >> (2 * (y * 4 + x))) & 0x3, dst, degenerate);
+						std::memcpy(dst, color_palette[(color_i >> (2 * (y * 4 + x))) & 0x3], 4);
 					}
 				}
 			}
@@ -328,6 +301,10 @@ bool save_texture_image(const resource_desc &desc, const subresource_data &data)
 				unpack_r5g6b5(color_0, color_0_rgb);
 				uint8_t color_1_rgb[3];
 				unpack_r5g6b5(color_1, color_1_rgb);
+				uint8_t color_palette[4][4];
+				build_bc1_palette(color_0_rgb, color_1_rgb, color_palette);
+				uint8_t alpha_palette[8];
+				build_bc4_palette(alpha_0, alpha_1, alpha_palette);
 
 				for (int y = 0; y < 4; ++y)
 				{
@@ -335,8 +312,8 @@ bool save_texture_image(const resource_desc &desc, const subresource_data &data)
 					{
 						uint8_t *const dst = rgba_pixel_data.data() + ((block_y * 4 + y) * desc.texture.width + (block_x * 4 + x)) * 4;
 
-						unpack_bc1_value(color_0_rgb, color_1_rgb, (color_i >> (2 * (y * 4 + x))) & 0x3, dst);
-						unpack_bc4_value(alpha_0, alpha_1, (alpha_i >> (3 * (y * 4 + x))) & 0x7, dst + 3);
+						std::memcpy(dst, color_palette[(color_i >> (2 * (y * 4 + x))) & 0x3], 3);
+						dst[3] = alpha_palette[(alpha_i >> (3 * (y * 4 + x))) & 0x7];
 					}
 				}
 			}
@@ -362,13 +339,16 @@ bool save_texture_image(const resource_desc &desc, const subresource_data &data)
 					(static_cast<uint64_t>(src[6]) << 32) |
 					(static_cast<uint64_t>(src[7]) << 40);
 
+				uint8_t red_palette[8];
+				build_bc4_palette(red_0, red_1, red_palette);
+
 				for (int y = 0; y < 4; ++y)
 				{
 					for (int x = 0; x < 4; ++x)
 					{
 						uint8_t *const dst = rgba_pixel_data.data() + ((block_y * 4 + y) * desc.texture.width + (block_x * 4 + x)) * 4;
 
-						unpack_bc4_value(red_0, red_1, (red_i >> (3 * (y * 4 + x))) & 0x7, dst);
+						dst[0] = red_palette[(red_i >> (3 * (y * 4 + x))) & 0x7];
 						dst[1] = dst[0];
 						dst[2] = dst[0];
 						dst[3] = 255;
@@ -407,14 +387,19 @@ bool save_texture_image(const resource_desc &desc, const subresource_data &data)
 					(static_cast<uint64_t>(src[14]) << 32) |
 					(static_cast<uint64_t>(src[15]) << 40);
 
+				uint8_t red_palette[8];
+				build_bc4_palette(red_0, red_1, red_palette);
+				uint8_t green_palette[8];
+				build_bc4_palette(green_0, green_1, green_palette);
+
 				for (int y = 0; y < 4; ++y)
 				{
 					for (int x = 0; x < 4; ++x)
 					{
 						uint8_t *const dst = rgba_pixel_data.data() + ((block_y * 4 + y) * desc.texture.width + (block_x * 4 + x)) * 4;
 
-						unpack_bc4_value(red_0, red_1, (red_i >> (3 * (y * 4 + x))) & 0x7, dst);
-						unpack_bc4_value(green_0, green_1, (green_i >> (3 * (y * 4 + x))) & 0x7, dst + 1);
+						dst[0] = red_palette[(red_i >> (3 * (y * 4 + x))) & 0x7];
+						dst[1] = green_palette[(green_i >> (3 * (y * 4 + x))) & 0x7];
 						dst[2] = 0;
 						dst[3] = 255;
 					}
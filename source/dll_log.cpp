@@ -4,7 +4,13 @@
  */
 
 #include "dll_log.hpp"
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
 #include <cstdarg>
+#include <cstring> // std::memchr, std::memcpy
+#include <algorithm> // std::stable_sort
 #include <Windows.h>
 
 struct scoped_file_handle
@@ -27,7 +33,305 @@ private:
 	HANDLE handle;
 };
 
+namespace
+{
+	/// <summary>
+	/// Ring buffer of log messages of a single thread.
+	/// The thread that owns it is the only one writing to it and the background writer thread is the only one reading from it, so no locks are needed.
+	/// </summary>
+	struct thread_ring_buffer
+	{
+		// Has to be a power of two, so that offsets can be wrapped around with a mask
+		static constexpr size_t capacity = 64 * 1024;
+
+		const DWORD thread_id = GetCurrentThreadId();
+		// Total number of bytes ever written to and read from the ring buffer (these only ever increase, the position in the buffer is the offset modulo capacity)
+		std::atomic<size_t> write_offset = 0;
+		std::atomic<size_t> read_offset = 0;
+		std::atomic<uint32_t> dropped_messages = 0;
+		// Set once the owning thread exited, so that the ring buffer can be released after everything in it was written
+		std::atomic<bool> abandoned = false;
+		char data[capacity];
+
+		void write(size_t offset, const void *src, size_t size)
+		{
+			offset &= capacity - 1;
+			const size_t size_before_wrap = std::min(size, capacity - offset);
+			std::memcpy(data + offset, src, size_before_wrap);
+			std::memcpy(data, static_cast<const char *>(src) + size_before_wrap, size - size_before_wrap);
+		}
+		void read(size_t offset, void *dst, size_t size) const
+		{
+			offset &= capacity - 1;
+			const size_t size_before_wrap = std::min(size, capacity - offset);
+			std::memcpy(dst, data + offset, size_before_wrap);
+			std::memcpy(static_cast<char *>(dst) + size_before_wrap, data, size - size_before_wrap);
+		}
+	};
+
+	/// <summary>
+	/// Keeps the ring buffer of the current thread alive until the thread exits.
+	/// </summary>
+	struct thread_ring_buffer_reference
+	{
+		std::shared_ptr<thread_ring_buffer> ring_buffer;
+
+		~thread_ring_buffer_reference()
+		{
+			if (ring_buffer != nullptr)
+				ring_buffer->abandoned.store(true, std::memory_order_release);
+		}
+	};
+
+	/// <summary>
+	/// A message that was taken out of a ring buffer, with the text stored in a separate shared buffer.
+	/// </summary>
+	struct staged_record
+	{
+		reshade::log::binary_record_header header;
+		size_t text_offset;
+	};
+}
+
+static_assert(sizeof(reshade::log::binary_file_header) == 8 && sizeof(reshade::log::binary_record_header) == 24, "unexpected binary log format structure size");
+
+static constexpr char s_level_names[][6] = { "ERROR", "WARN ", "INFO ", "DEBUG" };
+
 static scoped_file_handle s_log_file_handle;
+static bool s_binary_format = false;
+
+static std::atomic<bool> s_async_logging = false;
+static std::atomic<bool> s_writer_exit = false;
+static HANDLE s_writer_thread = nullptr;
+static HANDLE s_writer_wake_event = nullptr;
+static HANDLE s_writer_finished_event = nullptr;
+static std::atomic<uint64_t> s_dropped_message_count = 0;
+
+static std::mutex s_ring_buffers_mutex;
+static std::vector<std::shared_ptr<thread_ring_buffer>> s_ring_buffers;
+static thread_local thread_ring_buffer_reference t_ring_buffer;
+
+// Protects the staging buffers below and ensures that only one thread at a time takes messages out of the ring buffers
+static std::mutex s_drain_mutex;
+static std::vector<staged_record> s_staged_records;
+static std::string s_staged_text;
+static std::string s_batch;
+
+static uint64_t current_time()
+{
+	FILETIME time;
+	GetSystemTimeAsFileTime(&time);
+	return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+}
+
+// Appends a message in the text format to the output, with all LF replaced by CRLF
+static void append_text_line(std::string &output, const reshade::log::binary_record_header &header, const char *text)
+{
+	const uint64_t utc_time_value = header.time;
+	FILETIME utc_time, local_time;
+	utc_time.dwLowDateTime = static_cast<DWORD>(utc_time_value);
+	utc_time.dwHighDateTime = static_cast<DWORD>(utc_time_value >> 32);
+	SYSTEMTIME time = {};
+	FileTimeToLocalFileTime(&utc_time, &local_time);
+	FileTimeToSystemTime(&local_time, &time);
+
+	char prefix[64];
+	const int prefix_length = std::snprintf(prefix, std::size(prefix),
+#if RESHADE_VERBOSE_LOG
+		"%04hd-%02hd-%02hdT"
+#endif
+		"%02hd:%02hd:%02hd:%03hd [%5lu] | %.5s | ",
+#if RESHADE_VERBOSE_LOG
+		time.wYear, time.wMonth, time.wDay,
+#endif
+		time.wHour, time.wMinute, time.wSecond, time.wMilliseconds, static_cast<unsigned long>(header.thread_id), s_level_names[header.level - 1]);
+	output.append(prefix, prefix_length);
+
+	for (const char *const text_end = text + header.length; text < text_end;)
+	{
+		const char *const line_end = static_cast<const char *>(std::memchr(text, '\n', text_end - text));
+		if (line_end == nullptr)
+		{
+			output.append(text, text_end - text);
+			break;
+		}
+
+		output.append(text, line_end - text);
+		output += "\r\n";
+		text = line_end + 1;
+	}
+
+	output += "\r\n"; // Terminate line with line feed
+}
+// Appends a message in the format of the log file to the output
+static void append_record(std::string &output, const reshade::log::binary_record_header &header, const char *text)
+{
+	if (s_binary_format)
+	{
+		output.append(reinterpret_cast<const char *>(&header), sizeof(header));
+		output.append(text, header.length);
+	}
+	else
+	{
+		append_text_line(output, header, text);
+	}
+}
+
+static void write_to_log_file(const std::string &data)
+{
+	if (s_log_file_handle == INVALID_HANDLE_VALUE || data.empty())
+		return;
+
+	DWORD written = 0;
+	WriteFile(s_log_file_handle, data.data(), static_cast<DWORD>(data.size()), &written, nullptr);
+	assert(written == data.size());
+}
+
+// Takes all messages out of the ring buffers and writes them to the log file with a single write
+// The drain mutex has to be locked when calling this
+static void drain_ring_buffers()
+{
+	{
+		const std::lock_guard<std::mutex> lock(s_ring_buffers_mutex);
+
+		for (auto it = s_ring_buffers.begin(); it != s_ring_buffers.end();)
+		{
+			thread_ring_buffer &ring_buffer = **it;
+
+			// Check whether the thread exited before reading the write offset, so that messages it logged right before exiting are not missed
+			const bool abandoned = ring_buffer.abandoned.load(std::memory_order_acquire);
+
+			const size_t write_offset = ring_buffer.write_offset.load(std::memory_order_acquire);
+			size_t read_offset = ring_buffer.read_offset.load(std::memory_order_relaxed);
+
+			while (read_offset != write_offset)
+			{
+				staged_record &record = s_staged_records.emplace_back();
+				ring_buffer.read(read_offset, &record.header, sizeof(record.header));
+				record.text_offset = s_staged_text.size();
+				s_staged_text.resize(record.text_offset + record.header.length);
+				ring_buffer.read(read_offset + sizeof(record.header), s_staged_text.data() + record.text_offset, record.header.length);
+
+				read_offset += sizeof(record.header) + record.header.length;
+			}
+
+			// Give the space back to the logging thread
+			ring_buffer.read_offset.store(read_offset, std::memory_order_release);
+
+			if (const uint32_t dropped_messages = ring_buffer.dropped_messages.exchange(0, std::memory_order_relaxed);
+				dropped_messages != 0)
+			{
+				s_dropped_message_count.fetch_add(dropped_messages, std::memory_order_relaxed);
+
+				char text[128];
+				const int length = std::snprintf(text, std::size(text), "Dropped %u log message(s) because they were logged faster than they could be written.", dropped_messages);
+
+				staged_record &record = s_staged_records.emplace_back();
+				record.header.time = current_time();
+				record.header.thread_id = ring_buffer.thread_id;
+				record.header.level = static_cast<uint32_t>(reshade::log::level::warning);
+				record.header.length = static_cast<uint32_t>(length);
+				record.text_offset = s_staged_text.size();
+				s_staged_text.append(text, length);
+			}
+
+			if (abandoned)
+				it = s_ring_buffers.erase(it);
+			else
+				++it;
+		}
+	}
+
+	if (s_staged_records.empty())
+		return;
+
+	// Messages of different threads are interleaved by the time they were logged at (the sort is stable, so messages of the same thread stay in order even if logged within the same timer tick)
+	std::stable_sort(s_staged_records.begin(), s_staged_records.end(),
+		[](const staged_record &lhs, const staged_record &rhs) { return lhs.header.time < rhs.header.time; });
+
+	for (const staged_record &record : s_staged_records)
+		append_record(s_batch, record.header, s_staged_text.data() + record.text_offset);
+
+	write_to_log_file(s_batch);
+
+#ifndef NDEBUG
+	// Write lines to the debug output
+	if (s_binary_format)
+	{
+		s_batch.clear();
+		for (const staged_record &record : s_staged_records)
+			append_text_line(s_batch, record.header, s_staged_text.data() + record.text_offset);
+	}
+	OutputDebugStringA(s_batch.c_str());
+#endif
+
+	// Keep the memory of the staging buffers around for the next batch
+	s_staged_records.clear();
+	s_staged_text.clear();
+	s_batch.clear();
+}
+
+static DWORD WINAPI writer_thread_main(LPVOID parameter)
+{
+	// Reference to the ReShade module that was taken for this thread when it was created, so that the module cannot be unloaded while the thread still runs code in it
+	const HMODULE module = static_cast<HMODULE>(parameter);
+
+	while (!s_writer_exit.load(std::memory_order_acquire))
+	{
+		// Write out messages periodically, or earlier when a logging thread asks for it
+		WaitForSingleObject(s_writer_wake_event, 100);
+
+		const std::lock_guard<std::mutex> lock(s_drain_mutex);
+		drain_ring_buffers();
+	}
+
+	SetEvent(s_writer_finished_event);
+
+	// Release the module reference and exit without returning into module code, which may be unloaded as soon as the reference is released
+	FreeLibraryAndExitThread(module, 0);
+}
+
+// Queues a message in the ring buffer of the current thread
+// Returns false if the message is too large for the ring buffer and has to be written directly instead
+static bool enqueue_message(const reshade::log::binary_record_header &header, const char *text)
+{
+	thread_ring_buffer_reference &reference = t_ring_buffer;
+	if (reference.ring_buffer == nullptr)
+	{
+		reference.ring_buffer = std::make_shared<thread_ring_buffer>();
+
+		const std::lock_guard<std::mutex> lock(s_ring_buffers_mutex);
+		s_ring_buffers.push_back(reference.ring_buffer);
+	}
+
+	thread_ring_buffer &ring_buffer = *reference.ring_buffer;
+
+	const size_t record_size = sizeof(header) + header.length;
+	if (record_size > thread_ring_buffer::capacity / 4)
+		return false;
+
+	const size_t write_offset = ring_buffer.write_offset.load(std::memory_order_relaxed);
+	const size_t read_offset = ring_buffer.read_offset.load(std::memory_order_acquire);
+	const size_t used_size = write_offset - read_offset;
+
+	// Never block the calling thread, so drop the message if the writer thread cannot keep up
+	if (thread_ring_buffer::capacity - used_size < record_size)
+	{
+		if (ring_buffer.dropped_messages.fetch_add(1, std::memory_order_relaxed) == 0)
+			SetEvent(s_writer_wake_event);
+		return true;
+	}
+
+	ring_buffer.write(write_offset, &header, sizeof(header));
+	ring_buffer.write(write_offset + sizeof(header), text, header.length);
+	ring_buffer.write_offset.store(write_offset + record_size, std::memory_order_release);
+
+	// Wake up the writer thread early on errors (so that they make it to disk before a potential crash) and when the ring buffer becomes half full
+	if (header.level == static_cast<uint32_t>(reshade::log::level::error) || (used_size < thread_ring_buffer::capacity / 2 && used_size + record_size >= thread_ring_buffer::capacity / 2))
+		SetEvent(s_writer_wake_event);
+
+	return true;
+}
 
 bool reshade::log::open_log_file(const std::filesystem::path &path, std::error_code &ec)
 {
@@ -52,62 +356,155 @@ bool reshade::log::open_log_file(const std::filesystem::path &path, std::error_c
 	}
 }
 
-void reshade::log::message(level level, const char *format, ...)
+void reshade::log::start_async_logging(bool binary)
+{
+	if (s_async_logging.load(std::memory_order_acquire))
+		return;
+
+	if (binary && !s_binary_format)
+	{
+		s_binary_format = true;
+
+		const binary_file_header file_header;
+		write_to_log_file(std::string(reinterpret_cast<const char *>(&file_header), sizeof(file_header)));
+	}
+
+	s_writer_exit.store(false, std::memory_order_relaxed);
+	s_writer_wake_event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+	s_writer_finished_event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+	// The writer thread holds a reference to the ReShade module while it runs (which it releases on exit), since it may still be executing after the module was asked to unload
+	if (HMODULE module = nullptr;
+		s_writer_wake_event != nullptr && s_writer_finished_event != nullptr &&
+		GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, reinterpret_cast<LPCWSTR>(&writer_thread_main), &module))
+	{
+		s_writer_thread = CreateThread(nullptr, 0, &writer_thread_main, module, 0, nullptr);
+		if (s_writer_thread == nullptr)
+			FreeLibrary(module);
+	}
+
+	if (s_writer_thread == nullptr)
+	{
+		// Keep logging synchronously if the writer thread could not be created
+		if (s_writer_wake_event != nullptr)
+			CloseHandle(s_writer_wake_event), s_writer_wake_event = nullptr;
+		if (s_writer_finished_event != nullptr)
+			CloseHandle(s_writer_finished_event), s_writer_finished_event = nullptr;
+		return;
+	}
+
+	s_async_logging.store(true, std::memory_order_release);
+}
+
+void reshade::log::stop_async_logging(bool process_terminating)
 {
-	static constexpr char level_names[][6] = { "ERROR", "WARN ", "INFO ", "DEBUG" };
+	if (!s_async_logging.exchange(false, std::memory_order_acq_rel))
+		return;
 
+	s_writer_exit.store(true, std::memory_order_release);
+	SetEvent(s_writer_wake_event);
+
+	// Cannot wait on the thread handle, since this is usually called while the loader lock is held (from 'DllMain'), which the exiting thread needs to acquire too
+	// The writer thread keeps the module loaded until it exits, so it is safe for it to still be running after the wait below (e.g. if it timed out)
+	// When the process is terminating, the writer thread was already killed, possibly while holding one of the locks, so do not wait on anything then
+	const bool writer_running = !process_terminating && WaitForSingleObject(s_writer_finished_event, 1000) != WAIT_OBJECT_0;
+
+	// Write any messages that were queued after the writer thread finished
+	if (s_drain_mutex.try_lock())
+	{
+		if (s_ring_buffers_mutex.try_lock())
+		{
+			s_ring_buffers_mutex.unlock();
+			drain_ring_buffers();
+		}
+
+		s_drain_mutex.unlock();
+	}
+
+	CloseHandle(s_writer_thread);
+	s_writer_thread = nullptr;
+
+	// Leak the events if the writer thread is still running, since it signals the finished event right before it exits
+	if (!writer_running)
+	{
+		CloseHandle(s_writer_wake_event);
+		CloseHandle(s_writer_finished_event);
+	}
+	s_writer_wake_event = nullptr;
+	s_writer_finished_event = nullptr;
+}
+
+uint64_t reshade::log::dropped_message_count()
+{
+	return s_dropped_message_count.load(std::memory_order_relaxed);
+}
+
+void reshade::log::message(level level, const char *format, ...)
+{
 	if (static_cast<size_t>(level) == 0)
 		level = level::error;
-	if (static_cast<size_t>(level) > std::size(level_names))
+	if (static_cast<size_t>(level) > std::size(s_level_names))
 		level = level::debug;
 
-	SYSTEMTIME time;
-	GetLocalTime(&time);
-
-	std::string line_string(256, '\0');
-
-	// Start a new line
-	const auto meta_length = std::snprintf(line_string.data(), line_string.size(),
-#if RESHADE_VERBOSE_LOG
-		"%04hd-%02hd-%02hdT"
-#endif
-		"%02hd:%02hd:%02hd:%03hd [%5lu] | %.5s | ",
-#if RESHADE_VERBOSE_LOG
-		time.wYear, time.wMonth, time.wDay,
-#endif
-		time.wHour, time.wMinute, time.wSecond, time.wMilliseconds, GetCurrentThreadId(), level_names[static_cast<size_t>(level) - 1]);
+	// Format into a buffer on the stack first, which is large enough for most messages, to avoid a heap allocation
+	char text_buffer[512];
+	std::string text_string;
+	const char *text = text_buffer;
 
 	va_list args;
 	va_start(args, format);
-	const auto content_length = std::vsnprintf(line_string.data() + meta_length, line_string.size() + 1 - meta_length, format, args);
+	const int content_length = std::vsnprintf(text_buffer, std::size(text_buffer), format, args);
 	va_end(args);
 
-	const bool remaining_content = static_cast<size_t>(meta_length) + static_cast<size_t>(content_length) > line_string.size();
-	line_string.resize(static_cast<size_t>(meta_length) + static_cast<size_t>(content_length));
+	if (content_length < 0)
+		return;
 
-	if (remaining_content)
+	const size_t length = static_cast<size_t>(content_length);
+	if (length >= std::size(text_buffer))
 	{
+		text_string.resize(length);
+
 		va_start(args, format);
-		std::vsnprintf(line_string.data() + meta_length, line_string.size() + 1 - meta_length, format, args);
+		std::vsnprintf(text_string.data(), length + 1, format, args);
 		va_end(args);
-	}
 
-	line_string += '\n'; // Terminate line with line feed
+		text = text_string.data();
+	}
 
-	// Replace all LF with CRLF
-	for (size_t offset = 0; (offset = line_string.find('\n', offset)) != std::string::npos; offset += 2)
-		line_string.replace(offset, 1, "\r\n", 2);
+	binary_record_header header;
+	header.time = current_time();
+	header.thread_id = GetCurrentThreadId();
+	header.level = static_cast<uint32_t>(level);
+	header.length = static_cast<uint32_t>(length);
 
-	// Write line to the log file
-	if (s_log_file_handle != INVALID_HANDLE_VALUE)
+	if (s_async_logging.load(std::memory_order_acquire))
 	{
-		DWORD written = 0;
-		WriteFile(s_log_file_handle, line_string.data(), static_cast<DWORD>(line_string.size()), &written, nullptr);
-		assert(written == line_string.size());
+		if (enqueue_message(header, text))
+			return;
+
+		// Message is too large for the ring buffer, so write all queued messages first to keep them in order and then this one directly
+		const std::lock_guard<std::mutex> lock(s_drain_mutex);
+		drain_ring_buffers();
+
+		append_record(s_batch, header, text);
+		write_to_log_file(s_batch);
+		s_batch.clear();
+		return;
 	}
 
+	std::string line_string;
+	line_string.reserve(64 + length);
+	append_record(line_string, header, text);
+
+	// Write line to the log file
+	write_to_log_file(line_string);
+
 #ifndef NDEBUG
 	// Write line to the debug output
+	if (s_binary_format)
+	{
+		line_string.clear();
+		append_text_line(line_string, header, text);
+	}
 	OutputDebugStringA(line_string.c_str());
 #endif
 }
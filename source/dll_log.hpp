@@ -6,6 +6,7 @@
 #pragma once
 
 #include <cassert>
+#include <cstdint>
 #include <cinttypes>
 #include <string>
 #include <filesystem>
@@ -42,11 +43,57 @@ namespace reshade::log
 	/// <param name="ec">Error code that is set on failure.</param>
 	bool open_log_file(const std::filesystem::path &path, std::error_code &ec);
 
+	/// <summary>
+	/// Switches to asynchronous logging, where messages are queued in a ring buffer per thread and written to the open log file in batches by a background thread.
+	/// Messages are dropped instead of blocking the calling thread when its ring buffer is full, which is reported in the log once there is space again (see <see cref="dropped_message_count"/>).
+	/// </summary>
+	/// <param name="binary">Write messages in the compact binary format described by <see cref="binary_file_header"/> and <see cref="binary_record_header"/> instead of text. The log file has to be empty when enabling this.</param>
+	void start_async_logging(bool binary);
+	/// <summary>
+	/// Writes all queued messages and switches back to synchronous logging.
+	/// </summary>
+	/// <param name="process_terminating">Set to <see langword="true"/> when the process is exiting, in which case the background thread was already terminated and is not waited on.</param>
+	void stop_async_logging(bool process_terminating);
+	/// <summary>
+	/// Gets the total number of messages that were dropped because the ring buffer of the logging thread was full.
+	/// </summary>
+	uint64_t dropped_message_count();
+
 	/// <summary>
 	/// Constructs a single log message including current time and level and writes it to the open log file.
 	/// </summary>
 	void message(level level, const char *format, ...);
 
+	/// <summary>
+	/// Header at the start of a log file in the binary format, which is followed by a sequence of records.
+	/// </summary>
+	struct binary_file_header
+	{
+		static constexpr uint32_t magic_value = 0x474C5352; // 'RSLG'
+		static constexpr uint32_t version_value = 1;
+
+		uint32_t magic = magic_value;
+		uint32_t version = version_value;
+	};
+
+	/// <summary>
+	/// Header of a single message in a log file in the binary format, which is followed by the UTF-8 message text (without null-terminator).
+	/// </summary>
+	struct binary_record_header
+	{
+		/// <summary>
+		/// Time the message was logged at, as the number of 100-nanosecond intervals since January 1, 1601 (UTC).
+		/// </summary>
+		uint64_t time;
+		uint32_t thread_id;
+		uint32_t level;
+		/// <summary>
+		/// Length of the message text in bytes.
+		/// </summary>
+		uint32_t length;
+		uint32_t reserved = 0;
+	};
+
 #if defined(_HRESULT_DEFINED)
 	inline std::string hr_to_string(HRESULT hr)
 	{
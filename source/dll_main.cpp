@@ -114,7 +114,7 @@ std::filesystem::path get_module_path(HMODULE module)
 static PVOID s_exception_handler_handle = nullptr;
 #endif
 
-BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
+BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID lpReserved)
 {
 	switch (fdwReason)
 	{
@@ -172,8 +172,14 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
 
 			if (config.get("INSTALL", "Logging") || (!config.has("INSTALL", "Logging") && !GetEnvironmentVariableW(L"RESHADE_DISABLE_LOGGING", nullptr, 0)))
 			{
+				// Binary log files are written asynchronously too and use a different extension, since they need to be converted to text to be read
+				const bool binary_logging = config.get("INSTALL", "BinaryLogging");
+				const bool async_logging = binary_logging || config.get("INSTALL", "AsyncLogging");
+
+				const std::wstring log_extension = binary_logging ? L".binlog" : L".log";
+
 				std::filesystem::path log_path = config.path();
-				log_path.replace_extension(L".log");
+				log_path.replace_extension(log_extension);
 
 				std::error_code ec;
 				if (!reshade::log::open_log_file(log_path, ec))
@@ -181,7 +187,7 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
 					// Try a different file if the default failed to open (e.g. because currently in use by another ReShade instance)
 					for (int log_index = 0; log_index < 10 && std::filesystem::exists(log_path, ec); ++log_index)
 					{
-						log_path.replace_extension(L".log" + std::to_wstring(log_index + 1));
+						log_path.replace_extension(log_extension + std::to_wstring(log_index + 1));
 
 						if (reshade::log::open_log_file(log_path, ec))
 							break;
@@ -192,6 +198,9 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
 						reshade::log::message(reshade::log::level::error, "Opening the ReShade log file failed with error code %d.", ec.value());
 #endif
 				}
+
+				if (async_logging)
+					reshade::log::start_async_logging(binary_logging);
 			}
 
 			reshade::log::message(reshade::log::level::info,
@@ -415,6 +424,9 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
 #endif
 
 			reshade::log::message(reshade::log::level::info, "Finished exiting.");
+
+			// Write out any remaining queued log messages (the background writer thread was already terminated if the process is exiting, which is the case when 'lpReserved' is not null)
+			reshade::log::stop_async_logging(lpReserved != nullptr);
 		}
 		break;
 	}
@@ -11,6 +11,11 @@
 #include "addon_manager.hpp"
 #include "com_ptr.hpp"
 #include "ini_file.hpp"
+#include "runtime.hpp"
+#include "runtime_manager.hpp"
+#include "null/null_impl_swapchain.hpp"
+#include <chrono>
+#include <fstream>
 #include <d3d9.h>
 #include <d3d11.h>
 #include <d3d12.h>
@@ -62,6 +67,98 @@ static LONG APIENTRY HookD3DKMTQueryAdapterInfo(const void *pData)
 	return reshade::hooks::call(HookD3DKMTQueryAdapterInfo)(pData);
 }
 
+// Runs the effect runtime on a null device without any window or graphics driver, to measure effect loading and per-frame CPU costs in isolation
+static int run_null_benchmark(LPSTR lpCmdLine, LONG width, LONG height)
+{
+	reshade::api::device_api api = reshade::api::device_api::d3d11;
+	if (strstr(lpCmdLine, "-d3d9"))
+		api = reshade::api::device_api::d3d9;
+	if (strstr(lpCmdLine, "-d3d10"))
+		api = reshade::api::device_api::d3d10;
+	if (strstr(lpCmdLine, "-d3d12"))
+		api = reshade::api::device_api::d3d12;
+	if (strstr(lpCmdLine, "-opengl"))
+		api = reshade::api::device_api::opengl;
+	if (strstr(lpCmdLine, "-vulkan"))
+		api = reshade::api::device_api::vulkan;
+
+	unsigned long frame_count = 1000;
+	if (LPSTR frames_arg = std::strstr(lpCmdLine, "-frames "))
+		frame_count = std::strtoul(frames_arg + 8, nullptr, 10);
+	unsigned long preset_interval = 0;
+	if (LPSTR interval_arg = std::strstr(lpCmdLine, "-preset-interval "))
+		preset_interval = std::strtoul(interval_arg + 17, nullptr, 10);
+
+	// Read list of presets to cycle through (one path per line)
+	std::vector<std::string> presets;
+	if (LPSTR presets_arg = std::strstr(lpCmdLine, "-presets "))
+	{
+		std::string list_path = presets_arg + 9;
+		list_path.erase(std::min(list_path.find(' '), list_path.size()));
+
+		std::ifstream list_file(list_path);
+		for (std::string line; std::getline(list_file, line);)
+			if (!line.empty())
+				presets.push_back(std::move(line));
+	}
+
+	reshade::null::device_impl device(api, strstr(lpCmdLine, "-validation") != nullptr);
+	reshade::null::swapchain_impl swapchain(&device, width, height);
+
+	reshade::create_effect_runtime(&swapchain, &device);
+	reshade::init_effect_runtime(&swapchain);
+
+	const auto runtime = swapchain.get_private_data<reshade::runtime>();
+	if (runtime == nullptr)
+		return EXIT_FAILURE;
+
+	// Keep presenting until all effects finished compiling, so that loading is measured the same way it happens in a real application
+	const auto load_start = std::chrono::high_resolution_clock::now();
+	do
+	{
+		reshade::present_effect_runtime(&swapchain);
+		swapchain.present();
+	} while (runtime->is_loading());
+	const auto load_end = std::chrono::high_resolution_clock::now();
+
+	reshade::log::message(reshade::log::level::info, "Null device finished loading effects in %.3f ms.", std::chrono::duration<double, std::milli>(load_end - load_start).count());
+
+	device.reset_statistics();
+
+	double frame_time_total = 0.0, frame_time_min = std::numeric_limits<double>::max(), frame_time_max = 0.0;
+
+	for (unsigned long frame = 0; frame < frame_count; ++frame)
+	{
+		if (preset_interval != 0 && !presets.empty() && frame % preset_interval == 0)
+			runtime->set_current_preset_path(presets[(frame / preset_interval) % presets.size()].c_str());
+
+		const auto frame_start = std::chrono::high_resolution_clock::now();
+		reshade::present_effect_runtime(&swapchain);
+		swapchain.present();
+		const auto frame_end = std::chrono::high_resolution_clock::now();
+
+		const double frame_time = std::chrono::duration<double, std::milli>(frame_end - frame_start).count();
+		frame_time_total += frame_time;
+		frame_time_min = std::min(frame_time_min, frame_time);
+		frame_time_max = std::max(frame_time_max, frame_time);
+	}
+
+	if (frame_count != 0)
+	{
+		reshade::log::message(reshade::log::level::info, "Null device rendered %lu frames in %.3f ms (avg %.4f ms, min %.4f ms, max %.4f ms, %.1f bytes recorded per frame, %llu validation errors).",
+			frame_count, frame_time_total, frame_time_total / frame_count, frame_time_min, frame_time_max, static_cast<double>(device.get_recorded_bytes()) / frame_count, device.get_validation_errors());
+
+		const auto &call_counts = device.get_call_counts();
+		for (size_t i = 0; i < call_counts.size(); ++i)
+			if (call_counts[i] != 0)
+				reshade::log::message(reshade::log::level::info, "> Event %zu: %.2f calls per frame", i, static_cast<double>(call_counts[i]) / frame_count);
+	}
+
+	reshade::destroy_effect_runtime(&swapchain);
+
+	return device.get_validation_errors() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR lpCmdLine, int nCmdShow)
 {
 	g_module_handle = hInstance;
@@ -109,6 +206,13 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR lpCmdLine, int nCmdShow
 	if (LPSTR height_arg = std::strstr(lpCmdLine, "-height "))
 		window_h = std::strtol(height_arg + 8, nullptr, 10);
 
+	if (strstr(lpCmdLine, "-null"))
+	{
+		const int result = run_null_benchmark(lpCmdLine, window_w, window_h);
+		reshade::hooks::uninstall();
+		return result;
+	}
+
 	const LONG window_x = (GetSystemMetrics(SM_CXSCREEN) - window_w) / 2;
 	const LONG window_y = (GetSystemMetrics(SM_CYSCREEN) - window_h) / 2;
 
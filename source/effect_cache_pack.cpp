@@ -0,0 +1,459 @@
+/*
+ * Copyright (C) 2026 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "effect_cache_pack.hpp"
+#include <chrono>
+#include <cstddef> // offsetof
+#include <cstring> // std::memcmp, std::memcpy
+#include <vector>
+#include <algorithm> // std::sort
+#include <Windows.h>
+
+static const char s_pack_magic[8] = { 'R', 'S', 'F', 'X', 'P', 'A', 'C', 'K' };
+static const uint32_t s_pack_version = 1;
+static const uint32_t s_record_magic = 0x43455352; // "RSEC"
+
+struct pack_header
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t reserved;
+};
+
+struct record_header
+{
+	uint32_t magic;
+	uint32_t size;
+	uint64_t key[2];
+	uint64_t checksum;
+	uint64_t last_access_time;
+};
+
+static uint64_t current_time()
+{
+	return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static inline uint64_t rotl64(uint64_t x, int r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+static inline uint64_t fmix64(uint64_t k)
+{
+	k ^= k >> 33;
+	k *= 0xff51afd7ed558ccdull;
+	k ^= k >> 33;
+	k *= 0xc4ceb9fe1a85ec53ull;
+	k ^= k >> 33;
+	return k;
+}
+
+auto reshade::effect_cache_pack::compute_key(const void *data, size_t size) -> key
+{
+	// MurmurHash3 (x64, 128-bit variant), see https://github.com/aappleby/smhasher/blob/master/src/MurmurHash3.cpp
+	const auto bytes = static_cast<const uint8_t *>(data);
+	const size_t num_blocks = size / 16;
+
+	const uint64_t c1 = 0x87c37b91114253d5ull;
+	const uint64_t c2 = 0x4cf5ad432745937full;
+
+	uint64_t h1 = 0;
+	uint64_t h2 = 0;
+
+	for (size_t i = 0; i < num_blocks; ++i)
+	{
+		uint64_t k1, k2;
+		std::memcpy(&k1, bytes + i * 16 + 0, sizeof(k1));
+		std::memcpy(&k2, bytes + i * 16 + 8, sizeof(k2));
+
+		k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+		h1 = rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+		k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+		h2 = rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+	}
+
+	const uint8_t *const tail = bytes + num_blocks * 16;
+	uint64_t k1 = 0;
+	uint64_t k2 = 0;
+
+	switch (size & 15)
+	{
+	case 15: k2 ^= static_cast<uint64_t>(tail[14]) << 48; [[fallthrough]];
+	case 14: k2 ^= static_cast<uint64_t>(tail[13]) << 40; [[fallthrough]];
+	case 13: k2 ^= static_cast<uint64_t>(tail[12]) << 32; [[fallthrough]];
+	case 12: k2 ^= static_cast<uint64_t>(tail[11]) << 24; [[fallthrough]];
+	case 11: k2 ^= static_cast<uint64_t>(tail[10]) << 16; [[fallthrough]];
+	case 10: k2 ^= static_cast<uint64_t>(tail[ 9]) << 8; [[fallthrough]];
+	case  9: k2 ^= static_cast<uint64_t>(tail[ 8]) << 0;
+		k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+		[[fallthrough]];
+	case  8: k1 ^= static_cast<uint64_t>(tail[ 7]) << 56; [[fallthrough]];
+	case  7: k1 ^= static_cast<uint64_t>(tail[ 6]) << 48; [[fallthrough]];
+	case  6: k1 ^= static_cast<uint64_t>(tail[ 5]) << 40; [[fallthrough]];
+	case  5: k1 ^= static_cast<uint64_t>(tail[ 4]) << 32; [[fallthrough]];
+	case  4: k1 ^= static_cast<uint64_t>(tail[ 3]) << 24; [[fallthrough]];
+	case  3: k1 ^= static_cast<uint64_t>(tail[ 2]) << 16; [[fallthrough]];
+	case  2: k1 ^= static_cast<uint64_t>(tail[ 1]) << 8; [[fallthrough]];
+	case  1: k1 ^= static_cast<uint64_t>(tail[ 0]) << 0;
+		k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+		break;
+	}
+
+	h1 ^= size;
+	h2 ^= size;
+	h1 += h2;
+	h2 += h1;
+	h1 = fmix64(h1);
+	h2 = fmix64(h2);
+	h1 += h2;
+	h2 += h1;
+
+	return { { h1, h2 } };
+}
+
+std::string reshade::effect_cache_pack::key_to_string(const key &key)
+{
+	char hex[33];
+	for (int i = 0; i < 32; ++i)
+		hex[i] = "0123456789abcdef"[(key.hash[i / 16] >> (60 - (i % 16) * 4)) & 0xF];
+	return std::string(hex, 32);
+}
+
+static bool read_at(HANDLE file, uint64_t offset, void *data, size_t size)
+{
+	OVERLAPPED overlapped = {};
+	overlapped.Offset = static_cast<DWORD>(offset);
+	overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+	DWORD size_read = 0;
+	return ReadFile(file, data, static_cast<DWORD>(size), &size_read, &overlapped) && size_read == size;
+}
+static bool write_at(HANDLE file, uint64_t offset, const void *data, size_t size)
+{
+	OVERLAPPED overlapped = {};
+	overlapped.Offset = static_cast<DWORD>(offset);
+	overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+	DWORD size_written = 0;
+	return WriteFile(file, data, static_cast<DWORD>(size), &size_written, &overlapped) && size_written == size;
+}
+
+reshade::effect_cache_pack::~effect_cache_pack()
+{
+	close();
+}
+
+bool reshade::effect_cache_pack::open(const std::filesystem::path &path, uint64_t max_size)
+{
+	const std::unique_lock<std::mutex> lock(_mutex);
+
+	close_file();
+
+	_path = path;
+	_max_size = max_size;
+	_compaction_failed = false;
+
+	if (!open_file(false))
+		return false;
+
+	if (!read_index())
+		return false;
+
+	// The pack header is not part of any record, so do not count it as dead space (otherwise an empty pack would be compacted every time it is opened)
+	const uint64_t dead_size = _file_size - sizeof(pack_header) - _live_size;
+
+	// Leave some headroom after compaction, so that the next few appends do not immediately cause another compaction
+	if (_file_size > _max_size || dead_size > (_file_size / 2))
+		_compaction_failed = !compact(_max_size * 3 / 4);
+
+	return true;
+}
+void reshade::effect_cache_pack::close()
+{
+	const std::unique_lock<std::mutex> lock(_mutex);
+
+	close_file();
+
+	_path.clear();
+}
+
+bool reshade::effect_cache_pack::load(const key &key, std::string &data)
+{
+	const std::unique_lock<std::mutex> lock(_mutex);
+
+	const auto it = _index.find(key);
+	if (it == _index.end())
+		return false;
+
+	const uint64_t data_offset = it->second.offset + sizeof(record_header);
+
+	data.resize(it->second.size);
+	if (data_offset + data.size() <= _mapped_size)
+		std::memcpy(data.data(), _mapped_data + data_offset, data.size());
+	else if (!read_at(_file, data_offset, data.data(), data.size()))
+		return false;
+
+	// Verify data integrity, since the pack file may have been damaged by an interrupted write
+	if (compute_key(data).hash[0] != it->second.checksum)
+	{
+		_live_size -= sizeof(record_header) + it->second.size;
+		_index.erase(it);
+		return false;
+	}
+
+	if (!_read_only)
+	{
+		// Update last access time for eviction of least recently used entries
+		const uint64_t last_access_time = current_time();
+		if (it->second.offset + sizeof(record_header) <= _mapped_size)
+			std::memcpy(_mapped_data + it->second.offset + offsetof(record_header, last_access_time), &last_access_time, sizeof(last_access_time));
+		else
+			write_at(_file, it->second.offset + offsetof(record_header, last_access_time), &last_access_time, sizeof(last_access_time));
+	}
+
+	return true;
+}
+bool reshade::effect_cache_pack::save(const key &key, const std::string_view data)
+{
+	const std::unique_lock<std::mutex> lock(_mutex);
+
+	if (_file == nullptr || _read_only)
+		return false;
+
+	record_header header = {};
+	header.magic = s_record_magic;
+	header.size = static_cast<uint32_t>(data.size());
+	header.key[0] = key.hash[0];
+	header.key[1] = key.hash[1];
+	header.checksum = compute_key(data).hash[0];
+	header.last_access_time = current_time();
+
+	// Write data before the header, so that an interrupted write leaves no valid record header behind
+	if (!write_at(_file, _file_size + sizeof(header), data.data(), data.size()) ||
+		!write_at(_file, _file_size, &header, sizeof(header)))
+		return false;
+
+	const uint64_t record_size = sizeof(header) + data.size();
+
+	if (const auto it = _index.find(key); it != _index.end())
+		_live_size -= sizeof(record_header) + it->second.size;
+	_index[key] = { _file_size, header.size, header.checksum };
+
+	_file_size += record_size;
+	_live_size += record_size;
+
+	// Do not retry compaction on every append if it failed before (e.g. because another process has the pack file open), until the pack file is opened again
+	if (_file_size > _max_size && !_compaction_failed)
+		_compaction_failed = !compact(_max_size * 3 / 4);
+
+	return true;
+}
+
+bool reshade::effect_cache_pack::compact()
+{
+	const std::unique_lock<std::mutex> lock(_mutex);
+
+	return compact(_max_size);
+}
+bool reshade::effect_cache_pack::clear()
+{
+	const std::unique_lock<std::mutex> lock(_mutex);
+
+	if (_file == nullptr || _read_only)
+		return false;
+
+	close_file();
+
+	return open_file(true) && read_index();
+}
+
+bool reshade::effect_cache_pack::open_file(bool discard_contents)
+{
+	_read_only = false;
+
+	// Only allow a single process to write to the pack file at a time, any other processes get read-only access
+	HANDLE file = CreateFileW(_path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE && GetLastError() == ERROR_SHARING_VIOLATION)
+	{
+		file = CreateFileW(_path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		_read_only = true;
+	}
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	_file = file;
+
+	LARGE_INTEGER file_size = {};
+	GetFileSizeEx(file, &file_size);
+	_file_size = file_size.QuadPart;
+
+	pack_header header = {};
+	if (discard_contents || _file_size < sizeof(header) || !read_at(file, 0, &header, sizeof(header)) || std::memcmp(header.magic, s_pack_magic, sizeof(s_pack_magic)) != 0 || header.version != s_pack_version)
+	{
+		if (_read_only)
+		{
+			close_file();
+			return false;
+		}
+
+		// Pack file is new, is being cleared or was written by an incompatible version, so discard its contents
+		std::memcpy(header.magic, s_pack_magic, sizeof(s_pack_magic));
+		header.version = s_pack_version;
+		header.reserved = 0;
+
+		LARGE_INTEGER header_size = {};
+		header_size.QuadPart = sizeof(header);
+		if (!write_at(file, 0, &header, sizeof(header)) || !SetFilePointerEx(file, header_size, nullptr, FILE_BEGIN) || !SetEndOfFile(file))
+		{
+			close_file();
+			return false;
+		}
+
+		_file_size = sizeof(header);
+	}
+
+	// Map the existing contents of the file into memory (any entries appended later are read via normal file reads instead)
+	// This may fail in 32-bit processes when the file is too large to fit into the address space, in which case all reads go through the file handle
+	_mapping = CreateFileMappingW(file, nullptr, _read_only ? PAGE_READONLY : PAGE_READWRITE, 0, 0, nullptr);
+	if (_mapping != nullptr)
+	{
+		_mapped_data = static_cast<uint8_t *>(MapViewOfFile(_mapping, _read_only ? FILE_MAP_READ : FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, 0));
+		if (_mapped_data != nullptr)
+			_mapped_size = _file_size;
+	}
+
+	return true;
+}
+void reshade::effect_cache_pack::close_file()
+{
+	if (_mapped_data != nullptr)
+		UnmapViewOfFile(_mapped_data);
+	_mapped_data = nullptr;
+	_mapped_size = 0;
+
+	if (_mapping != nullptr)
+		CloseHandle(_mapping);
+	_mapping = nullptr;
+
+	if (_file != nullptr)
+		CloseHandle(_file);
+	_file = nullptr;
+
+	_file_size = 0;
+	_live_size = 0;
+	_index.clear();
+}
+
+bool reshade::effect_cache_pack::read_index()
+{
+	_index.clear();
+	_live_size = 0;
+
+	uint64_t offset = sizeof(pack_header);
+
+	while (offset + sizeof(record_header) <= _file_size)
+	{
+		record_header header;
+		if (offset + sizeof(header) <= _mapped_size)
+			std::memcpy(&header, _mapped_data + offset, sizeof(header));
+		else if (!read_at(_file, offset, &header, sizeof(header)))
+			break;
+
+		// Stop at the first incomplete record (e.g. from a write that was interrupted), so that it is overwritten by the next append
+		if (header.magic != s_record_magic || offset + sizeof(header) + header.size > _file_size)
+			break;
+
+		const key key = { { header.key[0], header.key[1] } };
+
+		// Later records replace earlier ones with the same key
+		if (const auto it = _index.find(key); it != _index.end())
+			_live_size -= sizeof(record_header) + it->second.size;
+		_index[key] = { offset, header.size, header.checksum };
+
+		offset += sizeof(header) + header.size;
+		_live_size += sizeof(header) + header.size;
+	}
+
+	_file_size = offset;
+
+	return true;
+}
+
+bool reshade::effect_cache_pack::compact(uint64_t target_size)
+{
+	if (_file == nullptr || _read_only)
+		return false;
+
+	struct live_entry
+	{
+		uint64_t offset;
+		uint64_t size;
+		uint64_t last_access_time;
+	};
+
+	std::vector<live_entry> live_entries;
+	live_entries.reserve(_index.size());
+	for (const auto &[key, entry] : _index)
+	{
+		record_header header;
+		if (entry.offset + sizeof(header) <= _mapped_size)
+			std::memcpy(&header, _mapped_data + entry.offset, sizeof(header));
+		else if (!read_at(_file, entry.offset, &header, sizeof(header)))
+			continue;
+
+		live_entries.push_back({ entry.offset, sizeof(record_header) + entry.size, header.last_access_time });
+	}
+
+	// Keep the most recently used entries that fit into the target size
+	std::sort(live_entries.begin(), live_entries.end(),
+		[](const live_entry &lhs, const live_entry &rhs) {
+			return lhs.last_access_time > rhs.last_access_time;
+		});
+
+	std::filesystem::path temp_path = _path;
+	temp_path += L".tmp";
+
+	const HANDLE temp_file = CreateFileW(temp_path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (temp_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	pack_header header = {};
+	std::memcpy(header.magic, s_pack_magic, sizeof(s_pack_magic));
+	header.version = s_pack_version;
+
+	bool success = write_at(temp_file, 0, &header, sizeof(header));
+
+	uint64_t temp_file_size = sizeof(header);
+	std::vector<uint8_t> record;
+
+	for (const live_entry &entry : live_entries)
+	{
+		if (!success)
+			break;
+
+		if (temp_file_size + entry.size > target_size)
+			continue;
+
+		record.resize(static_cast<size_t>(entry.size));
+		if (entry.offset + entry.size <= _mapped_size)
+			std::memcpy(record.data(), _mapped_data + entry.offset, record.size());
+		else if (!read_at(_file, entry.offset, record.data(), record.size()))
+			continue;
+
+		success = write_at(temp_file, temp_file_size, record.data(), record.size());
+		temp_file_size += entry.size;
+	}
+
+	CloseHandle(temp_file);
+
+	// Replace the pack file with the compacted one (this fails if another process still has it open)
+	close_file();
+
+	if (!success || !MoveFileExW(temp_path.c_str(), _path.c_str(), MOVEFILE_REPLACE_EXISTING))
+	{
+		DeleteFileW(temp_path.c_str());
+		success = false;
+	}
+
+	return open_file(false) && read_index() && success;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2026 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <filesystem>
+#include <unordered_map>
+
+namespace reshade
+{
+	/// <summary>
+	/// Persistent cache of effect compilation results (pre-processed source code, compiled shader modules, ...), stored in a single pack file.
+	/// New entries are appended to the end of the file, existing entries are read through a memory mapping of the file and looked up through an in-memory index from 128-bit content hashes to file offsets.
+	/// When the pack file grows past its size limit, it is compacted, evicting the least recently used entries.
+	/// </summary>
+	class effect_cache_pack
+	{
+	public:
+		struct key
+		{
+			uint64_t hash[2];
+
+			bool operator==(const key &other) const { return hash[0] == other.hash[0] && hash[1] == other.hash[1]; }
+		};
+
+		/// <summary>
+		/// Computes a stable 128-bit hash of the specified data, which stays the same across processes and builds.
+		/// </summary>
+		static key compute_key(const void *data, size_t size);
+		static key compute_key(const std::string_view data) { return compute_key(data.data(), data.size()); }
+
+		/// <summary>
+		/// Formats a key as a hexadecimal string.
+		/// </summary>
+		static std::string key_to_string(const key &key);
+
+		effect_cache_pack() = default;
+		~effect_cache_pack();
+
+		effect_cache_pack(const effect_cache_pack &) = delete;
+		effect_cache_pack &operator=(const effect_cache_pack &) = delete;
+
+		/// <summary>
+		/// Opens the pack file at the specified <paramref name="path"/> (or creates it if it does not exist yet) and builds the index of its entries.
+		/// If another process is already writing to the pack file, it is opened read-only.
+		/// </summary>
+		/// <param name="path">Path to the pack file.</param>
+		/// <param name="max_size">Maximum size of the pack file in bytes, after which least recently used entries are evicted.</param>
+		bool open(const std::filesystem::path &path, uint64_t max_size);
+		/// <summary>
+		/// Closes the pack file.
+		/// </summary>
+		void close();
+
+		/// <summary>
+		/// Gets the path to the currently open pack file.
+		/// </summary>
+		const std::filesystem::path &path() const { return _path; }
+
+		/// <summary>
+		/// Gets the data of the entry with the specified <paramref name="key"/>.
+		/// </summary>
+		/// <returns><see langword="true"/> if the entry exists, <see langword="false"/> otherwise.</returns>
+		bool load(const key &key, std::string &data);
+		/// <summary>
+		/// Appends an entry with the specified <paramref name="key"/> to the pack file, replacing any existing entry with the same key.
+		/// </summary>
+		bool save(const key &key, const std::string_view data);
+
+		/// <summary>
+		/// Rewrites the pack file without any replaced entries and evicts least recently used entries until the file fits into the size limit again.
+		/// </summary>
+		bool compact();
+		/// <summary>
+		/// Removes all entries from the pack file.
+		/// </summary>
+		bool clear();
+
+	private:
+		struct key_hash
+		{
+			size_t operator()(const key &key) const { return static_cast<size_t>(key.hash[0]); }
+		};
+		struct entry
+		{
+			uint64_t offset;
+			uint32_t size;
+			uint64_t checksum;
+		};
+
+		bool open_file(bool discard_contents);
+		void close_file();
+		bool read_index();
+		bool compact(uint64_t target_size);
+
+		std::mutex _mutex;
+		std::filesystem::path _path;
+		uint64_t _max_size = 0;
+		bool _read_only = false;
+		bool _compaction_failed = false;
+		void *_file = nullptr;
+		void *_mapping = nullptr;
+		uint8_t *_mapped_data = nullptr;
+		uint64_t _mapped_size = 0;
+		uint64_t _file_size = 0;
+		uint64_t _live_size = 0;
+		std::unordered_map<key, entry, key_hash> _index;
+	};
+}
@@ -7,7 +7,9 @@
 
 #include "effect_module.hpp"
 #include <memory> // std::unique_ptr
+#include <cstring> // std::memcmp
 #include <algorithm> // std::find_if
+#include <unordered_map>
 
 namespace reshadefx
 {
@@ -29,12 +31,24 @@ namespace reshadefx
 		/// </summary>
 		effect_module &module() { return _module; }
 
+		/// <summary>
+		/// Gets the optimization level the code is generated with.
+		/// </summary>
+		int optimization_level() const { return _optimization_level; }
+		/// <summary>
+		/// Sets the optimization level the code is generated with. This has to be called before parsing.
+		/// A level of zero or below disables all optimizations. Level one makes the parser reuse values within a basic block (common subexpression elimination, redundant load elimination, copy and constant propagation).
+		/// Level two and above additionally lets back-ends hoist uniform loads out of control flow and remove dead code, if they support that.
+		/// </summary>
+		void set_optimization_level(int level) { _optimization_level = level; }
+
 		/// <summary>
 		/// Finalizes and returns the generated code for the entire module (all entry points).
 		/// </summary>
 		virtual std::string finalize_code() const = 0;
 		/// <summary>
 		/// Finalizes and assembles the generated code for the specified entry point (and no other entry points).
+		/// Implementations must not modify any code generator state, so that this can be called concurrently for different entry points once code generation is complete.
 		/// </summary>
 		/// <param name="entry_point_name">Name of the entry point function to generate code for.</param>
 		/// <param name="binary">Output binary code.</param>
@@ -314,6 +328,83 @@ namespace reshadefx
 		/// </summary>
 		virtual void optimize_bindings();
 
+		/// <summary>
+		/// Hash function for types, which only considers the properties that are compared by the equality operator of types (so ignores qualifiers).
+		/// </summary>
+		struct type_hash
+		{
+			size_t operator()(const type &info) const
+			{
+				size_t hash = hash_combine(0, static_cast<uint32_t>(info.base) | (info.rows << 8) | (info.cols << 12));
+				hash = hash_combine(hash, info.array_length);
+				hash = hash_combine(hash, info.struct_definition);
+				return hash;
+			}
+		};
+		/// <summary>
+		/// Hash table from constants to the SSA ID of their definition, so that a constant with the same type and value can be reused instead of defined again.
+		/// Two constants are equal if their types are equal and the values of them and their array elements are bitwise identical.
+		/// Entries are keyed by a precomputed hash, so that lookups compare against the passed type and constant directly and only insertion copies them.
+		/// </summary>
+		class constant_lookup
+		{
+		public:
+			/// <summary>
+			/// Finds the SSA ID of an existing constant with the same type and value.
+			/// </summary>
+			/// <returns>SSA ID of the constant definition, or zero if there is none.</returns>
+			id find(const type &data_type, const constant &data) const
+			{
+				const auto range = _entries.equal_range(hash(data_type, data));
+				for (auto it = range.first; it != range.second; ++it)
+					if (equal(it->second.data_type, it->second.data, data_type, data))
+						return it->second.definition;
+				return 0;
+			}
+			/// <summary>
+			/// Adds a new constant definition to the hash table.
+			/// </summary>
+			void insert(const type &data_type, const constant &data, id definition)
+			{
+				_entries.emplace(hash(data_type, data), entry { data_type, data, definition });
+			}
+
+		private:
+			struct entry
+			{
+				type data_type;
+				constant data;
+				id definition;
+			};
+
+			static size_t hash(const type &data_type, const constant &data)
+			{
+				size_t hash = type_hash()(data_type);
+				for (const uint32_t value : data.as_uint)
+					hash = hash_combine(hash, value);
+				for (const constant &element : data.array_data)
+					for (const uint32_t value : element.as_uint)
+						hash = hash_combine(hash, value);
+				return hash;
+			}
+			static bool equal(const type &lhs_type, const constant &lhs, const type &rhs_type, const constant &rhs)
+			{
+				if (!(lhs_type == rhs_type && std::memcmp(&lhs.as_uint[0], &rhs.as_uint[0], sizeof(uint32_t) * 16) == 0 && lhs.array_data.size() == rhs.array_data.size()))
+					return false;
+				for (size_t i = 0; i < lhs.array_data.size(); ++i)
+					if (std::memcmp(&lhs.array_data[i].as_uint[0], &rhs.array_data[i].as_uint[0], sizeof(uint32_t) * 16) != 0)
+						return false;
+				return true;
+			}
+
+			std::unordered_multimap<size_t, entry> _entries;
+		};
+
+		static size_t hash_combine(size_t hash, uint32_t value)
+		{
+			return hash ^ (value + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+		}
+
 		/// <summary>
 		/// Looks up an existing struct type.
 		/// </summary>
@@ -386,6 +477,8 @@ namespace reshadefx
 		std::vector<struct_type> _structs;
 		std::vector<std::unique_ptr<function>> _functions;
 
+		int _optimization_level = 0;
+
 		id _next_id = 1;
 		id _last_block = 0;
 		id _current_block = 0;
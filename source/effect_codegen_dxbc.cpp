@@ -16,7 +16,7 @@ class codegen_dxbc final : public codegen_hlsl
 public:
 	codegen_dxbc(unsigned int shader_model, bool debug_info, bool uniforms_to_spec_constants, int optimization_level) :
 		codegen_hlsl(shader_model, debug_info, uniforms_to_spec_constants),
-		_optimization_level(optimization_level)
+		_compiler_optimization_level(optimization_level)
 	{
 	}
 
@@ -39,15 +39,15 @@ public:
 		profile[5] = '0' + (_shader_model % 10);
 
 		UINT compile_flags = 0;
-		if (_optimization_level < 0)
+		if (_compiler_optimization_level < 0)
 			compile_flags |= D3DCOMPILE_SKIP_OPTIMIZATION;
-		else if (_optimization_level >= 3)
+		else if (_compiler_optimization_level >= 3)
 			compile_flags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
-		else if (_optimization_level == 2)
+		else if (_compiler_optimization_level == 2)
 			compile_flags |= D3DCOMPILE_OPTIMIZATION_LEVEL2;
-		else if (_optimization_level == 1)
+		else if (_compiler_optimization_level == 1)
 			compile_flags |= D3DCOMPILE_OPTIMIZATION_LEVEL1;
-		else if (_optimization_level == 0)
+		else if (_compiler_optimization_level == 0)
 			compile_flags |= D3DCOMPILE_OPTIMIZATION_LEVEL0;
 
 		if (_shader_model >= 40)
@@ -114,13 +114,14 @@ public:
 	void emit_pragma(const std::string &pragma) override
 	{
 		if (pragma == "reshade skipoptimization" || pragma == "reshade nooptimization")
-			_optimization_level = -1;
+			_compiler_optimization_level = -1;
 
 		codegen_hlsl::emit_pragma(pragma);
 	}
 
 private:
-	int _optimization_level;
+	// Level passed to D3DCompile, which is separate from the ReShadeFX optimization level in the base class
+	int _compiler_optimization_level;
 };
 
 #ifndef RESHADEFX_CODEGEN_DXBC_INLINE
@@ -20,7 +20,7 @@ class codegen_dxil final : public codegen_hlsl
 public:
 	codegen_dxil(unsigned int shader_model, bool debug_info, bool uniforms_to_spec_constants, int optimization_level) :
 		codegen_hlsl(shader_model, debug_info, uniforms_to_spec_constants),
-		_optimization_level(optimization_level)
+		_compiler_optimization_level(optimization_level)
 	{
 	}
 
@@ -49,7 +49,7 @@ public:
 		const std::wstring entry_point_name_wide(entry_point_name.begin(), entry_point_name.end());
 
 		WCHAR optimization_level_flag[] = L"-O3";
-		optimization_level_flag[2] = _optimization_level >= 0 ? L'0' + (_optimization_level % 10) : L'd';
+		optimization_level_flag[2] = _compiler_optimization_level >= 0 ? L'0' + (_compiler_optimization_level % 10) : L'd';
 
 		LPCWSTR arguments[] = {
 			L"-T", profile,
@@ -106,13 +106,14 @@ public:
 	void emit_pragma(const std::string &pragma) override
 	{
 		if (pragma == "reshade skipoptimization" || pragma == "reshade nooptimization")
-			_optimization_level = -1;
+			_compiler_optimization_level = -1;
 
 		codegen_hlsl::emit_pragma(pragma);
 	}
 
 private:
-	int _optimization_level;
+	// Level passed to the DXC compiler, which is separate from the ReShadeFX optimization level in the base class
+	int _compiler_optimization_level;
 };
 
 #ifndef RESHADEFX_CODEGEN_DXIL_INLINE
@@ -70,13 +70,16 @@ protected:
 
 	std::unordered_map<id, std::string> _names;
 	std::unordered_map<id, std::string> _blocks;
+	// Location of the default binding index in the code of each sampler and storage block, which is replaced with the actual binding of an entry point during assembly
+	std::unordered_map<id, std::pair<size_t, size_t>> _binding_patch_points;
 	std::string _ubo_block;
 	std::string _compute_block;
 	std::string _current_function_declaration;
 
 	std::unordered_map<id, id> _remapped_sampler_variables;
 	std::unordered_map<std::string, uint32_t> _semantic_to_location;
-	std::vector<std::tuple<type, constant, id>> _constant_lookup;
+	constant_lookup _constant_lookup;
+	std::unordered_set<id> _constant_ids;
 
 	std::string finalize_preamble() const
 	{
@@ -185,6 +188,15 @@ protected:
 	{
 		std::string code = finalize_preamble();
 
+		size_t total_size = code.size() + _blocks.at(0).size();
+		for (const sampler &info : _module.samplers)
+			total_size += _blocks.at(info.id).size();
+		for (const storage &info : _module.storages)
+			total_size += _blocks.at(info.id).size();
+		for (const std::unique_ptr<function> &func : _functions)
+			total_size += _blocks.at(func->id).size() + 2 * func->unique_name.size() + 16;
+		code.reserve(total_size);
+
 		// Add sampler definitions
 		for (const sampler &info : _module.samplers)
 			code += _blocks.at(info.id);
@@ -218,8 +230,27 @@ protected:
 		if (entry_point == nullptr)
 			return false;
 
+		const auto is_referenced_function = [entry_point](const function &func) {
+			return func.id == entry_point->id ||
+				std::find(entry_point->referenced_functions.begin(), entry_point->referenced_functions.end(), func.id) != entry_point->referenced_functions.end();
+		};
+
 		code = finalize_preamble();
 
+		// Size the output for all the blocks that are gathered below up front, so that it does not need to be reallocated while appending them
+		// Binding indices are assumed to have at most ten digits, so that the patched bindings always fit as well
+		size_t total_size = code.size() + 512 + _blocks.at(0).size();
+		for (const id block : entry_point->referenced_samplers)
+			if (block != 0)
+				total_size += _blocks.at(block).size() + 10;
+		for (const id block : entry_point->referenced_storages)
+			if (block != 0)
+				total_size += _blocks.at(block).size() + 10;
+		for (const std::unique_ptr<function> &func : _functions)
+			if (is_referenced_function(*func))
+				total_size += _blocks.at(func->id).size();
+		code.reserve(total_size);
+
 		if (entry_point->type != shader_type::pixel)
 			code +=
 				// OpenGL does not allow using 'discard' in the vertex shader profile
@@ -246,11 +277,23 @@ protected:
 				"#define memoryBarrier()\n"
 				"#define groupMemoryBarrier()\n";
 
-		const auto replace_binding =
-			[](std::string &code, uint32_t binding) {
-				const size_t beg = code.find("layout(binding = ") + 17;
-				const size_t end = code.find_first_of("),", beg);
-				code.replace(beg, end - beg, std::to_string(binding));
+		// Append the code of a sampler or storage block, with the default binding index replaced by the binding of this entry point
+		const auto append_block_with_binding =
+			[this, &code](id block, uint32_t binding) {
+				const std::string &block_code = _blocks.at(block);
+
+				const auto patch_point_it = _binding_patch_points.find(block);
+				if (patch_point_it == _binding_patch_points.end())
+				{
+					code += block_code;
+					return;
+				}
+
+				const auto [offset, length] = patch_point_it->second;
+				code.append(block_code, 0, offset);
+				char binding_string[10];
+				code.append(binding_string, std::to_chars(binding_string, binding_string + sizeof(binding_string), binding).ptr);
+				code.append(block_code, offset + length, std::string::npos);
 			};
 
 		// Add referenced sampler definitions
@@ -259,9 +302,7 @@ protected:
 			if (entry_point->referenced_samplers[binding] == 0)
 				continue;
 
-			std::string block_code = _blocks.at(entry_point->referenced_samplers[binding]);
-			replace_binding(block_code, binding);
-			code += block_code;
+			append_block_with_binding(entry_point->referenced_samplers[binding], binding);
 		}
 
 		// Add referenced storage definitions
@@ -270,9 +311,7 @@ protected:
 			if (entry_point->referenced_storages[binding] == 0)
 				continue;
 
-			std::string block_code = _blocks.at(entry_point->referenced_storages[binding]);
-			replace_binding(block_code, binding);
-			code += block_code;
+			append_block_with_binding(entry_point->referenced_storages[binding], binding);
 		}
 
 		// Add global definitions (struct types, global variables, ...)
@@ -281,8 +320,7 @@ protected:
 		// Add referenced function definitions
 		for (const std::unique_ptr<function> &func : _functions)
 		{
-			if (func->id != entry_point->id &&
-				std::find(entry_point->referenced_functions.begin(), entry_point->referenced_functions.end(), func->id) == entry_point->referenced_functions.end())
+			if (!is_referenced_function(*func))
 				continue;
 
 			code += _blocks.at(func->id);
@@ -291,6 +329,16 @@ protected:
 		return true;
 	}
 
+	/// <summary>
+	/// Writes the default binding index of a sampler or storage and remembers where it is in the code of the block, so that it can be replaced during assembly without having to search for it.
+	/// </summary>
+	void write_binding(std::string &code, id block, uint32_t binding)
+	{
+		const size_t offset = code.size();
+		code += std::to_string(binding);
+		_binding_patch_points.insert_or_assign(block, std::make_pair(offset, code.size() - offset));
+	}
+
 	template <bool is_param = false, bool is_decl = true, bool is_interface = false>
 	void write_type(std::string &s, const type &type) const
 	{
@@ -564,7 +612,7 @@ protected:
 	}
 	void write_location(std::string &s, const location &loc) const
 	{
-		if (loc.source.empty() || !_debug_info)
+		if (loc.source == 0 || !_debug_info)
 			return;
 
 		s += "#line " + std::to_string(loc.line) + '\n';
@@ -820,7 +868,7 @@ protected:
 	}
 	id   define_sampler(const location &loc, const texture &, sampler &info) override
 	{
-		const id res = info.id = create_block();
+		const id res = info.id = create_declaration_block();
 		define_name<naming::unique>(res, info.unique_name);
 
 		std::string &code = _blocks.at(res);
@@ -830,7 +878,8 @@ protected:
 		// Default to a binding index equivalent to the entry in the sampler list (this is later overwritten in 'finalize_code_for_entry_point' to a more optimal placement)
 		const uint32_t default_binding = static_cast<uint32_t>(_module.samplers.size());
 
-		code += "layout(binding = " + std::to_string(default_binding);
+		code += "layout(binding = ";
+		write_binding(code, res, default_binding);
 		code += ") uniform ";
 		write_type(code, info.type);
 		code += ' ' + id_to_name(res) + ";\n";
@@ -841,7 +890,7 @@ protected:
 	}
 	id   define_storage(const location &loc, const texture &tex_info, storage &info) override
 	{
-		const id res = info.id = create_block();
+		const id res = info.id = create_declaration_block();
 		define_name<naming::unique>(res, info.unique_name);
 
 		std::string &code = _blocks.at(res);
@@ -851,7 +900,9 @@ protected:
 		// Default to a binding index equivalent to the entry in the storage list (this is later overwritten in 'finalize_code_for_entry_point' to a more optimal placement)
 		const uint32_t default_binding = static_cast<uint32_t>(_module.storages.size());
 
-		code += "layout(binding = " + std::to_string(default_binding) + ", ";
+		code += "layout(binding = ";
+		write_binding(code, res, default_binding);
+		code += ", ";
 		write_texture_format(code, tex_info.format);
 		code += ") uniform ";
 		write_type(code, info.type);
@@ -937,10 +988,7 @@ protected:
 	{
 		// Constant variables with a constant initializer can just point to the initializer SSA variable, since they cannot be modified anyway, thus saving an unnecessary assignment
 		if (initializer_value != 0 && type.has(type::q_const) &&
-			std::find_if(_constant_lookup.begin(), _constant_lookup.end(),
-				[initializer_value](const auto &x) {
-					return initializer_value == std::get<2>(x);
-				}) != _constant_lookup.end())
+			_constant_ids.find(initializer_value) != _constant_ids.end())
 			return initializer_value;
 
 		const id res = make_id();
@@ -1667,19 +1715,13 @@ protected:
 		{
 			assert(data_type.has(type::q_const));
 
-			if (const auto it = std::find_if(_constant_lookup.begin(), _constant_lookup.end(),
-					[&data_type, &data](const std::tuple<type, constant, id> &x) {
-						if (!(std::get<0>(x) == data_type && std::memcmp(&std::get<1>(x).as_uint[0], &data.as_uint[0], sizeof(uint32_t) * 16) == 0 && std::get<1>(x).array_data.size() == data.array_data.size()))
-							return false;
-						for (size_t i = 0; i < data.array_data.size(); ++i)
-							if (std::memcmp(&std::get<1>(x).array_data[i].as_uint[0], &data.array_data[i].as_uint[0], sizeof(uint32_t) * 16) != 0)
-								return false;
-						return true;
-					});
-				it != _constant_lookup.end())
-				return std::get<2>(*it); // Reuse existing constant instead of duplicating the definition
+			if (const id existing = _constant_lookup.find(data_type, data))
+				return existing; // Reuse existing constant instead of duplicating the definition
 			else if (data_type.is_array())
-				_constant_lookup.push_back({ data_type, data, res });
+			{
+				_constant_lookup.insert(data_type, data, res);
+				_constant_ids.insert(res);
+			}
 
 			// Put constant variable into global scope, so that it can be reused in different blocks
 			std::string &code = _blocks.at(0);
@@ -2292,6 +2334,15 @@ protected:
 	{
 	}
 
+	/// <summary>
+	/// Creates a block for the declaration of a single sampler or storage, without reserving as much memory as 'create_block' does for blocks of function code.
+	/// </summary>
+	id   create_declaration_block()
+	{
+		const id res = make_id();
+		_blocks.emplace(res, std::string());
+		return res;
+	}
 	id   create_block() override
 	{
 		const id res = make_id();
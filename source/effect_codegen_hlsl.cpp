@@ -11,6 +11,7 @@
 #include <cstring> // stricmp, std::memcmp
 #include <charconv> // std::from_chars, std::to_chars
 #include <algorithm> // std::equal, std::find, std::find_if, std::max
+#include <unordered_set>
 
 using namespace reshadefx;
 
@@ -60,12 +61,15 @@ protected:
 
 	std::unordered_map<id, std::string> _names;
 	std::unordered_map<id, std::string> _blocks;
+	// Location of the default register index in the code of each sampler and storage block, which is replaced with the actual binding of an entry point during assembly
+	std::unordered_map<id, std::pair<size_t, size_t>> _binding_patch_points;
 	std::string _cbuffer_block;
-	std::string _current_location;
+	uint32_t _current_location_source = 0;
 	std::string _current_function_declaration;
 
 	std::string _remapped_semantics[15];
-	std::vector<std::tuple<type, constant, id>> _constant_lookup;
+	constant_lookup _constant_lookup;
+	std::unordered_set<id> _constant_ids;
 	std::vector<sampler_binding> _sampler_lookup;
 
 	unsigned int _texture_semantic_index = 0;
@@ -335,6 +339,15 @@ protected:
 	{
 		std::string code = finalize_preamble();
 
+		size_t total_size = code.size() + _blocks.at(0).size();
+		for (const sampler &info : _module.samplers)
+			total_size += _blocks.at(info.id).size();
+		for (const storage &info : _module.storages)
+			total_size += _blocks.at(info.id).size();
+		for (const std::unique_ptr<function> &func : _functions)
+			total_size += _blocks.at(func->id).size();
+		code.reserve(total_size);
+
 		// Add global definitions (struct types, global variables, sampler state declarations, ...)
 		code += _blocks.at(0);
 
@@ -358,8 +371,27 @@ protected:
 		if (entry_point == nullptr)
 			return false;
 
+		const auto is_referenced_function = [entry_point](const function &func) {
+			return func.id == entry_point->id ||
+				std::find(entry_point->referenced_functions.begin(), entry_point->referenced_functions.end(), func.id) != entry_point->referenced_functions.end();
+		};
+
 		code = finalize_preamble();
 
+		// Size the output for all the blocks that are gathered below up front, so that it does not need to be reallocated while appending them
+		// Binding indices are assumed to have at most ten digits, so that the patched bindings always fit as well
+		size_t total_size = code.size() + 32 + _blocks.at(0).size();
+		for (const id block : entry_point->referenced_samplers)
+			if (block != 0)
+				total_size += _blocks.at(block).size() + 10;
+		for (const id block : entry_point->referenced_storages)
+			if (block != 0)
+				total_size += _blocks.at(block).size() + 10;
+		for (const std::unique_ptr<function> &func : _functions)
+			if (is_referenced_function(*func))
+				total_size += _blocks.at(func->id).size();
+		code.reserve(total_size);
+
 		if (_shader_model < 40 && entry_point->type == shader_type::pixel)
 			// Overwrite position semantic in pixel shaders
 			code += "#define POSITION VPOS\n";
@@ -367,11 +399,23 @@ protected:
 		// Add global definitions (struct types, global variables, sampler state declarations, ...)
 		code += _blocks.at(0);
 
-		const auto replace_binding =
-			[](std::string &code, uint32_t binding) {
-				const size_t beg = code.find(": register(") + 12;
-				const size_t end = code.find(')', beg);
-				code.replace(beg, end - beg, std::to_string(binding));
+		// Append the code of a sampler or storage block, with the default register index replaced by the binding of this entry point
+		const auto append_block_with_binding =
+			[this, &code](id block, uint32_t binding) {
+				const std::string &block_code = _blocks.at(block);
+
+				const auto patch_point_it = _binding_patch_points.find(block);
+				if (patch_point_it == _binding_patch_points.end())
+				{
+					code += block_code;
+					return;
+				}
+
+				const auto [offset, length] = patch_point_it->second;
+				code.append(block_code, 0, offset);
+				char binding_string[10];
+				code.append(binding_string, std::to_chars(binding_string, binding_string + sizeof(binding_string), binding).ptr);
+				code.append(block_code, offset + length, std::string::npos);
 			};
 
 		// Add referenced texture and sampler definitions
@@ -380,9 +424,7 @@ protected:
 			if (entry_point->referenced_samplers[binding] == 0)
 				continue;
 
-			std::string block_code = _blocks.at(entry_point->referenced_samplers[binding]);
-			replace_binding(block_code, binding);
-			code += block_code;
+			append_block_with_binding(entry_point->referenced_samplers[binding], binding);
 		}
 
 		// Add referenced storage definitions
@@ -391,16 +433,13 @@ protected:
 			if (entry_point->referenced_storages[binding] == 0)
 				continue;
 
-			std::string block_code = _blocks.at(entry_point->referenced_storages[binding]);
-			replace_binding(block_code, binding);
-			code += block_code;
+			append_block_with_binding(entry_point->referenced_storages[binding], binding);
 		}
 
 		// Add referenced function definitions
 		for (const std::unique_ptr<function> &func : _functions)
 		{
-			if (func->id != entry_point->id &&
-				std::find(entry_point->referenced_functions.begin(), entry_point->referenced_functions.end(), func->id) == entry_point->referenced_functions.end())
+			if (!is_referenced_function(*func))
 				continue;
 
 			code += _blocks.at(func->id);
@@ -409,6 +448,16 @@ protected:
 		return true;
 	}
 
+	/// <summary>
+	/// Writes the default register index of a sampler or storage and remembers where it is in the code of the block, so that it can be replaced during assembly without having to search for it.
+	/// </summary>
+	void write_binding(std::string &code, id block, uint32_t binding)
+	{
+		const size_t offset = code.size();
+		code += std::to_string(binding);
+		_binding_patch_points.insert_or_assign(block, std::make_pair(offset, code.size() - offset));
+	}
+
 	template <bool is_param = false, bool is_decl = true>
 	void write_type(std::string &s, const type &type, texture_format format = texture_format::unknown) const
 	{
@@ -655,7 +704,7 @@ protected:
 	template <bool force_source = false>
 	void write_location(std::string &s, const location &loc)
 	{
-		if (loc.source.empty() || !_debug_info)
+		if (loc.source == 0 || !_debug_info)
 			return;
 
 		s += "#line " + std::to_string(loc.line);
@@ -665,13 +714,13 @@ protected:
 		// Avoid writing the file name every time to reduce output text size
 		if constexpr (force_source)
 		{
-			s += " \"" + loc.source + '\"';
+			s += " \"" + loc.source_name() + '\"';
 		}
-		else if (loc.source != _current_location)
+		else if (loc.source != _current_location_source)
 		{
-			s += " \"" + loc.source + '\"';
+			s += " \"" + loc.source_name() + '\"';
 
-			_current_location = loc.source;
+			_current_location_source = loc.source;
 		}
 
 		// Need to escape string for new DirectX Shader Compiler (dxc)
@@ -897,7 +946,7 @@ protected:
 	}
 	id   define_sampler(const location &loc, const texture &tex_info, sampler &info) override
 	{
-		const id res = info.id = create_block();
+		const id res = info.id = create_declaration_block();
 		define_name<naming::unique>(res, info.unique_name);
 
 		std::string &code = _blocks.at(res);
@@ -947,7 +996,9 @@ protected:
 			code += to_digit(static_cast<unsigned int>(tex_info.type));
 			code += "D<";
 			write_texture_format(code, tex_info.format);
-			code += "> __" + info.unique_name + "_t : register(t" + std::to_string(default_binding) + "); \n";
+			code += "> __" + info.unique_name + "_t : register(t";
+			write_binding(code, res, default_binding);
+			code += "); \n";
 
 			write_location(code, loc);
 
@@ -961,7 +1012,9 @@ protected:
 
 			code += "sampler";
 			code += to_digit(texture_dimension);
-			code += "D __" + info.unique_name + "_s : register(s" + std::to_string(default_binding) + ");\n";
+			code += "D __" + info.unique_name + "_s : register(s";
+			write_binding(code, res, default_binding);
+			code += ");\n";
 
 			write_location(code, loc);
 
@@ -992,7 +1045,7 @@ protected:
 	}
 	id   define_storage(const location &loc, const texture &tex_info, storage &info) override
 	{
-		const id res = info.id = create_block();
+		const id res = info.id = create_declaration_block();
 		define_name<naming::unique>(res, info.unique_name);
 
 		// Default to a register index equivalent to the entry in the storage list (this is later overwritten in 'finalize_code_for_entry_point' to a more optimal placement)
@@ -1008,7 +1061,9 @@ protected:
 				code += "[[vk::binding(" + std::to_string(default_binding) + ", 3)]] "; // Descriptor set 3
 
 			write_type(code, info.type, tex_info.format);
-			code += ' ' + info.unique_name + " : register(u" + std::to_string(default_binding) + ");\n";
+			code += ' ' + info.unique_name + " : register(u";
+			write_binding(code, res, default_binding);
+			code += ");\n";
 		}
 
 		_module.storages.push_back(info);
@@ -1106,10 +1161,7 @@ protected:
 	{
 		// Constant variables with a constant initializer can just point to the initializer SSA variable, since they cannot be modified anyway, thus saving an unnecessary assignment
 		if (initializer_value != 0 && type.has(type::q_const) &&
-			std::find_if(_constant_lookup.begin(), _constant_lookup.end(),
-				[initializer_value](const auto &x) {
-					return initializer_value == std::get<2>(x);
-				}) != _constant_lookup.end())
+			_constant_ids.find(initializer_value) != _constant_ids.end())
 			return initializer_value;
 
 		const id res = make_id();
@@ -1462,19 +1514,13 @@ protected:
 		{
 			assert(data_type.has(type::q_const));
 
-			if (const auto it = std::find_if(_constant_lookup.begin(), _constant_lookup.end(),
-					[&data_type, &data](const std::tuple<type, constant, id> &x) {
-						if (!(std::get<0>(x) == data_type && std::memcmp(&std::get<1>(x).as_uint[0], &data.as_uint[0], sizeof(uint32_t) * 16) == 0 && std::get<1>(x).array_data.size() == data.array_data.size()))
-							return false;
-						for (size_t i = 0; i < data.array_data.size(); ++i)
-							if (std::memcmp(&std::get<1>(x).array_data[i].as_uint[0], &data.array_data[i].as_uint[0], sizeof(uint32_t) * 16) != 0)
-								return false;
-						return true;
-					});
-				it != _constant_lookup.end())
-				return std::get<2>(*it); // Reuse existing constant instead of duplicating the definition
+			if (const id existing = _constant_lookup.find(data_type, data))
+				return existing; // Reuse existing constant instead of duplicating the definition
 			else
-				_constant_lookup.push_back({ data_type, data, res });
+			{
+				_constant_lookup.insert(data_type, data, res);
+				_constant_ids.insert(res);
+			}
 
 			// Put constant variable into global scope, so that it can be reused in different blocks
 			std::string &code = _blocks.at(0);
@@ -2103,6 +2149,15 @@ protected:
 		code += "#pragma " + pragma + '\n';
 	}
 
+	/// <summary>
+	/// Creates a block for the declaration of a single sampler or storage, without reserving as much memory as 'create_block' does for blocks of function code.
+	/// </summary>
+	id   create_declaration_block()
+	{
+		const id res = make_id();
+		_blocks.emplace(res, std::string());
+		return res;
+	}
 	id   create_block() override
 	{
 		const id res = make_id();
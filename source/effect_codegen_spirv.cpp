@@ -6,7 +6,8 @@
 #include "effect_parser.hpp"
 #include "effect_codegen.hpp"
 #include <cassert>
-#include <cstring> // std::memcmp
+#include <cstring> // std::memcmp, std::memcpy
+#include <iterator> // std::make_move_iterator
 #include <charconv> // std::from_chars
 #include <algorithm> // std::find_if, std::max, std::sort
 #include <unordered_set>
@@ -89,26 +90,41 @@ struct spirv_instruction
 		// ...           | ...
 		// WordCount - 1 | Operand N (N is determined by WordCount minus the 1 to 3 words used for the opcode, instruction type <id>, and instruction Result <id>).
 
-		const uint32_t word_count = 1 + (type != 0) + (result != 0) + static_cast<uint32_t>(operands.size());
-		assert(word_count <= 0xFFFF);
-		write_word(output, (word_count << spv::WordCountShift) | op);
+		const uint32_t words = word_count();
+		assert(words <= 0xFFFF);
+
+		// Grow the output once and copy the whole instruction into it, instead of inserting word by word
+		const size_t offset = output.size();
+		output.resize(offset + words * sizeof(uint32_t));
+		uint32_t *const dest = reinterpret_cast<uint32_t *>(output.data() + offset);
+
+		uint32_t index = 0;
+		dest[index++] = (words << spv::WordCountShift) | op;
 
 		// Optional instruction type ID
 		if (type != 0)
-			write_word(output, type);
+			dest[index++] = type;
 
 		// Optional instruction result ID
 		if (result != 0)
-			write_word(output, result);
+			dest[index++] = result;
 
 		// Write out the operands
-		for (const uint32_t operand : operands)
-			write_word(output, operand);
+		if (!operands.empty())
+			std::memcpy(dest + index, operands.data(), operands.size() * sizeof(uint32_t));
+	}
+
+	/// <summary>
+	/// Gets the number of words this instruction occupies in a SPIR-V module.
+	/// </summary>
+	uint32_t word_count() const
+	{
+		return 1 + (type != 0) + (result != 0) + static_cast<uint32_t>(operands.size());
 	}
 
 	static void write_word(std::basic_string<char> &output, uint32_t word)
 	{
-		output.insert(output.end(), reinterpret_cast<const char *>(&word), reinterpret_cast<const char *>(&word + 1));
+		output.append(reinterpret_cast<const char *>(&word), sizeof(word));
 	}
 
 	operator uint32_t() const
@@ -128,10 +144,26 @@ struct spirv_basic_block
 
 	/// <summary>
 	/// Append another basic block the end of this one.
+	/// The instructions are moved out of the other block, leaving it empty.
 	/// </summary>
-	void append(const spirv_basic_block &block)
+	void append(spirv_basic_block &&block)
 	{
-		instructions.insert(instructions.end(), block.instructions.begin(), block.instructions.end());
+		if (instructions.empty())
+			instructions = std::move(block.instructions);
+		else
+			instructions.insert(instructions.end(), std::make_move_iterator(block.instructions.begin()), std::make_move_iterator(block.instructions.end()));
+		block.instructions.clear();
+	}
+
+	/// <summary>
+	/// Gets the number of words the instructions in this block occupy in a SPIR-V module.
+	/// </summary>
+	size_t word_count() const
+	{
+		size_t words = 0;
+		for (const spirv_instruction &inst : instructions)
+			words += inst.word_count();
+		return words;
 	}
 };
 
@@ -163,10 +195,34 @@ private:
 			return lhs.type == rhs.type && lhs.is_ptr == rhs.is_ptr && lhs.array_stride == rhs.array_stride && lhs.storage == rhs.storage;
 		}
 	};
+	struct type_lookup_hash
+	{
+		size_t operator()(const type_lookup &lookup) const
+		{
+			size_t hash = type_hash()(lookup.type);
+			hash = hash_combine(hash, lookup.is_ptr ? 1 : 0);
+			hash = hash_combine(hash, lookup.array_stride);
+			hash = hash_combine(hash, static_cast<uint32_t>(lookup.storage.first));
+			hash = hash_combine(hash, static_cast<uint32_t>(lookup.storage.second));
+			return hash;
+		}
+	};
+	struct function_type_lookup_hash
+	{
+		size_t operator()(const std::vector<reshadefx::type> &signature) const
+		{
+			size_t hash = 0;
+			for (const reshadefx::type &type : signature)
+				hash = hash_combine(hash, static_cast<uint32_t>(type_hash()(type)));
+			return hash;
+		}
+	};
 	struct function_blocks
 	{
 		spirv_basic_block declaration;
 		spirv_basic_block variables;
+		// Loads from uniform variables that were moved to the start of the function (see 'emit_load' below)
+		spirv_basic_block hoisted;
 		spirv_basic_block definition;
 		reshadefx::type return_type;
 		std::vector<reshadefx::type> param_types;
@@ -205,11 +261,14 @@ private:
 	spv::Id _global_ubo_variable = 0;
 	std::vector<spv::Id> _global_ubo_types;
 	function_blocks *_current_function_blocks = nullptr;
-
-	std::vector<std::pair<type_lookup, spv::Id>> _type_lookup;
-	std::vector<std::tuple<type, constant, spv::Id>> _constant_lookup;
-	std::vector<std::pair<function_blocks, spv::Id>> _function_type_lookup;
-	std::unordered_map<std::string, spv::Id> _string_lookup;
+	// Uniform loads that were moved to the start of the current function, looked up by the access chain they load from
+	std::unordered_map<std::string, spv::Id> _hoisted_loads;
+
+	std::unordered_map<type_lookup, spv::Id, type_lookup_hash> _type_lookup;
+	constant_lookup _constant_lookup;
+	// Function types are looked up by their signature, which is the return type followed by all parameter types
+	std::unordered_map<std::vector<type>, spv::Id, function_type_lookup_hash> _function_type_lookup;
+	std::unordered_map<uint32_t, spv::Id> _string_lookup;
 	std::unordered_map<spv::Id, std::pair<spv::StorageClass, spv::ImageFormat>> _storage_lookup;
 	std::unordered_map<std::string, uint32_t> _semantic_to_location;
 
@@ -218,7 +277,7 @@ private:
 
 	void add_location(const location &loc, spirv_basic_block &block)
 	{
-		if (loc.source.empty() || !_debug_info)
+		if (loc.source == 0 || !_debug_info)
 			return;
 
 		spv::Id source_id;
@@ -230,16 +289,18 @@ private:
 		}
 		else
 		{
+			const std::string &source_name = loc.source_name();
+
 			source_id =
 				add_instruction(spv::OpString, 0, _debug_a)
-					.add_string(loc.source.c_str());
+					.add_string(source_name.c_str());
 
 #ifndef NDEBUG
 			// Embed source in the SPIR-V container so that profiling tools like NVIDIA Nsight Graphics show source mapping
 #ifndef _WIN32
-			FILE *const file = fopen(loc.source.c_str(), "rb");
+			FILE *const file = fopen(source_name.c_str(), "rb");
 #else
-			FILE *const file = _fsopen(loc.source.c_str(), "rb", SH_DENYWR);
+			FILE *const file = _fsopen(source_name.c_str(), "rb", SH_DENYWR);
 #endif
 			if (file != nullptr)
 			{
@@ -346,11 +407,16 @@ private:
 				inst.write(spirv);
 		}
 	}
-	void finalize_type_and_constants_section(std::basic_string<char> &spirv) const
+	void finalize_type_and_constants_section(std::basic_string<char> &spirv, const std::unordered_set<spv::Id> &live_ids) const
 	{
-		// All type declarations
+		// All type declarations that are referenced
 		for (const spirv_instruction &inst : _types_and_constants.instructions)
+		{
+			if (inst.result != 0 && live_ids.find(inst.result) == live_ids.end())
+				continue;
+
 			inst.write(spirv);
+		}
 
 		// Initialize the UBO type now that all member types are known
 		if (_global_ubo_type == 0 || _global_ubo_variable == 0)
@@ -371,6 +437,304 @@ private:
 			.write(spirv);
 	}
 
+	static spv::Id function_definition_id(const function_blocks &function)
+	{
+		if (function.declaration.instructions.empty())
+			return 0;
+
+		const spirv_instruction &inst = function.declaration.instructions[function.declaration.instructions[0].op != spv::OpFunction ? 1 : 0];
+		assert(inst.op == spv::OpFunction);
+		return inst.result;
+	}
+
+	/// <summary>
+	/// Checks whether an instruction only computes its result, without any side effects, so that it can be removed if the result is not used.
+	/// </summary>
+	static bool is_pure_instruction(spv::Op op)
+	{
+		switch (op)
+		{
+		case spv::OpPhi:
+		case spv::OpLoad:
+		case spv::OpAccessChain:
+		case spv::OpVectorExtractDynamic:
+		case spv::OpVectorShuffle:
+		case spv::OpCompositeConstruct:
+		case spv::OpCompositeExtract:
+		case spv::OpCompositeInsert:
+		case spv::OpTranspose:
+		case spv::OpConvertFToU:
+		case spv::OpConvertFToS:
+		case spv::OpConvertSToF:
+		case spv::OpConvertUToF:
+		case spv::OpUConvert:
+		case spv::OpSConvert:
+		case spv::OpFConvert:
+		case spv::OpBitcast:
+		case spv::OpSNegate:
+		case spv::OpFNegate:
+		case spv::OpIAdd:
+		case spv::OpFAdd:
+		case spv::OpISub:
+		case spv::OpFSub:
+		case spv::OpIMul:
+		case spv::OpFMul:
+		case spv::OpUDiv:
+		case spv::OpSDiv:
+		case spv::OpFDiv:
+		case spv::OpUMod:
+		case spv::OpSRem:
+		case spv::OpFRem:
+		case spv::OpVectorTimesScalar:
+		case spv::OpMatrixTimesScalar:
+		case spv::OpVectorTimesMatrix:
+		case spv::OpMatrixTimesVector:
+		case spv::OpMatrixTimesMatrix:
+		case spv::OpDot:
+		case spv::OpAny:
+		case spv::OpAll:
+		case spv::OpIsNan:
+		case spv::OpIsInf:
+		case spv::OpLogicalEqual:
+		case spv::OpLogicalNotEqual:
+		case spv::OpLogicalOr:
+		case spv::OpLogicalAnd:
+		case spv::OpLogicalNot:
+		case spv::OpSelect:
+		case spv::OpIEqual:
+		case spv::OpINotEqual:
+		case spv::OpUGreaterThan:
+		case spv::OpSGreaterThan:
+		case spv::OpUGreaterThanEqual:
+		case spv::OpSGreaterThanEqual:
+		case spv::OpULessThan:
+		case spv::OpSLessThan:
+		case spv::OpULessThanEqual:
+		case spv::OpSLessThanEqual:
+		case spv::OpFOrdEqual:
+		case spv::OpFOrdNotEqual:
+		case spv::OpFOrdLessThan:
+		case spv::OpFOrdGreaterThan:
+		case spv::OpFOrdLessThanEqual:
+		case spv::OpFOrdGreaterThanEqual:
+		case spv::OpShiftRightLogical:
+		case spv::OpShiftRightArithmetic:
+		case spv::OpShiftLeftLogical:
+		case spv::OpBitwiseOr:
+		case spv::OpBitwiseXor:
+		case spv::OpBitwiseAnd:
+		case spv::OpNot:
+		case spv::OpBitReverse:
+		case spv::OpBitCount:
+		case spv::OpDPdx:
+		case spv::OpDPdy:
+		case spv::OpFwidth:
+		case spv::OpDPdxFine:
+		case spv::OpDPdyFine:
+		case spv::OpDPdxCoarse:
+		case spv::OpDPdyCoarse:
+		case spv::OpExtInst: // Only the GLSL.std.450 extended instruction set is used, which has no side effects
+		case spv::OpImage:
+		case spv::OpImageSampleImplicitLod:
+		case spv::OpImageSampleExplicitLod:
+		case spv::OpImageFetch:
+		case spv::OpImageGather:
+		case spv::OpImageRead:
+		case spv::OpImageQuerySize:
+		case spv::OpImageQuerySizeLod:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	/// <summary>
+	/// Removes instructions whose results are never used from a function, as well as function variables that are only ever written to (together with the stores to them).
+	/// Removed instructions are not referenced anymore, so their names and decorations are removed from the module in 'assemble_code_for_entry_point' as well.
+	/// </summary>
+	static void remove_dead_code(function_blocks &function)
+	{
+		spirv_basic_block *const blocks[] = { &function.variables, &function.hoisted, &function.definition };
+
+		std::unordered_map<spv::Id, uint32_t> use_counts;
+		std::unordered_map<spv::Id, spirv_instruction *> definitions;
+		// Stores to each function variable
+		std::unordered_map<spv::Id, std::vector<spirv_instruction *>> variable_stores;
+
+		// Any operand may be a reference to another ID (literal operands are treated the same, which at worst keeps a few more instructions alive than necessary)
+		for (spirv_basic_block *const block : blocks)
+		{
+			for (spirv_instruction &inst : block->instructions)
+			{
+				if (inst.result != 0)
+					definitions.emplace(inst.result, &inst);
+
+				if (inst.type != 0)
+					use_counts[inst.type]++;
+				for (const spv::Id operand : inst.operands)
+					use_counts[operand]++;
+
+				if (inst.op == spv::OpStore)
+					variable_stores[inst.operands[0]].push_back(&inst);
+			}
+		}
+
+		const auto is_dead = [&](const spirv_instruction &inst) {
+			const uint32_t use_count = use_counts[inst.result];
+			if (inst.op == spv::OpVariable)
+			{
+				const auto it = variable_stores.find(inst.result);
+				return use_count == (it != variable_stores.end() ? it->second.size() : 0);
+			}
+			return use_count == 0 && is_pure_instruction(inst.op);
+		};
+
+		std::vector<spirv_instruction *> worklist;
+		for (const auto &[id, inst] : definitions)
+			if (is_dead(*inst))
+				worklist.push_back(inst);
+
+		// Removed instructions are turned into 'OpNop' first and only erased from the blocks at the end, so that the pointers above stay valid
+		const auto remove_instruction = [&](spirv_instruction &inst) {
+			inst.op = spv::OpNop;
+
+			const auto release = [&](spv::Id id) {
+				use_counts[id]--;
+				// The defining instruction may have become dead now that this use is gone
+				if (const auto it = definitions.find(id);
+					it != definitions.end() && it->second->op != spv::OpNop && is_dead(*it->second))
+					worklist.push_back(it->second);
+			};
+
+			if (inst.type != 0)
+				release(inst.type);
+			for (const spv::Id operand : inst.operands)
+				release(operand);
+		};
+
+		while (!worklist.empty())
+		{
+			spirv_instruction &inst = *worklist.back();
+			worklist.pop_back();
+
+			if (inst.op == spv::OpNop)
+				continue; // Already removed
+
+			if (inst.op == spv::OpVariable)
+			{
+				if (const auto it = variable_stores.find(inst.result);
+					it != variable_stores.end())
+				{
+					for (spirv_instruction *const store : it->second)
+						remove_instruction(*store);
+				}
+			}
+
+			remove_instruction(inst);
+		}
+
+		for (spirv_basic_block *const block : blocks)
+		{
+			std::vector<spirv_instruction> &instructions = block->instructions;
+			instructions.erase(std::remove_if(instructions.begin(), instructions.end(),
+				[](const spirv_instruction &inst) { return inst.op == spv::OpNop; }), instructions.end());
+
+			// Remove debug line information that no longer applies to any instruction
+			for (size_t i = 0; i + 1 < instructions.size(); ++i)
+				if (instructions[i].op == spv::OpLine && instructions[i + 1].op == spv::OpLine)
+					instructions.erase(instructions.begin() + i--);
+		}
+	}
+
+	/// <summary>
+	/// Collects the IDs of all functions, global variables, types and constants that are reachable from the specified entry point.
+	/// Specialization constants and the global uniform buffer are always considered reachable, since they are part of the interface to the application.
+	/// </summary>
+	void collect_live_ids(spv::Id entry_point_id, std::unordered_set<spv::Id> &live_ids) const
+	{
+		// Build index from IDs to the instructions or functions defining them
+		std::unordered_map<spv::Id, const spirv_instruction *> global_definitions;
+		global_definitions.reserve(_types_and_constants.instructions.size() + _variables.instructions.size());
+		for (const spirv_instruction &inst : _types_and_constants.instructions)
+			if (inst.result != 0)
+				global_definitions.emplace(inst.result, &inst);
+		for (const spirv_instruction &inst : _variables.instructions)
+			if (inst.result != 0)
+				global_definitions.emplace(inst.result, &inst);
+
+		std::unordered_map<spv::Id, const function_blocks *> function_definitions;
+		function_definitions.reserve(_functions_blocks.size());
+		for (const function_blocks &function : _functions_blocks)
+			if (!function.definition.instructions.empty())
+				function_definitions.emplace(function_definition_id(function), &function);
+
+		std::vector<spv::Id> worklist;
+		const auto mark_live = [&](spv::Id id) {
+			// Only track IDs that are defined at global scope, so that a literal operand cannot accidentally keep a name or decoration of a removed local ID around
+			if (global_definitions.find(id) == global_definitions.end() && function_definitions.find(id) == function_definitions.end())
+				return;
+			if (live_ids.insert(id).second)
+				worklist.push_back(id);
+		};
+		// Any operand may be a reference to another ID (literal operands are treated the same, which at worst keeps a few more instructions alive than necessary)
+		const auto mark_referenced_ids = [&mark_live](const spirv_instruction &inst) {
+			mark_live(inst.type);
+			for (const spv::Id operand : inst.operands)
+				mark_live(operand);
+		};
+
+		live_ids.insert(entry_point_id);
+		worklist.push_back(entry_point_id);
+
+		for (const spirv_instruction &inst : _entries.instructions)
+		{
+			if (inst.operands[1] != entry_point_id)
+				continue;
+
+			// Mark all interface variables of the entry point, which follow its name
+			for (uint32_t k = 2 + static_cast<uint32_t>((std::strlen(reinterpret_cast<const char *>(&inst.operands[2])) + 4) / 4); k < inst.operands.size(); ++k)
+				mark_live(inst.operands[k]);
+		}
+
+		for (const spv::Id spec_constant : _spec_constants)
+			mark_live(spec_constant);
+
+		if (_global_ubo_type != 0 && _global_ubo_variable != 0)
+		{
+			live_ids.insert(_global_ubo_type);
+			live_ids.insert(_global_ubo_type + 1);
+			live_ids.insert(_global_ubo_variable);
+			for (const spv::Id member_type : _global_ubo_types)
+				mark_live(member_type);
+		}
+
+		while (!worklist.empty())
+		{
+			const spv::Id id = worklist.back();
+			worklist.pop_back();
+
+			if (const auto it = global_definitions.find(id);
+				it != global_definitions.end())
+			{
+				mark_referenced_ids(*it->second);
+			}
+			else
+			if (const auto it = function_definitions.find(id);
+				it != function_definitions.end())
+			{
+				for (const spirv_basic_block *block : { &it->second->declaration, &it->second->variables, &it->second->hoisted, &it->second->definition })
+				{
+					for (const spirv_instruction &inst : block->instructions)
+					{
+						// Keep names and decorations of the local IDs of a reachable function
+						live_ids.insert(inst.result);
+						mark_referenced_ids(inst);
+					}
+				}
+			}
+		}
+	}
+
 	std::string finalize_code() const override
 	{
 		// There is no high-level text representation
@@ -382,9 +746,20 @@ private:
 		if (entry_point == nullptr)
 			return false;
 
-		// Build list of IDs to remove
-		std::vector<spv::Id> variables_to_remove;
-		std::vector<spv::Id> functions_to_remove;
+		// Find everything that is reachable from the entry point, so that functions, variables, types and constants only used by other entry points are not part of the module
+		std::unordered_set<spv::Id> live_ids;
+		collect_live_ids(entry_point->id, live_ids);
+
+		// Size the output for the full module up front, so that it does not need to be reallocated while writing instructions
+		// This over-estimates the size, since instructions that are not reachable from the entry point are removed below, but avoids a second pass
+		size_t total_words = 64 + _global_ubo_types.size() + _capabilities.size() * 2 +
+			_entries.word_count() + _execution_modes.word_count() + _debug_b.word_count() + _annotations.word_count() + _types_and_constants.word_count() + _variables.word_count();
+		if (_debug_info)
+			total_words += _debug_a.word_count();
+		for (const function_blocks &function : _functions_blocks)
+			if (live_ids.find(function_definition_id(function)) != live_ids.end())
+				total_words += function.declaration.word_count() + function.variables.word_count() + function.hoisted.word_count() + function.definition.word_count();
+		spirv.reserve(spirv.size() + total_words * sizeof(uint32_t));
 
 		finalize_header_section(spirv);
 
@@ -398,14 +773,6 @@ private:
 			{
 				inst.write(spirv);
 			}
-			else
-			{
-				functions_to_remove.push_back(inst.operands[1]);
-
-				// Add interface variables to list of variables to remove
-				for (uint32_t k = 2 + static_cast<uint32_t>((std::strlen(reinterpret_cast<const char *>(&inst.operands[2])) + 4) / 4); k < inst.operands.size(); ++k)
-					variables_to_remove.push_back(inst.operands[k]);
-			}
 		}
 
 		for (const spirv_instruction &inst : _execution_modes.instructions)
@@ -423,45 +790,48 @@ private:
 
 		for (const spirv_instruction &inst : _debug_b.instructions)
 		{
-			// Remove all names of interface variables and functions for non-matching entry points
-			if (std::find(variables_to_remove.begin(), variables_to_remove.end(), inst.operands[0]) != variables_to_remove.end() ||
-				std::find(functions_to_remove.begin(), functions_to_remove.end(), inst.operands[0]) != functions_to_remove.end())
+			// Remove all names of unreachable variables, functions and types
+			if (live_ids.find(inst.operands[0]) == live_ids.end())
 				continue;
 
 			inst.write(spirv);
 		}
 
 		// All annotation instructions
-		for (spirv_instruction inst : _annotations.instructions)
+		for (const spirv_instruction &inst : _annotations.instructions)
 		{
-			if (inst.op == spv::OpDecorate)
+			// Remove all decorations targeting unreachable variables and types
+			if (live_ids.find(inst.operands[0]) == live_ids.end())
+				continue;
+
+			// Replace bindings
+			if (inst.op == spv::OpDecorate && inst.operands[1] == spv::DecorationBinding)
 			{
-				// Remove all decorations targeting any of the interface variables for non-matching entry points
-				if (std::find(variables_to_remove.begin(), variables_to_remove.end(), inst.operands[0]) != variables_to_remove.end())
-					continue;
+				inst.write(spirv);
 
-				// Replace bindings
-				if (inst.operands[1] == spv::DecorationBinding)
-				{
-					if (const auto referenced_sampler_it = std::find(entry_point->referenced_samplers.begin(), entry_point->referenced_samplers.end(), inst.operands[0]);
-						referenced_sampler_it != entry_point->referenced_samplers.end())
-						inst.operands[2] = static_cast<uint32_t>(referenced_sampler_it - entry_point->referenced_samplers.begin());
-					else
-					if (const auto referenced_storage_it = std::find(entry_point->referenced_storages.begin(), entry_point->referenced_storages.end(), inst.operands[0]);
-						referenced_storage_it != entry_point->referenced_storages.end())
-						inst.operands[2] = static_cast<uint32_t>(referenced_storage_it - entry_point->referenced_storages.begin());
-				}
+				// Patch the binding operand in the output directly, which is the last word of the instruction that was just written
+				assert(inst.operands.size() == 3);
+				uint32_t binding = inst.operands[2];
+				if (const auto referenced_sampler_it = std::find(entry_point->referenced_samplers.begin(), entry_point->referenced_samplers.end(), inst.operands[0]);
+					referenced_sampler_it != entry_point->referenced_samplers.end())
+					binding = static_cast<uint32_t>(referenced_sampler_it - entry_point->referenced_samplers.begin());
+				else
+				if (const auto referenced_storage_it = std::find(entry_point->referenced_storages.begin(), entry_point->referenced_storages.end(), inst.operands[0]);
+					referenced_storage_it != entry_point->referenced_storages.end())
+					binding = static_cast<uint32_t>(referenced_storage_it - entry_point->referenced_storages.begin());
+				std::memcpy(spirv.data() + spirv.size() - sizeof(binding), &binding, sizeof(binding));
+				continue;
 			}
 
 			inst.write(spirv);
 		}
 
-		finalize_type_and_constants_section(spirv);
+		finalize_type_and_constants_section(spirv, live_ids);
 
 		for (const spirv_instruction &inst : _variables.instructions)
 		{
-			// Remove all declarations of the interface variables for non-matching entry points
-			if (inst.op == spv::OpVariable && std::find(variables_to_remove.begin(), variables_to_remove.end(), inst.result) != variables_to_remove.end())
+			// Remove all declarations of unreachable global variables (including the interface variables of other entry points)
+			if (inst.result != 0 && live_ids.find(inst.result) == live_ids.end())
 				continue;
 
 			inst.write(spirv);
@@ -473,10 +843,7 @@ private:
 			if (function.definition.instructions.empty())
 				continue;
 
-			assert(function.declaration.instructions[function.declaration.instructions[0].op != spv::OpFunction ? 1 : 0].op == spv::OpFunction);
-			const spv::Id definition = function.declaration.instructions[function.declaration.instructions[0].op != spv::OpFunction ? 1 : 0].result;
-
-			if (std::find(functions_to_remove.begin(), functions_to_remove.end(), definition) != functions_to_remove.end())
+			if (live_ids.find(function_definition_id(function)) == live_ids.end())
 				continue;
 
 			for (const spirv_instruction &inst : function.declaration.instructions)
@@ -488,6 +855,8 @@ private:
 
 			for (const spirv_instruction &inst : function.variables.instructions)
 				inst.write(spirv);
+			for (const spirv_instruction &inst : function.hoisted.instructions)
+				inst.write(spirv);
 			for (auto inst_it = function.definition.instructions.begin() + 1; inst_it != function.definition.instructions.end(); ++inst_it)
 				inst_it->write(spirv);
 		}
@@ -517,8 +886,7 @@ private:
 
 		const type_lookup lookup { info, is_ptr, array_stride, { storage, format } };
 
-		if (const auto lookup_it = std::find_if(_type_lookup.begin(), _type_lookup.end(),
-				[&lookup](const std::pair<type_lookup, spv::Id> &lookup_entry) { return lookup_entry.first == lookup; });
+		if (const auto lookup_it = _type_lookup.find(lookup);
 			lookup_it != _type_lookup.end())
 			return lookup_it->second;
 
@@ -686,14 +1054,18 @@ private:
 			}
 		}
 
-		_type_lookup.push_back({ lookup, type_id });
+		_type_lookup.emplace(lookup, type_id);
 
 		return type_id;
 	}
 	spv::Id convert_type(const function_blocks &info)
 	{
-		if (const auto lookup_it = std::find_if(_function_type_lookup.begin(), _function_type_lookup.end(),
-				[&lookup = info](const std::pair<function_blocks, spv::Id> &lookup_entry) { return lookup_entry.first == lookup; });
+		std::vector<type> signature;
+		signature.reserve(1 + info.param_types.size());
+		signature.push_back(info.return_type);
+		signature.insert(signature.end(), info.param_types.begin(), info.param_types.end());
+
+		if (const auto lookup_it = _function_type_lookup.find(signature);
 			lookup_it != _function_type_lookup.end())
 			return lookup_it->second;
 
@@ -709,7 +1081,7 @@ private:
 			.add(return_type_id)
 			.add(param_type_ids.begin(), param_type_ids.end());
 
-		_function_type_lookup.push_back({ info, inst });
+		_function_type_lookup.emplace(std::move(signature), inst);
 
 		return inst;
 	}
@@ -737,8 +1109,7 @@ private:
 			lookup.type.struct_definition = static_cast<uint32_t>(elem_info.base);
 		}
 
-		if (const auto lookup_it = std::find_if(_type_lookup.begin(), _type_lookup.end(),
-				[&lookup](const std::pair<type_lookup, spv::Id> &lookup_entry) { return lookup_entry.first == lookup; });
+		if (const auto lookup_it = _type_lookup.find(lookup);
 			lookup_it != _type_lookup.end())
 			return lookup_it->second;
 
@@ -753,7 +1124,7 @@ private:
 				.add(info.is_storage() ? 2 : 1) // Used with a sampler or as storage
 				.add(format);
 
-		_type_lookup.push_back({ lookup, type_id });
+		_type_lookup.emplace(lookup, type_id);
 
 		return type_id;
 	}
@@ -1229,6 +1600,8 @@ private:
 		_current_function = _functions.back().get();
 		_current_function_blocks = &func;
 
+		_hoisted_loads.clear();
+
 		return res;
 	}
 
@@ -1583,6 +1956,41 @@ private:
 			if (!exp.chain.empty())
 				base_type = exp.chain[0].from;
 
+			// Uniform variables cannot change during an invocation, so load them once at the start of the function, which dominates all uses, instead of in every basic block again
+			// This is only done for loads that do not depend on any values computed inside the function (so no dynamic indexing)
+			spirv_basic_block *const block_data = _current_block_data;
+			std::string hoist_key;
+			if ((result & 0xF0000000) && _optimization_level >= 2 && is_in_function() && is_in_block())
+			{
+				hoist_key.append(reinterpret_cast<const char *>(&result), sizeof(result));
+				for (const expression::operation &op : exp.chain)
+				{
+					if (op.op == expression::operation::op_dynamic_index)
+					{
+						hoist_key.clear();
+						break;
+					}
+					if (op.op != expression::operation::op_member && op.op != expression::operation::op_constant_index)
+						break;
+					hoist_key.append(reinterpret_cast<const char *>(&op.index), sizeof(op.index));
+				}
+			}
+
+			if (!hoist_key.empty())
+			{
+				if (const auto it = _hoisted_loads.find(hoist_key);
+					it != _hoisted_loads.end())
+				{
+					result = it->second;
+					// Skip the part of the access chain that was already resolved by the hoisted load
+					while (i < exp.chain.size() && (exp.chain[i].op == expression::operation::op_member || exp.chain[i].op == expression::operation::op_constant_index))
+						base_type = exp.chain[i++].to;
+					goto apply_remaining_operations;
+				}
+
+				_current_block_data = &_current_function_blocks->hoisted;
+			}
+
 			std::pair<spv::StorageClass, spv::ImageFormat> storage = { spv::StorageClassFunction, spv::ImageFormatUnknown };
 			if (const auto it = _storage_lookup.find(exp.base);
 				it != _storage_lookup.end())
@@ -1644,19 +2052,26 @@ private:
 			result =
 				add_instruction(spv::OpLoad, convert_type(base_type, false, spv::StorageClassFunction, storage.second))
 					.add(result); // Pointer
-		}
 
-		// Need to convert boolean uniforms which are actually integers in SPIR-V
-		if (is_uniform_bool)
-		{
-			base_type.base = type::t_bool;
+			// Need to convert boolean uniforms which are actually integers in SPIR-V
+			if (is_uniform_bool)
+			{
+				base_type.base = type::t_bool;
 
-			result =
-				add_instruction(spv::OpINotEqual, convert_type(base_type))
-					.add(result)
-					.add(emit_constant(0));
+				result =
+					add_instruction(spv::OpINotEqual, convert_type(base_type))
+						.add(result)
+						.add(emit_constant(0));
+			}
+
+			if (!hoist_key.empty())
+			{
+				_hoisted_loads.emplace(std::move(hoist_key), result);
+				_current_block_data = block_data;
+			}
 		}
 
+	apply_remaining_operations:
 		// Work through all remaining operations in the access chain and apply them to the value
 		for (; i < exp.chain.size(); ++i)
 		{
@@ -1990,17 +2405,8 @@ private:
 	{
 		if (!spec_constant) // Specialization constants cannot reuse other constants
 		{
-			if (const auto it = std::find_if(_constant_lookup.begin(), _constant_lookup.end(),
-					[&data_type, &data](std::tuple<type, constant, spv::Id> &x) {
-						if (!(std::get<0>(x) == data_type && std::memcmp(&std::get<1>(x).as_uint[0], &data.as_uint[0], sizeof(uint32_t) * 16) == 0 && std::get<1>(x).array_data.size() == data.array_data.size()))
-							return false;
-						for (size_t i = 0; i < data.array_data.size(); ++i)
-							if (std::memcmp(&std::get<1>(x).array_data[i].as_uint[0], &data.array_data[i].as_uint[0], sizeof(uint32_t) * 16) != 0)
-								return false;
-						return true;
-					});
-				it != _constant_lookup.end())
-				return std::get<2>(*it); // Reuse existing constant instead of duplicating the definition
+			if (const id existing = _constant_lookup.find(data_type, data))
+				return existing; // Reuse existing constant instead of duplicating the definition
 		}
 
 		spv::Id result;
@@ -2080,7 +2486,7 @@ private:
 		if (spec_constant) // Keep track of all specialization constants
 			_spec_constants.insert(result);
 		else
-			_constant_lookup.push_back({ data_type, data, result });
+			_constant_lookup.insert(data_type, data, result);
 
 		return result;
 	}
@@ -2346,14 +2752,14 @@ private:
 
 	void emit_if(const location &loc, id, id condition_block, id true_statement_block, id false_statement_block, unsigned int selection_control) override
 	{
-		spirv_instruction merge_label = _current_block_data->instructions.back();
+		spirv_instruction merge_label = std::move(_current_block_data->instructions.back());
 		assert(merge_label.op == spv::OpLabel);
 		_current_block_data->instructions.pop_back();
 
 		// Add previous block containing the condition value first
-		_current_block_data->append(_block_data[condition_block]);
+		append_block(condition_block);
 
-		spirv_instruction branch_inst = _current_block_data->instructions.back();
+		spirv_instruction branch_inst = std::move(_current_block_data->instructions.back());
 		assert(branch_inst.op == spv::OpBranchConditional);
 		_current_block_data->instructions.pop_back();
 
@@ -2364,27 +2770,27 @@ private:
 			.add(selection_control & 0x3); // 'SelectionControl' happens to match the flags produced by the parser
 
 		// Append all blocks belonging to the branch
-		_current_block_data->instructions.push_back(branch_inst);
-		_current_block_data->append(_block_data[true_statement_block]);
-		_current_block_data->append(_block_data[false_statement_block]);
+		_current_block_data->instructions.push_back(std::move(branch_inst));
+		append_block(true_statement_block);
+		append_block(false_statement_block);
 
-		_current_block_data->instructions.push_back(merge_label);
+		_current_block_data->instructions.push_back(std::move(merge_label));
 	}
 	id   emit_phi(const location &loc, id, id condition_block, id true_value, id true_statement_block, id false_value, id false_statement_block, const type &res_type) override
 	{
-		spirv_instruction merge_label = _current_block_data->instructions.back();
+		spirv_instruction merge_label = std::move(_current_block_data->instructions.back());
 		assert(merge_label.op == spv::OpLabel);
 		_current_block_data->instructions.pop_back();
 
 		// Add previous block containing the condition value first
-		_current_block_data->append(_block_data[condition_block]);
+		append_block(condition_block);
 
 		if (true_statement_block != condition_block)
-			_current_block_data->append(_block_data[true_statement_block]);
+			append_block(true_statement_block);
 		if (false_statement_block != condition_block)
-			_current_block_data->append(_block_data[false_statement_block]);
+			append_block(false_statement_block);
 
-		_current_block_data->instructions.push_back(merge_label);
+		_current_block_data->instructions.push_back(std::move(merge_label));
 
 		add_location(loc, *_current_block_data);
 
@@ -2399,16 +2805,17 @@ private:
 	}
 	void emit_loop(const location &loc, id, id prev_block, id header_block, id condition_block, id loop_block, id continue_block, unsigned int loop_control) override
 	{
-		spirv_instruction merge_label = _current_block_data->instructions.back();
+		spirv_instruction merge_label = std::move(_current_block_data->instructions.back());
 		assert(merge_label.op == spv::OpLabel);
 		_current_block_data->instructions.pop_back();
 
 		// Add previous block first
-		_current_block_data->append(_block_data[prev_block]);
+		append_block(prev_block);
 
 		// Fill header block
 		assert(_block_data[header_block].instructions.size() == 2);
-		_current_block_data->instructions.push_back(_block_data[header_block].instructions[0]);
+		spirv_basic_block &header_block_data = _block_data[header_block];
+		_current_block_data->instructions.push_back(std::move(header_block_data.instructions[0]));
 		assert(_current_block_data->instructions.back().op == spv::OpLabel);
 
 		// Add structured control flow instruction
@@ -2418,31 +2825,32 @@ private:
 			.add(continue_block)
 			.add(loop_control & 0x3); // 'LoopControl' happens to match the flags produced by the parser
 
-		_current_block_data->instructions.push_back(_block_data[header_block].instructions[1]);
+		_current_block_data->instructions.push_back(std::move(header_block_data.instructions[1]));
 		assert(_current_block_data->instructions.back().op == spv::OpBranch);
+		_block_data.erase(header_block);
 
 		// Add condition block if it exists
 		if (condition_block != 0)
-			_current_block_data->append(_block_data[condition_block]);
+			append_block(condition_block);
 
 		// Append loop body block before continue block
-		_current_block_data->append(_block_data[loop_block]);
-		_current_block_data->append(_block_data[continue_block]);
+		append_block(loop_block);
+		append_block(continue_block);
 
-		_current_block_data->instructions.push_back(merge_label);
+		_current_block_data->instructions.push_back(std::move(merge_label));
 	}
 	void emit_switch(const location &loc, id, id selector_block, id default_label, id default_block, const std::vector<id> &case_literal_and_labels, const std::vector<id> &case_blocks, unsigned int selection_control) override
 	{
 		assert(case_blocks.size() == case_literal_and_labels.size() / 2);
 
-		spirv_instruction merge_label = _current_block_data->instructions.back();
+		spirv_instruction merge_label = std::move(_current_block_data->instructions.back());
 		assert(merge_label.op == spv::OpLabel);
 		_current_block_data->instructions.pop_back();
 
 		// Add previous block containing the selector value first
-		_current_block_data->append(_block_data[selector_block]);
+		append_block(selector_block);
 
-		spirv_instruction switch_inst = _current_block_data->instructions.back();
+		spirv_instruction switch_inst = std::move(_current_block_data->instructions.back());
 		assert(switch_inst.op == spv::OpSwitch);
 		_current_block_data->instructions.pop_back();
 
@@ -2457,7 +2865,7 @@ private:
 		switch_inst.add(case_literal_and_labels.begin(), case_literal_and_labels.end());
 
 		// Append all blocks belonging to the switch
-		_current_block_data->instructions.push_back(switch_inst);
+		_current_block_data->instructions.push_back(std::move(switch_inst));
 
 		std::vector<id> blocks = case_blocks;
 		if (default_label != merge_label)
@@ -2466,15 +2874,28 @@ private:
 		std::sort(blocks.begin(), blocks.end());
 		blocks.erase(std::unique(blocks.begin(), blocks.end()), blocks.end());
 		for (const id case_block : blocks)
-			_current_block_data->append(_block_data[case_block]);
+			append_block(case_block);
 
-		_current_block_data->instructions.push_back(merge_label);
+		_current_block_data->instructions.push_back(std::move(merge_label));
 	}
 
 	void emit_pragma(const std::string &) override
 	{
 	}
 
+	/// <summary>
+	/// Moves all instructions of the specified basic block to the end of the current one and releases the now empty block.
+	/// </summary>
+	void append_block(id block)
+	{
+		const auto it = _block_data.find(block);
+		if (it == _block_data.end())
+			return;
+
+		_current_block_data->append(std::move(it->second));
+		_block_data.erase(it);
+	}
+
 	bool is_in_function() const { return _current_function_blocks != nullptr; }
 
 	id   set_block(id id) override
@@ -2574,11 +2995,14 @@ private:
 	{
 		assert(is_in_function()); // Can only leave if there was a function to begin with
 
-		_current_function_blocks->definition = _block_data[_last_block];
+		_current_function_blocks->definition = std::move(_block_data[_last_block]);
 
 		// Append function end instruction
 		add_instruction_without_result(spv::OpFunctionEnd, _current_function_blocks->definition);
 
+		if (_optimization_level >= 2)
+			remove_dead_code(*_current_function_blocks);
+
 		_current_function = nullptr;
 		_current_function_blocks = nullptr;
 	}
@@ -4,10 +4,27 @@
  */
 
 #include "effect_lexer.hpp"
+#include <mutex>
+#include <atomic>
+#include <cstring> // std::memchr
+#include <deque>
+#include <vector>
 #include <cassert>
+#include <algorithm> // std::find, std::find_if, std::sort
 #include <string_view>
 #include <unordered_map> // Used for static lookup tables
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define RESHADEFX_LEXER_SSE2 1
+	#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+	#define RESHADEFX_LEXER_NEON 1
+	#include <arm_neon.h>
+#endif
+#ifdef _MSC_VER
+	#include <intrin.h> // _BitScanForward, _BitScanReverse
+#endif
+
 using namespace reshadefx;
 
 enum token_type
@@ -233,7 +250,107 @@ static const std::unordered_map<tokenid, std::string_view> s_token_lookup = {
 	{ tokenid::storage2d, "storage2D" },
 	{ tokenid::storage3d, "storage3D" },
 };
-static const std::unordered_map<std::string_view, tokenid> s_keyword_lookup = {
+// Perfect hash table for looking up the token identifier of a keyword
+// Keywords are distributed into buckets by a first hash, and each bucket gets a seed for a second hash that maps all its keywords to distinct slots, so every lookup is a single probe followed by a single string comparison
+// The seeds are searched for once during static initialization, which avoids having to regenerate a table by hand whenever a keyword is added
+class keyword_lookup
+{
+public:
+	using entry = std::pair<std::string_view, tokenid>;
+
+	keyword_lookup(std::initializer_list<entry> entries)
+	{
+		uint32_t num_slots = 1;
+		while (num_slots < entries.size() * 2) // Keep the load factor at or below one half, so that seeds are found quickly
+			num_slots *= 2;
+		uint32_t num_buckets = 1;
+		while (num_buckets * 4 < entries.size())
+			num_buckets *= 2;
+
+		_slot_mask = num_slots - 1;
+		_bucket_mask = num_buckets - 1;
+		_slots.resize(num_slots);
+		_seeds.resize(num_buckets);
+
+		std::vector<std::vector<const entry *>> buckets(num_buckets);
+		for (const entry &entry : entries)
+		{
+			assert(!entry.first.empty());
+
+			std::vector<const keyword_lookup::entry *> &bucket = buckets[hash(entry.first, 0) & _bucket_mask];
+			// Ignore duplicate keywords (keeping the first one), since they could never be placed into distinct slots
+			if (std::find_if(bucket.begin(), bucket.end(), [&entry](const keyword_lookup::entry *other) { return other->first == entry.first; }) == bucket.end())
+				bucket.push_back(&entry);
+		}
+
+		// Place the largest buckets first, while there are still many free slots
+		std::vector<uint32_t> bucket_order(num_buckets);
+		for (uint32_t i = 0; i < num_buckets; ++i)
+			bucket_order[i] = i;
+		std::sort(bucket_order.begin(), bucket_order.end(),
+			[&buckets](uint32_t lhs, uint32_t rhs) { return buckets[lhs].size() > buckets[rhs].size(); });
+
+		std::vector<bool> occupied(num_slots);
+		std::vector<uint32_t> bucket_slots;
+		for (const uint32_t bucket_index : bucket_order)
+		{
+			const std::vector<const entry *> &bucket = buckets[bucket_index];
+			if (bucket.empty())
+				break;
+
+			for (uint32_t seed = 1; ; ++seed)
+			{
+				bucket_slots.clear();
+				for (const entry *const entry : bucket)
+				{
+					const uint32_t slot = hash(entry->first, seed) & _slot_mask;
+					if (occupied[slot] || std::find(bucket_slots.begin(), bucket_slots.end(), slot) != bucket_slots.end())
+						break;
+					bucket_slots.push_back(slot);
+				}
+
+				if (bucket_slots.size() != bucket.size())
+					continue;
+
+				for (size_t i = 0; i < bucket.size(); ++i)
+				{
+					occupied[bucket_slots[i]] = true;
+					_slots[bucket_slots[i]] = *bucket[i];
+				}
+
+				_seeds[bucket_index] = seed;
+				break;
+			}
+		}
+	}
+
+	const entry *find(const std::string_view name) const
+	{
+		const entry &entry = _slots[hash(name, _seeds[hash(name, 0) & _bucket_mask]) & _slot_mask];
+		// Unused slots hold an empty name, so need to make sure an empty name does not match those
+		return entry.first == name && !name.empty() ? &entry : nullptr;
+	}
+
+private:
+	static uint32_t hash(const std::string_view name, uint32_t seed)
+	{
+		// FNV-1a with the seed mixed into the offset basis, followed by a finalizer to spread the bits
+		uint32_t h = 2166136261u ^ (seed * 0x9E3779B9u);
+		for (const char c : name)
+			h = (h ^ static_cast<uint8_t>(c)) * 16777619u;
+		h ^= h >> 16;
+		h *= 0x85EBCA6Bu;
+		h ^= h >> 13;
+		return h;
+	}
+
+	uint32_t _slot_mask = 0;
+	uint32_t _bucket_mask = 0;
+	std::vector<entry> _slots;
+	std::vector<uint32_t> _seeds;
+};
+
+static const keyword_lookup s_keyword_lookup = {
 	{ "_Pragma", tokenid::pragma },
 	{ "asm", tokenid::reserved },
 	{ "asm_fragment", tokenid::reserved },
@@ -495,7 +612,7 @@ static const std::unordered_map<std::string_view, tokenid> s_keyword_lookup = {
 	{ "volatile", tokenid::volatile_ },
 	{ "while", tokenid::while_ }
 };
-static const std::unordered_map<std::string_view, tokenid> s_pp_directive_lookup = {
+static const keyword_lookup s_pp_directive_lookup = {
 	{ "define", tokenid::hash_def },
 	{ "undef", tokenid::hash_undef },
 	{ "if", tokenid::hash_if },
@@ -558,6 +675,194 @@ static long long octal_to_decimal(long long n)
 	return n;
 }
 
+#if RESHADEFX_LEXER_SSE2 || RESHADEFX_LEXER_NEON
+static std::atomic<bool> s_vectorized_scanning = true;
+
+static uint32_t find_first_bit(uint32_t mask)
+{
+	assert(mask != 0);
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+static uint32_t find_last_bit(uint32_t mask)
+{
+	assert(mask != 0);
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse(&index, mask);
+	return index;
+#else
+	return 31 - __builtin_clz(mask);
+#endif
+}
+static uint32_t count_bits(uint32_t mask)
+{
+	// Not using a popcnt intrinsic, since that instruction is not guaranteed to be available on all x86 processors
+	mask = mask - ((mask >> 1) & 0x55555555);
+	mask = (mask & 0x33333333) + ((mask >> 2) & 0x33333333);
+	return (((mask + (mask >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+}
+
+// Helpers operating on 16 characters at a time, where comparisons produce a bit mask with one bit per character
+#if RESHADEFX_LEXER_SSE2
+using char_block = __m128i;
+
+static char_block load_block(const char *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+static char_block equal(char_block v, char c) { return _mm_cmpeq_epi8(v, _mm_set1_epi8(c)); }
+static char_block in_range(char_block v, char lo, char hi) { return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8(hi + 1))); } // Characters outside the ASCII range are negative and therefore never in range
+static char_block bitwise_or(char_block a, char_block b) { return _mm_or_si128(a, b); }
+static char_block bitwise_and(char_block a, char_block b) { return _mm_and_si128(a, b); }
+static char_block to_lower(char_block v) { return _mm_or_si128(v, _mm_set1_epi8(0x20)); }
+static uint32_t to_mask(char_block v) { return static_cast<uint32_t>(_mm_movemask_epi8(v)); }
+#else
+using char_block = uint8x16_t;
+
+static char_block load_block(const char *p) { return vld1q_u8(reinterpret_cast<const uint8_t *>(p)); }
+static char_block equal(char_block v, char c) { return vceqq_u8(v, vdupq_n_u8(static_cast<uint8_t>(c))); }
+static char_block in_range(char_block v, char lo, char hi) { return vandq_u8(vcgeq_u8(v, vdupq_n_u8(static_cast<uint8_t>(lo))), vcleq_u8(v, vdupq_n_u8(static_cast<uint8_t>(hi)))); }
+static char_block bitwise_or(char_block a, char_block b) { return vorrq_u8(a, b); }
+static char_block bitwise_and(char_block a, char_block b) { return vandq_u8(a, b); }
+static char_block to_lower(char_block v) { return vorrq_u8(v, vdupq_n_u8(0x20)); }
+static uint32_t to_mask(char_block v)
+{
+	// There is no equivalent to 'movemask' on ARM, so select one bit per lane and sum up each half
+	static const uint8_t lane_bits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+	const uint8x16_t bits = vandq_u8(v, vld1q_u8(lane_bits));
+	return vaddv_u8(vget_low_u8(bits)) | (static_cast<uint32_t>(vaddv_u8(vget_high_u8(bits))) << 8);
+}
+#endif
+#endif
+
+// Returns a pointer to the first character that is not a space (new line feeds do not count as space)
+static const char *scan_space(const char *cur, const char *const end)
+{
+#if RESHADEFX_LEXER_SSE2 || RESHADEFX_LEXER_NEON
+	if (s_vectorized_scanning.load(std::memory_order_relaxed))
+	{
+		for (; end - cur >= 16; cur += 16)
+		{
+			const char_block v = load_block(cur);
+			const uint32_t mask = ~to_mask(bitwise_or(bitwise_or(equal(v, ' '), equal(v, '\t')), bitwise_or(bitwise_or(equal(v, '\v'), equal(v, '\f')), equal(v, '\r')))) & 0xFFFF;
+			if (mask != 0)
+				return cur + find_first_bit(mask);
+		}
+	}
+#endif
+
+	while (cur < end && s_type_lookup[uint8_t(*cur)] == SPACE)
+		cur++;
+	return cur;
+}
+// Returns a pointer to the first character that cannot be part of an identifier
+static const char *scan_identifier(const char *cur, const char *const end)
+{
+#if RESHADEFX_LEXER_SSE2 || RESHADEFX_LEXER_NEON
+	if (s_vectorized_scanning.load(std::memory_order_relaxed))
+	{
+		for (; end - cur >= 16; cur += 16)
+		{
+			const char_block v = load_block(cur);
+			const uint32_t mask = ~to_mask(bitwise_or(bitwise_or(in_range(to_lower(v), 'a', 'z'), in_range(v, '0', '9')), equal(v, '_'))) & 0xFFFF;
+			if (mask != 0)
+				return cur + find_first_bit(mask);
+		}
+	}
+#endif
+
+	while (cur < end && (s_type_lookup[uint8_t(*cur)] == IDENT || s_type_lookup[uint8_t(*cur)] == DIGIT))
+		cur++;
+	return cur;
+}
+// Returns a pointer to the first '*/' sequence (or the end of the input if there is none) and counts the new line feeds before it
+static const char *scan_block_comment(const char *cur, const char *const end, uint32_t &num_lines, const char *&last_line_begin)
+{
+#if RESHADEFX_LEXER_SSE2 || RESHADEFX_LEXER_NEON
+	if (s_vectorized_scanning.load(std::memory_order_relaxed))
+	{
+		// Need one character of lookahead to check for the '/' following a '*'
+		for (; end - cur > 16; cur += 16)
+		{
+			const char_block v = load_block(cur);
+			const uint32_t terminator_mask = to_mask(bitwise_and(equal(v, '*'), equal(load_block(cur + 1), '/')));
+			uint32_t new_line_mask = to_mask(equal(v, '\n'));
+
+			if (terminator_mask != 0)
+				new_line_mask &= (terminator_mask & (0u - terminator_mask)) - 1; // Only count new line feeds before the terminator
+
+			if (new_line_mask != 0)
+			{
+				num_lines += count_bits(new_line_mask);
+				last_line_begin = cur + find_last_bit(new_line_mask) + 1;
+			}
+
+			if (terminator_mask != 0)
+				return cur + find_first_bit(terminator_mask);
+		}
+	}
+#endif
+
+	for (; cur < end; cur++)
+	{
+		if (*cur == '\n')
+		{
+			num_lines++;
+			last_line_begin = cur + 1;
+		}
+		else if (cur[0] == '*' && cur[1] == '/')
+		{
+			return cur;
+		}
+	}
+	return end;
+}
+
+// Table of all source file names referenced by locations, index zero is reserved for unknown sources
+// A deque is used so that references to existing names stay valid while new ones are added
+static std::mutex s_source_names_mutex;
+static std::deque<std::string> s_source_names(1);
+static const std::string s_unknown_source_name;
+static std::unordered_map<std::string_view, uint32_t> s_source_name_lookup;
+
+uint32_t reshadefx::location::intern_source_name(const std::string_view source_name)
+{
+	if (source_name.empty())
+		return 0;
+
+	const std::lock_guard<std::mutex> lock(s_source_names_mutex);
+
+	if (const auto it = s_source_name_lookup.find(source_name);
+		it != s_source_name_lookup.end())
+		return it->second;
+
+	const uint32_t source = static_cast<uint32_t>(s_source_names.size());
+	s_source_name_lookup.emplace(s_source_names.emplace_back(source_name), source);
+	return source;
+}
+const std::string &reshadefx::location::lookup_source_name(uint32_t source)
+{
+	if (source == 0)
+		return s_unknown_source_name;
+
+	const std::lock_guard<std::mutex> lock(s_source_names_mutex);
+
+	assert(source < s_source_names.size());
+	return s_source_names[source];
+}
+
+void reshadefx::lexer::set_vectorized_scanning(bool enable)
+{
+#if RESHADEFX_LEXER_SSE2 || RESHADEFX_LEXER_NEON
+	s_vectorized_scanning.store(enable, std::memory_order_relaxed);
+#else
+	(void)enable;
+#endif
+}
+
 std::string reshadefx::token::id_to_name(tokenid id)
 {
 	const auto it = s_token_lookup.find(id);
@@ -711,20 +1016,23 @@ next_token:
 		}
 		else if (_cur[1] == '*')
 		{
-			while (_cur < _end)
+			uint32_t num_lines = 0;
+			const char *last_line_begin = nullptr;
+			const char *comment_end = scan_block_comment(_cur, _end, num_lines, last_line_begin);
+			if (comment_end != _end)
+				comment_end += 2; // Skip the '*/'
+
+			if (num_lines != 0)
 			{
-				if (*_cur == '\n')
-				{
-					_cur_location.line++;
-					_cur_location.column = 1;
-				}
-				else if (_cur[0] == '*' && _cur[1] == '/')
-				{
-					skip(2);
-					break;
-				}
-				skip(1);
+				_cur_location.line += num_lines;
+				// Columns following a new line feed in a comment have always been counted starting from the new line feed itself, so keep doing that to not change reported locations
+				_cur_location.column = 2 + static_cast<unsigned int>(comment_end - last_line_begin);
+			}
+			else
+			{
+				_cur_location.column += static_cast<unsigned int>(comment_end - _cur);
 			}
+			_cur = comment_end;
 			if (_ignore_comments)
 				goto next_token;
 			tok.id = tokenid::multi_line_comment;
@@ -861,44 +1169,31 @@ void reshadefx::lexer::skip_space()
 			continue;
 		}
 
-		if (s_type_lookup[uint8_t(*_cur)] == SPACE)
-			skip(1);
-		else
+		const char *const space_end = scan_space(_cur, _end);
+		if (space_end == _cur)
 			break;
+		skip(space_end - _cur);
 	}
 }
 void reshadefx::lexer::skip_to_next_line()
 {
 	// Skip each character until a new line feed is found
-	while (*_cur != '\n' && _cur < _end)
-	{
-#if 0
-		if (_cur[0] == '\\' && (_cur[1] == '\n' || (_cur[1] == '\r' && _cur[2] == '\n')))
-		{
-			skip(_cur[1] == '\r' ? 3 : 2);
-			_cur_location.line++;
-			_cur_location.column = 1;
-			continue;
-		}
-#endif
-
-		skip(1);
-	}
+	const char *const line_end = static_cast<const char *>(std::memchr(_cur, '\n', _end - _cur));
+	skip((line_end != nullptr ? line_end : _end) - _cur);
 }
 
 void reshadefx::lexer::reset_to_offset(size_t offset)
 {
-	assert(offset < _input.size());
-	_cur = _input.data() + offset;
+	assert(offset < _input->size());
+	_cur = _input->data() + offset;
 }
 
 void reshadefx::lexer::parse_identifier(token &tok) const
 {
-	auto *const begin = _cur, *end = begin;
+	auto *const begin = _cur;
 
 	// Skip to the end of the identifier sequence
-	while (s_type_lookup[uint8_t(*end)] == IDENT || s_type_lookup[uint8_t(*end)] == DIGIT)
-		end++;
+	auto *const end = scan_identifier(begin, _end);
 
 	tok.id = tokenid::identifier;
 	tok.offset = input_offset();
@@ -909,7 +1204,7 @@ void reshadefx::lexer::parse_identifier(token &tok) const
 		return;
 
 	if (const auto it = s_keyword_lookup.find(tok.literal_as_string);
-		it != s_keyword_lookup.end())
+		it != nullptr)
 		tok.id = it->second;
 }
 bool reshadefx::lexer::parse_pp_directive(token &tok)
@@ -919,7 +1214,7 @@ bool reshadefx::lexer::parse_pp_directive(token &tok)
 	parse_identifier(tok);
 
 	if (const auto it = s_pp_directive_lookup.find(tok.literal_as_string);
-		it != s_pp_directive_lookup.end())
+		it != nullptr)
 	{
 		tok.id = it->second;
 		return true;
@@ -945,7 +1240,7 @@ bool reshadefx::lexer::parse_pp_directive(token &tok)
 			token temptok;
 			parse_string_literal(temptok, false);
 
-			_cur_location.source = std::move(temptok.literal_as_string);
+			_cur_location.source = location::intern_source_name(temptok.literal_as_string);
 		}
 
 		// Do not return the #line directive as token to the caller
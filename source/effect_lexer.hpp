@@ -6,6 +6,7 @@
 #pragma once
 
 #include "effect_token.hpp"
+#include <memory> // std::shared_ptr
 
 namespace reshadefx
 {
@@ -24,7 +25,8 @@ namespace reshadefx
 			bool ignore_keywords = false,
 			bool escape_string_literals = true,
 			const location &start_location = location()) :
-			_input(std::move(input)),
+			_owned_input(std::move(input)),
+			_input(&_owned_input),
 			_cur_location(start_location),
 			_ignore_comments(ignore_comments),
 			_ignore_whitespace(ignore_whitespace),
@@ -33,17 +35,44 @@ namespace reshadefx
 			_ignore_keywords(ignore_keywords),
 			_escape_string_literals(escape_string_literals)
 		{
-			_cur = _input.data();
-			_end = _cur + _input.size();
+			_cur = _input->data();
+			_end = _cur + _input->size();
+		}
+		/// <summary>
+		/// Constructs a lexical analyzer that shares the specified input string with its other owners, instead of keeping a copy of it.
+		/// </summary>
+		explicit lexer(
+			std::shared_ptr<const std::string> input,
+			bool ignore_comments = true,
+			bool ignore_whitespace = true,
+			bool ignore_pp_directives = true,
+			bool ignore_line_directives = false,
+			bool ignore_keywords = false,
+			bool escape_string_literals = true,
+			const location &start_location = location()) :
+			_shared_input(std::move(input)),
+			_input(_shared_input.get()),
+			_cur_location(start_location),
+			_ignore_comments(ignore_comments),
+			_ignore_whitespace(ignore_whitespace),
+			_ignore_pp_directives(ignore_pp_directives),
+			_ignore_line_directives(ignore_line_directives),
+			_ignore_keywords(ignore_keywords),
+			_escape_string_literals(escape_string_literals)
+		{
+			_cur = _input->data();
+			_end = _cur + _input->size();
 		}
 
 		lexer(const lexer &lexer) { operator=(lexer); }
 		lexer &operator=(const lexer &lexer)
 		{
-			_input = lexer._input;
+			_owned_input = lexer._owned_input;
+			_shared_input = lexer._shared_input;
+			_input = _shared_input != nullptr ? _shared_input.get() : &_owned_input;
 			_cur_location = lexer._cur_location;
-			reset_to_offset(lexer._cur - lexer._input.data());
-			_end = _input.data() + _input.size();
+			reset_to_offset(lexer._cur - lexer._input->data());
+			_end = _input->data() + _input->size();
 			_ignore_comments = lexer._ignore_comments;
 			_ignore_whitespace = lexer._ignore_whitespace;
 			_ignore_pp_directives = lexer._ignore_pp_directives;
@@ -54,16 +83,22 @@ namespace reshadefx
 			return *this;
 		}
 
+		/// <summary>
+		/// Selects whether runs of whitespace, identifier characters and comments are scanned 16 characters at a time using SSE2 or NEON instructions (if available on the target architecture) or one character at a time.
+		/// This is enabled by default and applies to all lexer instances.
+		/// </summary>
+		static void set_vectorized_scanning(bool enable);
+
 		/// <summary>
 		/// Gets the current position in the input string.
 		/// </summary>
-		size_t input_offset() const { return _cur - _input.data(); }
+		size_t input_offset() const { return _cur - _input->data(); }
 
 		/// <summary>
 		/// Gets the input string this lexical analyzer works on.
 		/// </summary>
 		/// <returns>Constant reference to the input string.</returns>
-		const std::string &input_string() const { return _input; }
+		const std::string &input_string() const { return *_input; }
 
 		/// <summary>
 		/// Performs lexical analysis on the input string and return the next token in sequence.
@@ -98,7 +133,10 @@ namespace reshadefx
 		void parse_string_literal(token &tok, bool escape);
 		void parse_numeric_literal(token &tok) const;
 
-		std::string _input;
+		// Input is either owned by this lexer or shared with other owners (like the include cache of the preprocessor), '_input' points to whichever is used
+		std::string _owned_input;
+		std::shared_ptr<const std::string> _shared_input;
+		const std::string *_input;
 		location _cur_location;
 		const std::string::value_type *_cur, *_end;
 
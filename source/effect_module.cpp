@@ -0,0 +1,462 @@
+/*
+ * Copyright (C) 2026 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "effect_module.hpp"
+#include <cstring> // std::memcpy
+#include <type_traits>
+
+// Magic value at the start of serialized modules ('RFXM')
+static constexpr uint32_t s_module_magic = 0x4D584652;
+// Increment this whenever the layout of any of the structures in 'effect_module.hpp' changes, so that old cache entries are rejected
+static constexpr uint32_t s_module_format_version = 1;
+
+// Upper bound for the nesting depth of array constants, to avoid unbounded recursion on corrupted data
+static constexpr unsigned int s_max_constant_depth = 16;
+
+namespace
+{
+	struct module_writer
+	{
+		std::string &data;
+
+		template <typename T>
+		void write(const T &value)
+		{
+			static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>);
+			data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+		}
+		template <typename T, size_t N>
+		void write(const T (&values)[N])
+		{
+			for (const T &value : values)
+				write(value);
+		}
+		template <typename T>
+		void write(const std::vector<T> &values)
+		{
+			write(static_cast<uint32_t>(values.size()));
+			for (const T &value : values)
+				write(value);
+		}
+
+		void write(const std::string &value)
+		{
+			write(static_cast<uint32_t>(value.size()));
+			data.append(value);
+		}
+
+		void write(const reshadefx::type &value)
+		{
+			write(static_cast<uint32_t>(value.base));
+			write(static_cast<uint32_t>(value.rows));
+			write(static_cast<uint32_t>(value.cols));
+			write(static_cast<uint32_t>(value.qualifiers));
+			write(value.array_length);
+			write(value.struct_definition);
+		}
+		void write(const reshadefx::constant &value)
+		{
+			write(value.as_uint);
+			write(value.string_data);
+			write(value.array_data);
+		}
+		void write(const reshadefx::annotation &value)
+		{
+			write(value.type);
+			write(value.name);
+			write(value.value);
+		}
+		void write(const reshadefx::texture &value)
+		{
+			write(value.width);
+			write(value.height);
+			write(value.depth);
+			write(value.levels);
+			write(value.type);
+			write(value.format);
+			write(value.id);
+			write(value.name);
+			write(value.unique_name);
+			write(value.semantic);
+			write(value.annotations);
+			write(value.render_target);
+			write(value.storage_access);
+			write(value.semantic_binding);
+		}
+		void write(const reshadefx::sampler &value)
+		{
+			write(value.filter);
+			write(value.address_u);
+			write(value.address_v);
+			write(value.address_w);
+			write(value.min_lod);
+			write(value.max_lod);
+			write(value.lod_bias);
+			write(value.type);
+			write(value.id);
+			write(value.name);
+			write(value.unique_name);
+			write(value.texture_name);
+			write(value.annotations);
+			write(value.srgb);
+		}
+		void write(const reshadefx::storage &value)
+		{
+			write(value.level);
+			write(value.type);
+			write(value.id);
+			write(value.name);
+			write(value.unique_name);
+			write(value.texture_name);
+		}
+		void write(const reshadefx::uniform &value)
+		{
+			write(value.type);
+			write(value.name);
+			write(value.unique_name);
+			write(value.size);
+			write(value.offset);
+			write(value.annotations);
+			write(value.has_initializer_value);
+			write(value.initializer_value);
+		}
+		void write(const reshadefx::texture_binding &value)
+		{
+			write(static_cast<uint64_t>(value.index));
+			write(value.entry_point_binding);
+			write(value.srgb);
+		}
+		void write(const reshadefx::sampler_binding &value)
+		{
+			write(static_cast<uint64_t>(value.index));
+			write(value.entry_point_binding);
+		}
+		void write(const reshadefx::storage_binding &value)
+		{
+			write(static_cast<uint64_t>(value.index));
+			write(value.entry_point_binding);
+		}
+		void write(const reshadefx::pass &value)
+		{
+			write(value.name);
+			for (const std::string &render_target_name : value.render_target_names)
+				write(render_target_name);
+			write(value.vs_entry_point);
+			write(value.ps_entry_point);
+			write(value.cs_entry_point);
+			write(value.generate_mipmaps);
+			write(value.clear_render_targets);
+			write(value.blend_enable);
+			write(value.source_color_blend_factor);
+			write(value.dest_color_blend_factor);
+			write(value.color_blend_op);
+			write(value.source_alpha_blend_factor);
+			write(value.dest_alpha_blend_factor);
+			write(value.alpha_blend_op);
+			write(value.srgb_write_enable);
+			write(value.render_target_write_mask);
+			write(value.stencil_enable);
+			write(value.stencil_read_mask);
+			write(value.stencil_write_mask);
+			write(value.stencil_reference_value);
+			write(value.stencil_comparison_func);
+			write(value.stencil_pass_op);
+			write(value.stencil_fail_op);
+			write(value.stencil_depth_fail_op);
+			write(value.topology);
+			write(value.num_vertices);
+			write(value.viewport_width);
+			write(value.viewport_height);
+			write(value.viewport_dispatch_z);
+			write(value.texture_bindings);
+			write(value.sampler_bindings);
+			write(value.storage_bindings);
+		}
+		void write(const reshadefx::technique &value)
+		{
+			write(value.name);
+			write(value.passes);
+			write(value.annotations);
+		}
+		void write(const std::pair<std::string, reshadefx::shader_type> &value)
+		{
+			write(value.first);
+			write(value.second);
+		}
+	};
+
+	// Reads back the data written by 'module_writer'
+	// Instead of checking every single read, reads past the end of the data set the failure flag and return zeroes, which is checked once at the end
+	struct module_reader
+	{
+		const char *cur;
+		const char *end;
+		bool failed = false;
+		unsigned int constant_depth = 0;
+
+		bool read_bytes(void *data, size_t size)
+		{
+			if (failed || static_cast<size_t>(end - cur) < size)
+			{
+				failed = true;
+				std::memset(data, 0, size);
+				return false;
+			}
+
+			std::memcpy(data, cur, size);
+			cur += size;
+			return true;
+		}
+
+		template <typename T>
+		void read(T &value)
+		{
+			static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>);
+			read_bytes(&value, sizeof(value));
+		}
+		void read(bool &value)
+		{
+			// Avoid loading values other than zero and one into a boolean from corrupted data
+			uint8_t byte = 0;
+			read(byte);
+			value = byte != 0;
+		}
+		template <typename T, size_t N>
+		void read(T (&values)[N])
+		{
+			for (T &value : values)
+				read(value);
+		}
+		template <typename T>
+		void read(std::vector<T> &values)
+		{
+			uint32_t size = 0;
+			read(size);
+			// Every element takes up at least one byte, so this catches corrupted sizes before attempting a huge allocation
+			if (size > static_cast<size_t>(end - cur))
+				failed = true;
+			if (failed)
+				return;
+
+			values.resize(size);
+			for (T &value : values)
+				read(value);
+		}
+
+		void read(std::string &value)
+		{
+			uint32_t size = 0;
+			read(size);
+			if (size > static_cast<size_t>(end - cur))
+				failed = true;
+			if (failed)
+				return;
+
+			value.assign(cur, size);
+			cur += size;
+		}
+
+		void read(reshadefx::type &value)
+		{
+			uint32_t base = 0, rows = 0, cols = 0, qualifiers = 0;
+			read(base);
+			read(rows);
+			read(cols);
+			read(qualifiers);
+			value.base = static_cast<reshadefx::type::datatype>(base);
+			value.rows = rows;
+			value.cols = cols;
+			value.qualifiers = qualifiers;
+			read(value.array_length);
+			read(value.struct_definition);
+		}
+		void read(reshadefx::constant &value)
+		{
+			if (++constant_depth > s_max_constant_depth)
+				failed = true;
+
+			read(value.as_uint);
+			read(value.string_data);
+			read(value.array_data);
+
+			--constant_depth;
+		}
+		void read(reshadefx::annotation &value)
+		{
+			read(value.type);
+			read(value.name);
+			read(value.value);
+		}
+		void read(reshadefx::texture &value)
+		{
+			read(value.width);
+			read(value.height);
+			read(value.depth);
+			read(value.levels);
+			read(value.type);
+			read(value.format);
+			read(value.id);
+			read(value.name);
+			read(value.unique_name);
+			read(value.semantic);
+			read(value.annotations);
+			read(value.render_target);
+			read(value.storage_access);
+			read(value.semantic_binding);
+		}
+		void read(reshadefx::sampler &value)
+		{
+			read(value.filter);
+			read(value.address_u);
+			read(value.address_v);
+			read(value.address_w);
+			read(value.min_lod);
+			read(value.max_lod);
+			read(value.lod_bias);
+			read(value.type);
+			read(value.id);
+			read(value.name);
+			read(value.unique_name);
+			read(value.texture_name);
+			read(value.annotations);
+			read(value.srgb);
+		}
+		void read(reshadefx::storage &value)
+		{
+			read(value.level);
+			read(value.type);
+			read(value.id);
+			read(value.name);
+			read(value.unique_name);
+			read(value.texture_name);
+		}
+		void read(reshadefx::uniform &value)
+		{
+			read(value.type);
+			read(value.name);
+			read(value.unique_name);
+			read(value.size);
+			read(value.offset);
+			read(value.annotations);
+			read(value.has_initializer_value);
+			read(value.initializer_value);
+		}
+		void read(reshadefx::texture_binding &value)
+		{
+			uint64_t index = 0;
+			read(index);
+			value.index = static_cast<size_t>(index);
+			read(value.entry_point_binding);
+			read(value.srgb);
+		}
+		void read(reshadefx::sampler_binding &value)
+		{
+			uint64_t index = 0;
+			read(index);
+			value.index = static_cast<size_t>(index);
+			read(value.entry_point_binding);
+		}
+		void read(reshadefx::storage_binding &value)
+		{
+			uint64_t index = 0;
+			read(index);
+			value.index = static_cast<size_t>(index);
+			read(value.entry_point_binding);
+		}
+		void read(reshadefx::pass &value)
+		{
+			read(value.name);
+			for (std::string &render_target_name : value.render_target_names)
+				read(render_target_name);
+			read(value.vs_entry_point);
+			read(value.ps_entry_point);
+			read(value.cs_entry_point);
+			read(value.generate_mipmaps);
+			read(value.clear_render_targets);
+			read(value.blend_enable);
+			read(value.source_color_blend_factor);
+			read(value.dest_color_blend_factor);
+			read(value.color_blend_op);
+			read(value.source_alpha_blend_factor);
+			read(value.dest_alpha_blend_factor);
+			read(value.alpha_blend_op);
+			read(value.srgb_write_enable);
+			read(value.render_target_write_mask);
+			read(value.stencil_enable);
+			read(value.stencil_read_mask);
+			read(value.stencil_write_mask);
+			read(value.stencil_reference_value);
+			read(value.stencil_comparison_func);
+			read(value.stencil_pass_op);
+			read(value.stencil_fail_op);
+			read(value.stencil_depth_fail_op);
+			read(value.topology);
+			read(value.num_vertices);
+			read(value.viewport_width);
+			read(value.viewport_height);
+			read(value.viewport_dispatch_z);
+			read(value.texture_bindings);
+			read(value.sampler_bindings);
+			read(value.storage_bindings);
+		}
+		void read(reshadefx::technique &value)
+		{
+			read(value.name);
+			read(value.passes);
+			read(value.annotations);
+		}
+		void read(std::pair<std::string, reshadefx::shader_type> &value)
+		{
+			read(value.first);
+			read(value.second);
+		}
+	};
+}
+
+void reshadefx::serialize_module(const effect_module &module, std::string &data)
+{
+	data.clear();
+
+	module_writer writer { data };
+	writer.write(s_module_magic);
+	writer.write(s_module_format_version);
+
+	writer.write(module.textures);
+	writer.write(module.samplers);
+	writer.write(module.storages);
+	writer.write(module.uniforms);
+	writer.write(module.spec_constants);
+	writer.write(module.total_uniform_size);
+	writer.write(module.techniques);
+	writer.write(module.entry_points);
+}
+
+bool reshadefx::deserialize_module(const std::string_view data, effect_module &module)
+{
+	module_reader reader { data.data(), data.data() + data.size() };
+
+	uint32_t magic = 0, format_version = 0;
+	reader.read(magic);
+	reader.read(format_version);
+	if (reader.failed || magic != s_module_magic || format_version != s_module_format_version)
+		return false;
+
+	effect_module result;
+	reader.read(result.textures);
+	reader.read(result.samplers);
+	reader.read(result.storages);
+	reader.read(result.uniforms);
+	reader.read(result.spec_constants);
+	reader.read(result.total_uniform_size);
+	reader.read(result.techniques);
+	reader.read(result.entry_points);
+
+	// Reject truncated data and trailing garbage alike
+	if (reader.failed || reader.cur != reader.end)
+		return false;
+
+	module = std::move(result);
+	return true;
+}
@@ -418,4 +418,14 @@ namespace reshadefx
 		std::vector<technique> techniques;
 		std::vector<std::pair<std::string, shader_type>> entry_points;
 	};
+
+	/// <summary>
+	/// Writes a binary representation of the specified effect <paramref name="module"/> to <paramref name="data"/>, so that it can be stored and loaded again later without having to parse the effect code.
+	/// </summary>
+	void serialize_module(const effect_module &module, std::string &data);
+	/// <summary>
+	/// Reads an effect module from the binary representation written by <see cref="serialize_module"/>.
+	/// </summary>
+	/// <returns><see langword="true"/> if the data was valid and written with the same format version, <see langword="false"/> otherwise (in which case <paramref name="module"/> is left unchanged).</returns>
+	bool deserialize_module(const std::string_view data, effect_module &module);
 }
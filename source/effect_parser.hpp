@@ -6,6 +6,7 @@
 #pragma once
 
 #include "effect_symbol_table.hpp"
+#include <unordered_set>
 
 namespace reshadefx
 {
@@ -73,6 +74,18 @@ namespace reshadefx
 		bool parse_statement(bool scoped);
 		bool parse_statement_block(bool scoped);
 
+		bool is_value_numbering_enabled();
+		bool is_mutable_value(uint32_t value) const { return _mutable_values.find(value) != _mutable_values.end(); }
+		void invalidate_loaded_values();
+		uint32_t emit_load(const expression &exp, bool force_new_id = false);
+		void     emit_store(const expression &exp, uint32_t value);
+		uint32_t emit_unary_op(const location &loc, tokenid op, const type &type, uint32_t val);
+		uint32_t emit_binary_op(const location &loc, tokenid op, const type &res_type, const type &type, uint32_t lhs, uint32_t rhs);
+		uint32_t emit_binary_op(const location &loc, tokenid op, const type &type, uint32_t lhs, uint32_t rhs) { return emit_binary_op(loc, op, type, type, lhs, rhs); }
+		uint32_t emit_ternary_op(const location &loc, tokenid op, const type &type, uint32_t condition, uint32_t true_value, uint32_t false_value);
+		uint32_t emit_call(const location &loc, const symbol &function, const std::vector<expression> &args);
+		uint32_t emit_construct(const location &loc, const type &type, const std::vector<expression> &args);
+
 		std::string _errors;
 
 		class lexer *_lexer = nullptr;
@@ -84,5 +97,14 @@ namespace reshadefx
 
 		std::vector<uint32_t> _loop_break_target_stack;
 		std::vector<uint32_t> _loop_continue_target_stack;
+
+		// State for local value numbering (see 'effect_parser_opt.cpp'), which is only valid for the basic block stored in '_value_block'
+		uint32_t _value_block = 0;
+		std::unordered_map<std::string, uint32_t> _values;
+		std::unordered_map<std::string, uint32_t> _loaded_values;
+		std::unordered_map<uint32_t, uint32_t> _stored_values;
+		std::unordered_map<uint32_t, std::pair<type, constant>> _constant_values;
+		std::unordered_set<uint32_t> _mutable_values;
+		std::unordered_set<uint32_t> _uniform_ids;
 	};
 }
@@ -21,7 +21,7 @@ reshadefx::parser::~parser()
 
 void reshadefx::parser::error(const location &location, unsigned int code, const std::string &message)
 {
-	_errors += location.source;
+	_errors += location.source_name();
 	_errors += '(' + std::to_string(location.line) + ", " + std::to_string(location.column) + ')';
 	_errors += ": error";
 	if (code != 0)
@@ -32,7 +32,7 @@ void reshadefx::parser::error(const location &location, unsigned int code, const
 }
 void reshadefx::parser::warning(const location &location, unsigned int code, const std::string &message)
 {
-	_errors += location.source;
+	_errors += location.source_name();
 	_errors += '(' + std::to_string(location.line) + ", " + std::to_string(location.column) + ')';
 	_errors += ": warning";
 	if (code != 0)
@@ -679,11 +679,11 @@ bool reshadefx::parser::parse_expression_unary(expression &exp)
 			// Create a constant one in the type of the expression
 			const codegen::id constant_one = _codegen->emit_constant(exp.type, 1);
 
-			const codegen::id value = _codegen->emit_load(exp);
-			const codegen::id result = _codegen->emit_binary_op(location, op, exp.type, value, constant_one);
+			const codegen::id value = emit_load(exp);
+			const codegen::id result = emit_binary_op(location, op, exp.type, value, constant_one);
 
 			// The "++" and "--" operands modify the source variable, so store result back into it
-			_codegen->emit_store(exp, result);
+			emit_store(exp, result);
 		}
 		else if (op != tokenid::plus) // Ignore "+" operator since it does not actually do anything
 		{
@@ -701,8 +701,8 @@ bool reshadefx::parser::parse_expression_unary(expression &exp)
 			// Constant expressions can be evaluated at compile time
 			if (!exp.evaluate_constant_expression(op))
 			{
-				const codegen::id value = _codegen->emit_load(exp);
-				const codegen::id result = _codegen->emit_unary_op(location, op, exp.type, value);
+				const codegen::id value = emit_load(exp);
+				const codegen::id result = emit_unary_op(location, op, exp.type, value);
 
 				exp.reset_to_rvalue(location, result, exp.type);
 			}
@@ -820,13 +820,13 @@ bool reshadefx::parser::parse_expression_unary(expression &exp)
 			for (expression &element_exp : elements)
 			{
 				element_exp.add_cast_operation(composite_type);
-				const codegen::id element_value = _codegen->emit_load(element_exp);
+				const codegen::id element_value = emit_load(element_exp);
 				element_exp.reset_to_rvalue(element_exp.location, element_value, composite_type);
 			}
 
 			composite_type.array_length = static_cast<unsigned int>(elements.size());
 
-			const codegen::id result = _codegen->emit_construct(location, composite_type, elements);
+			const codegen::id result = emit_construct(location, composite_type, elements);
 			exp.reset_to_rvalue(location, result, composite_type);
 		}
 
@@ -959,7 +959,7 @@ bool reshadefx::parser::parse_expression_unary(expression &exp)
 					scalar_type.base = type.base;
 					argument_exp.add_cast_operation(scalar_type);
 
-					argument_exp.reset_to_rvalue(argument_exp.location, _codegen->emit_load(argument_exp), scalar_type);
+					argument_exp.reset_to_rvalue(argument_exp.location, emit_load(argument_exp), scalar_type);
 				}
 				else
 				{
@@ -977,7 +977,7 @@ bool reshadefx::parser::parse_expression_unary(expression &exp)
 				}
 			}
 
-			const codegen::id result = _codegen->emit_construct(location, type, arguments);
+			const codegen::id result = emit_construct(location, type, arguments);
 
 			exp.reset_to_rvalue(location, result, type);
 		}
@@ -1101,7 +1101,7 @@ bool reshadefx::parser::parse_expression_unary(expression &exp)
 				{
 					expression argument_exp = arguments[i];
 					argument_exp.add_cast_operation(param_type);
-					const codegen::id argument_value = _codegen->emit_load(argument_exp);
+					const codegen::id argument_value = emit_load(argument_exp);
 					parameters[i].reset_to_rvalue(argument_exp.location, argument_value, param_type);
 
 					// Keep track of whether the parameter is a constant for code generation (this makes the expression invalid for all other uses)
@@ -1117,8 +1117,8 @@ bool reshadefx::parser::parse_expression_unary(expression &exp)
 				{
 					expression argument_exp = arguments[i];
 					argument_exp.add_cast_operation(parameters[i].type);
-					const codegen::id argument_value = _codegen->emit_load(argument_exp);
-					_codegen->emit_store(parameters[i], argument_value);
+					const codegen::id argument_value = emit_load(argument_exp);
+					emit_store(parameters[i], argument_value);
 				}
 			}
 
@@ -1134,16 +1134,14 @@ bool reshadefx::parser::parse_expression_unary(expression &exp)
 				parameters[i].reset_to_lvalue(param.location, temp_variable, param.type);
 
 				const codegen::id argument_value = _codegen->emit_constant(param.type, param.default_value);
-				_codegen->emit_store(parameters[i], argument_value);
+				emit_store(parameters[i], argument_value);
 			}
 
 			if (precise)
 				symbol.type.qualifiers |= type::q_precise;
 
 			// Check if the call resolving found an intrinsic or function and invoke the corresponding code
-			const codegen::id result = (symbol.op == symbol_type::function) ?
-				_codegen->emit_call(location, symbol.id, symbol.type, parameters) :
-				_codegen->emit_call_intrinsic(location, symbol.id, symbol.type, parameters);
+			const codegen::id result = emit_call(location, symbol, parameters);
 
 			exp.reset_to_rvalue(location, result, symbol.type);
 
@@ -1155,8 +1153,8 @@ bool reshadefx::parser::parse_expression_unary(expression &exp)
 				{
 					expression argument_exp = parameters[i];
 					argument_exp.add_cast_operation(arguments[i].type);
-					const codegen::id argument_value = _codegen->emit_load(argument_exp);
-					_codegen->emit_store(arguments[i], argument_value);
+					const codegen::id argument_value = emit_load(argument_exp);
+					emit_store(arguments[i], argument_value);
 				}
 			}
 
@@ -1256,11 +1254,11 @@ bool reshadefx::parser::parse_expression_unary(expression &exp)
 			// Create a constant one in the type of the expression
 			const codegen::id constant_one = _codegen->emit_constant(exp.type, 1);
 
-			const codegen::id value = _codegen->emit_load(exp, true);
-			const codegen::id result = _codegen->emit_binary_op(location, _token.id, exp.type, value, constant_one);
+			const codegen::id value = emit_load(exp, true);
+			const codegen::id result = emit_binary_op(location, _token.id, exp.type, value, constant_one);
 
 			// The "++" and "--" operands modify the source variable, so store result back into it
-			_codegen->emit_store(exp, result);
+			emit_store(exp, result);
 
 			// All postfix operators return a r-value rather than a l-value to the variable
 			exp.reset_to_rvalue(location, value, exp.type);
@@ -1468,7 +1466,7 @@ bool reshadefx::parser::parse_expression_unary(expression &exp)
 					exp.reset_to_lvalue(exp.location, temp_variable, exp.type);
 				}
 
-				exp.add_dynamic_index_access(_codegen->emit_load(index_exp));
+				exp.add_dynamic_index_access(emit_load(index_exp));
 			}
 		}
 		else
@@ -1609,7 +1607,7 @@ bool reshadefx::parser::parse_expression_multary(expression &lhs_exp, unsigned i
 			if (rhs_exp.is_constant && lhs_exp.evaluate_constant_expression(op, rhs_exp.constant))
 				continue;
 
-			const codegen::id lhs_value = _codegen->emit_load(lhs_exp);
+			const codegen::id lhs_value = emit_load(lhs_exp);
 
 #if RESHADEFX_SHORT_CIRCUIT
 			// Short circuit for logical && and || operators
@@ -1619,13 +1617,13 @@ bool reshadefx::parser::parse_expression_multary(expression &lhs_exp, unsigned i
 				codegen::id condition_value = lhs_value;
 				// Emit "if (!lhs) result = rhs" for || expression
 				if (op == tokenid::pipe_pipe)
-					condition_value = _codegen->emit_unary_op(lhs_exp.location, tokenid::exclaim, type, lhs_value);
+					condition_value = emit_unary_op(lhs_exp.location, tokenid::exclaim, type, lhs_value);
 
 				_codegen->leave_block_and_branch_conditional(condition_value, rhs_block, merge_block);
 
 				_codegen->set_block(rhs_block);
 				// Only load value of right hand side expression after entering the second block
-				const codegen::id rhs_value = _codegen->emit_load(rhs_exp);
+				const codegen::id rhs_value = emit_load(rhs_exp);
 				_codegen->leave_block_and_branch(merge_block);
 
 				_codegen->enter_block(merge_block);
@@ -1636,13 +1634,13 @@ bool reshadefx::parser::parse_expression_multary(expression &lhs_exp, unsigned i
 				continue;
 			}
 #endif
-			const codegen::id rhs_value = _codegen->emit_load(rhs_exp);
+			const codegen::id rhs_value = emit_load(rhs_exp);
 
 			// Certain operations return a boolean type instead of the type of the input expressions
 			if (is_bool_result)
 				type = { type::t_bool, type.rows, type.cols };
 
-			const codegen::id result_value = _codegen->emit_binary_op(lhs_exp.location, op, type, lhs_exp.type, lhs_value, rhs_value);
+			const codegen::id result_value = emit_binary_op(lhs_exp.location, op, type, lhs_exp.type, lhs_value, rhs_value);
 
 			lhs_exp.reset_to_rvalue(lhs_exp.location, result_value, type);
 		}
@@ -1725,29 +1723,29 @@ bool reshadefx::parser::parse_expression_multary(expression &lhs_exp, unsigned i
 			false_exp.add_cast_operation(type);
 
 			// Load condition value from expression
-			const codegen::id condition_value = _codegen->emit_load(lhs_exp);
+			const codegen::id condition_value = emit_load(lhs_exp);
 
 #if RESHADEFX_SHORT_CIRCUIT
 			_codegen->leave_block_and_branch_conditional(condition_value, true_block, false_block);
 
 			_codegen->set_block(true_block);
 			// Only load true expression value after entering the first block
-			const codegen::id true_value = _codegen->emit_load(true_exp);
+			const codegen::id true_value = emit_load(true_exp);
 			true_block = _codegen->leave_block_and_branch(merge_block);
 
 			_codegen->set_block(false_block);
 			// Only load false expression value after entering the second block
-			const codegen::id false_value = _codegen->emit_load(false_exp);
+			const codegen::id false_value = emit_load(false_exp);
 			false_block = _codegen->leave_block_and_branch(merge_block);
 
 			_codegen->enter_block(merge_block);
 
 			const codegen::id result_value = _codegen->emit_phi(lhs_exp.location, condition_value, condition_block, true_value, true_block, false_value, false_block, type);
 #else
-			const codegen::id true_value = _codegen->emit_load(true_exp);
-			const codegen::id false_value = _codegen->emit_load(false_exp);
+			const codegen::id true_value = emit_load(true_exp);
+			const codegen::id false_value = emit_load(false_exp);
 
-			const codegen::id result_value = _codegen->emit_ternary_op(lhs_exp.location, op, type, condition_value, true_value, false_value);
+			const codegen::id result_value = emit_ternary_op(lhs_exp.location, op, type, condition_value, true_value, false_value);
 #endif
 			lhs_exp.reset_to_rvalue(lhs_exp.location, result_value, type);
 		}
@@ -1803,20 +1801,20 @@ bool reshadefx::parser::parse_expression_assignment(expression &lhs_exp)
 
 		rhs_exp.add_cast_operation(lhs_exp.type);
 
-		codegen::id result_value = _codegen->emit_load(rhs_exp);
+		codegen::id result_value = emit_load(rhs_exp);
 
 		// Check if this is an assignment with an additional arithmetic instruction
 		if (op != tokenid::equal)
 		{
 			// Load value for modification
-			const codegen::id lhs_value = _codegen->emit_load(lhs_exp);
+			const codegen::id lhs_value = emit_load(lhs_exp);
 
 			// Handle arithmetic assignment operation
-			result_value = _codegen->emit_binary_op(lhs_exp.location, op, lhs_exp.type, lhs_value, result_value);
+			result_value = emit_binary_op(lhs_exp.location, op, lhs_exp.type, lhs_value, result_value);
 		}
 
 		// Write result back to variable
-		_codegen->emit_store(lhs_exp, result_value);
+		emit_store(lhs_exp, result_value);
 
 		// Return the result value since you can write assignments within expressions
 		lhs_exp.reset_to_rvalue(lhs_exp.location, result_value, lhs_exp.type);
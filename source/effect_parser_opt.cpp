@@ -0,0 +1,361 @@
+/*
+ * Copyright (C) 2026 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "effect_parser.hpp"
+#include "effect_codegen.hpp"
+#include <cstring> // std::memcpy
+#include <algorithm> // std::min, std::max
+
+// The parser reuses values within a basic block instead of emitting the same operation again when the optimization level is one or higher ("local value numbering").
+// Values are looked up by a key made up of the operation and the SSA IDs of its operands, so the same operation on the same IDs produces the same value.
+//
+// The text back-ends do not copy loaded values into temporaries, but instead refer to the variable inline wherever the loaded value is used (and may even return the ID of the variable itself).
+// Such "mutable" values change meaning when the variable is written to, so anything computed from them is only reused until the next operation that may write memory.
+// Results of all other operations are assigned to temporaries (or are real SSA values in case of SPIR-V), so they can be reused until the end of the basic block.
+
+static void append_key(std::string &key, uint32_t value)
+{
+	key.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+static void append_key(std::string &key, const reshadefx::type &type)
+{
+	// Storage and parameter qualifiers of the operands do not change the result of an operation, so ignore them to find more matches (e.g. 'x * k' and 'k * x' with a uniform 'k')
+	const uint32_t qualifiers = type.qualifiers & ~(reshadefx::type::q_extern | reshadefx::type::q_static | reshadefx::type::q_uniform | reshadefx::type::q_const | reshadefx::type::q_inout);
+
+	append_key(key, static_cast<uint32_t>(type.base) | (type.rows << 8) | (type.cols << 12) | (qualifiers << 16));
+	append_key(key, type.array_length);
+	append_key(key, type.struct_definition);
+}
+static void append_key(std::string &key, const reshadefx::expression &exp)
+{
+	append_key(key, exp.base);
+	append_key(key, exp.type);
+	append_key(key, (exp.is_lvalue ? 1u : 0u) | (exp.is_constant ? 2u : 0u));
+
+	for (const reshadefx::expression::operation &op : exp.chain)
+	{
+		uint32_t swizzle;
+		std::memcpy(&swizzle, op.swizzle, sizeof(swizzle));
+
+		append_key(key, static_cast<uint32_t>(op.op));
+		append_key(key, op.from);
+		append_key(key, op.to);
+		append_key(key, op.index);
+		append_key(key, swizzle);
+	}
+}
+
+static bool is_commutative(reshadefx::tokenid op)
+{
+	switch (op)
+	{
+	case reshadefx::tokenid::plus:
+	case reshadefx::tokenid::star: // Multiplication with the '*' operator is component-wise, even for matrices
+	case reshadefx::tokenid::ampersand:
+	case reshadefx::tokenid::pipe:
+	case reshadefx::tokenid::caret:
+	case reshadefx::tokenid::equal_equal:
+	case reshadefx::tokenid::exclaim_equal:
+		return true;
+	default:
+		return false;
+	}
+}
+static bool is_foldable(reshadefx::tokenid op)
+{
+	// Only fold operators that 'expression::evaluate_constant_expression' actually evaluates (it ignores all others)
+	switch (op)
+	{
+	case reshadefx::tokenid::plus:
+	case reshadefx::tokenid::minus:
+	case reshadefx::tokenid::star:
+	case reshadefx::tokenid::slash:
+	case reshadefx::tokenid::percent:
+	case reshadefx::tokenid::ampersand:
+	case reshadefx::tokenid::pipe:
+	case reshadefx::tokenid::caret:
+	case reshadefx::tokenid::less:
+	case reshadefx::tokenid::less_equal:
+	case reshadefx::tokenid::greater:
+	case reshadefx::tokenid::greater_equal:
+	case reshadefx::tokenid::equal_equal:
+	case reshadefx::tokenid::exclaim_equal:
+	case reshadefx::tokenid::less_less:
+	case reshadefx::tokenid::greater_greater:
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool reshadefx::parser::is_value_numbering_enabled()
+{
+	if (_codegen->_optimization_level < 1 || !_codegen->is_in_block())
+		return false;
+
+	// Values are only reused within the basic block they were defined in, since that is the only place where they are guaranteed to be available
+	if (_codegen->_current_block != _value_block)
+	{
+		_value_block = _codegen->_current_block;
+		_values.clear();
+		invalidate_loaded_values();
+	}
+
+	return true;
+}
+
+void reshadefx::parser::invalidate_loaded_values()
+{
+	_loaded_values.clear();
+	_stored_values.clear();
+}
+
+uint32_t reshadefx::parser::emit_load(const expression &exp, bool force_new_id)
+{
+	if (force_new_id || !is_value_numbering_enabled())
+		return _codegen->emit_load(exp, force_new_id);
+
+	if (exp.is_constant)
+	{
+		if (exp.type.is_array() || !exp.type.is_numeric() || !exp.chain.empty())
+			return _codegen->emit_load(exp);
+
+		// The text back-ends create a new ID for every constant, so look them up by value to make operations on equal constants match as well
+		std::string key(1, 'K');
+		append_key(key, exp.type);
+		for (unsigned int i = 0; i < exp.type.components(); ++i)
+			append_key(key, exp.constant.as_uint[i]);
+
+		if (const auto it = _values.find(key);
+			it != _values.end())
+			return it->second;
+
+		const codegen::id result = _codegen->emit_load(exp);
+		_values.emplace(std::move(key), result);
+
+		// Keep track of constant values, so that operations on them can be folded even if they were not part of the same expression
+		_constant_values.insert_or_assign(result, std::make_pair(exp.type, exp.constant));
+
+		return result;
+	}
+
+	if (exp.chain.empty())
+	{
+		if (!exp.is_lvalue)
+			return _codegen->emit_load(exp);
+
+		// Copy propagation: A variable that was stored to earlier in this basic block still holds the stored value
+		if (const auto it = _stored_values.find(exp.base);
+			it != _stored_values.end())
+			return it->second;
+	}
+
+	// Uniform variables are read-only, so loads from them are only mutable if indexed by a mutable value
+	bool is_mutable = exp.is_lvalue ? _uniform_ids.find(exp.base) == _uniform_ids.end() : is_mutable_value(exp.base);
+	for (const expression::operation &op : exp.chain)
+		if (op.op == expression::operation::op_dynamic_index && is_mutable_value(op.index))
+			is_mutable = true;
+
+	std::string key(1, 'L');
+	append_key(key, exp);
+
+	std::unordered_map<std::string, uint32_t> &values = is_mutable ? _loaded_values : _values;
+
+	if (const auto it = values.find(key);
+		it != values.end())
+		return it->second;
+
+	const codegen::id result = _codegen->emit_load(exp);
+	values.emplace(std::move(key), result);
+
+	if (is_mutable)
+		_mutable_values.insert(result);
+
+	return result;
+}
+
+void reshadefx::parser::emit_store(const expression &exp, uint32_t value)
+{
+	const bool enabled = is_value_numbering_enabled();
+
+	_codegen->emit_store(exp, value);
+
+	if (!enabled)
+		return;
+
+	// The store may have changed any variable loaded before through an aliasing access chain, so forget all of them
+	invalidate_loaded_values();
+
+	// Other invocations may write to shared memory at any time, so cannot assume it still holds the stored value
+	if (exp.chain.empty() && !exp.type.has(type::q_groupshared))
+		_stored_values.emplace(exp.base, value);
+}
+
+uint32_t reshadefx::parser::emit_unary_op(const location &loc, tokenid op, const type &type, uint32_t val)
+{
+	if (!is_value_numbering_enabled())
+		return _codegen->emit_unary_op(loc, op, type, val);
+
+	// Constant propagation: Fold operations on values that are known to be constant
+	if (const auto it = _constant_values.find(val);
+		it != _constant_values.end() && it->second.first == type &&
+		(type.is_boolean() ? op == tokenid::exclaim : type.is_numeric() && (op == tokenid::minus || (op == tokenid::tilde && type.is_integral()))))
+	{
+		expression exp;
+		exp.reset_to_rvalue_constant(loc, it->second.second, type);
+		if (exp.evaluate_constant_expression(op))
+			return emit_load(exp);
+	}
+
+	std::string key(1, 'U');
+	append_key(key, static_cast<uint32_t>(op));
+	append_key(key, type);
+	append_key(key, val);
+
+	std::unordered_map<std::string, uint32_t> &values = is_mutable_value(val) ? _loaded_values : _values;
+
+	if (const auto it = values.find(key);
+		it != values.end())
+		return it->second;
+
+	const codegen::id result = _codegen->emit_unary_op(loc, op, type, val);
+	values.emplace(std::move(key), result);
+	return result;
+}
+
+uint32_t reshadefx::parser::emit_binary_op(const location &loc, tokenid op, const type &res_type, const type &type, uint32_t lhs, uint32_t rhs)
+{
+	if (!is_value_numbering_enabled())
+		return _codegen->emit_binary_op(loc, op, res_type, type, lhs, rhs);
+
+	if (is_foldable(op) && !type.is_array())
+	{
+		if (const auto lhs_it = _constant_values.find(lhs), rhs_it = _constant_values.find(rhs);
+			lhs_it != _constant_values.end() && lhs_it->second.first == type &&
+			rhs_it != _constant_values.end() && rhs_it->second.first == type)
+		{
+			expression exp;
+			exp.reset_to_rvalue_constant(loc, lhs_it->second.second, type);
+			if (exp.evaluate_constant_expression(op, rhs_it->second.second) && exp.type == res_type)
+				return emit_load(exp);
+		}
+	}
+
+	std::string key(1, 'B');
+	append_key(key, static_cast<uint32_t>(op));
+	append_key(key, res_type);
+	append_key(key, type);
+	// Sort the operands of commutative operations, so that 'a + b' and 'b + a' map to the same value
+	append_key(key, is_commutative(op) ? std::min(lhs, rhs) : lhs);
+	append_key(key, is_commutative(op) ? std::max(lhs, rhs) : rhs);
+
+	std::unordered_map<std::string, uint32_t> &values = is_mutable_value(lhs) || is_mutable_value(rhs) ? _loaded_values : _values;
+
+	if (const auto it = values.find(key);
+		it != values.end())
+		return it->second;
+
+	const codegen::id result = _codegen->emit_binary_op(loc, op, res_type, type, lhs, rhs);
+	values.emplace(std::move(key), result);
+	return result;
+}
+
+uint32_t reshadefx::parser::emit_ternary_op(const location &loc, tokenid op, const type &type, uint32_t condition, uint32_t true_value, uint32_t false_value)
+{
+	if (!is_value_numbering_enabled())
+		return _codegen->emit_ternary_op(loc, op, type, condition, true_value, false_value);
+
+	std::string key(1, 'T');
+	append_key(key, static_cast<uint32_t>(op));
+	append_key(key, type);
+	append_key(key, condition);
+	append_key(key, true_value);
+	append_key(key, false_value);
+
+	std::unordered_map<std::string, uint32_t> &values = is_mutable_value(condition) || is_mutable_value(true_value) || is_mutable_value(false_value) ? _loaded_values : _values;
+
+	if (const auto it = values.find(key);
+		it != values.end())
+		return it->second;
+
+	const codegen::id result = _codegen->emit_ternary_op(loc, op, type, condition, true_value, false_value);
+	values.emplace(std::move(key), result);
+	return result;
+}
+
+uint32_t reshadefx::parser::emit_call(const location &loc, const symbol &function, const std::vector<expression> &args)
+{
+	const bool enabled = is_value_numbering_enabled();
+
+	// User-defined functions may write to global variables or resources, so are never reused
+	bool has_side_effects = function.op == symbol_type::function || function.type.is_void() || function.function->name.compare(0, 6, "atomic") == 0;
+	bool is_mutable = false;
+
+	for (const member_type &param : function.function->parameter_list)
+	{
+		if (param.type.has(type::q_out) || param.type.has(type::q_groupshared))
+			has_side_effects = true;
+		// Resources may be written to by other intrinsics, so treat reads from them like loads from variables
+		if (param.type.is_object())
+			is_mutable = true;
+	}
+
+	if (!enabled || has_side_effects)
+	{
+		const codegen::id result = function.op == symbol_type::function ?
+			_codegen->emit_call(loc, function.id, function.type, args) :
+			_codegen->emit_call_intrinsic(loc, function.id, function.type, args);
+
+		if (enabled)
+			invalidate_loaded_values();
+
+		return result;
+	}
+
+	std::string key(1, 'I');
+	append_key(key, function.id);
+	append_key(key, function.type);
+	for (const expression &arg : args)
+	{
+		append_key(key, arg);
+		is_mutable |= is_mutable_value(arg.base);
+	}
+
+	std::unordered_map<std::string, uint32_t> &values = is_mutable ? _loaded_values : _values;
+
+	if (const auto it = values.find(key);
+		it != values.end())
+		return it->second;
+
+	const codegen::id result = _codegen->emit_call_intrinsic(loc, function.id, function.type, args);
+	values.emplace(std::move(key), result);
+	return result;
+}
+
+uint32_t reshadefx::parser::emit_construct(const location &loc, const type &type, const std::vector<expression> &args)
+{
+	if (!is_value_numbering_enabled())
+		return _codegen->emit_construct(loc, type, args);
+
+	std::string key(1, 'C');
+	append_key(key, type);
+
+	bool is_mutable = false;
+	for (const expression &arg : args)
+	{
+		append_key(key, arg);
+		is_mutable |= is_mutable_value(arg.base);
+	}
+
+	std::unordered_map<std::string, uint32_t> &values = is_mutable ? _loaded_values : _values;
+
+	if (const auto it = values.find(key);
+		it != values.end())
+		return it->second;
+
+	const codegen::id result = _codegen->emit_construct(loc, type, args);
+	values.emplace(std::move(key), result);
+	return result;
+}
@@ -60,6 +60,14 @@ bool reshadefx::parser::parse(std::string source, codegen *backend)
 	_loop_break_target_stack.clear();
 	_loop_continue_target_stack.clear();
 
+	_value_block = 0;
+	_values.clear();
+	_loaded_values.clear();
+	_stored_values.clear();
+	_constant_values.clear();
+	_mutable_values.clear();
+	_uniform_ids.clear();
+
 	return parse_success;
 }
 
@@ -210,7 +218,7 @@ bool reshadefx::parser::parse_top(bool &parse_success)
 			}
 			else
 			{
-				if (!attribute_location.source.empty())
+				if (attribute_location.source != 0)
 				{
 					error(attribute_location, 0, "attribute is valid only on functions");
 					parse_success = false;
@@ -352,7 +360,7 @@ bool reshadefx::parser::parse_statement(bool scoped)
 			// Load condition and convert to boolean value as required by 'OpBranchConditional' in SPIR-V
 			condition_exp.add_cast_operation({ type::t_bool, 1, 1 });
 
-			const codegen::id condition_value = _codegen->emit_load(condition_exp);
+			const codegen::id condition_value = emit_load(condition_exp);
 			const codegen::id condition_block = _codegen->leave_block_and_branch_conditional(condition_value, true_block, false_block);
 
 			{ // Then block of the if statement
@@ -397,7 +405,7 @@ bool reshadefx::parser::parse_statement(bool scoped)
 			// Load selector and convert to integral value as required by switch instruction
 			selector_exp.add_cast_operation({ type::t_int, 1, 1 });
 
-			const codegen::id selector_value = _codegen->emit_load(selector_exp);
+			const codegen::id selector_value = emit_load(selector_exp);
 			const codegen::id selector_block = _codegen->leave_block_and_switch(selector_value, merge_block);
 
 			if (!expect('{'))
@@ -595,7 +603,7 @@ bool reshadefx::parser::parse_statement(bool scoped)
 					// Evaluate condition and branch to the right target
 					condition_exp.add_cast_operation({ type::t_bool, 1, 1 });
 
-					condition_value = _codegen->emit_load(condition_exp);
+					condition_value = emit_load(condition_exp);
 					condition_block = _codegen->leave_block_and_branch_conditional(condition_value, loop_block, merge_block);
 				}
 				else // It is valid for there to be no condition expression
@@ -688,7 +696,7 @@ bool reshadefx::parser::parse_statement(bool scoped)
 				// Evaluate condition and branch to the right target
 				condition_exp.add_cast_operation({ type::t_bool, 1, 1 });
 
-				condition_value = _codegen->emit_load(condition_exp);
+				condition_value = emit_load(condition_exp);
 				condition_block = _codegen->leave_block_and_branch_conditional(condition_value, loop_block, merge_block);
 			}
 
@@ -774,7 +782,7 @@ bool reshadefx::parser::parse_statement(bool scoped)
 				// Evaluate condition and branch to the right target
 				condition_exp.add_cast_operation({ type::t_bool, 1, 1 });
 
-				condition_value = _codegen->emit_load(condition_exp);
+				condition_value = emit_load(condition_exp);
 
 				_codegen->leave_block_and_branch_conditional(condition_value, header_label, merge_block);
 			}
@@ -852,7 +860,7 @@ bool reshadefx::parser::parse_statement(bool scoped)
 
 				return_exp.add_cast_operation(return_type);
 
-				const codegen::id return_value = _codegen->emit_load(return_exp);
+				const codegen::id return_value = emit_load(return_exp);
 
 				_codegen->leave_block_and_return(return_value);
 			}
@@ -2058,6 +2066,8 @@ bool reshadefx::parser::parse_variable(type type, std::string name, bool global)
 
 		const codegen::id id = _codegen->define_uniform(variable_location, uniform_info);
 		symbol = { symbol_type::variable, id, type };
+
+		_uniform_ids.insert(id);
 	}
 	// All other variables are separate entities
 	else
@@ -2066,10 +2076,15 @@ bool reshadefx::parser::parse_variable(type type, std::string name, bool global)
 		std::string unique_name = global ? 'V' + current_scope().name + name : name;
 		std::replace(unique_name.begin(), unique_name.end(), ':', '_');
 
+		// Shared variables cannot have an initializer
+		const codegen::id initializer_value = type.has(type::q_groupshared) ? 0 : emit_load(initializer);
+
 		symbol = { symbol_type::variable, 0, type };
-		symbol.id = _codegen->define_variable(variable_location, type, std::move(unique_name), global,
-			// Shared variables cannot have an initializer
-			type.has(type::q_groupshared) ? 0 : _codegen->emit_load(initializer));
+		symbol.id = _codegen->define_variable(variable_location, type, std::move(unique_name), global, initializer_value);
+
+		// Keep track of the initial value of local variables, same as for a store
+		if (!global && initializer_value != 0 && is_value_numbering_enabled())
+			_stored_values.emplace(symbol.id, initializer_value);
 	}
 
 	// Insert the symbol into the symbol table
@@ -8,7 +8,10 @@
 #include <limits>
 #include <cstdio> // fclose, fopen, fread, fseek
 #include <cassert>
-#include <algorithm> // std::find_if
+#include <atomic>
+#include <algorithm> // std::find_if, std::min_element
+#include <mutex>
+#include <shared_mutex>
 
 #ifndef _WIN32
 	// On Linux systems the native path encoding is UTF-8 already, so no conversion necessary
@@ -99,6 +102,90 @@ static bool read_file(const std::filesystem::path &path, std::string &file_data)
 	return true;
 }
 
+struct include_cache_entry
+{
+	std::filesystem::file_time_type last_write_time;
+	std::shared_ptr<const std::string> file_data;
+	// Value of the access counter when this entry was last used, updated while only holding the shared lock
+	std::atomic<uint64_t> last_access = 0;
+};
+
+// Cache of included files shared between all preprocessor instances, so that common headers only have to be read from disk once when compiling many effects
+// File contents are immutable and reference counted, so that a cache hit does not have to copy them
+static std::shared_mutex s_include_cache_mutex;
+static std::unordered_map<std::string, include_cache_entry> s_include_cache;
+static size_t s_include_cache_size = 0;
+static std::atomic<uint64_t> s_include_cache_access_counter = 0;
+// Limit the total size of cached file contents, so that the cache cannot grow indefinitely in long-running processes
+static constexpr size_t s_include_cache_max_size = 64 * 1024 * 1024;
+
+static bool read_file_cached(const std::filesystem::path &path, std::shared_ptr<const std::string> &file_data, bool &cache_hit)
+{
+	std::error_code ec;
+	const std::filesystem::file_time_type last_write_time = std::filesystem::last_write_time(path, ec);
+	if (ec)
+		return false;
+	std::filesystem::path canonical_path = std::filesystem::weakly_canonical(path, ec);
+	if (ec)
+		canonical_path = path;
+	const std::string canonical_path_string = canonical_path.u8string();
+
+	{
+		const std::shared_lock<std::shared_mutex> lock(s_include_cache_mutex);
+
+		if (const auto cache_it = s_include_cache.find(canonical_path_string);
+			cache_it != s_include_cache.end() && cache_it->second.last_write_time == last_write_time)
+		{
+			cache_it->second.last_access.store(++s_include_cache_access_counter, std::memory_order_relaxed);
+
+			file_data = cache_it->second.file_data;
+			cache_hit = true;
+			return true;
+		}
+	}
+
+	cache_hit = false;
+
+	std::string data;
+	if (!read_file(path, data))
+		return false;
+
+	file_data = std::make_shared<const std::string>(std::move(data));
+
+	const std::unique_lock<std::shared_mutex> lock(s_include_cache_mutex);
+
+	if (const auto cache_it = s_include_cache.find(canonical_path_string);
+		cache_it != s_include_cache.end())
+	{
+		s_include_cache_size -= cache_it->second.file_data->size();
+		s_include_cache.erase(cache_it);
+	}
+
+	// Evict the least recently used entries until the new one fits, so that commonly included headers stay in the cache (entries that are still referenced by a preprocessor stay alive until it is done with them)
+	while (!s_include_cache.empty() && s_include_cache_size + file_data->size() > s_include_cache_max_size)
+	{
+		const auto oldest_it = std::min_element(s_include_cache.begin(), s_include_cache.end(),
+			[](const std::pair<const std::string, include_cache_entry> &lhs, const std::pair<const std::string, include_cache_entry> &rhs) {
+				return lhs.second.last_access.load(std::memory_order_relaxed) < rhs.second.last_access.load(std::memory_order_relaxed);
+			});
+
+		s_include_cache_size -= oldest_it->second.file_data->size();
+		s_include_cache.erase(oldest_it);
+	}
+
+	if (file_data->size() <= s_include_cache_max_size)
+	{
+		include_cache_entry &entry = s_include_cache[canonical_path_string];
+		entry.last_write_time = last_write_time;
+		entry.file_data = file_data;
+		entry.last_access.store(++s_include_cache_access_counter, std::memory_order_relaxed);
+
+		s_include_cache_size += file_data->size();
+	}
+
+	return true;
+}
+
 template <char ESCAPE_CHAR = '\\'>
 static std::string escape_string(std::string s)
 {
@@ -107,6 +194,14 @@ static std::string escape_string(std::string s)
 	return '\"' + s + '\"';
 }
 
+void reshadefx::preprocessor::clear_include_cache()
+{
+	const std::unique_lock<std::shared_mutex> lock(s_include_cache_mutex);
+
+	s_include_cache.clear();
+	s_include_cache_size = 0;
+}
+
 reshadefx::preprocessor::preprocessor()
 {
 }
@@ -165,10 +260,18 @@ std::vector<std::filesystem::path> reshadefx::preprocessor::included_files() con
 {
 	std::vector<std::filesystem::path> files;
 	files.reserve(_file_cache.size());
-	for (const std::pair<std::string, std::string> &cache_entry : _file_cache)
+	for (const std::pair<const std::string, std::shared_ptr<const std::string>> &cache_entry : _file_cache)
 		files.push_back(std::filesystem::u8path(cache_entry.first));
 	return files;
 }
+std::vector<std::filesystem::path> reshadefx::preprocessor::missing_include_files() const
+{
+	std::vector<std::filesystem::path> files;
+	files.reserve(_missing_include_files.size());
+	for (const std::string &file : _missing_include_files)
+		files.push_back(std::filesystem::u8path(file));
+	return files;
+}
 std::vector<std::pair<std::string, std::string>> reshadefx::preprocessor::used_macro_definitions() const
 {
 	std::vector<std::pair<std::string, std::string>> definitions;
@@ -185,7 +288,7 @@ std::vector<std::pair<std::string, std::string>> reshadefx::preprocessor::used_m
 
 void reshadefx::preprocessor::error(const location &location, const std::string &message)
 {
-	_errors += location.source;
+	_errors += location.source_name();
 	_errors += '(' + std::to_string(location.line) + ", " + std::to_string(location.column) + ')';
 	_errors += ": preprocessor error: ";
 	_errors += message;
@@ -193,14 +296,15 @@ void reshadefx::preprocessor::error(const location &location, const std::string
 }
 void reshadefx::preprocessor::warning(const location &location, const std::string &message)
 {
-	_errors += location.source;
+	_errors += location.source_name();
 	_errors += '(' + std::to_string(location.line) + ", " + std::to_string(location.column) + ')';
 	_errors += ": preprocessor warning: ";
 	_errors += message;
 	_errors += '\n';
 }
 
-void reshadefx::preprocessor::push(std::string input, const std::string &name)
+template <typename T>
+void reshadefx::preprocessor::push(T &&input, const std::string &name)
 {
 	location start_location = !name.empty() ?
 		// Start at the beginning of the file when pushing a new file
@@ -208,9 +312,9 @@ void reshadefx::preprocessor::push(std::string input, const std::string &name)
 		// Start with last known token location when pushing an unnamed string
 		_token.location;
 
-	input_level level = { name };
+	input_level level = { name, start_location.source };
 	level.lexer.reset(new lexer(
-		std::move(input),
+		std::forward<T>(input),
 		true  /* ignore_comments */,
 		false /* ignore_whitespace */,
 		false /* ignore_pp_directives */,
@@ -221,10 +325,6 @@ void reshadefx::preprocessor::push(std::string input, const std::string &name)
 	level.next_token.id = tokenid::unknown;
 	level.next_token.location = start_location; // This is used in 'consume' to initialize the output location
 
-	// Inherit hidden macros from parent
-	if (!_input_stack.empty())
-		level.hidden_macros = _input_stack.back().hidden_macros;
-
 	_input_stack.push_back(std::move(level));
 	_next_input_index = _input_stack.size() - 1;
 
@@ -256,17 +356,17 @@ void reshadefx::preprocessor::consume()
 
 	// Update location information after switching input levels
 	input_level &input = _input_stack[_current_input_index];
-	if (!input.name.empty() && input.name != _output_location.source)
+	if (!input.name.empty() && input.source != _output_location.source)
 	{
 		_output += "#line " + std::to_string(input.next_token.location.line) + " \"" + input.name + "\"\n";
 		// Line number is increased before checking against next token in 'tokenid::end_of_line' handling in 'parse' function below, so compensate for that here
 		_output_location.line = input.next_token.location.line - 1;
-		_output_location.source = input.name;
+		_output_location.source = input.source;
 	}
 
 	// Set current token
 	_token = std::move(input.next_token);
-	_current_token_raw_data = input.lexer->input_string().substr(_token.offset, _token.length);
+	_current_token_raw_data = std::string_view(input.lexer->input_string()).substr(_token.offset, _token.length);
 
 	// Get the next token
 	input.next_token = input.lexer->lex();
@@ -286,6 +386,8 @@ void reshadefx::preprocessor::consume()
 		if (_next_input_index == 0)
 		{
 			// End of input has been reached, so cannot pop further and this is the last token
+			// Keep its lexer alive though, since the raw data of the current token still references its input string
+			_last_input_lexer = std::move(_input_stack.back().lexer);
 			_input_stack.pop_back();
 			return;
 		}
@@ -673,8 +775,6 @@ void reshadefx::preprocessor::parse_warning()
 
 void reshadefx::preprocessor::parse_pragma()
 {
-	const location keyword_location = std::move(_token.location);
-
 	if (!expect(tokenid::identifier))
 		return;
 
@@ -697,10 +797,10 @@ void reshadefx::preprocessor::parse_pragma()
 	if (pragma == "once")
 	{
 		// Clear file contents, so that future include statements simply push an empty string instead of these file contents again
-		if (const auto file_it = _file_cache.find(_output_location.source);
+		if (const auto file_it = _file_cache.find(_output_location.source_name());
 			file_it != _file_cache.end())
 		{
-			file_it->second.clear();
+			file_it->second.reset();
 		}
 		return;
 	}
@@ -730,15 +830,24 @@ void reshadefx::preprocessor::parse_include()
 	}
 
 	std::filesystem::path file_name = std::filesystem::u8path(_token.literal_as_string);
-	std::filesystem::path file_path = std::filesystem::u8path(_output_location.source);
+	std::filesystem::path file_path = std::filesystem::u8path(_output_location.source_name());
 	file_path.replace_filename(file_name);
 
+	// Keep track of all paths that were probed before the file was found, since creating a file at any of them later would change which file is included
 	std::error_code ec;
 	if (!std::filesystem::exists(file_path, ec))
+	{
+		_missing_include_files.insert(file_path.u8string());
+
 		for (const std::filesystem::path &include_path : _include_paths)
+		{
 			if (std::filesystem::exists(file_path = include_path / file_name, ec))
 				break;
 
+			_missing_include_files.insert(file_path.u8string());
+		}
+	}
+
 	const std::string file_path_string = file_path.u8string();
 
 	// Detect recursive include and abort to avoid infinite loop
@@ -748,7 +857,7 @@ void reshadefx::preprocessor::parse_include()
 			}) != _input_stack.end())
 		return error(_token.location, "recursive #include");
 
-	std::string input;
+	std::shared_ptr<const std::string> input;
 
 	if (const auto file_it = _file_cache.find(file_path_string);
 		file_it != _file_cache.end())
@@ -757,9 +866,15 @@ void reshadefx::preprocessor::parse_include()
 	}
 	else
 	{
-		if (!read_file(file_path, input))
+		bool cache_hit = false;
+		if (!read_file_cached(file_path, input, cache_hit))
 			return error(keyword_location, "could not open included file '" + file_name.u8string() + '\'');
 
+		if (cache_hit)
+			_include_cache_hits++;
+		else
+			_include_cache_misses++;
+
 		_file_cache.emplace(file_path_string, input);
 	}
 
@@ -771,7 +886,8 @@ void reshadefx::preprocessor::parse_include()
 	while (_input_stack.size() > (_next_input_index + 1))
 		_input_stack.pop_back();
 
-	push(std::move(input), file_path_string);
+	// The lexer shares the file contents with the include caches, so that they are not copied for every include
+	push(input != nullptr ? std::move(input) : std::make_shared<const std::string>(), file_path_string);
 }
 
 bool reshadefx::preprocessor::evaluate_expression()
@@ -927,7 +1043,7 @@ bool reshadefx::preprocessor::evaluate_expression()
 					return false;
 
 				std::filesystem::path file_name = std::filesystem::u8path(_token.literal_as_string);
-				std::filesystem::path file_path = std::filesystem::u8path(_output_location.source);
+				std::filesystem::path file_path = std::filesystem::u8path(_output_location.source_name());
 				file_path.replace_filename(file_name);
 
 				if (has_parentheses && !expect(tokenid::parenthesis_close))
@@ -1115,30 +1231,30 @@ bool reshadefx::preprocessor::evaluate_identifier_as_macro()
 	}
 	if (_token.literal_as_string == "__FILE__")
 	{
-		push(escape_string(_token.location.source));
+		push(escape_string(_token.location.source_name()));
 		return true;
 	}
 	if (_token.literal_as_string == "__FILE_STEM__")
 	{
-		const std::filesystem::path file_stem = std::filesystem::u8path(_token.location.source).stem();
+		const std::filesystem::path file_stem = std::filesystem::u8path(_token.location.source_name()).stem();
 		push(escape_string(file_stem.u8string()));
 		return true;
 	}
 	if (_token.literal_as_string == "__FILE_STEM_HASH__")
 	{
-		const std::filesystem::path file_stem = std::filesystem::u8path(_token.location.source).stem();
+		const std::filesystem::path file_stem = std::filesystem::u8path(_token.location.source_name()).stem();
 		push(std::to_string(std::hash<std::string>()(file_stem.u8string()) & 0xFFFFFFFF));
 		return true;
 	}
 	if (_token.literal_as_string == "__FILE_NAME__")
 	{
-		const std::filesystem::path file_name = std::filesystem::u8path(_token.location.source).filename();
+		const std::filesystem::path file_name = std::filesystem::u8path(_token.location.source_name()).filename();
 		push(escape_string(file_name.u8string()));
 		return true;
 	}
 	if (_token.literal_as_string == "__FILE_NAME_HASH__")
 	{
-		const std::filesystem::path file_name = std::filesystem::u8path(_token.location.source).filename();
+		const std::filesystem::path file_name = std::filesystem::u8path(_token.location.source_name()).filename();
 		push(std::to_string(std::hash<std::string>()(file_name.u8string()) & 0xFFFFFFFF));
 		return true;
 	}
@@ -1147,12 +1263,8 @@ bool reshadefx::preprocessor::evaluate_identifier_as_macro()
 	if (macro_it == _macros.end())
 		return false;
 
-	if (!_input_stack.empty())
-	{
-		const std::unordered_set<std::string> &hidden_macros = _input_stack[_current_input_index].hidden_macros;
-		if (hidden_macros.find(_token.literal_as_string) != hidden_macros.end())
-			return false;
-	}
+	if (is_hidden(_token.literal_as_string))
+		return false;
 
 	const location macro_location = _token.location;
 	if (_recursion_count++ >= 256)
@@ -1225,6 +1337,18 @@ bool reshadefx::preprocessor::is_defined(const std::string &name) const
 		name == "__FILE_NAME_HASH__";
 }
 
+bool reshadefx::preprocessor::is_hidden(const std::string &name) const
+{
+	if (_input_stack.empty())
+		return false;
+
+	// Each input level inherits the hidden macros of all the levels below it
+	for (size_t level_index = _current_input_index + 1; level_index-- > 0;)
+		if (_input_stack[level_index].hidden_macro == name)
+			return true;
+	return false;
+}
+
 void reshadefx::preprocessor::expand_macro(const std::string &name, const macro &definition, const std::vector<std::string> &arguments)
 {
 	if (definition.replacement_list.empty())
@@ -1295,7 +1419,7 @@ void reshadefx::preprocessor::expand_macro(const std::string &name, const macro
 	push(std::move(input));
 
 	// Avoid expanding macros again that are referencing themselves
-	_input_stack[_current_input_index].hidden_macros.insert(name);
+	_input_stack[_current_input_index].hidden_macro = name;
 }
 
 void reshadefx::preprocessor::create_macro_replacement_list(macro &definition)
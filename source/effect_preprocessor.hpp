@@ -6,8 +6,9 @@
 #pragma once
 
 #include "effect_token.hpp"
-#include <memory> // std::unique_ptr
+#include <memory> // std::shared_ptr, std::unique_ptr
 #include <filesystem>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -28,6 +29,11 @@ namespace reshadefx
 			bool is_function_like = false;
 		};
 
+		/// <summary>
+		/// Removes all files from the include cache shared between all preprocessor instances.
+		/// </summary>
+		static void clear_include_cache();
+
 		// Define constructor explicitly because lexer class is not included here
 		preprocessor();
 		~preprocessor();
@@ -83,12 +89,25 @@ namespace reshadefx
 		/// Gets a list of paths to all the included files.
 		/// </summary>
 		std::vector<std::filesystem::path> included_files() const;
+		/// <summary>
+		/// Gets a list of paths that were searched for included files, but did not exist.
+		/// </summary>
+		std::vector<std::filesystem::path> missing_include_files() const;
 
 		/// <summary>
 		/// Gets a list of all defines that were used in #ifdef and #ifndef lines.
 		/// </summary>
 		std::vector<std::pair<std::string, std::string>> used_macro_definitions() const;
 
+		/// <summary>
+		/// Gets the number of included files that were found in the include cache shared between all preprocessor instances.
+		/// </summary>
+		size_t include_cache_hits() const { return _include_cache_hits; }
+		/// <summary>
+		/// Gets the number of included files that were not found in the shared include cache and had to be read from disk.
+		/// </summary>
+		size_t include_cache_misses() const { return _include_cache_misses; }
+
 	private:
 		struct if_level
 		{
@@ -100,15 +119,19 @@ namespace reshadefx
 		struct input_level
 		{
 			std::string name;
+			uint32_t source = 0;
 			std::unique_ptr<class lexer> lexer;
 			token next_token;
-			std::unordered_set<std::string> hidden_macros;
+			// Macro that is hidden while expanding this level (macros hidden by parent levels are found by walking down the input stack)
+			std::string hidden_macro;
 		};
 
 		void error(const location &location, const std::string &message);
 		void warning(const location &location, const std::string &message);
 
-		void push(std::string input, const std::string &name = std::string());
+		// Input is either a 'std::string' or a 'std::shared_ptr<const std::string>' that is shared with the include caches
+		template <typename T>
+		void push(T &&input, const std::string &name = std::string());
 
 		bool peek(tokenid tokid) const;
 		void consume();
@@ -134,6 +157,7 @@ namespace reshadefx
 		bool evaluate_identifier_as_macro();
 
 		bool is_defined(const std::string &name) const;
+		bool is_hidden(const std::string &name) const;
 		void expand_macro(const std::string &name, const macro &definition, const std::vector<std::string> &arguments);
 		void create_macro_replacement_list(macro &definition);
 
@@ -143,7 +167,8 @@ namespace reshadefx
 		size_t _next_input_index = 0;
 		size_t _current_input_index = 0;
 		reshadefx::token _token;
-		std::string _current_token_raw_data;
+		std::string_view _current_token_raw_data;
+		std::unique_ptr<class lexer> _last_input_lexer;
 		reshadefx::location _output_location;
 
 		unsigned short _recursion_count = 0;
@@ -153,6 +178,9 @@ namespace reshadefx
 		std::vector<if_level> _if_stack;
 
 		std::vector<std::filesystem::path> _include_paths;
-		std::unordered_map<std::string, std::string> _file_cache;
+		std::unordered_map<std::string, std::shared_ptr<const std::string>> _file_cache;
+		std::unordered_set<std::string> _missing_include_files;
+		size_t _include_cache_hits = 0;
+		size_t _include_cache_misses = 0;
 	};
 }
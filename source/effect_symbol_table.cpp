@@ -8,6 +8,7 @@
 #include <malloc.h> // alloca
 #include <algorithm> // std::upper_bound, std::sort
 #include <functional> // std::greater
+#include <string_view>
 
 enum class intrinsic_id
 {
@@ -141,6 +142,23 @@ static const intrinsic s_intrinsics[] =
 #undef float3
 #undef float4
 
+// Lookup table from intrinsic name to all its overloads, bucketed by number of parameters
+// Overloads with the same name are defined next to each other, so this can be built with a single pass over the definitions
+using intrinsic_overload_list = std::vector<std::vector<const intrinsic *>>;
+static const std::unordered_map<std::string_view, intrinsic_overload_list> s_intrinsic_lookup = []() {
+	std::unordered_map<std::string_view, intrinsic_overload_list> lookup;
+	lookup.reserve(std::size(s_intrinsics));
+	for (const intrinsic &intrinsic : s_intrinsics)
+	{
+		intrinsic_overload_list &overloads = lookup[intrinsic.name];
+		const size_t num_parameters = intrinsic.parameter_list.size();
+		if (num_parameters >= overloads.size())
+			overloads.resize(num_parameters + 1);
+		overloads[num_parameters].push_back(&intrinsic);
+	}
+	return lookup;
+}();
+
 unsigned int reshadefx::type::rank(const type &src, const type &dst)
 {
 	if (src.is_array() != dst.is_array() || (src.array_length != dst.array_length && src.is_bounded_array() && dst.is_bounded_array()))
@@ -426,27 +444,55 @@ bool reshadefx::symbol_table::resolve_function_call(const std::string &name, con
 	// Try matching against intrinsic functions if no matching user-defined function was found up to this point
 	if (num_overloads == 0)
 	{
-		for (const intrinsic &intrinsic : s_intrinsics)
+		// Intrinsic overload resolution only depends on the name, the argument types and whether the call is made from the global namespace, so cache the result for repeated calls
+		std::string signature = name;
+		signature.reserve(name.size() + 1 + arguments.size() * 3 * sizeof(uint32_t));
+		signature.push_back(overload_namespace == 0 ? '\0' : '\1');
+		for (const expression &argument : arguments)
 		{
-			if (intrinsic.name != name || intrinsic.parameter_list.size() != arguments.size())
-				continue;
+			const uint32_t key[3] = { static_cast<uint32_t>(argument.type.base) | (argument.type.rows << 8) | (argument.type.cols << 12), argument.type.array_length, argument.type.struct_definition };
+			signature.append(reinterpret_cast<const char *>(key), sizeof(key));
+		}
 
-			// A new possibly-matching intrinsic function was found, compare it against the current result
-			const int comparison = compare_functions(arguments, &intrinsic, result);
+		if (const auto cache_it = _intrinsic_cache.find(signature); cache_it != _intrinsic_cache.end())
+		{
+			num_overloads = cache_it->second.second;
 
-			if (comparison < 0) // The new function is a better match
+			if (const function *const intrinsic = cache_it->second.first; intrinsic != nullptr)
 			{
 				out_data.op = symbol_type::intrinsic;
-				out_data.id = intrinsic.id;
-				out_data.type = intrinsic.return_type;
-				out_data.function = &intrinsic;
-				result = out_data.function;
-				num_overloads = 1;
+				out_data.id = intrinsic->id;
+				out_data.type = intrinsic->return_type;
+				out_data.function = intrinsic;
 			}
-			else if (comparison == 0 && overload_namespace == 0) // Both functions are equally viable, so the call is ambiguous (intrinsics are always in the global namespace)
+		}
+		else
+		{
+			if (const auto lookup_it = s_intrinsic_lookup.find(name);
+				lookup_it != s_intrinsic_lookup.end() && arguments.size() < lookup_it->second.size())
 			{
-				++num_overloads;
+				for (const intrinsic *const intrinsic : lookup_it->second[arguments.size()])
+				{
+					// A new possibly-matching intrinsic function was found, compare it against the current result
+					const int comparison = compare_functions(arguments, intrinsic, result);
+
+					if (comparison < 0) // The new function is a better match
+					{
+						out_data.op = symbol_type::intrinsic;
+						out_data.id = intrinsic->id;
+						out_data.type = intrinsic->return_type;
+						out_data.function = intrinsic;
+						result = out_data.function;
+						num_overloads = 1;
+					}
+					else if (comparison == 0 && overload_namespace == 0) // Both functions are equally viable, so the call is ambiguous (intrinsics are always in the global namespace)
+					{
+						++num_overloads;
+					}
+				}
 			}
+
+			_intrinsic_cache.emplace(std::move(signature), std::make_pair(result, num_overloads));
 		}
 	}
 
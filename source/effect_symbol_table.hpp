@@ -99,5 +99,7 @@ namespace reshadefx
 		scope _current_scope;
 		// Lookup table from name to matching symbols
 		std::unordered_map<std::string, std::vector<scoped_symbol>> _symbol_stack;
+		// Cache of resolved intrinsic overloads, keyed by function name and argument type signature
+		mutable std::unordered_map<std::string, std::pair<const function *, unsigned int>> _intrinsic_cache;
 	};
 }
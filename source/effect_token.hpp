@@ -6,6 +6,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cstdint>
 
@@ -16,11 +17,30 @@ namespace reshadefx
 	/// </summary>
 	struct location
 	{
-		location() : line(1), column(1) {}
-		explicit location(uint32_t line, uint32_t column = 1) : line(line), column(column) {}
-		explicit location(std::string source, uint32_t line, uint32_t column = 1) : source(std::move(source)), line(line), column(column) {}
+		location() : source(0), line(1), column(1) {}
+		explicit location(uint32_t line, uint32_t column = 1) : source(0), line(line), column(column) {}
+		explicit location(const std::string_view source_name, uint32_t line, uint32_t column = 1) : source(intern_source_name(source_name)), line(line), column(column) {}
 
-		std::string source;
+		/// <summary>
+		/// Gets the file name of the source this location refers to, or an empty string if it is unknown.
+		/// </summary>
+		const std::string &source_name() const { return lookup_source_name(source); }
+
+		/// <summary>
+		/// Adds a file name to the source file table, so that it can be referenced by locations.
+		/// The table is shared by all preprocessor, parser and code generator instances, so that locations stay valid after the objects that created them are gone.
+		/// </summary>
+		/// <returns>Index of the file name in the source file table, or zero if the file name is empty.</returns>
+		static uint32_t intern_source_name(const std::string_view source_name);
+		/// <summary>
+		/// Gets the file name at the specified index in the source file table.
+		/// </summary>
+		static const std::string &lookup_source_name(uint32_t source);
+
+		/// <summary>
+		/// Index of the source file in the source file table (zero if unknown), so that copying a location does not have to copy the file name.
+		/// </summary>
+		uint32_t source;
 		uint32_t line, column;
 	};
 
@@ -97,6 +97,7 @@ static ImVec2 calc_text_size(const char *text, const char *text_end = nullptr)
 reshade::imgui::code_editor::code_editor()
 {
 	_lines.emplace_back();
+	_line_states.emplace_back();
 }
 
 void reshade::imgui::code_editor::render(const char *title, const uint32_t palette[color_palette_max], bool border, ImFont *font, float font_size)
@@ -792,6 +793,7 @@ void reshade::imgui::code_editor::set_text(const std::string_view text)
 {
 	_lines.clear();
 	_lines.emplace_back();
+	_line_states.clear();
 
 	_undo.clear();
 	_undo_index = 0;
@@ -818,6 +820,8 @@ void reshade::imgui::code_editor::set_text(const std::string_view text)
 	_cursor_pos.line = std::min(_cursor_pos.line, _lines.size() - 1);
 	_cursor_pos.column = std::min(_cursor_pos.column, _lines[_cursor_pos.line].size());
 
+	_line_states.resize(_lines.size(), line_state::normal);
+
 	_colorize_line_beg = 0;
 	_colorize_line_end = _lines.size();
 }
@@ -864,6 +868,11 @@ void reshade::imgui::code_editor::insert_text(const std::string_view text)
 
 			std::vector<glyph> &new_line = *_lines.emplace(_lines.begin() + _cursor_pos.line + 1);
 			std::vector<glyph> &line = _lines[_cursor_pos.line];
+			_line_states.emplace(_line_states.begin() + _cursor_pos.line + 1);
+
+			// Lines after the new line that are still waiting to be colorized move one down too
+			if (_colorize_line_end > _cursor_pos.line + 1)
+				_colorize_line_end++;
 
 			new_line.insert(new_line.end(), line.begin() + _cursor_pos.column, line.end());
 			line.erase(line.begin() + _cursor_pos.column, line.begin() + line.size());
@@ -908,8 +917,8 @@ void reshade::imgui::code_editor::insert_character(uint32_t c, bool auto_indent)
 			text_pos &beg = _select_beg;
 			text_pos &end = _select_end;
 
-			_colorize_line_beg = std::min(_colorize_line_beg, beg.line - std::min(beg.line, static_cast<size_t>(10)));
-			_colorize_line_end = std::max(_colorize_line_end, end.line + 10 + 1);
+			_colorize_line_beg = std::min(_colorize_line_beg, beg.line);
+			_colorize_line_end = std::max(_colorize_line_end, end.line + 1);
 
 			beg.column = 0;
 			if (end.column == 0 && end.line > 0)
@@ -1008,8 +1017,7 @@ void reshade::imgui::code_editor::insert_character(uint32_t c, bool auto_indent)
 		u.added_beg = _cursor_pos;
 	}
 
-	// Colorize additional 10 lines above and below to better catch multi-line constructs
-	_colorize_line_beg = std::min(_colorize_line_beg, _cursor_pos.line - std::min(_cursor_pos.line, static_cast<size_t>(10)));
+	_colorize_line_beg = std::min(_colorize_line_beg, _cursor_pos.line);
 
 	// New line feed requires insertion of a new line
 	if (c == '\n')
@@ -1023,6 +1031,11 @@ void reshade::imgui::code_editor::insert_character(uint32_t c, bool auto_indent)
 
 		std::vector<glyph> &new_line = *_lines.emplace(_lines.begin() + _cursor_pos.line + 1);
 		std::vector<glyph> &line = _lines[_cursor_pos.line];
+		_line_states.emplace(_line_states.begin() + _cursor_pos.line + 1);
+
+		// Lines after the new line that are still waiting to be colorized move one down too
+		if (_colorize_line_end > _cursor_pos.line + 1)
+			_colorize_line_end++;
 
 		// Auto indentation
 		if (auto_indent && _cursor_pos.column == line.size())
@@ -1065,7 +1078,7 @@ void reshade::imgui::code_editor::insert_character(uint32_t c, bool auto_indent)
 
 	_scroll_to_cursor = true;
 
-	_colorize_line_end = std::max(_colorize_line_end, _cursor_pos.line + 10 + 1);
+	_colorize_line_end = std::max(_colorize_line_end, _cursor_pos.line + 1);
 }
 
 std::string reshade::imgui::code_editor::get_text() const
@@ -1235,8 +1248,8 @@ void reshade::imgui::code_editor::delete_next()
 
 	record_undo(std::move(u));
 
-	_colorize_line_beg = std::min(_colorize_line_beg, _cursor_pos.line - std::min(_cursor_pos.line, static_cast<size_t>(10)));
-	_colorize_line_end = std::max(_colorize_line_end, _cursor_pos.line + 10 + 1);
+	_colorize_line_beg = std::min(_colorize_line_beg, _cursor_pos.line);
+	_colorize_line_end = std::max(_colorize_line_end, _cursor_pos.line + 1);
 }
 void reshade::imgui::code_editor::delete_previous()
 {
@@ -1289,8 +1302,8 @@ void reshade::imgui::code_editor::delete_previous()
 
 	_scroll_to_cursor = true;
 
-	_colorize_line_beg = std::min(_colorize_line_beg, _cursor_pos.line - std::min(_cursor_pos.line, static_cast<size_t>(10)));
-	_colorize_line_end = std::max(_colorize_line_end, _cursor_pos.line + 10 + 1);
+	_colorize_line_beg = std::min(_colorize_line_beg, _cursor_pos.line);
+	_colorize_line_end = std::max(_colorize_line_end, _cursor_pos.line + 1);
 }
 void reshade::imgui::code_editor::delete_selection()
 {
@@ -1334,8 +1347,8 @@ void reshade::imgui::code_editor::delete_selection()
 		assert(!_lines.empty());
 	}
 
-	_colorize_line_beg = std::min(_colorize_line_beg, _select_beg.line - std::min(_cursor_pos.line, static_cast<size_t>(10)));
-	_colorize_line_end = std::max(_colorize_line_end, _select_end.line + 10 + 1);
+	_colorize_line_beg = std::min(_colorize_line_beg, _select_beg.line);
+	_colorize_line_end = std::max(_colorize_line_end, _select_beg.line + 1);
 
 	// Reset selection
 	_cursor_pos = _select_beg;
@@ -1355,6 +1368,21 @@ void reshade::imgui::code_editor::delete_lines(size_t first_line, size_t last_li
 	_errors = std::move(errors);
 
 	_lines.erase(_lines.begin() + first_line, _lines.begin() + last_line + 1);
+	_line_states.erase(_line_states.begin() + first_line, _line_states.begin() + last_line + 1);
+
+	// Move the range of lines that are still waiting to be colorized up accordingly, so that it does not extend past lines that were not modified
+	if (_colorize_line_beg < _colorize_line_end)
+	{
+		if (_colorize_line_beg > last_line)
+			_colorize_line_beg -= last_line + 1 - first_line;
+		else if (_colorize_line_beg > first_line)
+			_colorize_line_beg = first_line;
+
+		if (_colorize_line_end > last_line + 1)
+			_colorize_line_end -= last_line + 1 - first_line;
+		else if (_colorize_line_end > first_line)
+			_colorize_line_end = first_line + 1;
+	}
 }
 
 void reshade::imgui::code_editor::clipboard_copy()
@@ -1733,6 +1761,9 @@ void reshade::imgui::code_editor::move_lines_up()
 	for (size_t line = _select_beg.line; line <= _select_end.line; ++line)
 		std::swap(_lines[line], _lines[line - 1]);
 
+	_colorize_line_beg = std::min(_colorize_line_beg, _select_beg.line - 1);
+	_colorize_line_end = std::max(_colorize_line_end, _select_end.line + 1);
+
 	_select_beg.line--;
 	_select_end.line--;
 	_cursor_pos.line--;
@@ -1747,6 +1778,9 @@ void reshade::imgui::code_editor::move_lines_down()
 	for (size_t line = _select_end.line; line >= _select_beg.line && line < _lines.size(); --line)
 		std::swap(_lines[line], _lines[line + 1]);
 
+	_colorize_line_beg = std::min(_colorize_line_beg, _select_beg.line);
+	_colorize_line_end = std::max(_colorize_line_end, _select_end.line + 2);
+
 	_select_beg.line++;
 	_select_end.line++;
 	_cursor_pos.line++;
@@ -1899,24 +1933,70 @@ void reshade::imgui::code_editor::colorize()
 	if (_colorize_line_beg >= _colorize_line_end)
 		return;
 
+	assert(_line_states.size() == _lines.size());
+
+	// Lines before the first modified one are unchanged, so the lexer state stored for it is still valid and colorization can start right there
+	size_t line = std::min(_colorize_line_beg, _lines.size() - 1);
+	line_state state = _line_states[line];
+
 	// Step through code incrementally rather than coloring everything at once
-	const size_t from = _colorize_line_beg, to = std::min(from + 1000, _colorize_line_end);
-	_colorize_line_beg = to;
+	for (const size_t budget_end = line + 1000; line < _lines.size(); ++line)
+	{
+		if (line == budget_end)
+		{
+			// Continue with the next line in the next frame
+			_line_states[line] = state;
+			_colorize_line_beg = line;
+			_colorize_line_end = std::max(_colorize_line_end, line + 1);
+			return;
+		}
+
+		_line_states[line] = state;
+		state = colorize_line(line, state);
+
+		// Once past the modified lines, stop as soon as the lexer state at the beginning of the next line is the same as before, since all following lines then have the same colors as before too
+		if (line + 1 >= _colorize_line_end && line + 1 < _lines.size() && _line_states[line + 1] == state)
+			break;
+	}
+
+	// Reset coloring range since everything was colored
+	_colorize_line_beg = std::numeric_limits<size_t>::max();
+	_colorize_line_end = 0;
+}
+
+reshade::imgui::code_editor::line_state reshade::imgui::code_editor::colorize_line(size_t line_index, line_state state)
+{
+	std::vector<glyph> &line = _lines[line_index];
+
+	size_t column = 0;
 
-	// Reset coloring range if we have finished coloring it after this iteration
-	if (_colorize_line_end > _lines.size())
-		_colorize_line_end = _lines.size();
-	if (_colorize_line_beg == _colorize_line_end)
+	// Continue a block comment from a previous line up to its end
+	if (state == line_state::block_comment)
 	{
-		_colorize_line_beg = std::numeric_limits<size_t>::max();
-		_colorize_line_end = 0;
+		for (bool comment_end = false; !comment_end; ++column)
+		{
+			if (column >= line.size())
+				return line_state::block_comment;
+
+			comment_end = column > 0 && line[column - 1].c == '*' && line[column].c == '/';
+			line[column].col = color_multiline_comment;
+		}
 	}
 
-	// Copy lines into string for consumption by the lexer (needs to use the same offsets as the indices in '_lines', so strip any unicode characters which are multi-byte)
+	if (column >= line.size())
+		return line_state::normal;
+
+	// Continue a previous line that ended with a backslash (e.g. the definition of a multi-line macro)
+	// A '#' at the beginning of such a line does not start a new preprocessor directive (but is for example the stringizing operator in a macro), so put a placeholder token in front of the line to keep the lexer from parsing it as one
+	const size_t placeholder_length = (state == line_state::line_continuation) ? 1 : 0;
+	bool ends_with_backslash = false;
+
+	// Copy line into string for consumption by the lexer (needs to use the same offsets as the indices in the line, so strip any unicode characters which are multi-byte)
 	std::string input_string;
-	for (size_t l = from; l < to && l < _lines.size(); ++l, input_string.push_back('\n'))
-		for (size_t k = 0; k < _lines[l].size(); ++k)
-			input_string += _lines[l][k].c < 0x80 ? static_cast<char>(_lines[l][k].c) : '?';
+	input_string.reserve(placeholder_length + line.size() - column);
+	input_string.append(placeholder_length, ';');
+	for (size_t k = column; k < line.size(); ++k)
+		input_string += line[k].c < 0x80 ? static_cast<char>(line[k].c) : '?';
 
 	reshadefx::lexer lexer(
 		std::move(input_string),
@@ -1927,8 +2007,13 @@ void reshade::imgui::code_editor::colorize()
 		false /* ignore_keywords */,
 		false /* escape_string_literals */);
 
+	line_state end_state = line_state::normal;
+
 	for (reshadefx::token tok; (tok = lexer.lex()).id != reshadefx::tokenid::end_of_file;)
 	{
+		if (tok.offset < placeholder_length)
+			continue;
+
 		color col = color_default;
 
 		switch (tok.id)
@@ -2160,25 +2245,26 @@ void reshade::imgui::code_editor::colorize()
 			break;
 		case reshadefx::tokenid::multi_line_comment:
 			col = color_multiline_comment;
+			// Comment continues on the next line if it was not terminated on this one
+			if (tok.length < 3 || lexer.input_string().compare(tok.offset + tok.length - 2, 2, "*/") != 0)
+				end_state = line_state::block_comment;
 			break;
 		}
 
-		// Update character range matching the current the token
-		size_t line = from + tok.location.line - 1;
-		size_t column = tok.location.column - 1;
+		// A backslash at the end of the line continues it on the next line, so is not colored like punctuation
+		ends_with_backslash = tok.id == reshadefx::tokenid::backslash && tok.offset + tok.length == lexer.input_string().size();
+		if (ends_with_backslash)
+			col = color_default;
 
-		for (size_t k = 0; k < tok.length; ++k)
-		{
-			if (column >= _lines[line].size())
-			{
-				line++;
-				column = 0;
-				continue;
-			}
-
-			_lines[line][column++].col = col;
-		}
+		// Update character range matching the current the token (tokens cannot span multiple lines here, since the lexer only sees a single line)
+		for (size_t k = column + tok.offset - placeholder_length; k < column + tok.offset - placeholder_length + tok.length && k < line.size(); ++k)
+			line[k].col = col;
 	}
+
+	if (end_state == line_state::normal && ends_with_backslash)
+		end_state = line_state::line_continuation;
+
+	return end_state;
 }
 
 void reshade::imgui::code_editor::colorize(const text_pos &beg, const text_pos &end, color col)
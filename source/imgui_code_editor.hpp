@@ -216,8 +216,16 @@ namespace reshade::imgui
 	private:
 		struct glyph
 		{
-			uint32_t c = '\0';
-			color col = color_default;
+			// Unicode code points fit into 21 bits, so the color is packed into the remaining bits to keep this at 4 bytes per character
+			uint32_t c : 24;
+			color col : 8;
+		};
+
+		enum class line_state : uint8_t
+		{
+			normal,
+			block_comment,
+			line_continuation
 		};
 
 		struct undo_record
@@ -256,9 +264,12 @@ namespace reshade::imgui
 		void move_lines_down();
 
 		void colorize();
+		line_state colorize_line(size_t line_index, line_state state);
 
 		// Holds the entire text split up into individual character glyphs
 		std::vector<std::vector<glyph>> _lines;
+		// Lexer state at the beginning of each line, so that colorization can resume in the middle of the text
+		std::vector<line_state> _line_states;
 
 		bool _readonly = false;
 		bool _overwrite = false;
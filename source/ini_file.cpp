@@ -8,12 +8,37 @@
 #include <shared_mutex>
 #include <cctype> // std::toupper
 #include <cassert>
+#include <iterator> // std::back_inserter
 #include <algorithm> // std::min, std::sort, std::transform
 #include <utf8/core.h>
 
 static std::shared_mutex s_ini_cache_mutex;
 static std::unordered_map<std::filesystem::path::string_type, std::unique_ptr<reshade::ini_file>> s_ini_cache;
 
+static FILE *open_file(const std::filesystem::path &path, bool write)
+{
+#ifdef _WIN32
+	// Read in binary mode, so that the file size matches the amount of data read (carriage returns are trimmed during parsing)
+	return _wfsopen(path.c_str(), write ? L"w" : L"rb", SH_DENYWR);
+#else
+	return fopen(path.c_str(), write ? "w" : "rb");
+#endif
+}
+
+// Converts a section or key name to upper case once before sorting, instead of in every comparison
+static std::string to_sort_key(const std::string &name)
+{
+	std::string key;
+	key.reserve(name.size());
+	std::transform(name.begin(), name.end(), std::back_inserter(key), [](std::string::value_type c) { return static_cast<std::string::value_type>(std::toupper(c)); });
+	return key;
+}
+// Sorts case-insensitive, with names that only differ in case sorted by their original spelling to keep the order consistent
+static bool compare_sort_keys(const std::pair<std::string, const std::string *> &lhs, const std::pair<std::string, const std::string *> &rhs)
+{
+	return lhs.first != rhs.first ? lhs.first < rhs.first : *lhs.second < *rhs.second;
+}
+
 reshade::ini_file &reshade::global_config()
 {
 	return ini_file::load_cache(g_reshade_base_path / L"ReShade.ini");
@@ -28,36 +53,50 @@ bool reshade::ini_file::load()
 {
 	std::error_code ec;
 	const std::filesystem::file_time_type modified_at = std::filesystem::last_write_time(_path, ec);
+	_checked_at = std::chrono::steady_clock::now();
 	if (!ec && _modified_at >= modified_at)
 		return true; // Skip loading if there was no modification to the file since it was last loaded
 
 	// Clear when file does not exist too
 	_sections.clear();
 
-	FILE *const file = _wfsopen(_path.c_str(), L"r", SH_DENYWR);
+	FILE *const file = open_file(_path, false);
 	if (file == nullptr)
 		return false;
 
 	_modified = false;
 	_modified_at = modified_at;
 
-	// Remove BOM (0xefbbbf means 0xfeff)
-	if (fgetc(file) != utf8::bom[0] || fgetc(file) != utf8::bom[1] || fgetc(file) != utf8::bom[2])
-		fseek(file, 0, SEEK_SET);
-
-	std::string line_data, section;
-	line_data.resize(BUFSIZ);
-	while (fgets(line_data.data(), static_cast<int>(line_data.size() + 1), file))
+	// Read the entire file at once and parse it in place, instead of going through it line by line
+	std::string data;
+	if (fseek(file, 0, SEEK_END) == 0)
 	{
-		size_t line_length;
-		while ((line_length = std::strlen(line_data.data())) == line_data.size() && line_data.back() != '\n')
+		const long file_size = ftell(file);
+		if (file_size > 0)
 		{
-			line_data.resize(line_data.size() + BUFSIZ);
-			if (!fgets(line_data.data() + line_length, static_cast<int>(line_data.size() - line_length + 1), file))
-				break;
+			data.resize(static_cast<size_t>(file_size));
+			fseek(file, 0, SEEK_SET);
+			data.resize(fread(data.data(), 1, data.size(), file));
 		}
+	}
+
+	fclose(file);
 
-		const std::string_view line = trim(std::string_view(line_data.data(), line_length), " \t\r\n");
+	std::string_view remaining = data;
+
+	// Remove BOM (0xefbbbf means 0xfeff)
+	if (remaining.size() >= 3 && static_cast<uint8_t>(remaining[0]) == utf8::bom[0] && static_cast<uint8_t>(remaining[1]) == utf8::bom[1] && static_cast<uint8_t>(remaining[2]) == utf8::bom[2])
+		remaining.remove_prefix(3);
+
+	// Keep the current section and reuse the key string across lines, so that map lookups only allocate when a new entry is actually added
+	section_type *section = &_sections[std::string()];
+	std::string key_string;
+
+	while (!remaining.empty())
+	{
+		const size_t line_end = std::min(remaining.find('\n'), remaining.size());
+		const std::string_view line = trim(remaining.substr(0, line_end), " \t\r\n");
+		remaining.remove_prefix(std::min(line_end + 1, remaining.size()));
 
 		if (line.empty() || line[0] == ';' || line[0] == '/' || line[0] == '#')
 			continue;
@@ -65,7 +104,8 @@ bool reshade::ini_file::load()
 		// Read section name
 		if (line[0] == '[')
 		{
-			section = trim(line.substr(0, line.find(']')), " \t[]");
+			key_string = trim(line.substr(0, line.find(']')), " \t[]");
+			section = &_sections[key_string];
 			continue;
 		}
 
@@ -73,17 +113,17 @@ bool reshade::ini_file::load()
 		const size_t assign_index = line.find('=');
 		if (assign_index != std::string::npos)
 		{
-			const std::string_view key = trim(line.substr(0, assign_index));
+			key_string = trim(line.substr(0, assign_index));
 			const std::string_view value = trim(line.substr(assign_index + 1));
 
 			if (value.empty())
 			{
-				_sections[section].insert({ std::string(key), {} });
+				section->try_emplace(key_string);
 				continue;
 			}
 
 			// Append to key if it already exists
-			ini_file::value_type &elements = _sections[section][std::string(key)];
+			ini_file::value_type &elements = (*section)[key_string];
 			for (size_t offset = 0, base = 0, len = value.size(); offset <= len;)
 			{
 				// Treat ",," as an escaped comma and only split on single ","
@@ -94,16 +134,24 @@ bool reshade::ini_file::load()
 				}
 				else
 				{
-					std::string &element = elements.emplace_back();
-					element.reserve(found - base);
-
-					while (base < found)
+					// Most elements do not contain escaped commas, so can be copied directly
+					if (offset == base)
 					{
-						const char c = value[base++];
-						element += c;
+						elements.emplace_back(value.substr(base, found - base));
+					}
+					else
+					{
+						std::string &element = elements.emplace_back();
+						element.reserve(found - base);
+
+						while (base < found)
+						{
+							const char c = value[base++];
+							element += c;
 
-						if (c == ',' && base < found && value[base] == ',')
-							base++; // Skip second comma in a ",," escape sequence
+							if (c == ',' && base < found && value[base] == ',')
+								base++; // Skip second comma in a ",," escape sequence
+						}
 					}
 
 					offset = base = found + 1;
@@ -112,11 +160,13 @@ bool reshade::ini_file::load()
 		}
 		else
 		{
-			_sections[section].insert({ std::string(line), {} });
+			section->try_emplace(std::string(line));
 		}
 	}
 
-	fclose(file);
+	// Only keep the global section if it actually contains something
+	if (const auto it = _sections.find(std::string()); it != _sections.end() && it->second.empty())
+		_sections.erase(it);
 
 	return true;
 }
@@ -134,67 +184,58 @@ bool reshade::ini_file::save()
 		return false; // File exists and was modified on disk and therefore may have different data, so cannot save
 
 	std::string data;
-	std::vector<std::string> section_names, key_names;
+	std::vector<std::pair<std::string, const std::string *>> section_names, key_names;
 
 	section_names.reserve(_sections.size());
 	for (const std::pair<const std::string, section_type> &section : _sections)
-		section_names.push_back(section.first);
+		section_names.emplace_back(to_sort_key(section.first), &section.first);
 
 	// Sort sections to generate consistent files
-	std::sort(section_names.begin(), section_names.end(),
-		[](std::string a, std::string b) {
-			std::transform(a.begin(), a.end(), a.begin(), [](std::string::value_type c) { return static_cast<std::string::value_type>(std::toupper(c)); });
-			std::transform(b.begin(), b.end(), b.begin(), [](std::string::value_type c) { return static_cast<std::string::value_type>(std::toupper(c)); });
-			return a < b;
-		});
-
-	for (const std::string &section_name : section_names)
+	std::sort(section_names.begin(), section_names.end(), compare_sort_keys);
+
+	for (const std::pair<std::string, const std::string *> &section_name : section_names)
 	{
-		if (const section_type &keys = _sections.at(section_name); !keys.empty())
+		if (const section_type &keys = _sections.at(*section_name.second); !keys.empty())
 		{
 			key_names.clear();
 			key_names.reserve(keys.size());
 			for (const std::pair<const std::string, value_type> &key : keys)
-				key_names.push_back(key.first);
+				key_names.emplace_back(to_sort_key(key.first), &key.first);
 
-			std::sort(key_names.begin(), key_names.end(),
-				[](std::string a, std::string b) {
-					std::transform(a.begin(), a.end(), a.begin(), [](std::string::value_type c) { return static_cast<std::string::value_type>(std::toupper(c)); });
-					std::transform(b.begin(), b.end(), b.begin(), [](std::string::value_type c) { return static_cast<std::string::value_type>(std::toupper(c)); });
-					return a < b;
-				});
+			std::sort(key_names.begin(), key_names.end(), compare_sort_keys);
 
 			// Empty section should have been sorted to the top, so do not need to append it before keys
-			if (!section_name.empty())
-				data += '[' + section_name + ']' + '\n';
+			if (!section_name.second->empty())
+			{
+				data += '[';
+				data += *section_name.second;
+				data += ']';
+				data += '\n';
+			}
 
-			for (const std::string &key_name : key_names)
+			for (const std::pair<std::string, const std::string *> &key_name : key_names)
 			{
-				data += key_name + '=';
+				data += *key_name.second;
+				data += '=';
+
+				const size_t value_offset = data.size();
 
-				if (const ini_file::value_type &elements = keys.at(key_name); !elements.empty())
+				for (const std::string &element : keys.at(*key_name.second))
 				{
-					std::string value;
-					for (const std::string &element : elements)
-					{
-						// Empty elements mess with escaped commas, so simply skip them
-						if (element.empty())
-							continue;
-
-						value.reserve(value.size() + element.size() + 1);
-						for (const char c : element)
-							value.append(c == ',' ? 2 : 1, c);
-						value += ','; // Separate multiple values with a comma
-					}
+					// Empty elements mess with escaped commas, so simply skip them
+					if (element.empty())
+						continue;
 
-					// Remove the last comma
-					if (!value.empty())
-					{
-						assert(value.back() == ',');
-						value.pop_back();
-					}
+					for (const char c : element)
+						data.append(c == ',' ? 2 : 1, c);
+					data += ','; // Separate multiple values with a comma
+				}
 
-					data += value;
+				// Remove the last comma
+				if (data.size() != value_offset)
+				{
+					assert(data.back() == ',');
+					data.pop_back();
 				}
 
 				data += '\n';
@@ -204,7 +245,7 @@ bool reshade::ini_file::save()
 		}
 	}
 
-	FILE *const file = _wfsopen(_path.c_str(), L"w", SH_DENYWR);
+	FILE *const file = open_file(_path, true);
 	if (file == nullptr)
 		return false;
 	const size_t file_size_written = fwrite(data.data(), 1, data.size(), file);
@@ -274,14 +315,15 @@ reshade::ini_file &reshade::ini_file::load_cache(const std::filesystem::path &pa
 
 	const std::unique_lock<std::shared_mutex> lock(s_ini_cache_mutex);
 
-	const auto insert = s_ini_cache.try_emplace(path);
+	const auto insert = s_ini_cache.try_emplace(path.native());
 	const auto it = insert.first;
 
 	// Only construct when actually adding a new entry to the cache, since the 'ini_file' constructor performs a costly load of the file
 	if (insert.second)
 		it->second = std::make_unique<ini_file>(path);
 	// Don't reload file when it was just loaded or there are still modifications pending
-	else if (!it->second->_modified)
+	// Also only check for modifications on disk periodically, since querying the last write time is costly and this is called every frame during preset transitions
+	else if (!it->second->_modified && (std::chrono::steady_clock::now() - it->second->_checked_at) > std::chrono::milliseconds(500))
 		it->second->load();
 
 	return *it->second;
@@ -7,6 +7,7 @@
 
 #include <string>
 #include <vector>
+#include <chrono>
 #include <filesystem>
 #include <unordered_map>
 
@@ -320,7 +321,8 @@ namespace reshade
 		const std::filesystem::path _path;
 		std::unordered_map<std::string, section_type> _sections;
 		bool _modified = false;
-		std::filesystem::file_time_type _modified_at;
+		std::filesystem::file_time_type _modified_at = std::filesystem::file_time_type::min();
+		std::chrono::steady_clock::time_point _checked_at;
 	};
 
 	/// <summary>
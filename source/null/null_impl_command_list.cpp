@@ -0,0 +1,510 @@
+/*
+ * Copyright (C) 2026 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "null_impl_device.hpp"
+#include "dll_log.hpp"
+#include <cstring> // std::memcpy, std::strlen
+
+static size_t descriptor_size(reshade::api::descriptor_type type)
+{
+	switch (type)
+	{
+	case reshade::api::descriptor_type::sampler:
+		return sizeof(reshade::api::sampler);
+	case reshade::api::descriptor_type::sampler_with_resource_view:
+		return sizeof(reshade::api::sampler_with_resource_view);
+	case reshade::api::descriptor_type::constant_buffer:
+	case reshade::api::descriptor_type::shader_storage_buffer:
+		return sizeof(reshade::api::buffer_range);
+	default:
+		return sizeof(reshade::api::resource_view);
+	}
+}
+
+void reshade::null::device_impl::record_data(const void *data, size_t size)
+{
+	if (size == 0)
+		return;
+
+	const size_t offset = _command_stream.size();
+	_command_stream.resize(offset + size);
+	std::memcpy(_command_stream.data() + offset, data, size);
+
+	// Grow the size of the current command to include the new arguments
+	reinterpret_cast<command_header *>(_command_stream.data() + _current_command_offset)->size += static_cast<uint32_t>(size);
+
+	_recorded_bytes += size;
+}
+void reshade::null::device_impl::begin_command(addon_event type)
+{
+	count_call(type);
+
+	_current_command_offset = _command_stream.size();
+	_command_stream.resize(_current_command_offset + sizeof(command_header));
+	*reinterpret_cast<command_header *>(_command_stream.data() + _current_command_offset) = { type, 0 };
+
+	_recorded_bytes += sizeof(command_header);
+}
+
+void reshade::null::device_impl::barrier(uint32_t count, const api::resource *resources, const api::resource_usage *old_states, const api::resource_usage *new_states)
+{
+	for (uint32_t i = 0; i < count; ++i)
+		validate_object(resources[i].handle, object_type::resource, "barrier");
+
+	begin_command(addon_event::barrier);
+	record_array(resources, count);
+	record_array(old_states, count);
+	record_array(new_states, count);
+}
+
+void reshade::null::device_impl::begin_render_pass(uint32_t count, const api::render_pass_render_target_desc *rts, const api::render_pass_depth_stencil_desc *ds)
+{
+	if (_validation)
+	{
+		if (_render_pass_depth != 0)
+		{
+			log::message(log::level::error, "Render pass was begun while another one is still active!");
+			_validation_errors++;
+		}
+
+		for (uint32_t i = 0; i < count; ++i)
+			validate_object(rts[i].view.handle, object_type::resource_view, "begin_render_pass");
+		if (ds != nullptr)
+			validate_object(ds->view.handle, object_type::resource_view, "begin_render_pass");
+	}
+
+	_render_pass_depth++;
+
+	begin_command(addon_event::begin_render_pass);
+	record_array(rts, count);
+	record_array(ds, ds != nullptr ? 1 : 0);
+}
+void reshade::null::device_impl::end_render_pass()
+{
+	if (_render_pass_depth == 0)
+	{
+		if (_validation)
+		{
+			log::message(log::level::error, "Render pass was ended without being begun!");
+			_validation_errors++;
+		}
+	}
+	else
+	{
+		_render_pass_depth--;
+	}
+
+	begin_command(addon_event::end_render_pass);
+}
+void reshade::null::device_impl::bind_render_targets_and_depth_stencil(uint32_t count, const api::resource_view *rtvs, api::resource_view dsv)
+{
+	for (uint32_t i = 0; i < count; ++i)
+		validate_object(rtvs[i].handle, object_type::resource_view, "bind_render_targets_and_depth_stencil");
+	validate_object(dsv.handle, object_type::resource_view, "bind_render_targets_and_depth_stencil");
+
+	begin_command(addon_event::bind_render_targets_and_depth_stencil);
+	record_array(rtvs, count);
+	record_arg(dsv);
+}
+
+void reshade::null::device_impl::bind_pipeline(api::pipeline_stage stages, api::pipeline pipeline)
+{
+	validate_object(pipeline.handle, object_type::pipeline, "bind_pipeline");
+
+	begin_command(addon_event::bind_pipeline);
+	record_arg(stages);
+	record_arg(pipeline);
+}
+void reshade::null::device_impl::bind_pipeline_states(uint32_t count, const api::dynamic_state *states, const uint32_t *values)
+{
+	begin_command(addon_event::bind_pipeline_states);
+	record_array(states, count);
+	record_array(values, count);
+}
+void reshade::null::device_impl::bind_viewports(uint32_t first, uint32_t count, const api::viewport *viewports)
+{
+	begin_command(addon_event::bind_viewports);
+	record_arg(first);
+	record_array(viewports, count);
+}
+void reshade::null::device_impl::bind_scissor_rects(uint32_t first, uint32_t count, const api::rect *rects)
+{
+	begin_command(addon_event::bind_scissor_rects);
+	record_arg(first);
+	record_array(rects, count);
+}
+
+void reshade::null::device_impl::push_constants(api::shader_stage stages, api::pipeline_layout layout, uint32_t layout_param, uint32_t first, uint32_t count, const void *values)
+{
+	validate_object(layout.handle, object_type::pipeline_layout, "push_constants");
+
+	begin_command(addon_event::push_constants);
+	record_arg(stages);
+	record_arg(layout);
+	record_arg(layout_param);
+	record_arg(first);
+	record_array(static_cast<const uint32_t *>(values), count);
+}
+void reshade::null::device_impl::push_descriptors(api::shader_stage stages, api::pipeline_layout layout, uint32_t layout_param, const api::descriptor_table_update &update)
+{
+	validate_object(layout.handle, object_type::pipeline_layout, "push_descriptors");
+
+	if (_validation)
+	{
+		if (update.count != 0 && update.descriptors == nullptr)
+		{
+			log::message(log::level::error, "Descriptors passed to 'push_descriptors' are missing!");
+			_validation_errors++;
+		}
+		else
+		{
+			for (uint32_t i = 0; i < update.count; ++i)
+			{
+				switch (update.type)
+				{
+				case api::descriptor_type::sampler:
+					validate_object(static_cast<const api::sampler *>(update.descriptors)[i].handle, object_type::sampler, "push_descriptors");
+					break;
+				case api::descriptor_type::sampler_with_resource_view:
+					validate_object(static_cast<const api::sampler_with_resource_view *>(update.descriptors)[i].sampler.handle, object_type::sampler, "push_descriptors");
+					validate_object(static_cast<const api::sampler_with_resource_view *>(update.descriptors)[i].view.handle, object_type::resource_view, "push_descriptors");
+					break;
+				case api::descriptor_type::constant_buffer:
+				case api::descriptor_type::shader_storage_buffer:
+					validate_object(static_cast<const api::buffer_range *>(update.descriptors)[i].buffer.handle, object_type::resource, "push_descriptors");
+					break;
+				default:
+					validate_object(static_cast<const api::resource_view *>(update.descriptors)[i].handle, object_type::resource_view, "push_descriptors");
+					break;
+				}
+			}
+		}
+	}
+
+	begin_command(addon_event::push_descriptors);
+	record_arg(stages);
+	record_arg(layout);
+	record_arg(layout_param);
+	record_arg(update.binding);
+	record_arg(update.array_offset);
+	record_arg(update.type);
+	record_arg(update.count);
+	if (update.descriptors != nullptr)
+		record_data(update.descriptors, update.count * descriptor_size(update.type));
+}
+void reshade::null::device_impl::bind_descriptor_tables(api::shader_stage stages, api::pipeline_layout layout, uint32_t first, uint32_t count, const api::descriptor_table *tables)
+{
+	validate_object(layout.handle, object_type::pipeline_layout, "bind_descriptor_tables");
+	for (uint32_t i = 0; i < count; ++i)
+		validate_object(tables[i].handle, object_type::descriptor_table, "bind_descriptor_tables");
+
+	begin_command(addon_event::bind_descriptor_tables);
+	record_arg(stages);
+	record_arg(layout);
+	record_arg(first);
+	record_array(tables, count);
+}
+
+void reshade::null::device_impl::bind_index_buffer(api::resource buffer, uint64_t offset, uint32_t index_size)
+{
+	validate_object(buffer.handle, object_type::resource, "bind_index_buffer");
+
+	begin_command(addon_event::bind_index_buffer);
+	record_arg(buffer);
+	record_arg(offset);
+	record_arg(index_size);
+}
+void reshade::null::device_impl::bind_vertex_buffers(uint32_t first, uint32_t count, const api::resource *buffers, const uint64_t *offsets, const uint32_t *strides)
+{
+	for (uint32_t i = 0; i < count; ++i)
+		validate_object(buffers[i].handle, object_type::resource, "bind_vertex_buffers");
+
+	begin_command(addon_event::bind_vertex_buffers);
+	record_arg(first);
+	record_array(buffers, count);
+	record_array(offsets, count);
+	record_array(strides, count);
+}
+void reshade::null::device_impl::bind_stream_output_buffers(uint32_t first, uint32_t count, const api::resource *buffers, const uint64_t *offsets, const uint64_t *max_sizes, const api::resource *counter_buffers, const uint64_t *counter_offsets)
+{
+	for (uint32_t i = 0; i < count; ++i)
+		validate_object(buffers[i].handle, object_type::resource, "bind_stream_output_buffers");
+
+	begin_command(addon_event::bind_stream_output_buffers);
+	record_arg(first);
+	record_array(buffers, count);
+	record_array(offsets, count);
+	record_array(max_sizes, count);
+	record_array(counter_buffers, counter_buffers != nullptr ? count : 0);
+	record_array(counter_offsets, counter_offsets != nullptr ? count : 0);
+}
+
+void reshade::null::device_impl::draw(uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance)
+{
+	begin_command(addon_event::draw);
+	record_arg(vertex_count);
+	record_arg(instance_count);
+	record_arg(first_vertex);
+	record_arg(first_instance);
+}
+void reshade::null::device_impl::draw_indexed(uint32_t index_count, uint32_t instance_count, uint32_t first_index, int32_t vertex_offset, uint32_t first_instance)
+{
+	begin_command(addon_event::draw_indexed);
+	record_arg(index_count);
+	record_arg(instance_count);
+	record_arg(first_index);
+	record_arg(vertex_offset);
+	record_arg(first_instance);
+}
+void reshade::null::device_impl::dispatch(uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z)
+{
+	if (_validation && _render_pass_depth != 0)
+	{
+		log::message(log::level::error, "Compute work was dispatched inside a render pass!");
+		_validation_errors++;
+	}
+
+	begin_command(addon_event::dispatch);
+	record_arg(group_count_x);
+	record_arg(group_count_y);
+	record_arg(group_count_z);
+}
+void reshade::null::device_impl::dispatch_mesh(uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z)
+{
+	begin_command(addon_event::dispatch_mesh);
+	record_arg(group_count_x);
+	record_arg(group_count_y);
+	record_arg(group_count_z);
+}
+void reshade::null::device_impl::dispatch_rays(api::resource raygen, uint64_t raygen_offset, uint64_t raygen_size, api::resource miss, uint64_t miss_offset, uint64_t miss_size, uint64_t miss_stride, api::resource hit_group, uint64_t hit_group_offset, uint64_t hit_group_size, uint64_t hit_group_stride, api::resource callable, uint64_t callable_offset, uint64_t callable_size, uint64_t callable_stride, uint32_t width, uint32_t height, uint32_t depth)
+{
+	begin_command(addon_event::dispatch_rays);
+	record_arg(raygen);
+	record_arg(raygen_offset);
+	record_arg(raygen_size);
+	record_arg(miss);
+	record_arg(miss_offset);
+	record_arg(miss_size);
+	record_arg(miss_stride);
+	record_arg(hit_group);
+	record_arg(hit_group_offset);
+	record_arg(hit_group_size);
+	record_arg(hit_group_stride);
+	record_arg(callable);
+	record_arg(callable_offset);
+	record_arg(callable_size);
+	record_arg(callable_stride);
+	record_arg(width);
+	record_arg(height);
+	record_arg(depth);
+}
+void reshade::null::device_impl::draw_or_dispatch_indirect(api::indirect_command type, api::resource buffer, uint64_t offset, uint32_t draw_count, uint32_t stride)
+{
+	validate_object(buffer.handle, object_type::resource, "draw_or_dispatch_indirect");
+
+	begin_command(addon_event::draw_or_dispatch_indirect);
+	record_arg(type);
+	record_arg(buffer);
+	record_arg(offset);
+	record_arg(draw_count);
+	record_arg(stride);
+}
+
+void reshade::null::device_impl::copy_resource(api::resource source, api::resource dest)
+{
+	validate_object(source.handle, object_type::resource, "copy_resource");
+	validate_object(dest.handle, object_type::resource, "copy_resource");
+
+	begin_command(addon_event::copy_resource);
+	record_arg(source);
+	record_arg(dest);
+}
+void reshade::null::device_impl::copy_buffer_region(api::resource source, uint64_t source_offset, api::resource dest, uint64_t dest_offset, uint64_t size)
+{
+	validate_object(source.handle, object_type::resource, "copy_buffer_region");
+	validate_object(dest.handle, object_type::resource, "copy_buffer_region");
+
+	begin_command(addon_event::copy_buffer_region);
+	record_arg(source);
+	record_arg(source_offset);
+	record_arg(dest);
+	record_arg(dest_offset);
+	record_arg(size);
+}
+void reshade::null::device_impl::copy_buffer_to_texture(api::resource source, uint64_t source_offset, uint32_t row_length, uint32_t slice_height, api::resource dest, uint32_t dest_subresource, const api::subresource_box *dest_box)
+{
+	validate_object(source.handle, object_type::resource, "copy_buffer_to_texture");
+	validate_object(dest.handle, object_type::resource, "copy_buffer_to_texture");
+
+	begin_command(addon_event::copy_buffer_to_texture);
+	record_arg(source);
+	record_arg(source_offset);
+	record_arg(row_length);
+	record_arg(slice_height);
+	record_arg(dest);
+	record_arg(dest_subresource);
+	record_array(dest_box, dest_box != nullptr ? 1 : 0);
+}
+void reshade::null::device_impl::copy_texture_region(api::resource source, uint32_t source_subresource, const api::subresource_box *source_box, api::resource dest, uint32_t dest_subresource, const api::subresource_box *dest_box, api::filter_mode filter)
+{
+	validate_object(source.handle, object_type::resource, "copy_texture_region");
+	validate_object(dest.handle, object_type::resource, "copy_texture_region");
+
+	begin_command(addon_event::copy_texture_region);
+	record_arg(source);
+	record_arg(source_subresource);
+	record_array(source_box, source_box != nullptr ? 1 : 0);
+	record_arg(dest);
+	record_arg(dest_subresource);
+	record_array(dest_box, dest_box != nullptr ? 1 : 0);
+	record_arg(filter);
+}
+void reshade::null::device_impl::copy_texture_to_buffer(api::resource source, uint32_t source_subresource, const api::subresource_box *source_box, api::resource dest, uint64_t dest_offset, uint32_t row_length, uint32_t slice_height)
+{
+	validate_object(source.handle, object_type::resource, "copy_texture_to_buffer");
+	validate_object(dest.handle, object_type::resource, "copy_texture_to_buffer");
+
+	begin_command(addon_event::copy_texture_to_buffer);
+	record_arg(source);
+	record_arg(source_subresource);
+	record_array(source_box, source_box != nullptr ? 1 : 0);
+	record_arg(dest);
+	record_arg(dest_offset);
+	record_arg(row_length);
+	record_arg(slice_height);
+}
+void reshade::null::device_impl::resolve_texture_region(api::resource source, uint32_t source_subresource, const api::subresource_box *source_box, api::resource dest, uint32_t dest_subresource, uint32_t dest_x, uint32_t dest_y, uint32_t dest_z, api::format format)
+{
+	validate_object(source.handle, object_type::resource, "resolve_texture_region");
+	validate_object(dest.handle, object_type::resource, "resolve_texture_region");
+
+	begin_command(addon_event::resolve_texture_region);
+	record_arg(source);
+	record_arg(source_subresource);
+	record_array(source_box, source_box != nullptr ? 1 : 0);
+	record_arg(dest);
+	record_arg(dest_subresource);
+	record_arg(dest_x);
+	record_arg(dest_y);
+	record_arg(dest_z);
+	record_arg(format);
+}
+
+void reshade::null::device_impl::clear_depth_stencil_view(api::resource_view dsv, const float *depth, const uint8_t *stencil, uint32_t rect_count, const api::rect *rects)
+{
+	validate_object(dsv.handle, object_type::resource_view, "clear_depth_stencil_view");
+
+	begin_command(addon_event::clear_depth_stencil_view);
+	record_arg(dsv);
+	record_array(depth, depth != nullptr ? 1 : 0);
+	record_array(stencil, stencil != nullptr ? 1 : 0);
+	record_array(rects, rect_count);
+}
+void reshade::null::device_impl::clear_render_target_view(api::resource_view rtv, const float color[4], uint32_t rect_count, const api::rect *rects)
+{
+	validate_object(rtv.handle, object_type::resource_view, "clear_render_target_view");
+
+	begin_command(addon_event::clear_render_target_view);
+	record_arg(rtv);
+	record_data(color, 4 * sizeof(float));
+	record_array(rects, rect_count);
+}
+void reshade::null::device_impl::clear_unordered_access_view_uint(api::resource_view uav, const uint32_t values[4], uint32_t rect_count, const api::rect *rects)
+{
+	validate_object(uav.handle, object_type::resource_view, "clear_unordered_access_view_uint");
+
+	begin_command(addon_event::clear_unordered_access_view_uint);
+	record_arg(uav);
+	record_data(values, 4 * sizeof(uint32_t));
+	record_array(rects, rect_count);
+}
+void reshade::null::device_impl::clear_unordered_access_view_float(api::resource_view uav, const float values[4], uint32_t rect_count, const api::rect *rects)
+{
+	validate_object(uav.handle, object_type::resource_view, "clear_unordered_access_view_float");
+
+	begin_command(addon_event::clear_unordered_access_view_float);
+	record_arg(uav);
+	record_data(values, 4 * sizeof(float));
+	record_array(rects, rect_count);
+}
+
+void reshade::null::device_impl::generate_mipmaps(api::resource_view srv)
+{
+	validate_object(srv.handle, object_type::resource_view, "generate_mipmaps");
+
+	begin_command(addon_event::generate_mipmaps);
+	record_arg(srv);
+}
+
+void reshade::null::device_impl::begin_query(api::query_heap heap, api::query_type type, uint32_t index)
+{
+	validate_object(heap.handle, object_type::query_heap, "begin_query");
+
+	begin_command(addon_event::begin_query);
+	record_arg(heap);
+	record_arg(type);
+	record_arg(index);
+}
+void reshade::null::device_impl::end_query(api::query_heap heap, api::query_type type, uint32_t index)
+{
+	validate_object(heap.handle, object_type::query_heap, "end_query");
+
+	begin_command(addon_event::end_query);
+	record_arg(heap);
+	record_arg(type);
+	record_arg(index);
+}
+void reshade::null::device_impl::copy_query_heap_results(api::query_heap heap, api::query_type type, uint32_t first, uint32_t count, api::resource dest, uint64_t dest_offset, uint32_t stride)
+{
+	validate_object(heap.handle, object_type::query_heap, "copy_query_heap_results");
+	validate_object(dest.handle, object_type::resource, "copy_query_heap_results");
+
+	begin_command(addon_event::copy_query_heap_results);
+	record_arg(heap);
+	record_arg(type);
+	record_arg(first);
+	record_arg(count);
+	record_arg(dest);
+	record_arg(dest_offset);
+	record_arg(stride);
+}
+
+void reshade::null::device_impl::copy_acceleration_structure(api::resource_view source, api::resource_view dest, api::acceleration_structure_copy_mode mode)
+{
+	begin_command(addon_event::copy_acceleration_structure);
+	record_arg(source);
+	record_arg(dest);
+	record_arg(mode);
+}
+void reshade::null::device_impl::build_acceleration_structure(api::acceleration_structure_type type, api::acceleration_structure_build_flags flags, uint32_t input_count, const api::acceleration_structure_build_input *, api::resource scratch, uint64_t scratch_offset, api::resource_view source, api::resource_view dest, api::acceleration_structure_build_mode mode)
+{
+	begin_command(addon_event::build_acceleration_structure);
+	record_arg(type);
+	record_arg(flags);
+	record_arg(input_count);
+	record_arg(scratch);
+	record_arg(scratch_offset);
+	record_arg(source);
+	record_arg(dest);
+	record_arg(mode);
+}
+void reshade::null::device_impl::query_acceleration_structures(uint32_t count, const api::resource_view *acceleration_structures, api::query_heap heap, api::query_type type, uint32_t first)
+{
+	begin_command(addon_event::query_acceleration_structures);
+	record_array(acceleration_structures, count);
+	record_arg(heap);
+	record_arg(type);
+	record_arg(first);
+}
+
+void reshade::null::device_impl::begin_debug_event(const char *, const float[4])
+{
+}
+void reshade::null::device_impl::end_debug_event()
+{
+}
+void reshade::null::device_impl::insert_debug_marker(const char *, const float[4])
+{
+}
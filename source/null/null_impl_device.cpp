@@ -0,0 +1,522 @@
+/*
+ * Copyright (C) 2026 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "null_impl_device.hpp"
+#include "dll_log.hpp"
+#include <cassert>
+#include <cstring> // std::memcpy, std::memset, std::strncpy
+#include <iterator> // std::size
+#include <algorithm> // std::min, std::fill_n
+
+static const char *object_type_to_string(uint8_t type)
+{
+	static constexpr const char *names[] = { "sampler", "resource", "resource view", "pipeline", "pipeline layout", "descriptor table", "query heap", "fence" };
+	return type < std::size(names) ? names[type] : "object";
+}
+
+reshade::null::device_impl::device_impl(api::device_api api, bool validation) :
+	api_object_impl(this),
+	_api(api),
+	_validation(validation)
+{
+#if RESHADE_ADDON
+	static_assert(static_cast<size_t>(addon_event::max) <= num_call_types);
+#endif
+}
+reshade::null::device_impl::~device_impl()
+{
+	if (_validation && !_objects.empty())
+		log::message(log::level::warning, "Null device was destroyed with %zu object(s) still alive!", _objects.size());
+}
+
+bool reshade::null::device_impl::get_property(api::device_properties property, void *data) const
+{
+	switch (property)
+	{
+	case api::device_properties::api_version:
+		// Report the newest version of the emulated API, so that the runtime enables all its features
+		switch (_api)
+		{
+		case api::device_api::d3d9:
+			*static_cast<uint32_t *>(data) = 0x9300;
+			break;
+		case api::device_api::d3d10:
+			*static_cast<uint32_t *>(data) = 0xa100;
+			break;
+		case api::device_api::d3d11:
+			*static_cast<uint32_t *>(data) = 0xb100;
+			break;
+		case api::device_api::d3d12:
+			*static_cast<uint32_t *>(data) = 0xc200;
+			break;
+		case api::device_api::opengl:
+			*static_cast<uint32_t *>(data) = 0x4600;
+			break;
+		case api::device_api::vulkan:
+			*static_cast<uint32_t *>(data) = (1 << 12) | (3 << 8);
+			break;
+		}
+		return true;
+	case api::device_properties::driver_version:
+	case api::device_properties::vendor_id:
+	case api::device_properties::device_id:
+		*static_cast<uint32_t *>(data) = 0;
+		return true;
+	case api::device_properties::description:
+		std::strncpy(static_cast<char *>(data), "ReShade Null Device", 256);
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool reshade::null::device_impl::check_capability(api::device_caps capability) const
+{
+	switch (capability)
+	{
+	case api::device_caps::conservative_rasterization:
+	case api::device_caps::shared_resource:
+	case api::device_caps::shared_resource_nt_handle:
+	case api::device_caps::shared_fence:
+	case api::device_caps::shared_fence_nt_handle:
+	case api::device_caps::amplification_and_mesh_shader:
+	case api::device_caps::ray_tracing:
+		return false;
+	case api::device_caps::bind_render_targets_and_depth_stencil:
+		// Follow the binding model of the emulated API, since the runtime records different commands depending on it
+		return _api != api::device_api::d3d12 && _api != api::device_api::vulkan;
+	case api::device_caps::sampler_with_resource_view:
+		return _api == api::device_api::d3d9 || _api == api::device_api::opengl || _api == api::device_api::vulkan;
+	default:
+		return true;
+	}
+}
+bool reshade::null::device_impl::check_format_support(api::format format, api::resource_usage) const
+{
+	return format != api::format::unknown;
+}
+
+uint64_t reshade::null::device_impl::create_object(object_type type)
+{
+	const uint64_t handle = _next_handle++;
+	_objects.emplace(handle, type);
+	return handle;
+}
+bool reshade::null::device_impl::destroy_object(uint64_t handle, object_type type)
+{
+	if (handle == 0)
+		return false;
+
+	const auto it = _objects.find(handle);
+	if (it == _objects.end() || it->second != type)
+	{
+		if (_validation)
+		{
+			log::message(log::level::error, "Attempted to destroy invalid %s %#llx!", object_type_to_string(static_cast<uint8_t>(type)), handle);
+			_validation_errors++;
+		}
+		return false;
+	}
+
+	_objects.erase(it);
+	return true;
+}
+void reshade::null::device_impl::validate_object(uint64_t handle, object_type type, const char *call) const
+{
+	if (!_validation || handle == 0)
+		return;
+
+	const std::shared_lock<std::shared_mutex> lock(_mutex);
+
+	if (const auto it = _objects.find(handle);
+		it == _objects.end() || it->second != type)
+	{
+		log::message(log::level::error, "Invalid %s %#llx passed to '%s'!", object_type_to_string(static_cast<uint8_t>(type)), handle, call);
+		_validation_errors++;
+	}
+}
+
+bool reshade::null::device_impl::create_sampler(const api::sampler_desc &, api::sampler *out_sampler)
+{
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+	count_call(addon_event::create_sampler);
+
+	*out_sampler = { create_object(object_type::sampler) };
+	return true;
+}
+void reshade::null::device_impl::destroy_sampler(api::sampler sampler)
+{
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+	count_call(addon_event::destroy_sampler);
+
+	destroy_object(sampler.handle, object_type::sampler);
+}
+
+bool reshade::null::device_impl::create_resource(const api::resource_desc &desc, const api::subresource_data *initial_data, api::resource_usage, api::resource *out_resource, void **shared_handle)
+{
+	if (shared_handle != nullptr)
+		return false;
+
+	resource_data data;
+	data.desc = desc;
+
+	// Only allocate memory for resources that the CPU can access, everything else is never read from
+	if (desc.heap != api::memory_heap::gpu_only && desc.heap != api::memory_heap::unknown)
+	{
+		if (desc.type == api::resource_type::buffer)
+			data.memory.resize(static_cast<size_t>(desc.buffer.size));
+		else
+			data.memory.resize(static_cast<size_t>(api::format_slice_pitch(desc.texture.format, api::format_row_pitch(desc.texture.format, desc.texture.width), desc.texture.height)) * (desc.type == api::resource_type::texture_3d ? desc.texture.depth_or_layers : 1));
+
+		if (initial_data != nullptr && initial_data->data != nullptr && desc.type == api::resource_type::buffer)
+			std::memcpy(data.memory.data(), initial_data->data, data.memory.size());
+	}
+
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+	count_call(addon_event::create_resource);
+
+	*out_resource = { create_object(object_type::resource) };
+	_resources.emplace(out_resource->handle, std::move(data));
+	return true;
+}
+void reshade::null::device_impl::destroy_resource(api::resource resource)
+{
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+	count_call(addon_event::destroy_resource);
+
+	if (destroy_object(resource.handle, object_type::resource))
+		_resources.erase(resource.handle);
+}
+
+reshade::api::resource_desc reshade::null::device_impl::get_resource_desc(api::resource resource) const
+{
+	const std::shared_lock<std::shared_mutex> lock(_mutex);
+
+	if (const auto it = _resources.find(resource.handle); it != _resources.end())
+		return it->second.desc;
+
+	assert(false);
+	return api::resource_desc();
+}
+
+bool reshade::null::device_impl::create_resource_view(api::resource resource, api::resource_usage, const api::resource_view_desc &desc, api::resource_view *out_view)
+{
+	validate_object(resource.handle, object_type::resource, "create_resource_view");
+
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+	count_call(addon_event::create_resource_view);
+
+	*out_view = { create_object(object_type::resource_view) };
+	_resource_views.emplace(out_view->handle, resource_view_data { resource, desc });
+	return true;
+}
+void reshade::null::device_impl::destroy_resource_view(api::resource_view view)
+{
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+	count_call(addon_event::destroy_resource_view);
+
+	if (destroy_object(view.handle, object_type::resource_view))
+		_resource_views.erase(view.handle);
+}
+
+reshade::api::resource reshade::null::device_impl::get_resource_from_view(api::resource_view view) const
+{
+	const std::shared_lock<std::shared_mutex> lock(_mutex);
+
+	if (const auto it = _resource_views.find(view.handle); it != _resource_views.end())
+		return it->second.resource;
+
+	return { 0 };
+}
+reshade::api::resource_view_desc reshade::null::device_impl::get_resource_view_desc(api::resource_view view) const
+{
+	const std::shared_lock<std::shared_mutex> lock(_mutex);
+
+	if (const auto it = _resource_views.find(view.handle); it != _resource_views.end())
+		return it->second.desc;
+
+	assert(false);
+	return api::resource_view_desc();
+}
+
+bool reshade::null::device_impl::map_buffer_region(api::resource resource, uint64_t offset, uint64_t, api::map_access, void **out_data)
+{
+	if (out_data == nullptr)
+		return false;
+
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+	count_call(addon_event::map_buffer_region);
+
+	// Memory of a resource never moves after creation, so it is safe to hand out a pointer to it
+	if (const auto it = _resources.find(resource.handle);
+		it != _resources.end() && offset < it->second.memory.size())
+	{
+		*out_data = it->second.memory.data() + offset;
+		return true;
+	}
+
+	if (_validation)
+	{
+		log::message(log::level::error, "Attempted to map buffer %#llx, which is invalid or not CPU accessible!", resource.handle);
+		_validation_errors++;
+	}
+
+	*out_data = nullptr;
+	return false;
+}
+void reshade::null::device_impl::unmap_buffer_region(api::resource resource)
+{
+	validate_object(resource.handle, object_type::resource, "unmap_buffer_region");
+
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+	count_call(addon_event::unmap_buffer_region);
+}
+bool reshade::null::device_impl::map_texture_region(api::resource resource, uint32_t subresource, const api::subresource_box *box, api::map_access, api::subresource_data *out_data)
+{
+	if (out_data == nullptr)
+		return false;
+
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+	count_call(addon_event::map_texture_region);
+
+	// Only the first subresource of a texture has backing memory
+	if (const auto it = _resources.find(resource.handle);
+		it != _resources.end() && !it->second.memory.empty() && subresource == 0 && box == nullptr)
+	{
+		const api::resource_desc &desc = it->second.desc;
+
+		out_data->data = it->second.memory.data();
+		out_data->row_pitch = api::format_row_pitch(desc.texture.format, desc.texture.width);
+		out_data->slice_pitch = api::format_slice_pitch(desc.texture.format, out_data->row_pitch, desc.texture.height);
+		return true;
+	}
+
+	if (_validation)
+	{
+		log::message(log::level::error, "Attempted to map texture %#llx, which is invalid or not CPU accessible!", resource.handle);
+		_validation_errors++;
+	}
+
+	*out_data = {};
+	return false;
+}
+void reshade::null::device_impl::unmap_texture_region(api::resource resource, uint32_t)
+{
+	validate_object(resource.handle, object_type::resource, "unmap_texture_region");
+
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+	count_call(addon_event::unmap_texture_region);
+}
+
+void reshade::null::device_impl::update_buffer_region(const void *data, api::resource resource, uint64_t offset, uint64_t size)
+{
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+	count_call(addon_event::update_buffer_region);
+
+	// Keep contents of CPU accessible buffers up to date, so that mapping them afterwards returns the expected data
+	if (const auto it = _resources.find(resource.handle);
+		it != _resources.end() && data != nullptr && offset < it->second.memory.size())
+		std::memcpy(it->second.memory.data() + offset, data, static_cast<size_t>(std::min<uint64_t>(size, it->second.memory.size() - offset)));
+}
+void reshade::null::device_impl::update_texture_region(const api::subresource_data &, api::resource resource, uint32_t, const api::subresource_box *)
+{
+	validate_object(resource.handle, object_type::resource, "update_texture_region");
+
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+	count_call(addon_event::update_texture_region);
+}
+
+bool reshade::null::device_impl::create_pipeline(api::pipeline_layout layout, uint32_t, const api::pipeline_subobject *, api::pipeline *out_pipeline)
+{
+	validate_object(layout.handle, object_type::pipeline_layout, "create_pipeline");
+
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+	count_call(addon_event::create_pipeline);
+
+	*out_pipeline = { create_object(object_type::pipeline) };
+	return true;
+}
+void reshade::null::device_impl::destroy_pipeline(api::pipeline pipeline)
+{
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+	count_call(addon_event::destroy_pipeline);
+
+	destroy_object(pipeline.handle, object_type::pipeline);
+}
+
+bool reshade::null::device_impl::create_pipeline_layout(uint32_t, const api::pipeline_layout_param *, api::pipeline_layout *out_layout)
+{
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+	count_call(addon_event::create_pipeline_layout);
+
+	*out_layout = { create_object(object_type::pipeline_layout) };
+	return true;
+}
+void reshade::null::device_impl::destroy_pipeline_layout(api::pipeline_layout layout)
+{
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+	count_call(addon_event::destroy_pipeline_layout);
+
+	destroy_object(layout.handle, object_type::pipeline_layout);
+}
+
+bool reshade::null::device_impl::allocate_descriptor_tables(uint32_t count, api::pipeline_layout layout, uint32_t, api::descriptor_table *out_tables)
+{
+	validate_object(layout.handle, object_type::pipeline_layout, "allocate_descriptor_tables");
+
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+
+	for (uint32_t i = 0; i < count; ++i)
+		out_tables[i] = { create_object(object_type::descriptor_table) };
+	return true;
+}
+void reshade::null::device_impl::free_descriptor_tables(uint32_t count, const api::descriptor_table *tables)
+{
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+
+	for (uint32_t i = 0; i < count; ++i)
+		destroy_object(tables[i].handle, object_type::descriptor_table);
+}
+
+void reshade::null::device_impl::get_descriptor_heap_offset(api::descriptor_table table, uint32_t binding, uint32_t array_offset, api::descriptor_heap *out_heap, uint32_t *out_offset) const
+{
+	validate_object(table.handle, object_type::descriptor_table, "get_descriptor_heap_offset");
+
+	*out_heap = { 0 };
+	*out_offset = binding + array_offset;
+}
+
+void reshade::null::device_impl::copy_descriptor_tables(uint32_t count, const api::descriptor_table_copy *copies)
+{
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		validate_object(copies[i].source_table.handle, object_type::descriptor_table, "copy_descriptor_tables");
+		validate_object(copies[i].dest_table.handle, object_type::descriptor_table, "copy_descriptor_tables");
+	}
+
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+	count_call(addon_event::copy_descriptor_tables);
+}
+void reshade::null::device_impl::update_descriptor_tables(uint32_t count, const api::descriptor_table_update *updates)
+{
+	for (uint32_t i = 0; i < count; ++i)
+		validate_object(updates[i].table.handle, object_type::descriptor_table, "update_descriptor_tables");
+
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+	count_call(addon_event::update_descriptor_tables);
+}
+
+bool reshade::null::device_impl::create_query_heap(api::query_type, uint32_t, api::query_heap *out_heap)
+{
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+	count_call(addon_event::create_query_heap);
+
+	*out_heap = { create_object(object_type::query_heap) };
+	return true;
+}
+void reshade::null::device_impl::destroy_query_heap(api::query_heap heap)
+{
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+	count_call(addon_event::destroy_query_heap);
+
+	destroy_object(heap.handle, object_type::query_heap);
+}
+
+bool reshade::null::device_impl::get_query_heap_results(api::query_heap heap, uint32_t, uint32_t count, void *results, uint32_t stride)
+{
+	validate_object(heap.handle, object_type::query_heap, "get_query_heap_results");
+
+	// Nothing is ever executed, so all queries report zero
+	for (uint32_t i = 0; i < count; ++i)
+		std::memset(static_cast<uint8_t *>(results) + i * stride, 0, std::min(stride, static_cast<uint32_t>(sizeof(uint64_t))));
+	return true;
+}
+
+void reshade::null::device_impl::set_resource_name(api::resource resource, const char *)
+{
+	validate_object(resource.handle, object_type::resource, "set_resource_name");
+}
+void reshade::null::device_impl::set_resource_view_name(api::resource_view view, const char *)
+{
+	validate_object(view.handle, object_type::resource_view, "set_resource_view_name");
+}
+
+bool reshade::null::device_impl::create_fence(uint64_t initial_value, api::fence_flags, api::fence *out_fence, void **shared_handle)
+{
+	if (shared_handle != nullptr)
+		return false;
+
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+
+	*out_fence = { create_object(object_type::fence) };
+	_fences.emplace(out_fence->handle, initial_value);
+	return true;
+}
+void reshade::null::device_impl::destroy_fence(api::fence fence)
+{
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+
+	if (destroy_object(fence.handle, object_type::fence))
+		_fences.erase(fence.handle);
+}
+
+uint64_t reshade::null::device_impl::get_completed_fence_value(api::fence fence) const
+{
+	const std::shared_lock<std::shared_mutex> lock(_mutex);
+
+	if (const auto it = _fences.find(fence.handle); it != _fences.end())
+		return it->second;
+
+	return 0;
+}
+
+bool reshade::null::device_impl::wait(api::fence fence, uint64_t value, uint64_t)
+{
+	// Work completes instantly, so waiting can only fail if the value was never signaled
+	return get_completed_fence_value(fence) >= value;
+}
+bool reshade::null::device_impl::signal(api::fence fence, uint64_t value)
+{
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+
+	if (const auto it = _fences.find(fence.handle); it != _fences.end())
+	{
+		it->second = value;
+		return true;
+	}
+
+	return false;
+}
+
+void reshade::null::device_impl::get_acceleration_structure_size(api::acceleration_structure_type, api::acceleration_structure_build_flags, uint32_t, const api::acceleration_structure_build_input *, uint64_t *out_size, uint64_t *out_build_scratch_size, uint64_t *out_update_scratch_size) const
+{
+	if (out_size != nullptr)
+		*out_size = 0;
+	if (out_build_scratch_size != nullptr)
+		*out_build_scratch_size = 0;
+	if (out_update_scratch_size != nullptr)
+		*out_update_scratch_size = 0;
+}
+
+bool reshade::null::device_impl::get_pipeline_shader_group_handles(api::pipeline, uint32_t, uint32_t, void *)
+{
+	return false;
+}
+
+void reshade::null::device_impl::flush_immediate_command_list() const
+{
+	// There is nothing to execute, so simply start over with an empty command stream
+	_command_stream.clear();
+	_current_command_offset = 0;
+}
+
+void reshade::null::device_impl::reset_statistics()
+{
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+
+	std::fill_n(_call_counts.begin(), _call_counts.size(), 0);
+	_recorded_bytes = 0;
+	_validation_errors = 0;
+}
@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2026 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include "reshade_api_object_impl.hpp"
+#include "reshade_events.hpp"
+#include <array>
+#include <atomic>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <shared_mutex>
+
+namespace reshade::null
+{
+	/// <summary>
+	/// A device that does not talk to any graphics driver, but instead records all commands into a compact command stream and counts every call.
+	/// This makes it possible to run the effect runtime headless (e.g. to benchmark effect loading and per-frame costs), without any GPU work affecting the measurements.
+	/// </summary>
+	class device_impl : public api::api_object_impl<void *, api::device, api::command_queue, api::command_list>
+	{
+	public:
+		// Large enough to index with every 'addon_event' value
+		static constexpr size_t num_call_types = 128;
+
+		/// <summary>
+		/// Header of every command in the recorded command stream, followed by <see cref="size"/> bytes of arguments.
+		/// </summary>
+		struct command_header
+		{
+			addon_event type;
+			uint32_t size;
+		};
+
+		/// <param name="api">Graphics API to report to the runtime, which determines the shader code generator that is used when compiling effects.</param>
+		/// <param name="validation">Set to <see langword="true"/> to check that all objects passed to the device are valid and log errors for those that are not.</param>
+		device_impl(api::device_api api, bool validation);
+		~device_impl();
+
+		api::device_api get_api() const final { return _api; }
+
+		bool get_property(api::device_properties property, void *data) const final;
+
+		bool check_capability(api::device_caps capability) const final;
+		bool check_format_support(api::format format, api::resource_usage usage) const final;
+
+		bool create_sampler(const api::sampler_desc &desc, api::sampler *out_sampler) final;
+		void destroy_sampler(api::sampler sampler) final;
+
+		bool create_resource(const api::resource_desc &desc, const api::subresource_data *initial_data, api::resource_usage initial_state, api::resource *out_resource, void **shared_handle = nullptr) final;
+		void destroy_resource(api::resource resource) final;
+
+		api::resource_desc get_resource_desc(api::resource resource) const final;
+
+		bool create_resource_view(api::resource resource, api::resource_usage usage_type, const api::resource_view_desc &desc, api::resource_view *out_view) final;
+		void destroy_resource_view(api::resource_view view) final;
+
+		api::resource get_resource_from_view(api::resource_view view) const final;
+		api::resource_view_desc get_resource_view_desc(api::resource_view view) const final;
+
+		uint64_t get_resource_view_gpu_address(api::resource_view) const final { return 0; }
+
+		bool map_buffer_region(api::resource resource, uint64_t offset, uint64_t size, api::map_access access, void **out_data) final;
+		void unmap_buffer_region(api::resource resource) final;
+		bool map_texture_region(api::resource resource, uint32_t subresource, const api::subresource_box *box, api::map_access access, api::subresource_data *out_data) final;
+		void unmap_texture_region(api::resource resource, uint32_t subresource) final;
+
+		void update_buffer_region(const void *data, api::resource resource, uint64_t offset, uint64_t size) final;
+		void update_texture_region(const api::subresource_data &data, api::resource resource, uint32_t subresource, const api::subresource_box *box) final;
+
+		bool create_pipeline(api::pipeline_layout layout, uint32_t subobject_count, const api::pipeline_subobject *subobjects, api::pipeline *out_pipeline) final;
+		void destroy_pipeline(api::pipeline pipeline) final;
+
+		bool create_pipeline_layout(uint32_t param_count, const api::pipeline_layout_param *params, api::pipeline_layout *out_layout) final;
+		void destroy_pipeline_layout(api::pipeline_layout layout) final;
+
+		bool allocate_descriptor_tables(uint32_t count, api::pipeline_layout layout, uint32_t layout_param, api::descriptor_table *out_tables) final;
+		void free_descriptor_tables(uint32_t count, const api::descriptor_table *tables) final;
+
+		void get_descriptor_heap_offset(api::descriptor_table table, uint32_t binding, uint32_t array_offset, api::descriptor_heap *out_heap, uint32_t *out_offset) const final;
+
+		void copy_descriptor_tables(uint32_t count, const api::descriptor_table_copy *copies) final;
+		void update_descriptor_tables(uint32_t count, const api::descriptor_table_update *updates) final;
+
+		bool create_query_heap(api::query_type type, uint32_t count, api::query_heap *out_heap) final;
+		void destroy_query_heap(api::query_heap heap) final;
+
+		bool get_query_heap_results(api::query_heap heap, uint32_t first, uint32_t count, void *results, uint32_t stride) final;
+
+		void set_resource_name(api::resource resource, const char *name) final;
+		void set_resource_view_name(api::resource_view view, const char *name) final;
+
+		bool create_fence(uint64_t initial_value, api::fence_flags flags, api::fence *out_fence, void **shared_handle = nullptr) final;
+		void destroy_fence(api::fence fence) final;
+
+		uint64_t get_completed_fence_value(api::fence fence) const final;
+
+		bool wait(api::fence fence, uint64_t value, uint64_t timeout) final;
+		bool wait(api::fence fence, uint64_t value) final { return wait(fence, value, UINT64_MAX); }
+		bool signal(api::fence fence, uint64_t value) final;
+
+		void get_acceleration_structure_size(api::acceleration_structure_type type, api::acceleration_structure_build_flags flags, uint32_t input_count, const api::acceleration_structure_build_input *inputs, uint64_t *out_size, uint64_t *out_build_scratch_size, uint64_t *out_update_scratch_size) const final;
+
+		bool get_pipeline_shader_group_handles(api::pipeline pipeline, uint32_t first, uint32_t count, void *out_handles) final;
+
+		uint64_t get_timestamp_frequency() const final { return 0; }
+
+		api::device *get_device() final { return this; }
+
+		api::command_queue_type get_type() const final { return api::command_queue_type::graphics | api::command_queue_type::compute | api::command_queue_type::copy; }
+
+		void wait_idle() const final {}
+
+		void flush_immediate_command_list() const final;
+
+		api::command_list *get_immediate_command_list() final { return this; }
+
+		void barrier(uint32_t count, const api::resource *resources, const api::resource_usage *old_states, const api::resource_usage *new_states) final;
+
+		void begin_render_pass(uint32_t count, const api::render_pass_render_target_desc *rts, const api::render_pass_depth_stencil_desc *ds) final;
+		void end_render_pass() final;
+		void bind_render_targets_and_depth_stencil(uint32_t count, const api::resource_view *rtvs, api::resource_view dsv) final;
+
+		void bind_pipeline(api::pipeline_stage stages, api::pipeline pipeline) final;
+		void bind_pipeline_states(uint32_t count, const api::dynamic_state *states, const uint32_t *values) final;
+		void bind_viewports(uint32_t first, uint32_t count, const api::viewport *viewports) final;
+		void bind_scissor_rects(uint32_t first, uint32_t count, const api::rect *rects) final;
+
+		void push_constants(api::shader_stage stages, api::pipeline_layout layout, uint32_t layout_param, uint32_t first, uint32_t count, const void *values) final;
+		void push_descriptors(api::shader_stage stages, api::pipeline_layout layout, uint32_t layout_param, const api::descriptor_table_update &update) final;
+		void bind_descriptor_tables(api::shader_stage stages, api::pipeline_layout layout, uint32_t first, uint32_t count, const api::descriptor_table *tables) final;
+
+		void bind_index_buffer(api::resource buffer, uint64_t offset, uint32_t index_size) final;
+		void bind_vertex_buffers(uint32_t first, uint32_t count, const api::resource *buffers, const uint64_t *offsets, const uint32_t *strides) final;
+		void bind_stream_output_buffers(uint32_t first, uint32_t count, const api::resource *buffers, const uint64_t *offsets, const uint64_t *max_sizes, const api::resource *counter_buffers, const uint64_t *counter_offsets) final;
+
+		void draw(uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance) final;
+		void draw_indexed(uint32_t index_count, uint32_t instance_count, uint32_t first_index, int32_t vertex_offset, uint32_t first_instance) final;
+		void dispatch(uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z) final;
+		void dispatch_mesh(uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z) final;
+		void dispatch_rays(api::resource raygen, uint64_t raygen_offset, uint64_t raygen_size, api::resource miss, uint64_t miss_offset, uint64_t miss_size, uint64_t miss_stride, api::resource hit_group, uint64_t hit_group_offset, uint64_t hit_group_size, uint64_t hit_group_stride, api::resource callable, uint64_t callable_offset, uint64_t callable_size, uint64_t callable_stride, uint32_t width, uint32_t height, uint32_t depth) final;
+		void draw_or_dispatch_indirect(api::indirect_command type, api::resource buffer, uint64_t offset, uint32_t draw_count, uint32_t stride) final;
+
+		void copy_resource(api::resource source, api::resource dest) final;
+		void copy_buffer_region(api::resource source, uint64_t source_offset, api::resource dest, uint64_t dest_offset, uint64_t size) final;
+		void copy_buffer_to_texture(api::resource source, uint64_t source_offset, uint32_t row_length, uint32_t slice_height, api::resource dest, uint32_t dest_subresource, const api::subresource_box *dest_box) final;
+		void copy_texture_region(api::resource source, uint32_t source_subresource, const api::subresource_box *source_box, api::resource dest, uint32_t dest_subresource, const api::subresource_box *dest_box, api::filter_mode filter) final;
+		void copy_texture_to_buffer(api::resource source, uint32_t source_subresource, const api::subresource_box *source_box, api::resource dest, uint64_t dest_offset, uint32_t row_length, uint32_t slice_height) final;
+		void resolve_texture_region(api::resource source, uint32_t source_subresource, const api::subresource_box *source_box, api::resource dest, uint32_t dest_subresource, uint32_t dest_x, uint32_t dest_y, uint32_t dest_z, api::format format) final;
+
+		void clear_depth_stencil_view(api::resource_view dsv, const float *depth, const uint8_t *stencil, uint32_t rect_count, const api::rect *rects) final;
+		void clear_render_target_view(api::resource_view rtv, const float color[4], uint32_t rect_count, const api::rect *rects) final;
+		void clear_unordered_access_view_uint(api::resource_view uav, const uint32_t values[4], uint32_t rect_count, const api::rect *rects) final;
+		void clear_unordered_access_view_float(api::resource_view uav, const float values[4], uint32_t rect_count, const api::rect *rects) final;
+
+		void generate_mipmaps(api::resource_view srv) final;
+
+		void begin_query(api::query_heap heap, api::query_type type, uint32_t index) final;
+		void end_query(api::query_heap heap, api::query_type type, uint32_t index) final;
+		void copy_query_heap_results(api::query_heap heap, api::query_type type, uint32_t first, uint32_t count, api::resource dest, uint64_t dest_offset, uint32_t stride) final;
+
+		void copy_acceleration_structure(api::resource_view source, api::resource_view dest, api::acceleration_structure_copy_mode mode) final;
+		void build_acceleration_structure(api::acceleration_structure_type type, api::acceleration_structure_build_flags flags, uint32_t input_count, const api::acceleration_structure_build_input *inputs, api::resource scratch, uint64_t scratch_offset, api::resource_view source, api::resource_view dest, api::acceleration_structure_build_mode mode) final;
+		void query_acceleration_structures(uint32_t count, const api::resource_view *acceleration_structures, api::query_heap heap, api::query_type type, uint32_t first) final;
+
+		void begin_debug_event(const char *label, const float color[4]) final;
+		void end_debug_event() final;
+		void insert_debug_marker(const char *label, const float color[4]) final;
+
+		/// <summary>
+		/// Gets the number of times each call was made since the last <see cref="reset_statistics"/>, indexed by the corresponding <see cref="addon_event"/> value.
+		/// </summary>
+		const std::array<uint64_t, num_call_types> &get_call_counts() const { return _call_counts; }
+		/// <summary>
+		/// Gets the total amount of bytes that were recorded into the command stream since the last <see cref="reset_statistics"/>.
+		/// </summary>
+		uint64_t get_recorded_bytes() const { return _recorded_bytes; }
+		/// <summary>
+		/// Gets the number of invalid objects or calls that were found with validation enabled.
+		/// </summary>
+		uint64_t get_validation_errors() const { return _validation_errors; }
+
+		/// <summary>
+		/// Gets the commands that were recorded since the last flush of the immediate command list.
+		/// </summary>
+		const std::vector<uint8_t> &get_command_stream() const { return _command_stream; }
+
+		void reset_statistics();
+
+	private:
+		enum class object_type : uint8_t
+		{
+			sampler,
+			resource,
+			resource_view,
+			pipeline,
+			pipeline_layout,
+			descriptor_table,
+			query_heap,
+			fence
+		};
+
+		struct resource_data
+		{
+			api::resource_desc desc;
+			// Only resources that can be mapped have backing memory
+			std::vector<uint8_t> memory;
+		};
+		struct resource_view_data
+		{
+			api::resource resource;
+			api::resource_view_desc desc;
+		};
+
+		// Allocates a new handle and registers it as a live object of the specified type
+		uint64_t create_object(object_type type);
+		// Unregisters a handle, returning whether it was a live object of the specified type
+		bool destroy_object(uint64_t handle, object_type type);
+		// Checks that the handle refers to a live object of the specified type (null handles are always valid)
+		void validate_object(uint64_t handle, object_type type, const char *call) const;
+
+		void count_call(addon_event type) { _call_counts[static_cast<size_t>(type)]++; }
+
+		template <typename T>
+		void record_arg(const T &value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			record_data(&value, sizeof(value));
+		}
+		template <typename T>
+		void record_array(const T *values, uint32_t count)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			record_arg(count);
+			if (values != nullptr)
+				record_data(values, count * sizeof(T));
+		}
+		void record_data(const void *data, size_t size);
+		// Starts a new command in the command stream, which all following 'record_arg' and 'record_array' calls append to
+		void begin_command(addon_event type);
+
+		const api::device_api _api;
+		const bool _validation;
+
+		mutable std::shared_mutex _mutex;
+		uint64_t _next_handle = 1;
+		std::unordered_map<uint64_t, object_type> _objects;
+		std::unordered_map<uint64_t, resource_data> _resources;
+		std::unordered_map<uint64_t, resource_view_data> _resource_views;
+		std::unordered_map<uint64_t, uint64_t> _fences;
+
+		// Flushing the immediate command list discards everything recorded so far, which is allowed on a const queue
+		mutable std::vector<uint8_t> _command_stream;
+		mutable size_t _current_command_offset = 0;
+		uint32_t _render_pass_depth = 0;
+
+		std::array<uint64_t, num_call_types> _call_counts = {};
+		uint64_t _recorded_bytes = 0;
+		mutable std::atomic<uint64_t> _validation_errors = 0;
+	};
+}
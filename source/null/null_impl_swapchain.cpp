@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2026 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "null_impl_swapchain.hpp"
+#include <cassert>
+
+reshade::null::swapchain_impl::swapchain_impl(device_impl *device, uint32_t width, uint32_t height, api::format format, uint32_t back_buffer_count) :
+	api_object_impl(nullptr),
+	_device_impl(device),
+	_back_buffers(back_buffer_count)
+{
+	for (api::resource &back_buffer : _back_buffers)
+	{
+		if (!_device_impl->create_resource(
+				api::resource_desc(width, height, 1, 1, format, 1, api::memory_heap::gpu_only, api::resource_usage::render_target | api::resource_usage::copy_source | api::resource_usage::copy_dest),
+				nullptr, api::resource_usage::present, &back_buffer))
+			assert(false);
+	}
+}
+reshade::null::swapchain_impl::~swapchain_impl()
+{
+	for (const api::resource back_buffer : _back_buffers)
+		_device_impl->destroy_resource(back_buffer);
+}
+
+void reshade::null::swapchain_impl::present()
+{
+	_back_buffer_index = (_back_buffer_index + 1) % static_cast<uint32_t>(_back_buffers.size());
+
+	_device_impl->flush_immediate_command_list();
+}
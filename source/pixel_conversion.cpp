@@ -0,0 +1,1040 @@
+/*
+ * Copyright (C) 2026 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "pixel_conversion.hpp"
+#include <cmath> // std::nearbyint, std::pow
+#include <cstring> // std::memcpy
+#include <atomic>
+#include <algorithm> // std::max, std::min
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define RESHADE_PIXEL_CONVERSION_SSE2 1
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h> // __cpuid, __cpuidex
+	#else
+		#include <cpuid.h>
+	#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+	#define RESHADE_PIXEL_CONVERSION_NEON 1
+	#include <arm_neon.h>
+#endif
+
+using namespace reshade::pixel_conversion;
+
+// PQ constants as per Rec. ITU-R BT.2100-3 Table 4
+static constexpr float s_pq_m1 = 0.1593017578125f;
+static constexpr float s_pq_m2 = 78.84375f;
+static constexpr float s_pq_c1 = 0.8359375f;
+static constexpr float s_pq_c2 = 18.8515625f;
+static constexpr float s_pq_c3 = 18.6875f;
+
+// Rows are the contribution of the BT.709 red, green and blue channels to the BT.2020 red, green and blue channels
+static constexpr float s_bt709_to_bt2020[3][3] = {
+	{ 0.627403914928436279296875f,     0.069097287952899932861328125f,    0.01639143936336040496826171875f },
+	{ 0.3292830288410186767578125f,    0.9195404052734375f,               0.08801330626010894775390625f    },
+	{ 0.0433130674064159393310546875f, 0.011362315155565738677978515625f, 0.895595252513885498046875f      },
+};
+
+#pragma region Scalar
+static void convert_rgba8_scalar(uint8_t *dst, const uint8_t *src, size_t count, bool swap_rb, bool opaque)
+{
+	for (size_t i = 0; i < count; ++i, dst += 4, src += 4)
+	{
+		const uint8_t r = src[0], g = src[1], b = src[2], a = src[3];
+		dst[0] = swap_rb ? b : r;
+		dst[1] = g;
+		dst[2] = swap_rb ? r : b;
+		dst[3] = opaque ? 0xFF : a;
+	}
+}
+static void expand_r8_to_rgba8_scalar(uint8_t *dst, const uint8_t *src, size_t count)
+{
+	for (size_t i = 0; i < count; ++i, dst += 4)
+	{
+		dst[0] = src[i];
+		dst[1] = 0;
+		dst[2] = 0;
+		dst[3] = 0xFF;
+	}
+}
+static void expand_rg8_to_rgba8_scalar(uint8_t *dst, const uint8_t *src, size_t count)
+{
+	for (size_t i = 0; i < count; ++i, dst += 4, src += 2)
+	{
+		dst[0] = src[0];
+		dst[1] = src[1];
+		dst[2] = 0;
+		dst[3] = 0xFF;
+	}
+}
+
+// The packing functions iterate forwards, so that converting in place never overwrites a source pixel before it was read
+template <size_t src_channels, size_t dst_channels, typename T>
+static void pack_channels_scalar(T *dst, const T *src, size_t count)
+{
+	for (size_t i = 0; i < count; ++i, dst += dst_channels, src += src_channels)
+		for (size_t c = 0; c < dst_channels; ++c)
+			dst[c] = src[c];
+}
+
+static void unpack_rgb10a2_to_rgba8_scalar(uint8_t *dst, const uint32_t *src, size_t count, bool swap_rb)
+{
+	for (size_t i = 0; i < count; ++i, dst += 4)
+	{
+		const uint32_t rgba = src[i];
+		// Drop the lower two bits to get 10-bit range (0-1023) into 8-bit range (0-255)
+		const uint8_t c0 = static_cast<uint8_t>((rgba >>  2) & 0xFF);
+		const uint8_t c1 = static_cast<uint8_t>((rgba >> 12) & 0xFF);
+		const uint8_t c2 = static_cast<uint8_t>((rgba >> 22) & 0xFF);
+		dst[0] = swap_rb ? c2 : c0;
+		dst[1] = c1;
+		dst[2] = swap_rb ? c0 : c2;
+		dst[3] = static_cast<uint8_t>((rgba >> 30) * 85);
+	}
+}
+static void unpack_rgb10a2_to_rgb16_scalar(uint16_t *dst, const uint32_t *src, size_t count, bool swap_rb)
+{
+	for (size_t i = 0; i < count; ++i, dst += 3)
+	{
+		const uint32_t rgba = src[i];
+		// Multiply by 64 to get 10-bit range (0-1023) into 16-bit range (0-65535)
+		const uint16_t c0 = static_cast<uint16_t>(( rgba        & 0x3FF) << 6);
+		const uint16_t c1 = static_cast<uint16_t>(((rgba >> 10) & 0x3FF) << 6);
+		const uint16_t c2 = static_cast<uint16_t>(((rgba >> 20) & 0x3FF) << 6);
+		dst[0] = swap_rb ? c2 : c0;
+		dst[1] = c1;
+		dst[2] = swap_rb ? c0 : c2;
+	}
+}
+static void swap_rb_rgb10a2_scalar(uint32_t *dst, const uint32_t *src, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		const uint32_t rgba = src[i];
+		dst[i] = ((rgba & 0x000003FFu) << 20) | ((rgba & 0x3FF00000u) >> 20) | (rgba & 0xC00FFC00u);
+	}
+}
+
+static float half_to_float(uint16_t h)
+{
+	uint32_t bits = static_cast<uint32_t>(h & 0x8000) << 16;
+
+	uint32_t exponent = (h >> 10) & 0x1F;
+	uint32_t mantissa = h & 0x3FF;
+	if (exponent == 0x1F)
+	{
+		// Infinity or NaN (keeping the payload)
+		bits |= 0x7F800000 | (mantissa << 13);
+	}
+	else if (exponent != 0)
+	{
+		bits |= ((exponent + (127 - 15)) << 23) | (mantissa << 13);
+	}
+	else if (mantissa != 0)
+	{
+		// Denormals become normalized values in single precision
+		exponent = 127 - 15 + 1;
+		do
+		{
+			mantissa <<= 1;
+			exponent--;
+		} while ((mantissa & 0x400) == 0);
+
+		bits |= (exponent << 23) | ((mantissa & 0x3FF) << 13);
+	}
+
+	float result;
+	std::memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+static void convert_half_to_float_scalar(float *dst, const uint16_t *src, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+		dst[i] = half_to_float(src[i]);
+}
+
+static uint16_t encode_pq_scalar(float value)
+{
+	// Normalize so that 1.0 is 10000 nits (scRGB 1.0 is 80 nits), values above are clipped anyway by the transfer function
+	// Argument order makes NaN map to zero, same as with the vectorized maximum
+	const float x = std::min(std::max(0.0f, value / 125.0f), 1.0f);
+
+	const float p = std::pow(x, s_pq_m1);
+	float v = std::pow((s_pq_c2 * p + s_pq_c1) / (s_pq_c3 * p + 1.0f), s_pq_m2);
+
+	// Saturate to the 16-bit range before rounding, so that the vectorized implementations can do the same in floating-point
+	v = std::min(v * 65536.0f, 65535.0f);
+	return static_cast<uint16_t>(std::nearbyint(v));
+}
+static void encode_scrgb_half_to_hdr10_pq_scalar(uint16_t *dst, const uint16_t *src, size_t count)
+{
+	for (size_t i = 0; i < count; ++i, dst += 3, src += 3)
+	{
+		const float r = half_to_float(src[0]);
+		const float g = half_to_float(src[1]);
+		const float b = half_to_float(src[2]);
+
+		// Operation order matches the vectorized implementations, so that only the power function differs
+		dst[0] = encode_pq_scalar(r * s_bt709_to_bt2020[0][0] + (g * s_bt709_to_bt2020[1][0] + b * s_bt709_to_bt2020[2][0]));
+		dst[1] = encode_pq_scalar(r * s_bt709_to_bt2020[0][1] + (g * s_bt709_to_bt2020[1][1] + b * s_bt709_to_bt2020[2][1]));
+		dst[2] = encode_pq_scalar(r * s_bt709_to_bt2020[0][2] + (g * s_bt709_to_bt2020[1][2] + b * s_bt709_to_bt2020[2][2]));
+	}
+}
+#pragma endregion
+
+#pragma region SSE2
+#if RESHADE_PIXEL_CONVERSION_SSE2
+static void convert_rgba8_sse2(uint8_t *dst, const uint8_t *src, size_t count, bool swap_rb, bool opaque)
+{
+	const __m128i alpha = _mm_set1_epi32(opaque ? static_cast<int>(0xFF000000) : 0);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+		if (swap_rb)
+			v = _mm_or_si128(_mm_and_si128(v, _mm_set1_epi32(static_cast<int>(0xFF00FF00))), _mm_or_si128(_mm_and_si128(_mm_srli_epi32(v, 16), _mm_set1_epi32(0x000000FF)), _mm_and_si128(_mm_slli_epi32(v, 16), _mm_set1_epi32(0x00FF0000))));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), _mm_or_si128(v, alpha));
+	}
+
+	convert_rgba8_scalar(dst + i * 4, src + i * 4, count - i, swap_rb, opaque);
+}
+static void expand_r8_to_rgba8_sse2(uint8_t *dst, const uint8_t *src, size_t count)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+		const __m128i lo = _mm_unpacklo_epi8(v, zero);
+		const __m128i hi = _mm_unpackhi_epi8(v, zero);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4 +  0), _mm_or_si128(_mm_unpacklo_epi16(lo, zero), alpha));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4 + 16), _mm_or_si128(_mm_unpackhi_epi16(lo, zero), alpha));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4 + 32), _mm_or_si128(_mm_unpacklo_epi16(hi, zero), alpha));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4 + 48), _mm_or_si128(_mm_unpackhi_epi16(hi, zero), alpha));
+	}
+
+	expand_r8_to_rgba8_scalar(dst + i * 4, src + i, count - i);
+}
+static void expand_rg8_to_rgba8_sse2(uint8_t *dst, const uint8_t *src, size_t count)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 2));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4 +  0), _mm_or_si128(_mm_unpacklo_epi16(v, zero), alpha));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4 + 16), _mm_or_si128(_mm_unpackhi_epi16(v, zero), alpha));
+	}
+
+	expand_rg8_to_rgba8_scalar(dst + i * 4, src + i * 2, count - i);
+}
+
+// All source pixels of an iteration are loaded before anything is stored, and stores never reach past the source data of the next iteration, so the packing functions work in place
+static void pack_rgba8_to_r8_sse2(uint8_t *dst, const uint8_t *src, size_t count)
+{
+	const __m128i mask = _mm_set1_epi32(0xFF);
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		const __m128i a = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4 +  0)), mask);
+		const __m128i b = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4 + 16)), mask);
+		const __m128i c = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4 + 32)), mask);
+		const __m128i d = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4 + 48)), mask);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+	}
+
+	pack_channels_scalar<4, 1>(dst + i, src + i * 4, count - i);
+}
+static void pack_rgba8_to_rg8_sse2(uint8_t *dst, const uint8_t *src, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		// Sign extend the lower 16 bits, so that the saturating pack reproduces them exactly
+		const __m128i a = _mm_srai_epi32(_mm_slli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4 +  0)), 16), 16);
+		const __m128i b = _mm_srai_epi32(_mm_slli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4 + 16)), 16), 16);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 2), _mm_packs_epi32(a, b));
+	}
+
+	pack_channels_scalar<4, 2>(dst + i * 2, src + i * 4, count - i);
+}
+static void pack_rgba32f_to_r32f_sse2(float *dst, const float *src, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 a = _mm_loadu_ps(src + i * 4 +  0);
+		const __m128 b = _mm_loadu_ps(src + i * 4 +  4);
+		const __m128 c = _mm_loadu_ps(src + i * 4 +  8);
+		const __m128 d = _mm_loadu_ps(src + i * 4 + 12);
+		_mm_storeu_ps(dst + i, _mm_movelh_ps(_mm_unpacklo_ps(a, b), _mm_unpacklo_ps(c, d)));
+	}
+
+	pack_channels_scalar<4, 1>(dst + i, src + i * 4, count - i);
+}
+static void pack_rgba32f_to_rg32f_sse2(float *dst, const float *src, size_t count)
+{
+	size_t i = 0;
+	for (; i + 2 <= count; i += 2)
+	{
+		const __m128 a = _mm_loadu_ps(src + i * 4 + 0);
+		const __m128 b = _mm_loadu_ps(src + i * 4 + 4);
+		_mm_storeu_ps(dst + i * 2, _mm_movelh_ps(a, b));
+	}
+
+	pack_channels_scalar<4, 2>(dst + i * 2, src + i * 4, count - i);
+}
+
+static void unpack_rgb10a2_to_rgba8_sse2(uint8_t *dst, const uint32_t *src, size_t count, bool swap_rb)
+{
+	const __m128i mask = _mm_set1_epi32(0xFF);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+		const __m128i c0 = _mm_and_si128(_mm_srli_epi32(v,  2), mask);
+		const __m128i c1 = _mm_and_si128(_mm_srli_epi32(v, 12), mask);
+		const __m128i c2 = _mm_and_si128(_mm_srli_epi32(v, 22), mask);
+		// Alpha is at most 3, so multiplying by 85 is the same as repeating its two bits four times
+		__m128i a = _mm_srli_epi32(v, 30);
+		a = _mm_or_si128(a, _mm_slli_epi32(a, 2));
+		a = _mm_or_si128(a, _mm_slli_epi32(a, 4));
+
+		const __m128i r = swap_rb ? c2 : c0;
+		const __m128i b = swap_rb ? c0 : c2;
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(c1, 8)), _mm_or_si128(_mm_slli_epi32(b, 16), _mm_slli_epi32(a, 24))));
+	}
+
+	unpack_rgb10a2_to_rgba8_scalar(dst + i * 4, src + i, count - i, swap_rb);
+}
+static void swap_rb_rgb10a2_sse2(uint32_t *dst, const uint32_t *src, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+			_mm_or_si128(_mm_and_si128(v, _mm_set1_epi32(static_cast<int>(0xC00FFC00))), _mm_or_si128(_mm_slli_epi32(_mm_and_si128(v, _mm_set1_epi32(0x000003FF)), 20), _mm_srli_epi32(_mm_and_si128(v, _mm_set1_epi32(0x3FF00000)), 20))));
+	}
+
+	swap_rb_rgb10a2_scalar(dst + i, src + i, count - i);
+}
+
+// Converts the 16-bit floating-point values in the lower half of every 32-bit lane to 32-bit floating-point values, without requiring F16C
+// See https://fgiesen.wordpress.com/2012/03/28/half-to-float-done-quic/
+static __m128 half_to_float_sse2(__m128i h)
+{
+	const __m128i expmant = _mm_and_si128(h, _mm_set1_epi32(0x7FFF));
+	const __m128i sign = _mm_slli_epi32(_mm_xor_si128(h, expmant), 16);
+	// Shift exponent and mantissa into place and rebias the exponent with a multiplication, which also normalizes denormals
+	const __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(expmant, 13)), _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23)));
+	// Infinity and NaN need the maximum exponent instead
+	const __m128 infnan = _mm_and_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(expmant, _mm_set1_epi32(0x7BFF))), _mm_castsi128_ps(_mm_set1_epi32(255 << 23)));
+	return _mm_or_ps(scaled, _mm_or_ps(_mm_castsi128_ps(sign), infnan));
+}
+static void convert_half_to_float_sse2(float *dst, const uint16_t *src, size_t count)
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+		_mm_storeu_ps(dst + i + 0, half_to_float_sse2(_mm_unpacklo_epi16(v, zero)));
+		_mm_storeu_ps(dst + i + 4, half_to_float_sse2(_mm_unpackhi_epi16(v, zero)));
+	}
+
+	convert_half_to_float_scalar(dst + i, src + i, count - i);
+}
+
+// Approximates the base-2 logarithm of positive normal values
+// Uses the series ln(m) = 2 * atanh((m - 1) / (m + 1)) with the mantissa moved into [sqrt(0.5), sqrt(2)), which is accurate to about one unit in the last place
+static __m128 log2_sse2(__m128 x)
+{
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	const __m128i bits = _mm_castps_si128(x);
+	__m128i exponent = _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127));
+	__m128 mantissa = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_castps_si128(one)));
+
+	const __m128 above_sqrt2 = _mm_cmpgt_ps(mantissa, _mm_set1_ps(1.41421356f));
+	mantissa = _mm_or_ps(_mm_andnot_ps(above_sqrt2, mantissa), _mm_and_ps(above_sqrt2, _mm_mul_ps(mantissa, _mm_set1_ps(0.5f))));
+	exponent = _mm_sub_epi32(exponent, _mm_castps_si128(above_sqrt2)); // Mask is -1, so this adds one
+
+	const __m128 t = _mm_div_ps(_mm_sub_ps(mantissa, one), _mm_add_ps(mantissa, one));
+	const __m128 t2 = _mm_mul_ps(t, t);
+	__m128 poly = _mm_set1_ps(1.0f / 9.0f);
+	poly = _mm_add_ps(_mm_mul_ps(poly, t2), _mm_set1_ps(1.0f / 7.0f));
+	poly = _mm_add_ps(_mm_mul_ps(poly, t2), _mm_set1_ps(1.0f / 5.0f));
+	poly = _mm_add_ps(_mm_mul_ps(poly, t2), _mm_set1_ps(1.0f / 3.0f));
+	poly = _mm_add_ps(_mm_mul_ps(poly, t2), one);
+
+	return _mm_add_ps(_mm_cvtepi32_ps(exponent), _mm_mul_ps(_mm_mul_ps(t, poly), _mm_set1_ps(2.0f / 0.693147180559945309f)));
+}
+// Approximates two to the power of the input, using a polynomial for the fractional part
+static __m128 exp2_sse2(__m128 y)
+{
+	y = _mm_min_ps(_mm_max_ps(y, _mm_set1_ps(-126.0f)), _mm_set1_ps(127.0f));
+
+	const __m128i n = _mm_cvtps_epi32(y);
+	const __m128 f = _mm_sub_ps(y, _mm_cvtepi32_ps(n));
+
+	__m128 poly = _mm_set1_ps(1.5252733804059840e-5f);
+	poly = _mm_add_ps(_mm_mul_ps(poly, f), _mm_set1_ps(1.5403530393381606e-4f));
+	poly = _mm_add_ps(_mm_mul_ps(poly, f), _mm_set1_ps(1.3333558146428443e-3f));
+	poly = _mm_add_ps(_mm_mul_ps(poly, f), _mm_set1_ps(9.6181291076284772e-3f));
+	poly = _mm_add_ps(_mm_mul_ps(poly, f), _mm_set1_ps(5.5504108664821580e-2f));
+	poly = _mm_add_ps(_mm_mul_ps(poly, f), _mm_set1_ps(2.4022650695910071e-1f));
+	poly = _mm_add_ps(_mm_mul_ps(poly, f), _mm_set1_ps(6.9314718055994531e-1f));
+	poly = _mm_add_ps(_mm_mul_ps(poly, f), _mm_set1_ps(1.0f));
+
+	return _mm_mul_ps(poly, _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23)));
+}
+static __m128i encode_pq_sse2(__m128 value)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	const __m128 x = _mm_min_ps(_mm_max_ps(_mm_div_ps(value, _mm_set1_ps(125.0f)), zero), one);
+
+	// Power of zero is zero, but the logarithm approximation does not handle it
+	const __m128 p = _mm_andnot_ps(_mm_cmpeq_ps(x, zero), exp2_sse2(_mm_mul_ps(log2_sse2(x), _mm_set1_ps(s_pq_m1))));
+	const __m128 v = _mm_div_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(s_pq_c2), p), _mm_set1_ps(s_pq_c1)), _mm_add_ps(_mm_mul_ps(_mm_set1_ps(s_pq_c3), p), one));
+
+	return _mm_cvtps_epi32(_mm_min_ps(_mm_mul_ps(exp2_sse2(_mm_mul_ps(log2_sse2(v), _mm_set1_ps(s_pq_m2))), _mm_set1_ps(65536.0f)), _mm_set1_ps(65535.0f)));
+}
+// Converts four RGB pixels stored as 'r0 g0 b0 r1 | g1 b1 r2 g2 | b2 r3 g3 b3' to one register per channel
+static void deinterleave_rgb_sse2(__m128 a, __m128 b, __m128 c, __m128 &r, __m128 &g, __m128 &bl)
+{
+	r  = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 2, 3, 0)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 1, 0));
+	g  = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+	bl = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+static void store_rgb16(uint16_t *dst, __m128i r, __m128i g, __m128i b, size_t count)
+{
+	alignas(16) int32_t channels[3][4];
+	_mm_store_si128(reinterpret_cast<__m128i *>(channels[0]), r);
+	_mm_store_si128(reinterpret_cast<__m128i *>(channels[1]), g);
+	_mm_store_si128(reinterpret_cast<__m128i *>(channels[2]), b);
+
+	for (size_t k = 0; k < count; ++k, dst += 3)
+	{
+		dst[0] = static_cast<uint16_t>(channels[0][k]);
+		dst[1] = static_cast<uint16_t>(channels[1][k]);
+		dst[2] = static_cast<uint16_t>(channels[2][k]);
+	}
+}
+static void encode_bt2020_pq_sse2(uint16_t *dst, __m128 r, __m128 g, __m128 b)
+{
+	const auto transform = [r, g, b](int c) {
+		return _mm_max_ps(_mm_setzero_ps(), _mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(s_bt709_to_bt2020[0][c])), _mm_add_ps(_mm_mul_ps(g, _mm_set1_ps(s_bt709_to_bt2020[1][c])), _mm_mul_ps(b, _mm_set1_ps(s_bt709_to_bt2020[2][c])))));
+	};
+
+	store_rgb16(dst, encode_pq_sse2(transform(0)), encode_pq_sse2(transform(1)), encode_pq_sse2(transform(2)), 4);
+}
+static void encode_scrgb_half_to_hdr10_pq_sse2(uint16_t *dst, const uint16_t *src, size_t count)
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i v0 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i * 3 + 0));
+		const __m128i v1 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i * 3 + 4));
+		const __m128i v2 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i * 3 + 8));
+
+		__m128 r, g, b;
+		deinterleave_rgb_sse2(half_to_float_sse2(_mm_unpacklo_epi16(v0, zero)), half_to_float_sse2(_mm_unpacklo_epi16(v1, zero)), half_to_float_sse2(_mm_unpacklo_epi16(v2, zero)), r, g, b);
+
+		encode_bt2020_pq_sse2(dst + i * 3, r, g, b);
+	}
+
+	encode_scrgb_half_to_hdr10_pq_scalar(dst + i * 3, src + i * 3, count - i);
+}
+#endif
+#pragma endregion
+
+#pragma region AVX2
+#if RESHADE_PIXEL_CONVERSION_SSE2
+#if defined(__clang__)
+	#pragma clang attribute push(__attribute__((target("avx2,f16c"))), apply_to = function)
+#elif defined(__GNUC__)
+	#pragma GCC push_options
+	#pragma GCC target("avx2,f16c")
+#endif
+
+static void convert_rgba8_avx2(uint8_t *dst, const uint8_t *src, size_t count, bool swap_rb, bool opaque)
+{
+	const __m256i alpha = _mm256_set1_epi32(opaque ? static_cast<int>(0xFF000000) : 0);
+	const __m256i shuffle = swap_rb ?
+		_mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15, 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15) :
+		_mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i * 4));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 4), _mm256_or_si256(_mm256_shuffle_epi8(v, shuffle), alpha));
+	}
+
+	convert_rgba8_sse2(dst + i * 4, src + i * 4, count - i, swap_rb, opaque);
+}
+
+// The 16 byte stores below write a few bytes past the packed pixels, which is fine as long as the loop stops early enough to not write past the end of the destination and those bytes are overwritten in the next iteration
+static void pack_rgba8_to_rgb8_avx2(uint8_t *dst, const uint8_t *src, size_t count)
+{
+	const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+	size_t i = 0;
+	for (; i + 6 <= count; i += 4)
+	{
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 3), _mm_shuffle_epi8(v, shuffle));
+	}
+
+	pack_channels_scalar<4, 3>(dst + i * 3, src + i * 4, count - i);
+}
+static void pack_rgba16_to_rgb16_avx2(uint16_t *dst, const uint16_t *src, size_t count)
+{
+	const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 8, 9, 10, 11, 12, 13, -1, -1, -1, -1);
+
+	size_t i = 0;
+	for (; i + 3 <= count; i += 2)
+	{
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 3), _mm_shuffle_epi8(v, shuffle));
+	}
+
+	pack_channels_scalar<4, 3>(dst + i * 3, src + i * 4, count - i);
+}
+
+static void convert_half_to_float_avx2(float *dst, const uint16_t *src, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+		_mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i))));
+
+	convert_half_to_float_sse2(dst + i, src + i, count - i);
+}
+
+// Same as the SSE2 versions above, just eight values at a time
+static __m256 log2_avx2(__m256 x)
+{
+	const __m256 one = _mm256_set1_ps(1.0f);
+
+	const __m256i bits = _mm256_castps_si256(x);
+	__m256i exponent = _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127));
+	__m256 mantissa = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)), _mm256_castps_si256(one)));
+
+	const __m256 above_sqrt2 = _mm256_cmp_ps(mantissa, _mm256_set1_ps(1.41421356f), _CMP_GT_OQ);
+	mantissa = _mm256_blendv_ps(mantissa, _mm256_mul_ps(mantissa, _mm256_set1_ps(0.5f)), above_sqrt2);
+	exponent = _mm256_sub_epi32(exponent, _mm256_castps_si256(above_sqrt2));
+
+	const __m256 t = _mm256_div_ps(_mm256_sub_ps(mantissa, one), _mm256_add_ps(mantissa, one));
+	const __m256 t2 = _mm256_mul_ps(t, t);
+	__m256 poly = _mm256_set1_ps(1.0f / 9.0f);
+	poly = _mm256_add_ps(_mm256_mul_ps(poly, t2), _mm256_set1_ps(1.0f / 7.0f));
+	poly = _mm256_add_ps(_mm256_mul_ps(poly, t2), _mm256_set1_ps(1.0f / 5.0f));
+	poly = _mm256_add_ps(_mm256_mul_ps(poly, t2), _mm256_set1_ps(1.0f / 3.0f));
+	poly = _mm256_add_ps(_mm256_mul_ps(poly, t2), one);
+
+	return _mm256_add_ps(_mm256_cvtepi32_ps(exponent), _mm256_mul_ps(_mm256_mul_ps(t, poly), _mm256_set1_ps(2.0f / 0.693147180559945309f)));
+}
+static __m256 exp2_avx2(__m256 y)
+{
+	y = _mm256_min_ps(_mm256_max_ps(y, _mm256_set1_ps(-126.0f)), _mm256_set1_ps(127.0f));
+
+	const __m256i n = _mm256_cvtps_epi32(y);
+	const __m256 f = _mm256_sub_ps(y, _mm256_cvtepi32_ps(n));
+
+	__m256 poly = _mm256_set1_ps(1.5252733804059840e-5f);
+	poly = _mm256_add_ps(_mm256_mul_ps(poly, f), _mm256_set1_ps(1.5403530393381606e-4f));
+	poly = _mm256_add_ps(_mm256_mul_ps(poly, f), _mm256_set1_ps(1.3333558146428443e-3f));
+	poly = _mm256_add_ps(_mm256_mul_ps(poly, f), _mm256_set1_ps(9.6181291076284772e-3f));
+	poly = _mm256_add_ps(_mm256_mul_ps(poly, f), _mm256_set1_ps(5.5504108664821580e-2f));
+	poly = _mm256_add_ps(_mm256_mul_ps(poly, f), _mm256_set1_ps(2.4022650695910071e-1f));
+	poly = _mm256_add_ps(_mm256_mul_ps(poly, f), _mm256_set1_ps(6.9314718055994531e-1f));
+	poly = _mm256_add_ps(_mm256_mul_ps(poly, f), _mm256_set1_ps(1.0f));
+
+	return _mm256_mul_ps(poly, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(n, _mm256_set1_epi32(127)), 23)));
+}
+static __m256i encode_pq_avx2(__m256 value)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+
+	const __m256 x = _mm256_min_ps(_mm256_max_ps(_mm256_div_ps(value, _mm256_set1_ps(125.0f)), zero), one);
+
+	const __m256 p = _mm256_andnot_ps(_mm256_cmp_ps(x, zero, _CMP_EQ_OQ), exp2_avx2(_mm256_mul_ps(log2_avx2(x), _mm256_set1_ps(s_pq_m1))));
+	const __m256 v = _mm256_div_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(s_pq_c2), p), _mm256_set1_ps(s_pq_c1)), _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(s_pq_c3), p), one));
+
+	return _mm256_cvtps_epi32(_mm256_min_ps(_mm256_mul_ps(exp2_avx2(_mm256_mul_ps(log2_avx2(v), _mm256_set1_ps(s_pq_m2))), _mm256_set1_ps(65536.0f)), _mm256_set1_ps(65535.0f)));
+}
+static void encode_scrgb_half_to_hdr10_pq_avx2(uint16_t *dst, const uint16_t *src, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		// Convert two groups of four pixels with F16C and combine them after deinterleaving
+		__m128 r[2], g[2], b[2];
+		for (size_t k = 0; k < 2; ++k)
+		{
+			const uint16_t *const group = src + (i + k * 4) * 3;
+			deinterleave_rgb_sse2(
+				_mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(group + 0))),
+				_mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(group + 4))),
+				_mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(group + 8))),
+				r[k], g[k], b[k]);
+		}
+
+		const __m256 r8 = _mm256_insertf128_ps(_mm256_castps128_ps256(r[0]), r[1], 1);
+		const __m256 g8 = _mm256_insertf128_ps(_mm256_castps128_ps256(g[0]), g[1], 1);
+		const __m256 b8 = _mm256_insertf128_ps(_mm256_castps128_ps256(b[0]), b[1], 1);
+
+		__m256i channels[3];
+		for (int c = 0; c < 3; ++c)
+			channels[c] = encode_pq_avx2(_mm256_max_ps(_mm256_setzero_ps(), _mm256_add_ps(_mm256_mul_ps(r8, _mm256_set1_ps(s_bt709_to_bt2020[0][c])), _mm256_add_ps(_mm256_mul_ps(g8, _mm256_set1_ps(s_bt709_to_bt2020[1][c])), _mm256_mul_ps(b8, _mm256_set1_ps(s_bt709_to_bt2020[2][c]))))));
+
+		store_rgb16(dst + (i + 0) * 3, _mm256_castsi256_si128(channels[0]), _mm256_castsi256_si128(channels[1]), _mm256_castsi256_si128(channels[2]), 4);
+		store_rgb16(dst + (i + 4) * 3, _mm256_extracti128_si256(channels[0], 1), _mm256_extracti128_si256(channels[1], 1), _mm256_extracti128_si256(channels[2], 1), 4);
+	}
+
+	encode_scrgb_half_to_hdr10_pq_sse2(dst + i * 3, src + i * 3, count - i);
+}
+
+#if defined(__clang__)
+	#pragma clang attribute pop
+#elif defined(__GNUC__)
+	#pragma GCC pop_options
+#endif
+#endif
+#pragma endregion
+
+#pragma region NEON
+#if RESHADE_PIXEL_CONVERSION_NEON
+static void convert_rgba8_neon(uint8_t *dst, const uint8_t *src, size_t count, bool swap_rb, bool opaque)
+{
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		uint8x16x4_t v = vld4q_u8(src + i * 4);
+		if (swap_rb)
+		{
+			const uint8x16_t r = v.val[0];
+			v.val[0] = v.val[2];
+			v.val[2] = r;
+		}
+		if (opaque)
+			v.val[3] = vdupq_n_u8(0xFF);
+		vst4q_u8(dst + i * 4, v);
+	}
+
+	convert_rgba8_scalar(dst + i * 4, src + i * 4, count - i, swap_rb, opaque);
+}
+static void expand_r8_to_rgba8_neon(uint8_t *dst, const uint8_t *src, size_t count)
+{
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		uint8x16x4_t v;
+		v.val[0] = vld1q_u8(src + i);
+		v.val[1] = vdupq_n_u8(0);
+		v.val[2] = vdupq_n_u8(0);
+		v.val[3] = vdupq_n_u8(0xFF);
+		vst4q_u8(dst + i * 4, v);
+	}
+
+	expand_r8_to_rgba8_scalar(dst + i * 4, src + i, count - i);
+}
+static void expand_rg8_to_rgba8_neon(uint8_t *dst, const uint8_t *src, size_t count)
+{
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		const uint8x16x2_t rg = vld2q_u8(src + i * 2);
+		uint8x16x4_t v;
+		v.val[0] = rg.val[0];
+		v.val[1] = rg.val[1];
+		v.val[2] = vdupq_n_u8(0);
+		v.val[3] = vdupq_n_u8(0xFF);
+		vst4q_u8(dst + i * 4, v);
+	}
+
+	expand_rg8_to_rgba8_scalar(dst + i * 4, src + i * 2, count - i);
+}
+
+static void pack_rgba8_to_rgb8_neon(uint8_t *dst, const uint8_t *src, size_t count)
+{
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		const uint8x16x4_t v = vld4q_u8(src + i * 4);
+		uint8x16x3_t rgb;
+		rgb.val[0] = v.val[0];
+		rgb.val[1] = v.val[1];
+		rgb.val[2] = v.val[2];
+		vst3q_u8(dst + i * 3, rgb);
+	}
+
+	pack_channels_scalar<4, 3>(dst + i * 3, src + i * 4, count - i);
+}
+static void pack_rgba8_to_r8_neon(uint8_t *dst, const uint8_t *src, size_t count)
+{
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+		vst1q_u8(dst + i, vld4q_u8(src + i * 4).val[0]);
+
+	pack_channels_scalar<4, 1>(dst + i, src + i * 4, count - i);
+}
+static void pack_rgba8_to_rg8_neon(uint8_t *dst, const uint8_t *src, size_t count)
+{
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		const uint8x16x4_t v = vld4q_u8(src + i * 4);
+		uint8x16x2_t rg;
+		rg.val[0] = v.val[0];
+		rg.val[1] = v.val[1];
+		vst2q_u8(dst + i * 2, rg);
+	}
+
+	pack_channels_scalar<4, 2>(dst + i * 2, src + i * 4, count - i);
+}
+static void pack_rgba32f_to_r32f_neon(float *dst, const float *src, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+		vst1q_f32(dst + i, vld4q_f32(src + i * 4).val[0]);
+
+	pack_channels_scalar<4, 1>(dst + i, src + i * 4, count - i);
+}
+static void pack_rgba32f_to_rg32f_neon(float *dst, const float *src, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		const float32x4x4_t v = vld4q_f32(src + i * 4);
+		float32x4x2_t rg;
+		rg.val[0] = v.val[0];
+		rg.val[1] = v.val[1];
+		vst2q_f32(dst + i * 2, rg);
+	}
+
+	pack_channels_scalar<4, 2>(dst + i * 2, src + i * 4, count - i);
+}
+static void pack_rgba16_to_rgb16_neon(uint16_t *dst, const uint16_t *src, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		const uint16x8x4_t v = vld4q_u16(src + i * 4);
+		uint16x8x3_t rgb;
+		rgb.val[0] = v.val[0];
+		rgb.val[1] = v.val[1];
+		rgb.val[2] = v.val[2];
+		vst3q_u16(dst + i * 3, rgb);
+	}
+
+	pack_channels_scalar<4, 3>(dst + i * 3, src + i * 4, count - i);
+}
+
+static void unpack_rgb10a2_to_rgba8_neon(uint8_t *dst, const uint32_t *src, size_t count, bool swap_rb)
+{
+	const uint32x4_t mask = vdupq_n_u32(0xFF);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		const uint32x4_t v = vld1q_u32(src + i);
+		const uint32x4_t c0 = vandq_u32(vshrq_n_u32(v,  2), mask);
+		const uint32x4_t c1 = vandq_u32(vshrq_n_u32(v, 12), mask);
+		const uint32x4_t c2 = vandq_u32(vshrq_n_u32(v, 22), mask);
+		const uint32x4_t a = vmulq_n_u32(vshrq_n_u32(v, 30), 85);
+
+		const uint32x4_t r = swap_rb ? c2 : c0;
+		const uint32x4_t b = swap_rb ? c0 : c2;
+		vst1q_u8(dst + i * 4, vreinterpretq_u8_u32(vorrq_u32(vorrq_u32(r, vshlq_n_u32(c1, 8)), vorrq_u32(vshlq_n_u32(b, 16), vshlq_n_u32(a, 24)))));
+	}
+
+	unpack_rgb10a2_to_rgba8_scalar(dst + i * 4, src + i, count - i, swap_rb);
+}
+static void swap_rb_rgb10a2_neon(uint32_t *dst, const uint32_t *src, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		const uint32x4_t v = vld1q_u32(src + i);
+		vst1q_u32(dst + i, vorrq_u32(vandq_u32(v, vdupq_n_u32(0xC00FFC00)), vorrq_u32(vshlq_n_u32(vandq_u32(v, vdupq_n_u32(0x000003FF)), 20), vshrq_n_u32(vandq_u32(v, vdupq_n_u32(0x3FF00000)), 20))));
+	}
+
+	swap_rb_rgb10a2_scalar(dst + i, src + i, count - i);
+}
+
+static void convert_half_to_float_neon(float *dst, const uint16_t *src, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+		vst1q_f32(dst + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(src + i))));
+
+	convert_half_to_float_scalar(dst + i, src + i, count - i);
+}
+#endif
+#pragma endregion
+
+struct kernel_table
+{
+	instruction_set set;
+	void(*convert_rgba8)(uint8_t *, const uint8_t *, size_t, bool, bool);
+	void(*expand_r8_to_rgba8)(uint8_t *, const uint8_t *, size_t);
+	void(*expand_rg8_to_rgba8)(uint8_t *, const uint8_t *, size_t);
+	void(*pack_rgba8_to_rgb8)(uint8_t *, const uint8_t *, size_t);
+	void(*pack_rgba8_to_r8)(uint8_t *, const uint8_t *, size_t);
+	void(*pack_rgba8_to_rg8)(uint8_t *, const uint8_t *, size_t);
+	void(*pack_rgba32f_to_r32f)(float *, const float *, size_t);
+	void(*pack_rgba32f_to_rg32f)(float *, const float *, size_t);
+	void(*pack_rgba16_to_rgb16)(uint16_t *, const uint16_t *, size_t);
+	void(*unpack_rgb10a2_to_rgba8)(uint8_t *, const uint32_t *, size_t, bool);
+	void(*unpack_rgb10a2_to_rgb16)(uint16_t *, const uint32_t *, size_t, bool);
+	void(*swap_rb_rgb10a2)(uint32_t *, const uint32_t *, size_t);
+	void(*convert_half_to_float)(float *, const uint16_t *, size_t);
+	void(*encode_scrgb_half_to_hdr10_pq)(uint16_t *, const uint16_t *, size_t);
+};
+
+// Kernels without a vectorized version for an instruction set fall back to the next best one
+static const kernel_table s_scalar_kernels = {
+	instruction_set::scalar,
+	convert_rgba8_scalar,
+	expand_r8_to_rgba8_scalar,
+	expand_rg8_to_rgba8_scalar,
+	pack_channels_scalar<4, 3, uint8_t>,
+	pack_channels_scalar<4, 1, uint8_t>,
+	pack_channels_scalar<4, 2, uint8_t>,
+	pack_channels_scalar<4, 1, float>,
+	pack_channels_scalar<4, 2, float>,
+	pack_channels_scalar<4, 3, uint16_t>,
+	unpack_rgb10a2_to_rgba8_scalar,
+	unpack_rgb10a2_to_rgb16_scalar,
+	swap_rb_rgb10a2_scalar,
+	convert_half_to_float_scalar,
+	encode_scrgb_half_to_hdr10_pq_scalar,
+};
+#if RESHADE_PIXEL_CONVERSION_SSE2
+static const kernel_table s_sse2_kernels = {
+	instruction_set::sse2,
+	convert_rgba8_sse2,
+	expand_r8_to_rgba8_sse2,
+	expand_rg8_to_rgba8_sse2,
+	pack_channels_scalar<4, 3, uint8_t>,
+	pack_rgba8_to_r8_sse2,
+	pack_rgba8_to_rg8_sse2,
+	pack_rgba32f_to_r32f_sse2,
+	pack_rgba32f_to_rg32f_sse2,
+	pack_channels_scalar<4, 3, uint16_t>,
+	unpack_rgb10a2_to_rgba8_sse2,
+	unpack_rgb10a2_to_rgb16_scalar,
+	swap_rb_rgb10a2_sse2,
+	convert_half_to_float_sse2,
+	encode_scrgb_half_to_hdr10_pq_sse2,
+};
+static const kernel_table s_avx2_kernels = {
+	instruction_set::avx2,
+	convert_rgba8_avx2,
+	expand_r8_to_rgba8_sse2,
+	expand_rg8_to_rgba8_sse2,
+	pack_rgba8_to_rgb8_avx2,
+	pack_rgba8_to_r8_sse2,
+	pack_rgba8_to_rg8_sse2,
+	pack_rgba32f_to_r32f_sse2,
+	pack_rgba32f_to_rg32f_sse2,
+	pack_rgba16_to_rgb16_avx2,
+	unpack_rgb10a2_to_rgba8_sse2,
+	unpack_rgb10a2_to_rgb16_scalar,
+	swap_rb_rgb10a2_sse2,
+	convert_half_to_float_avx2,
+	encode_scrgb_half_to_hdr10_pq_avx2,
+};
+#endif
+#if RESHADE_PIXEL_CONVERSION_NEON
+static const kernel_table s_neon_kernels = {
+	instruction_set::neon,
+	convert_rgba8_neon,
+	expand_r8_to_rgba8_neon,
+	expand_rg8_to_rgba8_neon,
+	pack_rgba8_to_rgb8_neon,
+	pack_rgba8_to_r8_neon,
+	pack_rgba8_to_rg8_neon,
+	pack_rgba32f_to_r32f_neon,
+	pack_rgba32f_to_rg32f_neon,
+	pack_rgba16_to_rgb16_neon,
+	unpack_rgb10a2_to_rgba8_neon,
+	unpack_rgb10a2_to_rgb16_scalar,
+	swap_rb_rgb10a2_neon,
+	convert_half_to_float_neon,
+	encode_scrgb_half_to_hdr10_pq_scalar,
+};
+#endif
+
+#if RESHADE_PIXEL_CONVERSION_SSE2
+static bool cpu_supports_avx2()
+{
+	int info[4] = {};
+	const auto cpuid = [&info](int leaf) {
+#ifdef _MSC_VER
+		__cpuidex(info, leaf, 0);
+#else
+		__cpuid_count(leaf, 0, info[0], info[1], info[2], info[3]);
+#endif
+	};
+
+	cpuid(0);
+	if (info[0] < 7)
+		return false;
+
+	cpuid(1);
+	// Require SSSE3, OSXSAVE, AVX and F16C
+	if ((info[2] & (1 << 9)) == 0 || (info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (info[2] & (1 << 29)) == 0)
+		return false;
+
+	// Operating system has to save the upper halves of the YMM registers
+#ifdef _MSC_VER
+	const unsigned long long xcr0 = _xgetbv(0);
+#else
+	unsigned int xcr0_lo = 0, xcr0_hi = 0;
+	__asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+	const unsigned long long xcr0 = xcr0_lo | (static_cast<unsigned long long>(xcr0_hi) << 32);
+#endif
+	if ((xcr0 & 0x6) != 0x6)
+		return false;
+
+	cpuid(7);
+	return (info[1] & (1 << 5)) != 0;
+}
+#endif
+
+static const kernel_table *find_kernels(instruction_set set)
+{
+#if RESHADE_PIXEL_CONVERSION_SSE2
+	static const bool s_avx2_supported = cpu_supports_avx2();
+#endif
+
+	switch (set)
+	{
+	case instruction_set::scalar:
+		return &s_scalar_kernels;
+#if RESHADE_PIXEL_CONVERSION_SSE2
+	case instruction_set::sse2:
+		return &s_sse2_kernels;
+	case instruction_set::avx2:
+		return s_avx2_supported ? &s_avx2_kernels : nullptr;
+#endif
+#if RESHADE_PIXEL_CONVERSION_NEON
+	case instruction_set::neon:
+		return &s_neon_kernels;
+#endif
+	default:
+		return nullptr;
+	}
+}
+static std::atomic<const kernel_table *> &active_kernels()
+{
+	static std::atomic<const kernel_table *> s_active = []() {
+		for (const instruction_set set : { instruction_set::avx2, instruction_set::neon, instruction_set::sse2 })
+			if (const kernel_table *const kernels = find_kernels(set))
+				return kernels;
+		return &s_scalar_kernels;
+	}();
+	return s_active;
+}
+static const kernel_table &kernels()
+{
+	return *active_kernels().load(std::memory_order_relaxed);
+}
+
+auto reshade::pixel_conversion::get_instruction_set() -> instruction_set
+{
+	return kernels().set;
+}
+bool reshade::pixel_conversion::set_instruction_set(instruction_set set)
+{
+	const kernel_table *const kernels = find_kernels(set);
+	if (kernels == nullptr)
+		return false;
+
+	active_kernels().store(kernels, std::memory_order_relaxed);
+	return true;
+}
+bool reshade::pixel_conversion::is_instruction_set_supported(instruction_set set)
+{
+	return find_kernels(set) != nullptr;
+}
+
+void reshade::pixel_conversion::convert_rgba8(uint8_t *dst, const uint8_t *src, size_t count, bool swap_rb, bool opaque)
+{
+	kernels().convert_rgba8(dst, src, count, swap_rb, opaque);
+}
+void reshade::pixel_conversion::expand_r8_to_rgba8(uint8_t *dst, const uint8_t *src, size_t count)
+{
+	kernels().expand_r8_to_rgba8(dst, src, count);
+}
+void reshade::pixel_conversion::expand_rg8_to_rgba8(uint8_t *dst, const uint8_t *src, size_t count)
+{
+	kernels().expand_rg8_to_rgba8(dst, src, count);
+}
+
+void reshade::pixel_conversion::pack_rgba8_to_rgb8(uint8_t *dst, const uint8_t *src, size_t count)
+{
+	kernels().pack_rgba8_to_rgb8(dst, src, count);
+}
+void reshade::pixel_conversion::pack_rgba8_to_r8(uint8_t *dst, const uint8_t *src, size_t count)
+{
+	kernels().pack_rgba8_to_r8(dst, src, count);
+}
+void reshade::pixel_conversion::pack_rgba8_to_rg8(uint8_t *dst, const uint8_t *src, size_t count)
+{
+	kernels().pack_rgba8_to_rg8(dst, src, count);
+}
+void reshade::pixel_conversion::pack_rgba32f_to_r32f(float *dst, const float *src, size_t count)
+{
+	kernels().pack_rgba32f_to_r32f(dst, src, count);
+}
+void reshade::pixel_conversion::pack_rgba32f_to_rg32f(float *dst, const float *src, size_t count)
+{
+	kernels().pack_rgba32f_to_rg32f(dst, src, count);
+}
+void reshade::pixel_conversion::pack_rgba16_to_rgb16(uint16_t *dst, const uint16_t *src, size_t count)
+{
+	kernels().pack_rgba16_to_rgb16(dst, src, count);
+}
+
+void reshade::pixel_conversion::unpack_rgb10a2_to_rgba8(uint8_t *dst, const uint32_t *src, size_t count, bool swap_rb)
+{
+	kernels().unpack_rgb10a2_to_rgba8(dst, src, count, swap_rb);
+}
+void reshade::pixel_conversion::unpack_rgb10a2_to_rgb16(uint16_t *dst, const uint32_t *src, size_t count, bool swap_rb)
+{
+	kernels().unpack_rgb10a2_to_rgb16(dst, src, count, swap_rb);
+}
+void reshade::pixel_conversion::swap_rb_rgb10a2(uint32_t *dst, const uint32_t *src, size_t count)
+{
+	kernels().swap_rb_rgb10a2(dst, src, count);
+}
+
+void reshade::pixel_conversion::convert_half_to_float(float *dst, const uint16_t *src, size_t count)
+{
+	kernels().convert_half_to_float(dst, src, count);
+}
+
+void reshade::pixel_conversion::encode_scrgb_half_to_hdr10_pq(uint16_t *dst, const uint16_t *src, size_t count)
+{
+	kernels().encode_scrgb_half_to_hdr10_pq(dst, src, count);
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2026 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace reshade::pixel_conversion
+{
+	/// <summary>
+	/// Instruction set used by the conversion kernels.
+	/// </summary>
+	enum class instruction_set
+	{
+		/// <summary>
+		/// Portable reference implementation, which all other implementations are checked against.
+		/// </summary>
+		scalar,
+		sse2,
+		/// <summary>
+		/// AVX2 together with F16C (and SSSE3, which every processor with AVX2 supports).
+		/// </summary>
+		avx2,
+		neon,
+	};
+
+	/// <summary>
+	/// Gets the instruction set that is currently used by the conversion kernels.
+	/// Defaults to the best one supported by the processor.
+	/// </summary>
+	instruction_set get_instruction_set();
+	/// <summary>
+	/// Overrides the instruction set used by the conversion kernels (e.g. to compare them against the scalar reference).
+	/// </summary>
+	/// <returns><see langword="true"/> if the instruction set is supported by this build and the processor, <see langword="false"/> otherwise (in which case nothing is changed).</returns>
+	bool set_instruction_set(instruction_set set);
+	/// <summary>
+	/// Checks whether the specified instruction set is supported by this build and the processor.
+	/// </summary>
+	bool is_instruction_set_supported(instruction_set set);
+
+	// All functions below convert 'count' pixels from 'src' to 'dst'.
+	// Functions that reduce the size of a pixel may be called with 'dst' equal to 'src' to convert in place.
+
+	/// <summary>
+	/// Converts 8-bit RGBA or BGRA pixels to 8-bit RGBA, optionally swapping the red and blue channels and/or forcing alpha to 0xFF.
+	/// </summary>
+	void convert_rgba8(uint8_t *dst, const uint8_t *src, size_t count, bool swap_rb, bool opaque);
+	/// <summary>
+	/// Expands 8-bit R pixels to opaque 8-bit RGBA with green and blue set to zero.
+	/// </summary>
+	void expand_r8_to_rgba8(uint8_t *dst, const uint8_t *src, size_t count);
+	/// <summary>
+	/// Expands 8-bit RG pixels to opaque 8-bit RGBA with blue set to zero.
+	/// </summary>
+	void expand_rg8_to_rgba8(uint8_t *dst, const uint8_t *src, size_t count);
+
+	/// <summary>
+	/// Removes the alpha channel from 8-bit RGBA pixels. Can be done in place.
+	/// </summary>
+	void pack_rgba8_to_rgb8(uint8_t *dst, const uint8_t *src, size_t count);
+	/// <summary>
+	/// Keeps only the red channel of 8-bit RGBA pixels. Can be done in place.
+	/// </summary>
+	void pack_rgba8_to_r8(uint8_t *dst, const uint8_t *src, size_t count);
+	/// <summary>
+	/// Keeps only the red and green channels of 8-bit RGBA pixels. Can be done in place.
+	/// </summary>
+	void pack_rgba8_to_rg8(uint8_t *dst, const uint8_t *src, size_t count);
+	/// <summary>
+	/// Keeps only the red channel of 32-bit floating-point RGBA pixels. Can be done in place.
+	/// </summary>
+	void pack_rgba32f_to_r32f(float *dst, const float *src, size_t count);
+	/// <summary>
+	/// Keeps only the red and green channels of 32-bit floating-point RGBA pixels. Can be done in place.
+	/// </summary>
+	void pack_rgba32f_to_rg32f(float *dst, const float *src, size_t count);
+	/// <summary>
+	/// Removes the alpha channel from 16-bit RGBA pixels (works for both normalized and floating-point data). Can be done in place.
+	/// </summary>
+	void pack_rgba16_to_rgb16(uint16_t *dst, const uint16_t *src, size_t count);
+
+	/// <summary>
+	/// Converts 10:10:10:2 RGBA or BGRA pixels to 8-bit RGBA by truncating the lower bits of every channel.
+	/// </summary>
+	void unpack_rgb10a2_to_rgba8(uint8_t *dst, const uint32_t *src, size_t count, bool swap_rb);
+	/// <summary>
+	/// Converts 10:10:10:2 RGBA or BGRA pixels to 16-bit RGB, dropping the alpha channel.
+	/// </summary>
+	void unpack_rgb10a2_to_rgb16(uint16_t *dst, const uint32_t *src, size_t count, bool swap_rb);
+	/// <summary>
+	/// Swaps the red and blue channels of 10:10:10:2 pixels. Can be done in place.
+	/// </summary>
+	void swap_rb_rgb10a2(uint32_t *dst, const uint32_t *src, size_t count);
+
+	/// <summary>
+	/// Converts 16-bit floating-point values to 32-bit floating-point values. This is exact for all inputs, including denormals, infinities and NaNs.
+	/// Note that 'count' is the number of values, not pixels.
+	/// </summary>
+	void convert_half_to_float(float *dst, const uint16_t *src, size_t count);
+
+	/// <summary>
+	/// Converts 16-bit floating-point scRGB pixels (linear BT.709 primaries, 1.0 = 80 nits) to 16-bit HDR10 pixels (BT.2020 primaries, PQ transfer function). Can be done in place.
+	/// The vectorized implementations approximate the power function, so their results may differ from the scalar reference by one unit.
+	/// </summary>
+	void encode_scrgb_half_to_hdr10_pq(uint16_t *dst, const uint16_t *src, size_t count);
+}
@@ -8,6 +8,8 @@
 #include "effect_parser.hpp"
 #include "effect_codegen.hpp"
 #include "effect_preprocessor.hpp"
+#include "effect_cache_pack.hpp"
+#include "task_pool.hpp"
 #include "version.h"
 #include "dll_log.hpp"
 #include "dll_resources.hpp"
@@ -18,7 +20,9 @@
 #include "com_ptr.hpp"
 #include "platform_utils.hpp"
 #include "reshade_api_object_impl.hpp"
+#include "pixel_conversion.hpp"
 #include <set>
+#include <condition_variable>
 #include <cmath> // std::abs, std::fmod
 #include <cctype> // std::toupper
 #include <cwctype> // std::towlower
@@ -27,9 +31,6 @@
 #include <cstring> // std::memcpy, std::memset, std::strlen
 #include <charconv> // std::to_chars
 #include <algorithm> // std::all_of, std::copy_n, std::equal, std::fill_n, std::find, std::find_if, std::for_each, std::max, std::min, std::replace, std::remove, std::remove_if, std::reverse, std::search, std::set_symmetric_difference, std::sort, std::stable_sort, std::swap, std::transform
-#include <emmintrin.h>
-#include <smmintrin.h>
-#include <immintrin.h>
 #include <fpng.h>
 #include <simple_lossless.h>
 #include <stb_image.h>
@@ -64,6 +65,9 @@ bool resolve_preset_path(std::filesystem::path &path, std::error_code &ec)
 	return !resolve_path(path, ec) || reshade::ini_file::load_cache(path).has({}, "Techniques");
 }
 
+// Optimization level of the ReShadeFX compiler used for effects (this is part of the effect module cache key, since it changes the generated module)
+static constexpr int s_effect_optimization_level = 0;
+
 static std::filesystem::path make_relative_path(const std::filesystem::path &path)
 {
 	if (path.empty())
@@ -175,6 +179,114 @@ static std::vector<std::filesystem::path> find_files(const std::vector<std::file
 	return files;
 }
 
+struct file_content_hash_entry
+{
+	std::filesystem::file_time_type last_write_time;
+	uintmax_t file_size;
+	std::string hash;
+};
+
+// Cache of content hashes of files effects depend on, so that common headers only have to be hashed once when validating many cached effects
+static std::mutex s_file_content_hash_mutex;
+static std::unordered_map<std::filesystem::path::string_type, file_content_hash_entry> s_file_content_hashes;
+
+static bool compute_file_content_hash(const std::filesystem::path &path, std::string &hash)
+{
+	std::error_code ec;
+	const std::filesystem::file_time_type last_write_time = std::filesystem::last_write_time(path, ec);
+	if (ec)
+		return false;
+	const uintmax_t file_size = std::filesystem::file_size(path, ec);
+	if (ec)
+		return false;
+
+	{
+		const std::unique_lock<std::mutex> lock(s_file_content_hash_mutex);
+
+		if (const auto it = s_file_content_hashes.find(path.native());
+			it != s_file_content_hashes.end() && it->second.last_write_time == last_write_time && it->second.file_size == file_size)
+		{
+			hash = it->second.hash;
+			return true;
+		}
+	}
+
+	FILE *const file = _wfsopen(path.c_str(), L"rb", SH_DENYNO);
+	if (file == nullptr)
+		return false;
+
+	std::string file_data(static_cast<size_t>(file_size), '\0');
+	const size_t file_size_read = fread(file_data.data(), 1, file_data.size(), file);
+	fclose(file);
+	if (file_size_read != file_data.size())
+		return false;
+
+	hash = reshade::effect_cache_pack::key_to_string(reshade::effect_cache_pack::compute_key(file_data));
+
+	const std::unique_lock<std::mutex> lock(s_file_content_hash_mutex);
+	s_file_content_hashes.insert_or_assign(path.native(), file_content_hash_entry { last_write_time, file_size, hash });
+
+	return true;
+}
+
+// Build a list of the specified included files together with hashes of their contents, with one "hash path" pair per line
+// Paths that were searched for included files but did not exist are added with a "-" instead of a hash, since a file created at any of them would shadow the one that was included
+static bool build_effect_dependencies(const std::vector<std::filesystem::path> &included_files, const std::vector<std::filesystem::path> &missing_files, std::string &dependencies)
+{
+	dependencies.clear();
+
+	for (const std::filesystem::path &included_file : included_files)
+	{
+		std::string hash;
+		if (!compute_file_content_hash(included_file, hash))
+			return false;
+
+		dependencies += hash;
+		dependencies += ' ';
+		dependencies += included_file.u8string();
+		dependencies += '\n';
+	}
+
+	for (const std::filesystem::path &missing_file : missing_files)
+	{
+		dependencies += "- ";
+		dependencies += missing_file.u8string();
+		dependencies += '\n';
+	}
+
+	return true;
+}
+// Check whether the contents of all files in a list built by 'build_effect_dependencies' are still the same and none of the missing files were created since
+static bool check_effect_dependencies(const std::string &dependencies, std::vector<std::filesystem::path> *included_files = nullptr)
+{
+	for (size_t offset = 0, next; offset < dependencies.size(); offset = next + 1)
+	{
+		next = dependencies.find('\n', offset);
+		const size_t space_index = dependencies.find(' ', offset);
+		if (next == std::string::npos || space_index == std::string::npos || space_index > next)
+			return false;
+
+		const std::filesystem::path included_file = std::filesystem::u8path(dependencies.begin() + space_index + 1, dependencies.begin() + next);
+
+		if (dependencies.compare(offset, space_index - offset, "-") == 0)
+		{
+			std::error_code ec;
+			if (std::filesystem::exists(included_file, ec) || ec)
+				return false;
+			continue;
+		}
+
+		std::string hash;
+		if (!compute_file_content_hash(included_file, hash) || dependencies.compare(offset, space_index - offset, hash) != 0)
+			return false;
+
+		if (included_files != nullptr)
+			included_files->push_back(included_file);
+	}
+
+	return true;
+}
+
 reshade::runtime::runtime(api::swapchain *swapchain, api::command_queue *graphics_queue, const std::filesystem::path &config_path, bool is_vr) :
 	_swapchain(swapchain),
 	_device(swapchain->get_device()),
@@ -238,6 +350,14 @@ reshade::runtime::runtime(api::swapchain *swapchain, api::command_queue *graphic
 
 	load_config();
 
+	// Keep one core free for the application while loading effects in the background
+	size_t num_worker_threads = static_cast<size_t>(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+#ifndef _WIN64
+	// Limit number of threads in 32-bit due to the limited about of address space being available there and compilation being memory hungry
+	num_worker_threads = std::min(num_worker_threads, static_cast<size_t>(4));
+#endif
+	_task_pool = std::make_unique<task_pool>(num_worker_threads);
+
 	fpng::fpng_init();
 }
 reshade::runtime::~runtime()
@@ -527,9 +647,14 @@ void reshade::runtime::on_reset()
 	else
 		return; // Nothing to do if the runtime was already destroyed or not successfully initialized in the first place
 
+	// Finish any screenshots still in flight, so that they are not lost (this has to happen before the worker threads are joined in 'destroy_effects')
+	update_texture_readbacks(true);
+
 	// Already performs a wait for idle, so no need to do it again before destroying resources below
 	destroy_effects();
 
+	destroy_texture_readbacks();
+
 	_device->destroy_resource(_empty_tex);
 	_empty_tex = {};
 	_device->destroy_resource_view(_empty_srv);
@@ -592,6 +717,9 @@ void reshade::runtime::on_present()
 	_is_in_present_call = true;
 #endif
 
+	// Hand off screenshots whose copy finished on the GPU since the last frame
+	update_texture_readbacks();
+
 	api::command_list *const cmd_list = _graphics_queue->get_immediate_command_list();
 
 	capture_state(cmd_list, _app_state);
@@ -649,6 +777,9 @@ void reshade::runtime::on_present()
 	const auto current_time = std::chrono::high_resolution_clock::now();
 	_last_frame_duration = current_time - _last_present_time; _last_present_time = current_time;
 
+	_last_frame_uniform_upload_bytes = _uniform_upload_bytes; _uniform_upload_bytes = 0;
+	_last_frame_uniform_upload_count = _uniform_upload_count; _uniform_upload_count = 0;
+
 #if RESHADE_GUI
 	// Draw overlay
 	if (_is_vr)
@@ -912,6 +1043,7 @@ void reshade::runtime::load_config()
 	config_get("GENERAL", "SkipLoadingDisabledEffects", _effect_load_skipping);
 	config_get("GENERAL", "TextureSearchPaths", _texture_search_paths);
 	config_get("GENERAL", "IntermediateCachePath", _effect_cache_path);
+	config_get("GENERAL", "IntermediateCacheSize", _effect_cache_size);
 
 	config_get("GENERAL", "StartupPresetPath", _startup_preset_path);
 	config_get("GENERAL", "PresetPath", _current_preset_path);
@@ -927,6 +1059,18 @@ void reshade::runtime::load_config()
 			log::message(log::level::error, "Failed to create effect cache directory '%s' with error code %d!", _effect_cache_path.u8string().c_str(), ec.value());
 	}
 
+	if (!_no_effect_cache)
+	{
+		if (_effect_cache_pack == nullptr)
+			_effect_cache_pack = std::make_unique<effect_cache_pack>();
+
+		// Only reopen the pack file if the cache path changed
+		if (const std::filesystem::path effect_cache_pack_path = g_reshade_base_path / _effect_cache_path / L"reshade-effects.pack";
+			_effect_cache_pack->path() != effect_cache_pack_path &&
+			!_effect_cache_pack->open(effect_cache_pack_path, static_cast<uint64_t>(_effect_cache_size) * 1024 * 1024))
+			log::message(log::level::warning, "Failed to open effect cache pack file '%s'!", effect_cache_pack_path.u8string().c_str());
+	}
+
 	// Use startup preset instead of last selection
 	if (!_startup_preset_path.empty() && resolve_preset_path(_startup_preset_path, ec))
 		_current_preset_path = _startup_preset_path;
@@ -989,6 +1133,7 @@ void reshade::runtime::save_config() const
 	config.set("GENERAL", "SkipLoadingDisabledEffects", _effect_load_skipping);
 	config.set("GENERAL", "TextureSearchPaths", _texture_search_paths);
 	config.set("GENERAL", "IntermediateCachePath", _effect_cache_path);
+	config.set("GENERAL", "IntermediateCacheSize", _effect_cache_size);
 
 	config.set("GENERAL", "StartupPresetPath", make_relative_path(_startup_preset_path));
 	config.set("GENERAL", "PresetPath", make_relative_path(_current_preset_path));
@@ -1444,53 +1589,29 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 	for (const std::pair<std::string, std::string> &definition : preprocessor_definitions)
 		attributes += definition.first + '=' + definition.second + ';';
 
+	// Search paths were already resolved and expanded once for all effects in 'load_effects', so only have to add the directory of this effect
 	std::error_code ec;
-	std::set<std::filesystem::path> include_paths;
+	std::set<std::filesystem::path> include_paths = _effect_include_paths;
 	if (source_file.is_absolute())
 		include_paths.emplace(source_file.parent_path());
-	for (std::filesystem::path include_path : _effect_search_paths)
-	{
-		const bool recursive_search = include_path.filename() == L"**";
-		if (recursive_search)
-			include_path.remove_filename();
-
-		if (resolve_path(include_path, ec))
-		{
-			include_paths.emplace(include_path);
-
-			if (recursive_search)
-			{
-				for (const std::filesystem::directory_entry &entry : std::filesystem::recursive_directory_iterator(include_path, std::filesystem::directory_options::skip_permission_denied, ec))
-					if (entry.is_directory(ec))
-						include_paths.emplace(entry);
-			}
-		}
-	}
 
 	attributes += effect_name;
 	attributes += '?';
 	attributes += std::to_string(std::filesystem::last_write_time(source_file, ec).time_since_epoch().count());
 	attributes += ';';
 
-	// The actual included files are not known at this point, so detect changes to any ".fxh" files in the search paths
+	// Changes to the search paths can change which files are included
+	// Changes to the included files themselves are detected by checking the dependency list that is saved alongside the preprocessed source
 	for (const std::filesystem::path &include_path : include_paths)
 	{
-		for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(include_path, std::filesystem::directory_options::skip_permission_denied, ec))
-		{
-			if (entry.path().extension() == L".fxh")
-			{
-				attributes += entry.path().filename().u8string();
-				attributes += '?';
-				attributes += std::to_string(entry.last_write_time(ec).time_since_epoch().count());
-				attributes += ';';
-			}
-		}
+		attributes += include_path.u8string();
+		attributes += ';';
 	}
 
 	effect &effect = _effects[effect_index];
 
 	const size_t source_hash = std::hash<std::string>()(attributes);
-	if (permutation_index == 0 && (source_file != effect.source_file || source_hash != effect.source_hash))
+	if (permutation_index == 0 && (source_file != effect.source_file || source_hash != effect.source_hash || !check_effect_dependencies(effect.dependencies)))
 	{
 		if (effect.created)
 		{
@@ -1538,8 +1659,18 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 	bool source_cached = false;
 	std::string source;
 	std::string errors;
+	std::string dependencies;
+	std::vector<std::filesystem::path> included_files;
+
+	const std::string source_cache_id = source_file.stem().u8string() + '-' + std::to_string(_renderer_id) + '-' + std::to_string(source_hash);
 
-	if (!preprocessed && (preprocess_required || (source_cached = load_effect_cache(source_file.stem().u8string() + '-' + std::to_string(_renderer_id) + '-' + std::to_string(source_hash), "i", source)) == false))
+	// Only use the cached preprocessed source if none of the files that were included when it was generated have changed since
+	if (!preprocessed && !preprocess_required &&
+		load_effect_cache(source_cache_id, "dep", dependencies) &&
+		check_effect_dependencies(dependencies, &included_files))
+		source_cached = load_effect_cache(source_cache_id, "i", source);
+
+	if (!preprocessed && !source_cached)
 	{
 		reshadefx::preprocessor pp;
 		pp.add_macro_definition("__RESHADE__", std::to_string(VERSION_MAJOR * 10000 + VERSION_MINOR * 100 + VERSION_REVISION));
@@ -1587,6 +1718,16 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 		// Append preprocessor errors to the error list
 		errors += pp.errors();
 
+#if RESHADE_VERBOSE_LOG
+		log::message(log::level::debug, "Preprocessed '%s' with %zu included files read from the include cache and %zu read from disk.", source_file.u8string().c_str(), pp.include_cache_hits(), pp.include_cache_misses());
+#endif
+
+		included_files = pp.included_files();
+		std::sort(included_files.begin(), included_files.end()); // Sort file names alphabetically
+		std::vector<std::filesystem::path> missing_include_files = pp.missing_include_files();
+		std::sort(missing_include_files.begin(), missing_include_files.end());
+		dependencies.clear();
+
 		if (preprocessed)
 		{
 			source = pp.output();
@@ -1607,7 +1748,10 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 				source = "// " + definition.first + '=' + definition.second + '\n' + source;
 			}
 
-			source_cached = save_effect_cache(source_file.stem().u8string() + '-' + std::to_string(_renderer_id) + '-' + std::to_string(source_hash), "i", source);
+			if (build_effect_dependencies(included_files, missing_include_files, dependencies))
+				source_cached = save_effect_cache(source_cache_id, "i", source) && save_effect_cache(source_cache_id, "dep", dependencies);
+			else
+				dependencies.clear();
 		}
 
 		if (permutation_index == 0)
@@ -1616,8 +1760,8 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 			std::sort(effect.definitions.begin(), effect.definitions.end());
 
 			// Keep track of included files
-			effect.included_files = pp.included_files();
-			std::sort(effect.included_files.begin(), effect.included_files.end()); // Sort file names alphabetically
+			effect.included_files = std::move(included_files);
+			effect.dependencies = std::move(dependencies);
 
 			effect.preprocessed = preprocessed;
 		}
@@ -1646,13 +1790,22 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 			}
 
 			std::sort(effect.definitions.begin(), effect.definitions.end());
+
+			// Dependency list was sorted before it was saved, so included files are already in alphabetical order
+			effect.included_files = std::move(included_files);
+			effect.dependencies = std::move(dependencies);
 		}
 	}
 
+	const std::chrono::high_resolution_clock::time_point time_preprocess_finished = std::chrono::high_resolution_clock::now();
+
 	std::unique_ptr<reshadefx::codegen> codegen;
 	size_t spec_constants_hash = 0;
-	if (!compiled && !source.empty())
-	{
+	// Address the effect module and compiled shader modules by the pre-processed source code and all options affecting compilation, so that identical code is shared between effects and permutations
+	// Not using the generated code for this, since code generators without a text representation (like the SPIR-V one) do not produce any
+	std::string module_cache_id;
+
+	const auto create_codegen_and_parse = [&](std::string &parser_errors) -> bool {
 		unsigned shader_model;
 		if (_renderer_id == 0x9000)
 			shader_model = 30; // D3D9
@@ -1672,16 +1825,72 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 		else // Vulkan uses SPIR-V input
 			codegen.reset(reshadefx::create_codegen_spirv(true, !_no_debug_info, _performance_mode, false, false));
 
+		// The D3D compiler optimization level passed above is separate from the ReShadeFX one
+		// The ReShadeFX optimizer stays disabled until its output was validated against the effect corpus with 'spirv-val' and real drivers, it can be enabled for testing with the '-O' option of the command-line compiler
+		codegen->set_optimization_level(s_effect_optimization_level);
+
 		reshadefx::parser parser;
 
 		// Compile the pre-processed source code (try the compile even if the preprocessor step failed to get additional error information)
-		compiled = parser.parse(std::move(source), codegen.get());
+		const bool success = parser.parse(std::move(source), codegen.get());
+
+		parser_errors = parser.errors();
 
-		// Append parser errors to the error list
-		errors  += parser.errors();
+		return success;
+	};
+	// The code generator is skipped when the effect module was loaded from the cache, so it has to be created on demand if any of the code it generates is missing from the cache
+	const auto ensure_codegen = [&]() -> bool {
+		if (codegen != nullptr)
+			return true;
+
+		// Warnings were already reported along with the cached effect module, so only report errors (which should not happen, since only successfully parsed modules are cached)
+		std::string parser_errors;
+		if (!create_codegen_and_parse(parser_errors))
+		{
+			errors += parser_errors;
+			return false;
+		}
 
-		// Write result to effect module
-		permutation.module = codegen->module();
+		// Update specialization constant values for when code is generated in 'finalize_code' and 'assemble_code_for_entry_point'
+		if (_performance_mode)
+			codegen->module().spec_constants = permutation.module.spec_constants;
+
+		return true;
+	};
+
+	if (!compiled && !source.empty())
+	{
+		module_cache_id = std::to_string(_renderer_id) + '-' + std::to_string(VERSION_MAJOR) + '.' + std::to_string(VERSION_MINOR) + '.' + std::to_string(VERSION_REVISION) + '-' + (_performance_mode ? 'p' : 'd') + (_no_debug_info ? '0' : '1') + 'o' + std::to_string(s_effect_optimization_level) + '-' + effect_cache_pack::key_to_string(effect_cache_pack::compute_key(source));
+
+		// Try to load the effect module from the cache first, so that parsing can be skipped entirely if the pre-processed source code did not change since it was last compiled
+		std::string module_data, parser_errors;
+		if (load_effect_cache(module_cache_id, "mod", module_data) &&
+			load_effect_cache(module_cache_id, "log", parser_errors) &&
+			reshadefx::deserialize_module(module_data, permutation.module))
+		{
+			compiled = true;
+
+			// Append warnings reported when the effect module was parsed to the error list
+			errors += parser_errors;
+		}
+		else
+		{
+			compiled = create_codegen_and_parse(parser_errors);
+
+			// Append parser errors to the error list
+			errors += parser_errors;
+
+			// Write result to effect module
+			permutation.module = codegen->module();
+
+			if (compiled)
+			{
+				reshadefx::serialize_module(permutation.module, module_data);
+
+				save_effect_cache(module_cache_id, "mod", module_data);
+				save_effect_cache(module_cache_id, "log", parser_errors);
+			}
+		}
 
 		if (compiled)
 		{
@@ -1691,6 +1900,7 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 
 				// Create space for all variables (aligned to 16 bytes)
 				effect.uniform_data_storage.resize((permutation.module.total_uniform_size + 15) & ~15);
+				effect.uniform_data_dirty_begin = effect.uniform_data_dirty_end = 0;
 
 				for (uniform variable : permutation.module.uniforms)
 				{
@@ -1737,6 +1947,9 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 
 					effect.uniforms.push_back(std::move(variable));
 				}
+
+				// Resolve special uniform parameters once here, so that 'render_effects' does not have to look them up every frame
+				effect.special_uniforms.build(effect.uniforms);
 			}
 			else
 			{
@@ -1861,7 +2074,8 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 				spec_constants_hash = std::hash<std::string>()(spec_constant_attributes);
 
 				// Update specialization constant values for when code is generated below in 'finalize_code' and 'assemble_code_for_entry_point'
-				codegen->module().spec_constants = permutation.module.spec_constants;
+				if (codegen != nullptr)
+					codegen->module().spec_constants = permutation.module.spec_constants;
 			}
 		}
 		else if (!preprocessed)
@@ -1871,16 +2085,41 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 			return load_effect(source_file, preset, effect_index, permutation_index, force_load, true);
 		}
 
-		permutation.generated_code = codegen->finalize_code();
+		// Generated code depends on the values of specialization constants as well
+		const std::string generated_code_cache_id = module_cache_id + '-' + std::to_string(spec_constants_hash);
+
+		if (codegen != nullptr || !load_effect_cache(generated_code_cache_id, "gen", permutation.generated_code))
+		{
+			if (ensure_codegen())
+			{
+				permutation.generated_code = codegen->finalize_code();
+
+				if (compiled)
+					save_effect_cache(generated_code_cache_id, "gen", permutation.generated_code);
+			}
+			else
+			{
+				compiled = false;
+			}
+		}
 	}
 
+	const std::chrono::high_resolution_clock::time_point time_codegen_finished = std::chrono::high_resolution_clock::now();
+	std::chrono::high_resolution_clock::time_point time_assemble_finished = time_codegen_finished;
+
 	if ((preprocessed || source_cached) && compiled)
 	{
 		if (permutation.cso.empty())
 		{
-			// Compile shader modules
-			for (const std::pair<std::string, reshadefx::shader_type> &entry_point : permutation.module.entry_points)
+			const size_t num_entry_points = permutation.module.entry_points.size();
+
+			// Look up the output strings up front, so that the worker threads below only have to read the maps
+			std::vector<std::string *> entry_point_cso(num_entry_points);
+			std::vector<std::string *> entry_point_assembly(num_entry_points);
+			for (size_t i = 0; i < num_entry_points; ++i)
 			{
+				const std::pair<std::string, reshadefx::shader_type> &entry_point = permutation.module.entry_points[i];
+
 				if (entry_point.second == reshadefx::shader_type::compute && !_device->check_capability(api::device_caps::compute_shader))
 				{
 					errors += "error: " + entry_point.first + ": compute shaders are not supported in D3D9/D3D10\n";
@@ -1888,28 +2127,110 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 					break;
 				}
 
-				std::string &cso = permutation.cso[entry_point.first];
-				std::string &assembly = permutation.assembly[entry_point.first];
+				entry_point_cso[i] = &permutation.cso[entry_point.first];
+				entry_point_assembly[i] = &permutation.assembly[entry_point.first];
+			}
 
-				const std::string cache_id = source_file.stem().u8string() + '-' + std::to_string(_renderer_id) + '-' + std::to_string(source_hash) + '-' + std::to_string(spec_constants_hash) + '-' + entry_point.first;
+			// Look up all shader modules in the cache up front if the effect module was loaded from the cache, since the code generator has to be created before any missing ones can be assembled
+			const std::unique_ptr<bool[]> entry_point_cached = std::make_unique<bool[]>(num_entry_points);
+			if (compiled && codegen == nullptr)
+			{
+				bool all_cached = true;
 
-				if (load_effect_cache(cache_id, "cso", cso) &&
-					load_effect_cache(cache_id, "asm", assembly))
+				for (size_t i = 0; i < num_entry_points; ++i)
 				{
-					continue;
+					const std::string cache_id = module_cache_id + '-' + std::to_string(spec_constants_hash) + '-' + permutation.module.entry_points[i].first;
+
+					entry_point_cached[i] =
+						load_effect_cache(cache_id, "cso", *entry_point_cso[i]) &&
+						load_effect_cache(cache_id, "asm", *entry_point_assembly[i]);
+
+					if (!entry_point_cached[i])
+					{
+						entry_point_cso[i]->clear();
+						entry_point_assembly[i]->clear();
+						all_cached = false;
+					}
 				}
-				else
+
+				if (!all_cached && !ensure_codegen())
+					compiled = false;
+			}
+
+			if (compiled)
+			{
+				// Keep the state that is accessed after the last entry point finished in a separate allocation, since tasks that start late may still access it after this function returned
+				struct assemble_state
 				{
-					if (!codegen->assemble_code_for_entry_point(entry_point.first, cso, assembly, errors))
+					explicit assemble_state(size_t num_entry_points) : num_entry_points(num_entry_points) {}
+
+					const size_t num_entry_points;
+					std::atomic<size_t> next_index = 0;
+					size_t num_finished = 0;
+					std::mutex finished_mutex;
+					std::condition_variable finished_condition;
+				};
+
+				const auto state = std::make_shared<assemble_state>(num_entry_points);
+
+				// Errors are collected per entry point and merged in entry point order below, so that the result does not depend on which thread finished first
+				std::vector<std::string> entry_point_errors(num_entry_points);
+				const std::unique_ptr<bool[]> entry_point_succeeded = std::make_unique<bool[]>(num_entry_points);
+
+				const auto assemble_entry_points = [&, state]() {
+					for (size_t i; (i = state->next_index++) < state->num_entry_points;)
+					{
+						const std::string &entry_point_name = permutation.module.entry_points[i].first;
+
+						const std::string cache_id = module_cache_id + '-' + std::to_string(spec_constants_hash) + '-' + entry_point_name;
+
+						if (entry_point_cached[i] || (
+							load_effect_cache(cache_id, "cso", *entry_point_cso[i]) &&
+							load_effect_cache(cache_id, "asm", *entry_point_assembly[i])))
+						{
+							entry_point_succeeded[i] = true;
+						}
+						else
+						{
+							// Code generators do not modify any state when assembling, so this is safe to call concurrently
+							entry_point_succeeded[i] = codegen->assemble_code_for_entry_point(entry_point_name, *entry_point_cso[i], *entry_point_assembly[i], entry_point_errors[i]);
+
+							if (entry_point_succeeded[i])
+							{
+								save_effect_cache(cache_id, "cso", *entry_point_cso[i]);
+								save_effect_cache(cache_id, "asm", *entry_point_assembly[i]);
+							}
+						}
+
+						const std::unique_lock<std::mutex> lock(state->finished_mutex);
+						if (++state->num_finished == state->num_entry_points)
+							state->finished_condition.notify_all();
+					}
+				};
+
+				// Compile shader modules in parallel, with this thread taking part as well, so that nothing is blocked in case all worker threads are busy with other effects
+				for (size_t i = 1; i < std::min(num_entry_points, _task_pool->num_threads() + 1); ++i)
+					_task_pool->submit(assemble_entry_points);
+				assemble_entry_points();
+
+				{
+					std::unique_lock<std::mutex> lock(state->finished_mutex);
+					state->finished_condition.wait(lock, [&state]() { return state->num_finished == state->num_entry_points; });
+				}
+
+				for (size_t i = 0; i < num_entry_points; ++i)
+				{
+					errors += entry_point_errors[i];
+
+					if (!entry_point_succeeded[i])
 					{
 						compiled = false;
 						break;
 					}
-
-					save_effect_cache(cache_id, "cso", cso);
-					save_effect_cache(cache_id, "asm", assembly);
 				}
 			}
+
+			time_assemble_finished = std::chrono::high_resolution_clock::now();
 		}
 
 		const std::unique_lock<std::shared_mutex> lock(_reload_mutex);
@@ -2061,6 +2382,16 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 
 	const std::chrono::high_resolution_clock::time_point time_load_finished = std::chrono::high_resolution_clock::now();
 
+#if RESHADE_VERBOSE_LOG
+	// Report time spent in each stage, to see which one is on the critical path when loading many effects
+	log::message(log::level::debug, "Loading '%s'%s took %f s for preprocessing, %f s for parsing and code generation, %f s for assembly and %f s for effect setup.",
+		source_file.u8string().c_str(), permutation_index == 0 ? "" : " permutation",
+		std::chrono::duration_cast<std::chrono::microseconds>(time_preprocess_finished - time_load_started).count() * 1e-6f,
+		std::chrono::duration_cast<std::chrono::microseconds>(time_codegen_finished - time_preprocess_finished).count() * 1e-6f,
+		std::chrono::duration_cast<std::chrono::microseconds>(time_assemble_finished - time_codegen_finished).count() * 1e-6f,
+		std::chrono::duration_cast<std::chrono::microseconds>(time_load_finished - time_assemble_finished).count() * 1e-6f);
+#endif
+
 	if (_reload_remaining_effects != std::numeric_limits<size_t>::max())
 	{
 		assert(_reload_remaining_effects != 0);
@@ -2260,8 +2591,11 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 	{
 		if (permutation_index == 0)
 		{
+			// Partial uploads in OpenGL go through 'glBufferSubData', which requires the buffer to be created with dynamic storage
+			const api::resource_flags cb_flags = (_device->get_api() == api::device_api::opengl) ? api::resource_flags::dynamic : api::resource_flags::none;
+
 			if (!_device->create_resource(
-					api::resource_desc(effect.uniform_data_storage.size(), api::memory_heap::cpu_to_gpu, api::resource_usage::constant_buffer),
+					api::resource_desc(effect.uniform_data_storage.size(), api::memory_heap::cpu_to_gpu, api::resource_usage::constant_buffer, cb_flags),
 					nullptr, api::resource_usage::cpu_access, &effect.cb))
 			{
 				log::message(log::level::error, "Failed to create constant buffer for effect file '%s'!", effect.source_file.u8string().c_str());
@@ -2269,6 +2603,9 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 			}
 
 			_device->set_resource_name(effect.cb, "ReShade constant buffer");
+
+			// Contents of the new buffer are undefined, so have to upload everything before it is first used
+			effect.mark_uniform_data_dirty(0, effect.uniform_data_storage.size());
 		}
 		else
 		{
@@ -2961,26 +3298,22 @@ void reshade::runtime::load_textures(size_t effect_index)
 			continue;
 		}
 
+		const size_t num_pixels = static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(depth);
+
 		// Collapse data to the correct number of components per pixel based on the texture format
 		switch (tex.format)
 		{
 		case reshadefx::texture_format::r8:
-			for (size_t i = 4, k = 1; i < static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(depth) * 4; i += 4, k += 1)
-				static_cast<stbi_uc *>(pixels)[k] = static_cast<stbi_uc *>(pixels)[i];
+			pixel_conversion::pack_rgba8_to_r8(static_cast<stbi_uc *>(pixels), static_cast<const stbi_uc *>(pixels), num_pixels);
 			break;
 		case reshadefx::texture_format::r32f:
-			for (size_t i = 4, k = 1; i < static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(depth) * 4; i += 4, k += 1)
-				static_cast<float *>(pixels)[k] = static_cast<float *>(pixels)[i];
+			pixel_conversion::pack_rgba32f_to_r32f(static_cast<float *>(pixels), static_cast<const float *>(pixels), num_pixels);
 			break;
 		case reshadefx::texture_format::rg8:
-			for (size_t i = 4, k = 2; i < static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(depth) * 4; i += 4, k += 2)
-				static_cast<stbi_uc *>(pixels)[k + 0] = static_cast<stbi_uc *>(pixels)[i + 0],
-				static_cast<stbi_uc *>(pixels)[k + 1] = static_cast<stbi_uc *>(pixels)[i + 1];
+			pixel_conversion::pack_rgba8_to_rg8(static_cast<stbi_uc *>(pixels), static_cast<const stbi_uc *>(pixels), num_pixels);
 			break;
 		case reshadefx::texture_format::rg32f:
-			for (size_t i = 4, k = 2; i < static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(depth) * 4; i += 4, k += 2)
-				static_cast<float *>(pixels)[k + 0] = static_cast<float *>(pixels)[i + 0],
-				static_cast<float *>(pixels)[k + 1] = static_cast<float *>(pixels)[i + 1];
+			pixel_conversion::pack_rgba32f_to_rg32f(static_cast<float *>(pixels), static_cast<const float *>(pixels), num_pixels);
 			break;
 		case reshadefx::texture_format::rgba8:
 		case reshadefx::texture_format::rgba32f:
@@ -3298,6 +3631,27 @@ void reshade::runtime::load_effects(bool force_load_all)
 	if (effect_files.empty())
 		return; // No effect files found, so nothing more to do
 
+	// Resolve the include paths once here, instead of walking through all recursive search paths again for every effect
+	_effect_include_paths.clear();
+	for (std::filesystem::path include_path : _effect_search_paths)
+	{
+		const bool recursive_search = include_path.filename() == L"**";
+		if (recursive_search)
+			include_path.remove_filename();
+
+		if (std::error_code ec; resolve_path(include_path, ec))
+		{
+			_effect_include_paths.emplace(include_path);
+
+			if (recursive_search)
+			{
+				for (const std::filesystem::directory_entry &entry : std::filesystem::recursive_directory_iterator(include_path, std::filesystem::directory_options::skip_permission_denied, ec))
+					if (entry.is_directory(ec))
+						_effect_include_paths.emplace(entry);
+			}
+		}
+	}
+
 	ini_file &preset = ini_file::load_cache(_current_preset_path);
 
 	// Have to be initialized at this point or else the threads spawned below will immediately exit without reducing the remaining effects count
@@ -3314,21 +3668,27 @@ void reshade::runtime::load_effects(bool force_load_all)
 	_effects.resize(offset + effect_files.size());
 	_reload_remaining_effects = effect_files.size();
 
-	// Now that we have a list of files, load them in parallel
-	// Split workload into batches instead of launching a thread for every file to avoid launch overhead and stutters due to too many threads being in flight
-	size_t num_splits = std::min(effect_files.size(), static_cast<size_t>(std::max(std::thread::hardware_concurrency(), 2u) - 1));
-#ifndef _WIN64
-	// Limit number of threads in 32-bit due to the limited about of address space being available there and compilation being memory hungry
-	num_splits = std::min(num_splits, static_cast<size_t>(4));
-#endif
+	// Start with the largest effect files, since those usually take the longest to compile and would otherwise hold up the end of loading while all other workers are idle
+	// File size is only an estimate of compile time, but workers steal pending effects from each other, so the remaining effects still balance out between them
+	std::vector<std::pair<uintmax_t, size_t>> effect_load_order;
+	effect_load_order.reserve(effect_files.size());
+	for (size_t i = 0; i < effect_files.size(); ++i)
+	{
+		std::error_code ec;
+		const uintmax_t file_size = std::filesystem::file_size(effect_files[i], ec);
+		effect_load_order.emplace_back(ec ? 0 : file_size, i);
+	}
+	std::stable_sort(effect_load_order.begin(), effect_load_order.end(),
+		[](const std::pair<uintmax_t, size_t> &lhs, const std::pair<uintmax_t, size_t> &rhs) {
+			return lhs.first > rhs.first;
+		});
 
-	// Keep track of the spawned threads, so the runtime cannot be destroyed while they are still running
-	for (size_t n = 0; n < num_splits; ++n)
-		_worker_threads.emplace_back([this, effect_files, offset, num_splits, n, &preset, force_load_all]() {
+	// Now that we have a list of files, load them in parallel
+	for (const std::pair<uintmax_t, size_t> &effect_load : effect_load_order)
+		_task_pool->submit([this, effect_file = effect_files[effect_load.second], effect_index = offset + effect_load.second, &preset, force_load_all]() {
 			// Abort loading when initialization state changes (indicating that 'on_reset' was called in the meantime)
-			for (size_t i = 0; i < effect_files.size() && _is_initialized; ++i)
-				if (i * num_splits / effect_files.size() == n)
-					load_effect(effect_files[i], preset, offset + i, 0, force_load_all || effect_files[i].extension() == L".addonfx");
+			if (_is_initialized)
+				load_effect(effect_file, preset, effect_index, 0, force_load_all || effect_file.extension() == L".addonfx");
 		});
 }
 bool reshade::runtime::reload_effect(size_t effect_index)
@@ -3360,6 +3720,9 @@ void reshade::runtime::reload_effects(bool force_load_all)
 	// Clear out any previous effects
 	destroy_effects();
 
+	// Drop included files cached during the previous load, no preprocessor is running anymore at this point
+	reshadefx::preprocessor::clear_include_cache();
+
 #if RESHADE_ADDON
 	// Call event after destroying previous effects, so add-ons get a chance to release any handles they hold to variables and techniques
 	invoke_addon_event<addon_event::reshade_reloaded_effects>(this);
@@ -3377,6 +3740,10 @@ void reshade::runtime::reload_effects(bool force_load_all)
 void reshade::runtime::destroy_effects()
 {
 	// Make sure no threads are still accessing effect data
+	// Effects that have not started loading yet are dropped, so that this does not have to wait for all of them to finish after a reset
+	_task_pool->cancel();
+	_task_pool->wait_idle();
+
 	for (std::thread &thread : _worker_threads)
 		if (thread.joinable())
 			thread.join();
@@ -3413,46 +3780,26 @@ void reshade::runtime::destroy_effects()
 
 bool reshade::runtime::load_effect_cache(const std::string &id, const std::string &type, std::string &data) const
 {
-	if (_no_effect_cache)
+	if (_no_effect_cache || _effect_cache_pack == nullptr)
 		return false;
 
-	std::filesystem::path path = g_reshade_base_path / _effect_cache_path;
-	path /= std::filesystem::u8path("reshade-" + id + '.' + type);
-
-	FILE *const file = _wfsopen(path.c_str(), L"rb", SH_DENYNO);
-	if (file == nullptr)
-		return false;
-
-	fseek(file, 0, SEEK_END);
-	const size_t file_size = ftell(file);
-	fseek(file, 0, SEEK_SET);
-
-	data.resize(file_size, '\0');
-	const size_t file_size_read = fread(data.data(), 1, data.size(), file);
-	fclose(file);
-	return file_size_read == data.size();
+	return _effect_cache_pack->load(effect_cache_pack::compute_key(id + '.' + type), data);
 }
 bool reshade::runtime::save_effect_cache(const std::string &id, const std::string &type, const std::string &data) const
 {
-	if (_no_effect_cache)
-		return false;
-
-	std::filesystem::path path = g_reshade_base_path / _effect_cache_path;
-	path /= std::filesystem::u8path("reshade-" + id + '.' + type);
-
-	FILE *const file = _wfsopen(path.c_str(), L"wb", SH_DENYNO);
-	if (file == nullptr)
+	if (_no_effect_cache || _effect_cache_pack == nullptr)
 		return false;
 
-	const size_t file_size_written = fwrite(data.data(), 1, data.size(), file);
-	fclose(file);
-	return file_size_written == data.size();
+	return _effect_cache_pack->save(effect_cache_pack::compute_key(id + '.' + type), data);
 }
 void reshade::runtime::clear_effect_cache()
 {
+	if (_effect_cache_pack != nullptr && !_effect_cache_pack->clear())
+		log::message(log::level::error, "Failed to clear effect cache pack file '%s'!", _effect_cache_pack->path().u8string().c_str());
+
 	std::error_code ec;
 
-	// Find all cached effect files and delete them
+	// Find all loose cached effect files written by previous versions and delete them
 	for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(g_reshade_base_path / _effect_cache_path, std::filesystem::directory_options::skip_permission_denied, ec))
 	{
 		if (entry.is_directory(ec))
@@ -3582,7 +3929,7 @@ void reshade::runtime::update_effects()
 
 				_reload_remaining_effects += 1;
 
-				_worker_threads.emplace_back([this, effect_index, permutation_index]() {
+				_task_pool->submit([this, effect_index, permutation_index]() {
 						load_effect(_effects[effect_index].source_file, ini_file::load_cache(_current_preset_path), effect_index, permutation_index, true);
 					});
 			}
@@ -3598,6 +3945,9 @@ void reshade::runtime::update_effects()
 
 	if (_reload_remaining_effects == 0)
 	{
+		// Tasks may still be returning from 'load_effect' after decrementing the remaining effects count, so wait for them to finish before continuing
+		_task_pool->wait_idle();
+
 		// Clear the thread list now that they all have finished
 		for (std::thread &thread : _worker_threads)
 			if (thread.joinable())
@@ -3707,168 +4057,167 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 		input_lock = _input->lock();
 
 	// Update special uniform variables
+	// Values that are the same for every variable are computed once up front, the rest is driven by the per-effect plans that were resolved during loading
+	const float frame_time = _last_frame_duration.count() * 1e-6f;
+	const float frame_time_seconds = _last_frame_duration.count() * 1e-9f;
+	const unsigned int frame_count = static_cast<unsigned int>(_frame_count % UINT_MAX);
+	const bool frame_parity = (_frame_count % 2) == 0;
+	const unsigned int timer_ms = static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::milliseconds>(_last_present_time - _start_time).count());
+
 	for (effect &effect : _effects)
 	{
 		if (!effect.rendering || (!_effects_enabled && !effect.addon))
 			continue;
 
-		for (uniform &variable : effect.uniforms)
+		const special_uniform_plan &plan = effect.special_uniforms;
+
+		for (const uint32_t index : plan.frame_time)
+			set_uniform_value(effect.uniforms[index], frame_time);
+		for (const uint32_t index : plan.frame_count)
+			set_uniform_value(effect.uniforms[index], frame_count);
+		for (const uint32_t index : plan.frame_parity)
+			set_uniform_value(effect.uniforms[index], frame_parity);
+
+		for (size_t i = 0; i < plan.random.index.size(); ++i)
+			set_uniform_value(effect.uniforms[plan.random.index[i]], plan.random.min[i] + (std::rand() % plan.random.range[i]));
+
+		for (size_t i = 0; i < plan.ping_pong.index.size(); ++i)
 		{
-			switch (variable.special)
+			uniform &variable = effect.uniforms[plan.ping_pong.index[i]];
+
+			const float min = plan.ping_pong.min[i];
+			const float max = plan.ping_pong.max[i];
+			const float step_min = plan.ping_pong.step_min[i];
+			const float step_max = plan.ping_pong.step_max[i];
+			float increment = step_max == 0 ? step_min : (step_min + std::fmod(static_cast<float>(std::rand()), step_max - step_min + 1));
+			const float smoothing = plan.ping_pong.smoothing[i];
+
+			float value[2] = { 0, 0 };
+			get_uniform_value(variable, value, 2);
+			if (value[1] >= 0)
 			{
-			case special_uniform::frame_time:
-				set_uniform_value(variable, _last_frame_duration.count() * 1e-6f);
-				break;
-			case special_uniform::frame_count:
-				if (variable.type.is_boolean())
-					set_uniform_value(variable, (_frame_count % 2) == 0);
-				else
-					set_uniform_value(variable, static_cast<unsigned int>(_frame_count % UINT_MAX));
-				break;
-			case special_uniform::random:
-				{
-					const int min = variable.annotation_as_int("min", 0, 0);
-					const int max = variable.annotation_as_int("max", 0, RAND_MAX);
-					set_uniform_value(variable, min + (std::rand() % (std::abs(max - min) + 1)));
-				}
-				break;
-			case special_uniform::ping_pong:
-				{
-					const float min = variable.annotation_as_float("min", 0, 0.0f);
-					const float max = variable.annotation_as_float("max", 0, 1.0f);
-					const float step_min = variable.annotation_as_float("step", 0);
-					const float step_max = variable.annotation_as_float("step", 1);
-					float increment = step_max == 0 ? step_min : (step_min + std::fmod(static_cast<float>(std::rand()), step_max - step_min + 1));
-					const float smoothing = variable.annotation_as_float("smoothing");
-
-					float value[2] = { 0, 0 };
-					get_uniform_value(variable, value, 2);
-					if (value[1] >= 0)
-					{
-						increment = std::max(increment - std::max(0.0f, smoothing - (max - value[0])), 0.05f);
-						increment *= _last_frame_duration.count() * 1e-9f;
+				increment = std::max(increment - std::max(0.0f, smoothing - (max - value[0])), 0.05f);
+				increment *= frame_time_seconds;
 
-						if ((value[0] += increment) >= max)
-							value[0] = max, value[1] = -1;
-					}
-					else
-					{
-						increment = std::max(increment - std::max(0.0f, smoothing - (value[0] - min)), 0.05f);
-						increment *= _last_frame_duration.count() * 1e-9f;
+				if ((value[0] += increment) >= max)
+					value[0] = max, value[1] = -1;
+			}
+			else
+			{
+				increment = std::max(increment - std::max(0.0f, smoothing - (value[0] - min)), 0.05f);
+				increment *= frame_time_seconds;
 
-						if ((value[0] -= increment) <= min)
-							value[0] = min, value[1] = +1;
-					}
-					set_uniform_value(variable, value, 2);
-				}
-				break;
-			case special_uniform::date:
-				{
-					const std::time_t t = std::chrono::system_clock::to_time_t(_current_time);
-					struct tm tm; localtime_s(&tm, &t);
-
-					const int value[4] = {
-						tm.tm_year + 1900,
-						tm.tm_mon + 1,
-						tm.tm_mday,
-						tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec
-					};
-					set_uniform_value(variable, value, 4);
-				}
-				break;
-			case special_uniform::timer:
-				{
-					const unsigned long long timer_ms = std::chrono::duration_cast<std::chrono::milliseconds>(_last_present_time - _start_time).count();
-					set_uniform_value(variable, static_cast<unsigned int>(timer_ms));
-				}
-				break;
-			case special_uniform::key:
-				if (_input != nullptr)
-				{
-					const int keycode = variable.annotation_as_int("keycode");
-					if (keycode <= 7 || keycode >= 256)
-						break;
+				if ((value[0] -= increment) <= min)
+					value[0] = min, value[1] = +1;
+			}
+			set_uniform_value(variable, value, 2);
+		}
+
+		if (!plan.date.empty())
+		{
+			const std::time_t t = std::chrono::system_clock::to_time_t(_current_time);
+			struct tm tm; localtime_s(&tm, &t);
+
+			const int value[4] = {
+				tm.tm_year + 1900,
+				tm.tm_mon + 1,
+				tm.tm_mday,
+				tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec
+			};
+
+			for (const uint32_t index : plan.date)
+				set_uniform_value(effect.uniforms[index], value, 4);
+		}
+
+		for (const uint32_t index : plan.timer)
+			set_uniform_value(effect.uniforms[index], timer_ms);
+
+		if (_input != nullptr)
+		{
+			for (size_t i = 0; i < plan.key.index.size(); ++i)
+			{
+				uniform &variable = effect.uniforms[plan.key.index[i]];
+				const int keycode = plan.key.keycode[i];
 
-					const std::string_view mode = variable.annotation_as_string("mode");
-					if (mode == "toggle" || variable.annotation_as_int("toggle"))
+				switch (plan.key.mode[i])
+				{
+				case special_uniform_plan::input_mode::toggle:
+					if (_input->is_key_pressed(keycode))
 					{
 						bool current_value = false;
 						get_uniform_value(variable, &current_value);
-						if (_input->is_key_pressed(keycode))
-							set_uniform_value(variable, !current_value);
+						set_uniform_value(variable, !current_value);
 					}
-					else if (mode == "press")
-						set_uniform_value(variable, _input->is_key_pressed(keycode));
-					else
-						set_uniform_value(variable, _input->is_key_down(keycode));
+					break;
+				case special_uniform_plan::input_mode::press:
+					set_uniform_value(variable, _input->is_key_pressed(keycode));
+					break;
+				case special_uniform_plan::input_mode::down:
+					set_uniform_value(variable, _input->is_key_down(keycode));
+					break;
 				}
-				break;
-			case special_uniform::mouse_point:
-				if (_input != nullptr)
-					set_uniform_value(variable, _input->mouse_position_x(), _input->mouse_position_y());
-				break;
-			case special_uniform::mouse_delta:
-				if (_input != nullptr)
-					set_uniform_value(variable, _input->mouse_movement_delta_x(), _input->mouse_movement_delta_y());
-				break;
-			case special_uniform::mouse_button:
-				if (_input != nullptr)
-				{
-					const int keycode = variable.annotation_as_int("keycode");
-					if (keycode < 0 || keycode >= 5)
-						break;
+			}
+
+			for (const uint32_t index : plan.mouse_point)
+				set_uniform_value(effect.uniforms[index], _input->mouse_position_x(), _input->mouse_position_y());
+			for (const uint32_t index : plan.mouse_delta)
+				set_uniform_value(effect.uniforms[index], _input->mouse_movement_delta_x(), _input->mouse_movement_delta_y());
+
+			for (size_t i = 0; i < plan.mouse_button.index.size(); ++i)
+			{
+				uniform &variable = effect.uniforms[plan.mouse_button.index[i]];
+				const int keycode = plan.mouse_button.keycode[i];
 
-					const std::string_view mode = variable.annotation_as_string("mode");
-					if (mode == "toggle" || variable.annotation_as_int("toggle"))
+				switch (plan.mouse_button.mode[i])
+				{
+				case special_uniform_plan::input_mode::toggle:
+					if (_input->is_mouse_button_pressed(keycode))
 					{
 						bool current_value = false;
 						get_uniform_value(variable, &current_value);
-						if (_input->is_mouse_button_pressed(keycode))
-							set_uniform_value(variable, !current_value);
+						set_uniform_value(variable, !current_value);
 					}
-					else if (mode == "press")
-						set_uniform_value(variable, _input->is_mouse_button_pressed(keycode));
-					else
-						set_uniform_value(variable, _input->is_mouse_button_down(keycode));
+					break;
+				case special_uniform_plan::input_mode::press:
+					set_uniform_value(variable, _input->is_mouse_button_pressed(keycode));
+					break;
+				case special_uniform_plan::input_mode::down:
+					set_uniform_value(variable, _input->is_mouse_button_down(keycode));
+					break;
 				}
-				break;
-			case special_uniform::mouse_wheel:
-				if (_input != nullptr)
+			}
+
+			for (size_t i = 0; i < plan.mouse_wheel.index.size(); ++i)
+			{
+				uniform &variable = effect.uniforms[plan.mouse_wheel.index[i]];
+
+				const float min = plan.mouse_wheel.min[i];
+				const float max = plan.mouse_wheel.max[i];
+
+				float value[2] = { 0, 0 };
+				get_uniform_value(variable, value, 2);
+				value[1] = _input->mouse_wheel_delta();
+				value[0] = value[0] + value[1] * plan.mouse_wheel.step[i];
+				if (min != max)
 				{
-					const float min = variable.annotation_as_float("min");
-					const float max = variable.annotation_as_float("max");
-					float step = variable.annotation_as_float("step");
-					if (step == 0.0f)
-						step = 1.0f;
-
-					float value[2] = { 0, 0 };
-					get_uniform_value(variable, value, 2);
-					value[1] = _input->mouse_wheel_delta();
-					value[0] = value[0] + value[1] * step;
-					if (min != max)
-					{
-						value[0] = std::max(value[0], min);
-						value[0] = std::min(value[0], max);
-					}
-					set_uniform_value(variable, value, 2);
+					value[0] = std::max(value[0], min);
+					value[0] = std::min(value[0], max);
 				}
-				break;
-#if RESHADE_GUI
-			case special_uniform::overlay_open:
-				set_uniform_value(variable, _show_overlay);
-				break;
-			case special_uniform::overlay_active:
-			case special_uniform::overlay_hovered:
-				// These are set in 'draw_variable_editor' when overlay is open
-				if (!_show_overlay)
-					set_uniform_value(variable, 0);
-				break;
-#endif
-			case special_uniform::screenshot:
-				set_uniform_value(variable, _should_save_screenshot);
-				break;
+				set_uniform_value(variable, value, 2);
 			}
 		}
+
+#if RESHADE_GUI
+		for (const uint32_t index : plan.overlay_open)
+			set_uniform_value(effect.uniforms[index], _show_overlay);
+		// These are set in 'draw_variable_editor' when overlay is open
+		if (!_show_overlay)
+			for (const uint32_t index : plan.overlay_state)
+				set_uniform_value(effect.uniforms[index], 0);
+#endif
+
+		for (const uint32_t index : plan.screenshot)
+			set_uniform_value(effect.uniforms[index], _should_save_screenshot);
 	}
 
 	if (rtv == 0)
@@ -3987,11 +4336,59 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 #endif
 
 	// Update shader constants
-	if (void *mapped_uniform_data;
-		effect.cb != 0 && _device->map_buffer_region(effect.cb, 0, effect.uniform_data_storage.size(), api::map_access::write_discard, &mapped_uniform_data))
+	// Only the range that was modified since the last upload is written, so the constant buffer is uploaded at most once per frame even when multiple techniques of the same effect are rendered, and not at all when nothing changed
+	if (effect.cb != 0)
 	{
-		std::memcpy(mapped_uniform_data, effect.uniform_data_storage.data(), effect.uniform_data_storage.size());
-		_device->unmap_buffer_region(effect.cb);
+		if (effect.uniform_data_dirty_begin < effect.uniform_data_dirty_end)
+		{
+			size_t offset = effect.uniform_data_dirty_begin;
+			size_t size = std::min(effect.uniform_data_dirty_end, effect.uniform_data_storage.size()) - offset;
+
+			bool uploaded = false;
+			switch (_device->get_api())
+			{
+			case api::device_api::opengl:
+				// Small changes are cheaper to upload through the command stream than by orphaning the entire buffer
+				if (size <= effect.uniform_data_storage.size() / 2)
+				{
+					cmd_list->update_buffer_region(effect.uniform_data_storage.data() + offset, effect.cb, offset, size);
+					uploaded = true;
+				}
+				break;
+			case api::device_api::d3d12:
+			case api::device_api::vulkan:
+				// Upload heap buffers are mapped persistently, so can write just the modified range
+				if (void *mapped_uniform_data; _device->map_buffer_region(effect.cb, offset, size, api::map_access::write_only, &mapped_uniform_data))
+				{
+					std::memcpy(mapped_uniform_data, effect.uniform_data_storage.data() + offset, size);
+					_device->unmap_buffer_region(effect.cb);
+					uploaded = true;
+				}
+				break;
+			}
+
+			// Dynamic buffers in D3D10/D3D11 can only be mapped with discard, which requires writing the entire buffer
+			if (!uploaded)
+			{
+				offset = 0;
+				size = effect.uniform_data_storage.size();
+
+				if (void *mapped_uniform_data; _device->map_buffer_region(effect.cb, 0, size, api::map_access::write_discard, &mapped_uniform_data))
+				{
+					std::memcpy(mapped_uniform_data, effect.uniform_data_storage.data(), size);
+					_device->unmap_buffer_region(effect.cb);
+					uploaded = true;
+				}
+			}
+
+			if (uploaded)
+			{
+				effect.uniform_data_dirty_begin = effect.uniform_data_dirty_end = 0;
+
+				_uniform_upload_bytes += size;
+				_uniform_upload_count++;
+			}
+		}
 	}
 	else if (_device->get_api() == api::device_api::d3d9)
 	{
@@ -4241,14 +4638,14 @@ void reshade::runtime::save_texture(const texture &tex)
 
 	_last_screenshot_save_successful = true;
 
-	if (std::vector<uint8_t> pixels(static_cast<size_t>(tex.width) * static_cast<size_t>(tex.height) * 4);
-		get_texture_data(tex.resource, api::resource_usage::shader_resource, pixels.data(), api::format::r8g8b8a8_unorm))
-	{
-		_worker_threads.emplace_back([this, screenshot_path, pixels = std::move(pixels), width = tex.width, height = tex.height]() mutable {
+	// Read back asynchronously, the file is written on a worker thread once the copy finished on the GPU
+	enqueue_texture_readback(tex.resource, api::resource_usage::shader_resource, api::format::r8g8b8a8_unorm,
+		[this, screenshot_path, width = tex.width, height = tex.height](std::vector<uint8_t> &&pixels) {
 			// Default to a save failure unless it is reported to succeed below
 			bool save_success = false;
 
-			if (FILE *const file = _wfsopen(screenshot_path.c_str(), L"wb", SH_DENYNO))
+			// Pixel data is empty if reading back the texture failed
+			if (FILE *const file = pixels.empty() ? nullptr : _wfsopen(screenshot_path.c_str(), L"wb", SH_DENYNO))
 			{
 				const auto write_callback = [](void *context, void *data, int size) {
 					fwrite(data, 1, size, static_cast<FILE *>(context));
@@ -4333,7 +4730,6 @@ void reshade::runtime::save_texture(const texture &tex)
 				_last_screenshot_save_successful = save_success;
 			}
 		});
-	}
 }
 void reshade::runtime::update_texture(texture &tex, uint32_t width, uint32_t height, uint32_t depth, const void *pixels)
 {
@@ -4431,6 +4827,7 @@ void reshade::runtime::reset_uniform_value(uniform &variable)
 	if (variable.special != reshade::special_uniform::none)
 	{
 		std::memset(_effects[variable.effect_index].uniform_data_storage.data() + variable.offset, 0, variable.size);
+		_effects[variable.effect_index].mark_uniform_data_dirty(variable.offset, variable.size);
 		return;
 	}
 
@@ -4566,7 +4963,8 @@ void reshade::runtime::set_uniform_value_data(uniform &variable, const uint8_t *
 	size = std::min(size, static_cast<size_t>(variable.size));
 	assert(data != nullptr && (size % 4) == 0);
 
-	std::vector<uint8_t> &data_storage = _effects[variable.effect_index].uniform_data_storage;
+	effect &effect = _effects[variable.effect_index];
+	std::vector<uint8_t> &data_storage = effect.uniform_data_storage;
 	assert(variable.offset + size <= data_storage.size());
 
 	const size_t array_length = (variable.type.is_array() ? variable.type.array_length : 1u);
@@ -4575,6 +4973,9 @@ void reshade::runtime::set_uniform_value_data(uniform &variable, const uint8_t *
 
 	if (variable.type.is_matrix())
 	{
+		// Elements are spread out due to alignment, so simply consider the entire variable modified
+		effect.mark_uniform_data_dirty(variable.offset, variable.size);
+
 		for (size_t a = base_index, i = 0; a < array_length; ++a)
 			// Each row of a matrix is 16-byte aligned, so needs special handling
 			for (size_t row = 0; row < variable.type.rows; ++row)
@@ -4585,6 +4986,8 @@ void reshade::runtime::set_uniform_value_data(uniform &variable, const uint8_t *
 	}
 	else if (array_length > 1)
 	{
+		effect.mark_uniform_data_dirty(variable.offset, variable.size);
+
 		for (size_t a = base_index, i = 0; a < array_length; ++a)
 			// Each element in the array is 16-byte aligned, so needs special handling
 			for (size_t row = 0; i < (size / 4) && row < variable.type.rows; ++row, ++i)
@@ -4592,8 +4995,11 @@ void reshade::runtime::set_uniform_value_data(uniform &variable, const uint8_t *
 					data_storage.data() + variable.offset + (a * 4 + row) * 4,
 					data + ((a - base_index) * variable.type.components() + row) * 4, 4);
 	}
-	else
+	// Avoid uploading the constant buffer again when a value did not actually change (which is common for special variables like key states)
+	else if (std::memcmp(data_storage.data() + variable.offset, data, size) != 0)
 	{
+		effect.mark_uniform_data_dirty(variable.offset, size);
+
 		std::memcpy(data_storage.data() + variable.offset, data, size);
 	}
 }
@@ -4817,23 +5223,29 @@ void reshade::runtime::save_screenshot(const char *postfix_in)
 
 	_last_screenshot_save_successful = true;
 
-	if (std::vector<uint8_t> pixels(static_cast<size_t>(_width) * static_cast<size_t>(_height) * (screenshot_format >= 4 ? 6 : 4));
-		get_texture_data(
-			_back_buffer_resolved != 0 ? _back_buffer_resolved : _swapchain->get_current_back_buffer(),
-			_back_buffer_resolved != 0 ? api::resource_usage::render_target : api::resource_usage::present,
-			pixels.data(),
-			screenshot_format >= 4 ? (_back_buffer_format == api::format::r16g16b16a16_float ? api::format::r16g16b16_float : api::format::r16g16b16_unorm) : api::format::r8g8b8a8_unorm))
-	{
-		const bool include_preset =
-			_screenshot_include_preset &&
-			postfix != "Before" && postfix != "Overlay" &&
-			ini_file::flush_cache(_current_preset_path);
+	// Preset is only flushed once the readback was successfully enqueued, but before the callback can run
+	const std::shared_ptr<bool> include_preset = std::make_shared<bool>(false);
+
+	// Only enqueue the copy here, the data is picked up a few frames later once the GPU finished it and then encoded on a worker thread, so that saving does not stall rendering
+	const bool enqueued = enqueue_texture_readback(
+		_back_buffer_resolved != 0 ? _back_buffer_resolved : _swapchain->get_current_back_buffer(),
+		_back_buffer_resolved != 0 ? api::resource_usage::render_target : api::resource_usage::present,
+		screenshot_format >= 4 ? (_back_buffer_format == api::format::r16g16b16a16_float ? api::format::r16g16b16_float : api::format::r16g16b16_unorm) : api::format::r8g8b8a8_unorm,
+		[this, screenshot_count, screenshot_format, screenshot_path, postfix, include_preset](std::vector<uint8_t> &&pixels) {
+			// Pixel data is empty if reading back the back buffer failed
+			if (pixels.empty())
+			{
+				log::message(log::level::error, "Failed to read back screenshot data for '%s'!", screenshot_path.u8string().c_str());
 
-		// Play screenshot sound
-		if (!_screenshot_sound_path.empty())
-			utils::play_sound_async(g_reshade_base_path / _screenshot_sound_path);
+				if (_last_screenshot_save_successful)
+				{
+					_last_screenshot_time = std::chrono::high_resolution_clock::now();
+					_last_screenshot_file = screenshot_path;
+					_last_screenshot_save_successful = false;
+				}
+				return;
+			}
 
-		_worker_threads.emplace_back([this, screenshot_count, screenshot_format, screenshot_path, postfix, pixels = std::move(pixels), include_preset]() mutable {
 			// Remove alpha channel
 			int comp = 4;
 			if (screenshot_format >= 4)
@@ -4843,8 +5255,7 @@ void reshade::runtime::save_screenshot(const char *postfix_in)
 			else if (_screenshot_clear_alpha)
 			{
 				comp = 3;
-				for (size_t i = 0; i < static_cast<size_t>(_width) * static_cast<size_t>(_height); ++i)
-					*reinterpret_cast<uint32_t *>(pixels.data() + 3 * i) = *reinterpret_cast<const uint32_t *>(pixels.data() + 4 * i);
+				pixel_conversion::pack_rgba8_to_rgb8(pixels.data(), pixels.data(), static_cast<size_t>(_width) * static_cast<size_t>(_height));
 			}
 
 			// Create screenshot directory if it does not exist
@@ -4883,50 +5294,8 @@ void reshade::runtime::save_screenshot(const char *postfix_in)
 				case 4: // HDR PNG
 					if (_back_buffer_format == api::format::r16g16b16a16_float)
 					{
-						if (!fpng::fpng_cpu_supports_sse41())
-						{
-							// Technically requires F16C instruction set, not just SSE4.1
-							save_success = false;
-							break;
-						}
-
-						for (size_t i = 0; i < static_cast<size_t>(_width) * static_cast<size_t>(_height); ++i)
-						{
-							uint16_t *const pixel = reinterpret_cast<uint16_t *>(pixels.data()) + i * 3;
-							alignas(16) uint16_t result[4] = { pixel[0], pixel[1], pixel[2] };
-
-							// Convert 16-bit floating point values to 32-bit floating point
-							auto rgba_float_srgb = _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(result)));
-
-							// Convert BT.709/sRGB to BT.2020 primaries
-							auto rgba_float_bt2100 = _mm_max_ps(_mm_setzero_ps(),
-								_mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(rgba_float_srgb, rgba_float_srgb, 0b00000000), _mm_setr_ps(0.627403914928436279296875f,     0.069097287952899932861328125f,    0.01639143936336040496826171875f, 0.0f)),
-								_mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(rgba_float_srgb, rgba_float_srgb, 0b01010101), _mm_setr_ps(0.3292830288410186767578125f,    0.9195404052734375f,               0.08801330626010894775390625f,    0.0f)),
-								           _mm_mul_ps(_mm_shuffle_ps(rgba_float_srgb, rgba_float_srgb, 0b10101010), _mm_setr_ps(0.0433130674064159393310546875f, 0.011362315155565738677978515625f, 0.895595252513885498046875f,      0.0f)))));
-
-							// Convert linear to PQ
-							// PQ constants as per Rec. ITU-R BT.2100-3 Table 4
-							const float PQ_m1 = 0.1593017578125f;
-							const float PQ_m2 = 78.84375f;
-							const float PQ_c1 = 0.8359375f;
-							const float PQ_c2 = 18.8515625f;
-							const float PQ_c3 = 18.6875f;
-
-							auto rgba_float_bt2100_pq = _mm_div_ps(rgba_float_bt2100, _mm_set_ps1(125.0f));
-							alignas(16) float temp[4];
-							_mm_store_ps(temp, rgba_float_bt2100_pq);
-							rgba_float_bt2100_pq = _mm_setr_ps(std::powf(temp[0], PQ_m1), std::powf(temp[1], PQ_m1), std::powf(temp[2], PQ_m1), 0.0f);
-							rgba_float_bt2100_pq = _mm_div_ps(_mm_add_ps(_mm_mul_ps(_mm_set_ps1(PQ_c2), rgba_float_bt2100_pq), _mm_set_ps1(PQ_c1)), _mm_add_ps(_mm_mul_ps(_mm_set_ps1(PQ_c3), rgba_float_bt2100_pq), _mm_set_ps1(1.0f)));
-							_mm_store_ps(temp, rgba_float_bt2100_pq);
-							rgba_float_bt2100_pq = _mm_setr_ps(std::powf(temp[0], PQ_m2), std::powf(temp[1], PQ_m2), std::powf(temp[2], PQ_m2), 0.0f);
-
-							// Convert to integers and pack into 16-bit range
-							_mm_storel_epi64(reinterpret_cast<__m128i *>(result), _mm_packus_epi32(_mm_cvtps_epi32(_mm_mul_ps(rgba_float_bt2100_pq, _mm_set_ps1(65536.0f))), _mm_setzero_si128()));
-
-							pixel[0] = result[0];
-							pixel[1] = result[1];
-							pixel[2] = result[2];
-						}
+						// Convert BT.709/sRGB to BT.2020 primaries and linear to PQ
+						pixel_conversion::encode_scrgb_half_to_hdr10_pq(reinterpret_cast<uint16_t *>(pixels.data()), reinterpret_cast<const uint16_t *>(pixels.data()), static_cast<size_t>(_width) * static_cast<size_t>(_height));
 					}
 
 					save_success = stbi_write_hdr_png_to_func(
@@ -5019,7 +5388,7 @@ void reshade::runtime::save_screenshot(const char *postfix_in)
 			{
 				execute_screenshot_post_save_command(screenshot_path, screenshot_count, postfix);
 
-				if (include_preset)
+				if (*include_preset)
 				{
 					std::filesystem::path screenshot_preset_path = screenshot_path;
 					screenshot_preset_path.replace_extension(L".ini");
@@ -5045,7 +5414,24 @@ void reshade::runtime::save_screenshot(const char *postfix_in)
 				_last_screenshot_save_successful = save_success;
 			}
 		});
+
+	// Do not flush the preset or play the sound for a screenshot that will never be written
+	if (!enqueued)
+	{
+		_last_screenshot_time = std::chrono::high_resolution_clock::now();
+		_last_screenshot_file = screenshot_path;
+		_last_screenshot_save_successful = false;
+		return;
 	}
+
+	*include_preset =
+		_screenshot_include_preset &&
+		postfix != "Before" && postfix != "Overlay" &&
+		ini_file::flush_cache(_current_preset_path);
+
+	// Play screenshot sound
+	if (!_screenshot_sound_path.empty())
+		utils::play_sound_async(g_reshade_base_path / _screenshot_sound_path);
 }
 bool reshade::runtime::execute_screenshot_post_save_command(const std::filesystem::path &screenshot_path, unsigned int screenshot_count, std::string_view postfix)
 {
@@ -5093,6 +5479,74 @@ bool reshade::runtime::execute_screenshot_post_save_command(const std::filesyste
 	return true;
 }
 
+static bool convert_texture_data(const uint8_t *mapped_pixels, uint32_t mapped_row_pitch, reshade::api::format intermediate_format, uint32_t width, uint32_t height, uint8_t *pixels, reshade::api::format quantization_format)
+{
+	const uint32_t pixels_row_pitch = reshade::api::format_row_pitch(quantization_format, width);
+
+	for (size_t y = 0; y < height; ++y, pixels += pixels_row_pitch, mapped_pixels += mapped_row_pitch)
+	{
+		if (quantization_format == intermediate_format)
+		{
+			std::memcpy(pixels, mapped_pixels, pixels_row_pitch);
+			continue;
+		}
+
+		if (quantization_format == reshade::api::format::r8g8b8a8_unorm)
+		{
+			switch (intermediate_format)
+			{
+			case reshade::api::format::r8_unorm:
+				reshade::pixel_conversion::expand_r8_to_rgba8(pixels, mapped_pixels, width);
+				continue;
+			case reshade::api::format::r8g8_unorm:
+				reshade::pixel_conversion::expand_rg8_to_rgba8(pixels, mapped_pixels, width);
+				continue;
+			case reshade::api::format::r8g8b8x8_unorm:
+				reshade::pixel_conversion::convert_rgba8(pixels, mapped_pixels, width, false, true);
+				continue;
+			case reshade::api::format::b8g8r8a8_unorm:
+				// Format is BGRA, but output should be RGBA, so flip channels
+				reshade::pixel_conversion::convert_rgba8(pixels, mapped_pixels, width, true, false);
+				continue;
+			case reshade::api::format::b8g8r8x8_unorm:
+				reshade::pixel_conversion::convert_rgba8(pixels, mapped_pixels, width, true, true);
+				continue;
+			case reshade::api::format::r10g10b10a2_unorm:
+			case reshade::api::format::b10g10r10a2_unorm:
+				reshade::pixel_conversion::unpack_rgb10a2_to_rgba8(pixels, reinterpret_cast<const uint32_t *>(mapped_pixels), width, intermediate_format == reshade::api::format::b10g10r10a2_unorm);
+				continue;
+			}
+		}
+		else if (quantization_format == reshade::api::format::r16g16b16_unorm)
+		{
+			switch (intermediate_format)
+			{
+			case reshade::api::format::r10g10b10a2_unorm:
+			case reshade::api::format::b10g10r10a2_unorm:
+				reshade::pixel_conversion::unpack_rgb10a2_to_rgb16(reinterpret_cast<uint16_t *>(pixels), reinterpret_cast<const uint32_t *>(mapped_pixels), width, intermediate_format == reshade::api::format::b10g10r10a2_unorm);
+				continue;
+			}
+		}
+		else if (quantization_format == reshade::api::format::r16g16b16_float && intermediate_format == reshade::api::format::r16g16b16a16_float)
+		{
+			reshade::pixel_conversion::pack_rgba16_to_rgb16(reinterpret_cast<uint16_t *>(pixels), reinterpret_cast<const uint16_t *>(mapped_pixels), width);
+			continue;
+		}
+		else if (quantization_format == reshade::api::format::r10g10b10a2_unorm && intermediate_format == reshade::api::format::b10g10r10a2_unorm)
+		{
+			// Format is BGRA, but output should be RGBA, so flip channels
+			reshade::pixel_conversion::swap_rb_rgb10a2(reinterpret_cast<uint32_t *>(pixels), reinterpret_cast<const uint32_t *>(mapped_pixels), width);
+			continue;
+		}
+
+		// Unsupported quantization
+		reshade::log::message(reshade::log::level::error, "Screenshots are not supported for format %u!", static_cast<uint32_t>(intermediate_format));
+		return false;
+	}
+
+	return true;
+}
+
 bool reshade::runtime::get_texture_data(api::resource resource, api::resource_usage state, uint8_t *pixels, api::format quantization_format)
 {
 	assert(quantization_format != api::format::unknown);
@@ -5121,140 +5575,162 @@ bool reshade::runtime::get_texture_data(api::resource resource, api::resource_us
 	_device->destroy_fence(copy_sync_fence);
 
 	// Copy data from intermediate image into output buffer
-	api::subresource_data mapped_data = {};
-	if (_device->map_texture_region(intermediate, 0, nullptr, api::map_access::read_only, &mapped_data))
+	bool result = false;
+	if (api::subresource_data mapped_data = {};
+		_device->map_texture_region(intermediate, 0, nullptr, api::map_access::read_only, &mapped_data))
+	{
+		result = convert_texture_data(static_cast<const uint8_t *>(mapped_data.data), mapped_data.row_pitch, intermediate_format, desc.texture.width, desc.texture.height, pixels, quantization_format);
+
+		_device->unmap_texture_region(intermediate, 0);
+	}
+
+	_device->destroy_resource(intermediate);
+
+	return result;
+}
+bool reshade::runtime::enqueue_texture_readback(api::resource resource, api::resource_usage state, api::format quantization_format, std::function<void(std::vector<uint8_t> &&pixels)> &&callback)
+{
+	assert(quantization_format != api::format::unknown);
+
+	const api::resource_desc desc = _device->get_resource_desc(resource);
+	const api::resource_desc intermediate_desc(desc.texture.width, desc.texture.height, 1, 1, api::format_to_default_typed(desc.texture.format, 0), 1, api::memory_heap::gpu_to_cpu, api::resource_usage::copy_dest);
+
+	if (_texture_readback_fence == 0 && !_device->create_fence(0, api::fence_flags::none, &_texture_readback_fence))
+		_texture_readback_fence = {};
+
+	// Limit the number of staging textures kept alive, in case many screenshots are requested in quick succession
+	constexpr size_t max_texture_readbacks = 4;
+
+	texture_readback *readback = nullptr;
+	for (texture_readback &candidate : _texture_readbacks)
 	{
-		auto mapped_pixels = static_cast<const uint8_t *>(mapped_data.data);
-		const uint32_t pixels_row_pitch = api::format_row_pitch(quantization_format, desc.texture.width);
+		if (candidate.pending)
+			continue;
+		// Prefer an idle staging texture that already has a matching description, to avoid creating a new one
+		if (readback == nullptr || (candidate.desc.texture.width == intermediate_desc.texture.width && candidate.desc.texture.height == intermediate_desc.texture.height && candidate.desc.texture.format == intermediate_desc.texture.format))
+			readback = &candidate;
+	}
 
-		for (size_t y = 0; y < desc.texture.height; ++y, pixels += pixels_row_pitch, mapped_pixels += mapped_data.row_pitch)
+	if (readback == nullptr)
+	{
+		if (_texture_readbacks.size() >= max_texture_readbacks)
 		{
-			if (quantization_format == intermediate_format)
-			{
-				std::memcpy(pixels, mapped_pixels, pixels_row_pitch);
-				continue;
-			}
+			// All staging textures are in flight, so have to wait for them to free one up
+			update_texture_readbacks(true);
+			readback = &_texture_readbacks.front();
+		}
+		else
+		{
+			readback = &_texture_readbacks.emplace_back();
+		}
+	}
 
-			if (quantization_format == api::format::r8g8b8a8_unorm)
-			{
-				switch (intermediate_format)
-				{
-				case api::format::r8_unorm:
-					for (size_t x = 0; x < desc.texture.width; ++x)
-					{
-						pixels[x * 4 + 0] = mapped_pixels[x];
-						pixels[x * 4 + 1] = 0;
-						pixels[x * 4 + 2] = 0;
-						pixels[x * 4 + 3] = 0xFF;
-					}
-					continue;
-				case api::format::r8g8_unorm:
-					for (size_t x = 0; x < desc.texture.width; ++x)
-					{
-						pixels[x * 4 + 0] = mapped_pixels[x * 2 + 0];
-						pixels[x * 4 + 1] = mapped_pixels[x * 2 + 1];
-						pixels[x * 4 + 2] = 0;
-						pixels[x * 4 + 3] = 0xFF;
-					}
-					continue;
-				case api::format::r8g8b8x8_unorm:
-					for (size_t x = 0; x < pixels_row_pitch; x += 4)
-					{
-						pixels[x + 0] = mapped_pixels[x + 0];
-						pixels[x + 1] = mapped_pixels[x + 1];
-						pixels[x + 2] = mapped_pixels[x + 2];
-						pixels[x + 3] = 0xFF;
-					}
-					continue;
-				case api::format::b8g8r8a8_unorm:
-					// Format is BGRA, but output should be RGBA, so flip channels
-					for (size_t x = 0; x < pixels_row_pitch; x += 4)
-					{
-						pixels[x + 0] = mapped_pixels[x + 2];
-						pixels[x + 1] = mapped_pixels[x + 1];
-						pixels[x + 2] = mapped_pixels[x + 0];
-						pixels[x + 3] = mapped_pixels[x + 3];
-					}
-					continue;
-				case api::format::b8g8r8x8_unorm:
-					for (size_t x = 0; x < pixels_row_pitch; x += 4)
-					{
-						pixels[x + 0] = mapped_pixels[x + 2];
-						pixels[x + 1] = mapped_pixels[x + 1];
-						pixels[x + 2] = mapped_pixels[x + 0];
-						pixels[x + 3] = 0xFF;
-					}
-					continue;
-				case api::format::r10g10b10a2_unorm:
-				case api::format::b10g10r10a2_unorm:
-					for (size_t x = 0; x < pixels_row_pitch; x += 4)
-					{
-						const auto offset_r = intermediate_format == api::format::b10g10r10a2_unorm ? 2 : 0;
-						const auto offset_g = 1;
-						const auto offset_b = intermediate_format == api::format::b10g10r10a2_unorm ? 0 : 2;
-						const auto offset_a = 3;
-
-						const uint32_t rgba = *reinterpret_cast<const uint32_t *>(mapped_pixels + x);
-						// Divide by 4 to get 10-bit range (0-1023) into 8-bit range (0-255)
-						pixels[x + offset_r] = (( rgba & 0x000003FFu)        /  4) & 0xFF;
-						pixels[x + offset_g] = (((rgba & 0x000FFC00u) >> 10) /  4) & 0xFF;
-						pixels[x + offset_b] = (((rgba & 0x3FF00000u) >> 20) /  4) & 0xFF;
-						pixels[x + offset_a] = (((rgba & 0xC0000000u) >> 30) * 85) & 0xFF;
-					}
-					continue;
-				}
-			}
-			else if (quantization_format == api::format::r16g16b16_unorm)
-			{
-				switch (intermediate_format)
-				{
-				case api::format::r10g10b10a2_unorm:
-				case api::format::b10g10r10a2_unorm:
-					for (size_t x = 0; x < pixels_row_pitch; x += sizeof(uint16_t) * 3)
-					{
-						const auto offset_r = intermediate_format == api::format::b10g10r10a2_unorm ? 2 : 0;
-						const auto offset_g = 1;
-						const auto offset_b = intermediate_format == api::format::b10g10r10a2_unorm ? 0 : 2;
-
-						const uint32_t rgba = *reinterpret_cast<const uint32_t *>(mapped_pixels + (x / (sizeof(uint16_t) * 3)) * 4);
-						// Multiply by 64 to get 10-bit range (0-1023) into 16-bit range (0-65535)
-						reinterpret_cast<uint16_t *>(pixels + x)[offset_r] = ( (rgba & 0x000003FFu)        * 64) & 0xFFFF;
-						reinterpret_cast<uint16_t *>(pixels + x)[offset_g] = (((rgba & 0x000FFC00u) >> 10) * 64) & 0xFFFF;
-						reinterpret_cast<uint16_t *>(pixels + x)[offset_b] = (((rgba & 0x3FF00000u) >> 20) * 64) & 0xFFFF;
-					}
-					continue;
-				}
-			}
-			else if (quantization_format == api::format::r16g16b16_float && intermediate_format == api::format::r16g16b16a16_float)
-			{
-				for (size_t x = 0; x < pixels_row_pitch; x += sizeof(uint16_t) * 3)
-				{
-					std::memcpy(pixels + x, mapped_pixels + (x / 3) * 4, sizeof(uint16_t) * 3);
-				}
-				continue;
-			}
-			else if (quantization_format == api::format::r10g10b10a2_unorm && intermediate_format == api::format::b10g10r10a2_unorm)
-			{
-				// Format is BGRA, but output should be RGBA, so flip channels
-				for (size_t x = 0; x < pixels_row_pitch; x += sizeof(uint32_t))
-				{
-					const uint32_t rgba = *reinterpret_cast<const uint32_t *>(mapped_pixels + x);
-					*reinterpret_cast<uint32_t *>(pixels + x) = ((rgba & 0x000003FFu) << 20) | ((rgba & 0x3FF00000u) >> 20) | (rgba & 0xC00FFC00u);
-				}
+	if (readback->intermediate == 0 || readback->desc.texture.width != intermediate_desc.texture.width || readback->desc.texture.height != intermediate_desc.texture.height || readback->desc.texture.format != intermediate_desc.texture.format)
+	{
+		_device->destroy_resource(readback->intermediate);
+		readback->intermediate = {};
+
+		if (!_device->create_resource(intermediate_desc, nullptr, api::resource_usage::copy_dest, &readback->intermediate))
+		{
+			log::message(log::level::error, "Failed to create system memory texture for screenshot capture!");
+			return false;
+		}
+
+		_device->set_resource_name(readback->intermediate, "ReShade screenshot texture");
+
+		readback->desc = intermediate_desc;
+	}
+
+	api::command_list *const cmd_list = _graphics_queue->get_immediate_command_list();
+	cmd_list->barrier(resource, state, api::resource_usage::copy_source);
+	cmd_list->copy_texture_region(resource, 0, nullptr, readback->intermediate, 0, nullptr);
+	cmd_list->barrier(resource, api::resource_usage::copy_source, state);
+
+	readback->quantization_format = quantization_format;
+	readback->callback = std::move(callback);
+	readback->pending = true;
+
+	// Fall back to waiting for the copy right away if the device does not support fences
+	if (_texture_readback_fence != 0 && _graphics_queue->signal(_texture_readback_fence, ++_texture_readback_fence_value))
+	{
+		readback->fence_value = _texture_readback_fence_value;
+	}
+	else
+	{
+		_graphics_queue->wait_idle();
+		readback->fence_value = 0;
+	}
+
+	return true;
+}
+void reshade::runtime::update_texture_readbacks(bool wait_for_completion)
+{
+	for (texture_readback &readback : _texture_readbacks)
+	{
+		if (!readback.pending)
+			continue;
+
+		if (readback.fence_value != 0 && _device->get_completed_fence_value(_texture_readback_fence) < readback.fence_value)
+		{
+			if (!wait_for_completion)
 				continue;
-			}
 
-			// Unsupported quantization, return an error below
-			mapped_data.data = nullptr;
+			if (!_device->wait(_texture_readback_fence, readback.fence_value))
+				_graphics_queue->wait_idle();
+		}
 
-			log::message(log::level::error, "Screenshots are not supported for format %u!", static_cast<uint32_t>(desc.texture.format));
-			break;
+		readback.pending = false;
+
+		// Only copy the raw data on this thread and leave format conversion and the callback to a worker thread
+		const uint32_t width = readback.desc.texture.width;
+		const uint32_t height = readback.desc.texture.height;
+		const api::format intermediate_format = readback.desc.texture.format;
+		const uint32_t row_pitch = api::format_row_pitch(intermediate_format, width);
+
+		std::vector<uint8_t> data;
+		if (api::subresource_data mapped_data = {};
+			_device->map_texture_region(readback.intermediate, 0, nullptr, api::map_access::read_only, &mapped_data))
+		{
+			data.resize(static_cast<size_t>(row_pitch) * height);
+
+			auto mapped_pixels = static_cast<const uint8_t *>(mapped_data.data);
+			if (mapped_data.row_pitch == row_pitch)
+				std::memcpy(data.data(), mapped_pixels, data.size());
+			else
+				for (size_t y = 0; y < height; ++y, mapped_pixels += mapped_data.row_pitch)
+					std::memcpy(data.data() + y * row_pitch, mapped_pixels, row_pitch);
+
+			_device->unmap_texture_region(readback.intermediate, 0);
 		}
 
-		_device->unmap_texture_region(intermediate, 0);
-	}
+		if (data.empty())
+		{
+			log::message(log::level::error, "Failed to map system memory texture for screenshot capture!");
 
-	_device->destroy_resource(intermediate);
+			// Report failure to the callback with empty pixel data
+			readback.callback({});
+			readback.callback = nullptr;
+			continue;
+		}
+
+		_worker_threads.emplace_back([data = std::move(data), callback = std::move(readback.callback), width, height, row_pitch, intermediate_format, quantization_format = readback.quantization_format]() {
+			if (std::vector<uint8_t> pixels(static_cast<size_t>(api::format_row_pitch(quantization_format, width)) * height);
+				convert_texture_data(data.data(), row_pitch, intermediate_format, width, height, pixels.data(), quantization_format))
+				callback(std::move(pixels));
+			else
+				callback({});
+		});
+
+		readback.callback = nullptr;
+	}
+}
+void reshade::runtime::destroy_texture_readbacks()
+{
+	for (const texture_readback &readback : _texture_readbacks)
+		_device->destroy_resource(readback.intermediate);
+	_texture_readbacks.clear();
 
-	return mapped_data.data != nullptr;
+	_device->destroy_fence(_texture_readback_fence);
+	_texture_readback_fence = {};
+	_texture_readback_fence_value = 0;
 }
@@ -8,11 +8,13 @@
 #include "reshade_api.hpp"
 #include "state_block.hpp"
 #include "imgui_code_editor.hpp"
+#include <set>
 #include <atomic>
 #include <thread>
 #include <chrono>
 #include <memory>
 #include <filesystem>
+#include <functional>
 #include <mutex>
 #include <shared_mutex>
 
@@ -233,6 +235,9 @@ namespace reshade
 		bool get_preprocessor_definition(const std::string &effect_name, const std::string &name, int scope_mask, std::vector<std::pair<std::string, std::string>> *&scope, std::vector<std::pair<std::string, std::string>>::iterator &value) const;
 
 		bool get_texture_data(api::resource resource, api::resource_usage state, uint8_t *pixels, api::format quantization_format);
+		bool enqueue_texture_readback(api::resource resource, api::resource_usage state, api::format quantization_format, std::function<void(std::vector<uint8_t> &&pixels)> &&callback);
+		void update_texture_readbacks(bool wait_for_completion = false);
+		void destroy_texture_readbacks();
 
 		bool execute_screenshot_post_save_command(const std::filesystem::path &screenshot_path, unsigned int screenshot_count, std::string_view postfix);
 
@@ -275,6 +280,9 @@ namespace reshade
 		uint64_t _frame_count = 0;
 		std::chrono::high_resolution_clock::duration _last_frame_duration;
 		std::chrono::high_resolution_clock::time_point _start_time, _last_present_time;
+		// Amount of uniform data uploaded to effect constant buffers during the current and the last frame
+		size_t _uniform_upload_bytes = 0, _last_frame_uniform_upload_bytes = 0;
+		unsigned int _uniform_upload_count = 0, _last_frame_uniform_upload_count = 0;
 		#pragma endregion
 
 		#pragma region Effect Loading
@@ -290,7 +298,11 @@ namespace reshade
 		std::vector<std::pair<size_t, size_t>> _reload_required_effects;
 
 		std::filesystem::path _effect_cache_path;
+		unsigned int _effect_cache_size = 1024;
+		std::unique_ptr<class effect_cache_pack> _effect_cache_pack;
 		std::vector<std::filesystem::path> _effect_search_paths;
+		// Effect search paths resolved to absolute paths, with recursive ones expanded to all their sub-directories (updated in 'load_effects')
+		std::set<std::filesystem::path> _effect_include_paths;
 		std::vector<std::filesystem::path> _texture_search_paths;
 
 		std::atomic<bool> _last_reload_successful = true;
@@ -304,6 +316,7 @@ namespace reshade
 		std::vector<size_t> _technique_sorting;
 
 		std::vector<std::thread> _worker_threads;
+		std::unique_ptr<class task_pool> _task_pool;
 		std::chrono::high_resolution_clock::time_point _last_reload_time;
 		#pragma endregion
 
@@ -365,6 +378,21 @@ namespace reshade
 		bool _screenshot_directory_creation_successful = true;
 		std::filesystem::path _last_screenshot_file;
 		std::chrono::high_resolution_clock::time_point _last_screenshot_time;
+
+		struct texture_readback
+		{
+			api::resource intermediate = {};
+			api::resource_desc desc;
+			api::format quantization_format = api::format::unknown;
+			uint64_t fence_value = 0;
+			bool pending = false;
+			std::function<void(std::vector<uint8_t> &&pixels)> callback;
+		};
+
+		// Staging textures are reused across screenshots and only read back once the GPU signaled the fence, so that saving does not stall rendering
+		std::vector<texture_readback> _texture_readbacks;
+		api::fence _texture_readback_fence = {};
+		uint64_t _texture_readback_fence_value = 0;
 		#pragma endregion
 
 		#pragma region Preset Switching
@@ -2532,6 +2532,7 @@ void reshade::runtime::draw_gui_statistics()
 		ImGui::TextUnformatted(_("Resolution:"));
 		ImGui::Text(_("Frame %llu:"), _frame_count + 1);
 		ImGui::TextUnformatted(_("Post-Processing:"));
+		ImGui::TextUnformatted(_("Uniform Uploads:"));
 
 		ImGui::EndGroup();
 		ImGui::SameLine(ImGui::GetWindowWidth() * 0.33333333f);
@@ -2570,6 +2571,7 @@ void reshade::runtime::draw_gui_statistics()
 		ImGui::Text("%ux%u", _effect_permutations[0].width, _effect_permutations[0].height);
 		ImGui::Text("%.2f fps", _imgui_context->IO.Framerate);
 		ImGui::Text("%*.3f ms CPU", cpu_digits + 4, post_processing_time_cpu * 1e-6f);
+		ImGui::Text("%.2f KiB", _last_frame_uniform_upload_bytes / 1024.0f);
 
 		ImGui::EndGroup();
 		ImGui::SameLine(ImGui::GetWindowWidth() * 0.66666666f);
@@ -2586,6 +2588,9 @@ void reshade::runtime::draw_gui_statistics()
 		ImGui::Text("%*.3f ms", gpu_digits + 4, _last_frame_duration.count() * 1e-6f);
 		if (_gather_gpu_statistics && post_processing_time_gpu != 0)
 			ImGui::Text("%*.3f ms GPU", gpu_digits + 4, (post_processing_time_gpu * 1e-6f));
+		else
+			ImGui::NewLine();
+		ImGui::Text(_("%u buffer updates"), _last_frame_uniform_upload_count);
 
 		ImGui::EndGroup();
 	}
@@ -5,33 +5,11 @@
 
 #pragma once
 
-#include "effect_module.hpp"
 #include "moving_average.hpp"
-#include <algorithm>
+#include "runtime_special_uniforms.hpp"
 
 namespace reshade
 {
-	enum class special_uniform
-	{
-		none,
-		frame_time,
-		frame_count,
-		random,
-		ping_pong,
-		date,
-		timer,
-		key,
-		mouse_point,
-		mouse_delta,
-		mouse_button,
-		mouse_wheel,
-		overlay_open,
-		overlay_active,
-		overlay_hovered,
-		screenshot,
-		unknown
-	};
-
 	struct texture : reshadefx::texture
 	{
 		texture(const reshadefx::texture &init) : reshadefx::texture(init) {}
@@ -78,55 +56,6 @@ namespace reshade
 		std::vector<api::resource_view> uav;
 	};
 
-	struct uniform : reshadefx::uniform
-	{
-		uniform(const reshadefx::uniform &init) : reshadefx::uniform(init) {}
-
-		auto annotation_as_int(const std::string_view ann_name, size_t i = 0, int default_value = 0) const
-		{
-			const auto it = std::find_if(annotations.cbegin(), annotations.cend(),
-				[ann_name](const reshadefx::annotation &annotation) { return annotation.name == ann_name; });
-			return it != annotations.cend() && i < 16 ?
-				(it->type.is_integral() ? it->value.as_int[i] : static_cast<int>(it->value.as_float[i])) : default_value;
-		}
-		auto annotation_as_uint(const std::string_view ann_name, size_t i = 0, unsigned int default_value = 0) const
-		{
-			const auto it = std::find_if(annotations.cbegin(), annotations.cend(),
-				[ann_name](const reshadefx::annotation &annotation) { return annotation.name == ann_name; });
-			return it != annotations.cend() && i < 16 ?
-				(it->type.is_integral() ? it->value.as_uint[i] : static_cast<unsigned int>(it->value.as_float[i])) : default_value;
-		}
-		auto annotation_as_float(const std::string_view ann_name, size_t i = 0, float default_value = 0.0f) const
-		{
-			const auto it = std::find_if(annotations.cbegin(), annotations.cend(),
-				[ann_name](const reshadefx::annotation &annotation) { return annotation.name == ann_name; });
-			return it != annotations.cend() && i < 16 ?
-				(it->type.is_floating_point() ? it->value.as_float[i] : static_cast<float>(it->value.as_int[i])) : default_value;
-		}
-		auto annotation_as_string(const std::string_view ann_name, const std::string_view default_value = std::string_view()) const
-		{
-			const auto it = std::find_if(annotations.cbegin(), annotations.cend(),
-				[ann_name](const reshadefx::annotation &annotation) { return annotation.name == ann_name; });
-			return it != annotations.cend() ?
-				std::string_view(it->value.string_data) : default_value;
-		}
-
-		bool supports_toggle_key() const
-		{
-			if (type.base == reshadefx::type::t_bool)
-				return true;
-			if (type.base != reshadefx::type::t_int && type.base != reshadefx::type::t_uint)
-				return false;
-			const std::string_view ui_type = annotation_as_string("ui_type");
-			return ui_type == "list" || ui_type == "combo" || ui_type == "radio";
-		}
-
-		size_t effect_index = std::numeric_limits<size_t>::max();
-		unsigned int toggle_key_data[4] = {};
-
-		special_uniform special = special_uniform::none;
-	};
-
 	struct technique
 	{
 		technique(const reshadefx::technique &init) :
@@ -221,12 +150,32 @@ namespace reshade
 		std::string errors;
 
 		std::vector<std::filesystem::path> included_files;
+		// List of included files with hashes of their contents, to detect when the effect has to be preprocessed again
+		std::string dependencies;
 		std::vector<std::pair<std::string, std::string>> definitions;
 
 		std::vector<uniform> uniforms;
 		std::vector<uint8_t> uniform_data_storage;
+		// Byte range of the uniform data storage that was modified since it was last uploaded to the constant buffer
+		size_t uniform_data_dirty_begin = 0;
+		size_t uniform_data_dirty_end = 0;
+		special_uniform_plan special_uniforms;
 		api::resource cb = {};
 
+		void mark_uniform_data_dirty(size_t offset, size_t size)
+		{
+			if (uniform_data_dirty_begin < uniform_data_dirty_end)
+			{
+				uniform_data_dirty_begin = std::min(uniform_data_dirty_begin, offset);
+				uniform_data_dirty_end = std::max(uniform_data_dirty_end, offset + size);
+			}
+			else
+			{
+				uniform_data_dirty_begin = offset;
+				uniform_data_dirty_end = offset + size;
+			}
+		}
+
 		struct binding
 		{
 			std::string semantic;
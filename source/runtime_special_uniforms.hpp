@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2014 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include "effect_module.hpp"
+#include <limits>
+#include <cstdlib> // std::abs, RAND_MAX
+#include <algorithm>
+
+namespace reshade
+{
+	enum class special_uniform
+	{
+		none,
+		frame_time,
+		frame_count,
+		random,
+		ping_pong,
+		date,
+		timer,
+		key,
+		mouse_point,
+		mouse_delta,
+		mouse_button,
+		mouse_wheel,
+		overlay_open,
+		overlay_active,
+		overlay_hovered,
+		screenshot,
+		unknown
+	};
+
+	struct uniform : reshadefx::uniform
+	{
+		uniform(const reshadefx::uniform &init) : reshadefx::uniform(init) {}
+
+		auto annotation_as_int(const std::string_view ann_name, size_t i = 0, int default_value = 0) const
+		{
+			const auto it = std::find_if(annotations.cbegin(), annotations.cend(),
+				[ann_name](const reshadefx::annotation &annotation) { return annotation.name == ann_name; });
+			return it != annotations.cend() && i < 16 ?
+				(it->type.is_integral() ? it->value.as_int[i] : static_cast<int>(it->value.as_float[i])) : default_value;
+		}
+		auto annotation_as_uint(const std::string_view ann_name, size_t i = 0, unsigned int default_value = 0) const
+		{
+			const auto it = std::find_if(annotations.cbegin(), annotations.cend(),
+				[ann_name](const reshadefx::annotation &annotation) { return annotation.name == ann_name; });
+			return it != annotations.cend() && i < 16 ?
+				(it->type.is_integral() ? it->value.as_uint[i] : static_cast<unsigned int>(it->value.as_float[i])) : default_value;
+		}
+		auto annotation_as_float(const std::string_view ann_name, size_t i = 0, float default_value = 0.0f) const
+		{
+			const auto it = std::find_if(annotations.cbegin(), annotations.cend(),
+				[ann_name](const reshadefx::annotation &annotation) { return annotation.name == ann_name; });
+			return it != annotations.cend() && i < 16 ?
+				(it->type.is_floating_point() ? it->value.as_float[i] : static_cast<float>(it->value.as_int[i])) : default_value;
+		}
+		auto annotation_as_string(const std::string_view ann_name, const std::string_view default_value = std::string_view()) const
+		{
+			const auto it = std::find_if(annotations.cbegin(), annotations.cend(),
+				[ann_name](const reshadefx::annotation &annotation) { return annotation.name == ann_name; });
+			return it != annotations.cend() ?
+				std::string_view(it->value.string_data) : default_value;
+		}
+
+		bool supports_toggle_key() const
+		{
+			if (type.base == reshadefx::type::t_bool)
+				return true;
+			if (type.base != reshadefx::type::t_int && type.base != reshadefx::type::t_uint)
+				return false;
+			const std::string_view ui_type = annotation_as_string("ui_type");
+			return ui_type == "list" || ui_type == "combo" || ui_type == "radio";
+		}
+
+		size_t effect_index = std::numeric_limits<size_t>::max();
+		unsigned int toggle_key_data[4] = {};
+
+		special_uniform special = special_uniform::none;
+	};
+
+	/// <summary>
+	/// Special uniform variables of an effect grouped by their source, with all annotation parameters resolved when the effect is loaded.
+	/// Updating them every frame then only walks these flat arrays, without any annotation lookups or string comparisons.
+	/// All indices refer to the uniform list of the effect the plan was built for.
+	/// </summary>
+	struct special_uniform_plan
+	{
+		enum class input_mode : uint8_t
+		{
+			down,
+			press,
+			toggle
+		};
+
+		struct random_list
+		{
+			std::vector<uint32_t> index;
+			std::vector<int> min;
+			std::vector<int> range;
+		};
+		struct ping_pong_list
+		{
+			std::vector<uint32_t> index;
+			std::vector<float> min;
+			std::vector<float> max;
+			std::vector<float> step_min;
+			std::vector<float> step_max;
+			std::vector<float> smoothing;
+		};
+		struct input_list
+		{
+			std::vector<uint32_t> index;
+			std::vector<int> keycode;
+			std::vector<input_mode> mode;
+		};
+		struct mouse_wheel_list
+		{
+			std::vector<uint32_t> index;
+			std::vector<float> min;
+			std::vector<float> max;
+			std::vector<float> step;
+		};
+
+		void build(const std::vector<uniform> &uniforms)
+		{
+			*this = special_uniform_plan();
+
+			for (uint32_t index = 0; index < static_cast<uint32_t>(uniforms.size()); ++index)
+			{
+				const uniform &variable = uniforms[index];
+
+				switch (variable.special)
+				{
+				case special_uniform::frame_time:
+					frame_time.push_back(index);
+					break;
+				case special_uniform::frame_count:
+					(variable.type.is_boolean() ? frame_parity : frame_count).push_back(index);
+					break;
+				case special_uniform::random:
+					{
+						const int min_value = variable.annotation_as_int("min", 0, 0);
+						const int max_value = variable.annotation_as_int("max", 0, RAND_MAX);
+						random.index.push_back(index);
+						random.min.push_back(min_value);
+						random.range.push_back(std::abs(max_value - min_value) + 1);
+					}
+					break;
+				case special_uniform::ping_pong:
+					ping_pong.index.push_back(index);
+					ping_pong.min.push_back(variable.annotation_as_float("min", 0, 0.0f));
+					ping_pong.max.push_back(variable.annotation_as_float("max", 0, 1.0f));
+					ping_pong.step_min.push_back(variable.annotation_as_float("step", 0));
+					ping_pong.step_max.push_back(variable.annotation_as_float("step", 1));
+					ping_pong.smoothing.push_back(variable.annotation_as_float("smoothing"));
+					break;
+				case special_uniform::date:
+					date.push_back(index);
+					break;
+				case special_uniform::timer:
+					timer.push_back(index);
+					break;
+				case special_uniform::key:
+					// Skip variables with an invalid key code entirely, instead of checking again every frame
+					if (const int keycode = variable.annotation_as_int("keycode"); keycode > 7 && keycode < 256)
+						add_input(key, index, keycode, variable);
+					break;
+				case special_uniform::mouse_point:
+					mouse_point.push_back(index);
+					break;
+				case special_uniform::mouse_delta:
+					mouse_delta.push_back(index);
+					break;
+				case special_uniform::mouse_button:
+					if (const int keycode = variable.annotation_as_int("keycode"); keycode >= 0 && keycode < 5)
+						add_input(mouse_button, index, keycode, variable);
+					break;
+				case special_uniform::mouse_wheel:
+					{
+						const float step = variable.annotation_as_float("step");
+						mouse_wheel.index.push_back(index);
+						mouse_wheel.min.push_back(variable.annotation_as_float("min"));
+						mouse_wheel.max.push_back(variable.annotation_as_float("max"));
+						mouse_wheel.step.push_back(step != 0.0f ? step : 1.0f);
+					}
+					break;
+				case special_uniform::overlay_open:
+					overlay_open.push_back(index);
+					break;
+				case special_uniform::overlay_active:
+				case special_uniform::overlay_hovered:
+					overlay_state.push_back(index);
+					break;
+				case special_uniform::screenshot:
+					screenshot.push_back(index);
+					break;
+				case special_uniform::none:
+				case special_uniform::unknown:
+					break;
+				}
+			}
+		}
+
+		std::vector<uint32_t> frame_time;
+		std::vector<uint32_t> frame_count;
+		// Boolean frame count variables, which alternate between true and false every frame
+		std::vector<uint32_t> frame_parity;
+		random_list random;
+		ping_pong_list ping_pong;
+		std::vector<uint32_t> date;
+		std::vector<uint32_t> timer;
+		input_list key;
+		std::vector<uint32_t> mouse_point;
+		std::vector<uint32_t> mouse_delta;
+		input_list mouse_button;
+		mouse_wheel_list mouse_wheel;
+		std::vector<uint32_t> overlay_open;
+		// Overlay active and hovered variables, which are both reset while the overlay is closed
+		std::vector<uint32_t> overlay_state;
+		std::vector<uint32_t> screenshot;
+
+	private:
+		static void add_input(input_list &list, uint32_t index, int keycode, const uniform &variable)
+		{
+			const std::string_view mode = variable.annotation_as_string("mode");
+
+			list.index.push_back(index);
+			list.keycode.push_back(keycode);
+			list.mode.push_back(
+				mode == "toggle" || variable.annotation_as_int("toggle") ? input_mode::toggle :
+				mode == "press" ? input_mode::press : input_mode::down);
+		}
+	};
+}
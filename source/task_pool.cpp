@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2026 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "task_pool.hpp"
+#include <cassert>
+#include <algorithm> // std::max
+
+reshade::task_pool::task_pool(size_t num_threads) :
+	_num_queues(std::max(num_threads, static_cast<size_t>(1))),
+	_queues(std::make_unique<queue[]>(_num_queues))
+{
+	_threads.reserve(_num_queues);
+	for (size_t i = 0; i < _num_queues; ++i)
+		_threads.emplace_back(&task_pool::worker_main, this, i);
+}
+reshade::task_pool::~task_pool()
+{
+	cancel();
+
+	{
+		const std::unique_lock<std::mutex> lock(_wake_mutex);
+		_shutdown = true;
+	}
+	_wake_condition.notify_all();
+
+	for (std::thread &thread : _threads)
+		thread.join();
+}
+
+void reshade::task_pool::submit(std::function<void()> &&task)
+{
+	assert(task);
+
+	_num_unfinished_tasks++;
+
+	{
+		// Update count before the task is published, so that a worker popping it cannot decrement the count below zero
+		// This is done while holding the wake lock, so that a worker cannot miss the notification between checking the count and going to sleep
+		const std::unique_lock<std::mutex> lock(_wake_mutex);
+		_num_queued_tasks++;
+	}
+
+	queue &queue = _queues[_next_queue_index++ % _num_queues];
+	{
+		const std::unique_lock<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(std::move(task));
+	}
+
+	_wake_condition.notify_one();
+}
+
+void reshade::task_pool::cancel()
+{
+	size_t num_cancelled_tasks = 0;
+
+	for (size_t i = 0; i < _num_queues; ++i)
+	{
+		queue &queue = _queues[i];
+
+		const std::unique_lock<std::mutex> lock(queue.mutex);
+		num_cancelled_tasks += queue.tasks.size();
+		queue.tasks.clear();
+	}
+
+	if (num_cancelled_tasks == 0)
+		return;
+
+	_num_queued_tasks -= num_cancelled_tasks;
+
+	if ((_num_unfinished_tasks -= num_cancelled_tasks) == 0)
+	{
+		const std::unique_lock<std::mutex> lock(_wake_mutex);
+		_idle_condition.notify_all();
+	}
+}
+
+void reshade::task_pool::wait_idle()
+{
+	std::unique_lock<std::mutex> lock(_wake_mutex);
+	_idle_condition.wait(lock, [this]() { return _num_unfinished_tasks == 0; });
+}
+
+bool reshade::task_pool::pop_task(size_t queue_index, std::function<void()> &task)
+{
+	// Check own queue first, then try to steal from the other queues
+	// Always take from the front, so that tasks are started in submission order (which lets callers schedule expensive tasks first) even when stolen
+	for (size_t i = 0; i < _num_queues; ++i)
+	{
+		queue &queue = _queues[(queue_index + i) % _num_queues];
+
+		const std::unique_lock<std::mutex> lock(queue.mutex);
+		if (queue.tasks.empty())
+			continue;
+
+		task = std::move(queue.tasks.front());
+		queue.tasks.pop_front();
+
+		_num_queued_tasks--;
+		return true;
+	}
+
+	return false;
+}
+
+void reshade::task_pool::run_task(std::function<void()> &task)
+{
+	task();
+	task = nullptr; // Destroy any captured state before signaling completion
+
+	if (--_num_unfinished_tasks == 0)
+	{
+		const std::unique_lock<std::mutex> lock(_wake_mutex);
+		_idle_condition.notify_all();
+	}
+}
+
+void reshade::task_pool::worker_main(size_t queue_index)
+{
+	std::function<void()> task;
+
+	while (true)
+	{
+		if (pop_task(queue_index, task))
+		{
+			run_task(task);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(_wake_mutex);
+		_wake_condition.wait(lock, [this]() { return _shutdown || _num_queued_tasks != 0; });
+
+		if (_shutdown && _num_queued_tasks == 0)
+			break;
+	}
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2026 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+namespace reshade
+{
+	/// <summary>
+	/// Pool of worker threads that are kept alive between tasks, with a separate task queue per worker thread.
+	/// Workers take tasks from their own queue first and steal tasks from the queues of other workers once their own queue runs empty, so that a single long task does not leave the remaining workers idle.
+	/// Tasks are started in the order they were submitted, so submitting the most expensive tasks first shortens the time until all of them have finished.
+	/// </summary>
+	class task_pool
+	{
+	public:
+		explicit task_pool(size_t num_threads);
+		~task_pool();
+
+		task_pool(const task_pool &) = delete;
+		task_pool &operator=(const task_pool &) = delete;
+
+		/// <summary>
+		/// Gets the number of worker threads in this pool.
+		/// </summary>
+		size_t num_threads() const { return _num_queues; }
+
+		/// <summary>
+		/// Adds a task to the queue of the next worker thread.
+		/// </summary>
+		void submit(std::function<void()> &&task);
+
+		/// <summary>
+		/// Removes all tasks that have not been started yet from the queues.
+		/// Tasks that are already running are not interrupted.
+		/// </summary>
+		void cancel();
+
+		/// <summary>
+		/// Waits until all queued and running tasks have finished.
+		/// </summary>
+		void wait_idle();
+
+	private:
+		struct queue
+		{
+			std::mutex mutex;
+			std::deque<std::function<void()>> tasks;
+		};
+
+		bool pop_task(size_t queue_index, std::function<void()> &task);
+		void run_task(std::function<void()> &task);
+		void worker_main(size_t queue_index);
+
+		const size_t _num_queues;
+		std::unique_ptr<queue[]> _queues;
+		std::vector<std::thread> _threads;
+		std::atomic<size_t> _next_queue_index = 0;
+		std::atomic<size_t> _num_queued_tasks = 0;
+		std::atomic<size_t> _num_unfinished_tasks = 0;
+		std::mutex _wake_mutex;
+		std::condition_variable _wake_condition;
+		std::condition_variable _idle_condition;
+		bool _shutdown = false;
+	};
+}
@@ -0,0 +1,871 @@
+/*
+ * Copyright (C) 2026 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "effect_lexer.hpp"
+#include "effect_parser.hpp"
+#include "effect_codegen.hpp"
+#include "effect_preprocessor.hpp"
+#include <new>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <cstddef> // std::max_align_t
+#include <cstdio> // std::snprintf
+#include <cstdlib> // std::free, std::malloc, std::strtoul
+#include <cstring> // std::memcmp, std::strcmp
+#include <fstream>
+#include <iostream>
+#include <algorithm> // std::equal, std::min, std::sort
+
+#ifdef _WIN32
+	#include <Windows.h>
+	#include <Psapi.h>
+#else
+	#include <sys/resource.h>
+#endif
+
+#ifndef RESHADEFX_BENCH_CORPUS_PATH
+	#define RESHADEFX_BENCH_CORPUS_PATH "tools/fxbench_corpus"
+#endif
+
+// Increment this whenever the structure of the JSON report changes, so that tools comparing reports between commits can detect it
+static constexpr unsigned int s_report_format_version = 1;
+
+// Track all heap allocations made through 'operator new', so that allocation counts and peak memory usage can be reported per stage
+// These are deterministic, unlike timings, so they can be compared between commits exactly
+static std::atomic<size_t> s_num_allocations = 0;
+static std::atomic<size_t> s_allocated_bytes = 0;
+static std::atomic<size_t> s_live_bytes = 0;
+static std::atomic<size_t> s_peak_live_bytes = 0;
+
+// Every allocation is prefixed with a header storing its size, so that the number of live bytes can be updated when it is freed again
+static constexpr size_t s_allocation_header_size = alignof(std::max_align_t);
+
+static void *tracked_allocate(size_t size) noexcept
+{
+	void *const block = std::malloc(s_allocation_header_size + size);
+	if (block == nullptr)
+		return nullptr;
+
+	*static_cast<size_t *>(block) = size;
+
+	s_num_allocations.fetch_add(1, std::memory_order_relaxed);
+	s_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+
+	const size_t live_bytes = s_live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+	for (size_t peak_live_bytes = s_peak_live_bytes.load(std::memory_order_relaxed); live_bytes > peak_live_bytes && !s_peak_live_bytes.compare_exchange_weak(peak_live_bytes, live_bytes, std::memory_order_relaxed);)
+		continue;
+
+	return static_cast<char *>(block) + s_allocation_header_size;
+}
+static void tracked_deallocate(void *ptr) noexcept
+{
+	if (ptr == nullptr)
+		return;
+
+	void *const block = static_cast<char *>(ptr) - s_allocation_header_size;
+
+	s_live_bytes.fetch_sub(*static_cast<const size_t *>(block), std::memory_order_relaxed);
+
+	std::free(block);
+}
+
+void *operator new(size_t size)
+{
+	if (void *const ptr = tracked_allocate(size))
+		return ptr;
+	throw std::bad_alloc();
+}
+void *operator new[](size_t size)
+{
+	if (void *const ptr = tracked_allocate(size))
+		return ptr;
+	throw std::bad_alloc();
+}
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+	return tracked_allocate(size);
+}
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+	return tracked_allocate(size);
+}
+void operator delete(void *ptr) noexcept
+{
+	tracked_deallocate(ptr);
+}
+void operator delete[](void *ptr) noexcept
+{
+	tracked_deallocate(ptr);
+}
+void operator delete(void *ptr, size_t) noexcept
+{
+	tracked_deallocate(ptr);
+}
+void operator delete[](void *ptr, size_t) noexcept
+{
+	tracked_deallocate(ptr);
+}
+void operator delete(void *ptr, const std::nothrow_t &) noexcept
+{
+	tracked_deallocate(ptr);
+}
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept
+{
+	tracked_deallocate(ptr);
+}
+
+static size_t peak_resident_set_size()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters = { sizeof(counters) };
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return counters.PeakWorkingSetSize;
+	return 0;
+#else
+	struct rusage usage = {};
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#ifdef __APPLE__
+	return static_cast<size_t>(usage.ru_maxrss); // Reported in bytes on macOS
+#else
+	return static_cast<size_t>(usage.ru_maxrss) * 1024; // Reported in kilobytes on Linux
+#endif
+#endif
+}
+
+static void print_usage(const char *path)
+{
+	printf(R"(usage: %s [options]
+
+Runs the lexer, preprocessor, parser and code generators over a corpus of effect files and synthetic stress cases, and the validation and preprocessing of a generated tree of 300 effects including 500 headers, and writes a JSON report with throughput, allocation counts and peak memory usage of every stage. Also checks that the effect modules survive a round trip through the effect cache serialization unchanged, and fails if they do not.
+
+Options:
+  -h, --help                Print this help.
+
+  --corpus <path>           Directory containing the effect files to benchmark. Defaults to the corpus checked in next to the source code.
+  --iterations <count>      Number of times every stage is run, of which the fastest time is reported. Defaults to 5.
+  --filter <text>           Only run cases whose name contains the given text.
+  --output <file>           Write the report to the given file instead of standard output.
+	)", path);
+}
+
+struct bench_case
+{
+	std::string name;
+	// Either the path to an effect file, or the source code of a generated effect
+	std::filesystem::path path;
+	std::string source;
+};
+
+struct stage_result
+{
+	std::string name;
+	// Fastest time of all iterations, in seconds
+	double time = 0.0;
+	// Size of the stage output (number of tokens, size of the generated code, ...)
+	size_t output_size = 0;
+	size_t num_allocations = 0;
+	size_t allocated_bytes = 0;
+	size_t peak_bytes = 0;
+};
+
+struct case_result
+{
+	std::string name;
+	bool success = false;
+	std::string errors;
+	size_t preprocessed_size = 0;
+	std::vector<stage_result> stages;
+};
+
+template <typename F>
+static stage_result measure_stage(const char *name, unsigned int iterations, F &&run)
+{
+	stage_result result;
+	result.name = name;
+	result.time = std::numeric_limits<double>::max();
+
+	for (unsigned int i = 0; i < iterations; ++i)
+	{
+		const size_t num_allocations = s_num_allocations.load();
+		const size_t allocated_bytes = s_allocated_bytes.load();
+		const size_t live_bytes = s_live_bytes.load();
+		s_peak_live_bytes.store(live_bytes);
+
+		const std::chrono::high_resolution_clock::time_point time_start = std::chrono::high_resolution_clock::now();
+		result.output_size = run();
+		const std::chrono::high_resolution_clock::time_point time_finished = std::chrono::high_resolution_clock::now();
+
+		result.time = std::min(result.time, std::chrono::duration<double>(time_finished - time_start).count());
+
+		// Allocations do not differ between iterations, so just keep the ones of the last iteration
+		result.num_allocations = s_num_allocations.load() - num_allocations;
+		result.allocated_bytes = s_allocated_bytes.load() - allocated_bytes;
+		result.peak_bytes = s_peak_live_bytes.load() - live_bytes;
+	}
+
+	return result;
+}
+
+static void setup_preprocessor(reshadefx::preprocessor &pp, const std::filesystem::path &corpus_path)
+{
+	pp.add_include_path(corpus_path);
+
+	pp.add_macro_definition("BUFFER_WIDTH", "1920");
+	pp.add_macro_definition("BUFFER_HEIGHT", "1080");
+	pp.add_macro_definition("BUFFER_RCP_WIDTH", "(1.0 / BUFFER_WIDTH)");
+	pp.add_macro_definition("BUFFER_RCP_HEIGHT", "(1.0 / BUFFER_HEIGHT)");
+	pp.add_macro_definition("BUFFER_COLOR_BIT_DEPTH", "8");
+}
+
+static bool preprocess(const bench_case &bench, const std::filesystem::path &corpus_path, std::string &output, std::string &errors)
+{
+	reshadefx::preprocessor pp;
+	setup_preprocessor(pp, corpus_path);
+
+	const bool success = bench.source.empty() ? pp.append_file(bench.path) : pp.append_string(bench.source, bench.path);
+
+	output = pp.output();
+	errors = pp.errors();
+
+	return success;
+}
+
+static reshadefx::codegen *create_codegen(const char *backend)
+{
+	if (0 == std::strcmp(backend, "spirv"))
+		return reshadefx::create_codegen_spirv(true, false, false, false);
+	if (0 == std::strcmp(backend, "glsl"))
+		return reshadefx::create_codegen_glsl(false, false, false, false);
+	if (0 == std::strcmp(backend, "hlsl"))
+		return reshadefx::create_codegen_hlsl(50, false, false);
+	return nullptr;
+}
+
+template <typename T, typename F>
+static bool equal_elements(const std::vector<T> &lhs, const std::vector<T> &rhs, F &&equal)
+{
+	return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), equal);
+}
+
+static bool equal_constant(const reshadefx::constant &lhs, const reshadefx::constant &rhs)
+{
+	return std::memcmp(lhs.as_uint, rhs.as_uint, sizeof(lhs.as_uint)) == 0 && lhs.string_data == rhs.string_data && equal_elements(lhs.array_data, rhs.array_data, equal_constant);
+}
+static bool equal_annotation(const reshadefx::annotation &lhs, const reshadefx::annotation &rhs)
+{
+	return lhs.type == rhs.type && lhs.name == rhs.name && equal_constant(lhs.value, rhs.value);
+}
+static bool equal_texture(const reshadefx::texture &lhs, const reshadefx::texture &rhs)
+{
+	return
+		lhs.width == rhs.width && lhs.height == rhs.height && lhs.depth == rhs.depth && lhs.levels == rhs.levels && lhs.type == rhs.type && lhs.format == rhs.format &&
+		lhs.id == rhs.id && lhs.name == rhs.name && lhs.unique_name == rhs.unique_name && lhs.semantic == rhs.semantic && equal_elements(lhs.annotations, rhs.annotations, equal_annotation) &&
+		lhs.render_target == rhs.render_target && lhs.storage_access == rhs.storage_access && lhs.semantic_binding == rhs.semantic_binding;
+}
+static bool equal_sampler(const reshadefx::sampler &lhs, const reshadefx::sampler &rhs)
+{
+	return
+		lhs.filter == rhs.filter && lhs.address_u == rhs.address_u && lhs.address_v == rhs.address_v && lhs.address_w == rhs.address_w && lhs.min_lod == rhs.min_lod && lhs.max_lod == rhs.max_lod && lhs.lod_bias == rhs.lod_bias &&
+		lhs.type == rhs.type && lhs.id == rhs.id && lhs.name == rhs.name && lhs.unique_name == rhs.unique_name && lhs.texture_name == rhs.texture_name && equal_elements(lhs.annotations, rhs.annotations, equal_annotation) &&
+		lhs.srgb == rhs.srgb;
+}
+static bool equal_storage(const reshadefx::storage &lhs, const reshadefx::storage &rhs)
+{
+	return lhs.level == rhs.level && lhs.type == rhs.type && lhs.id == rhs.id && lhs.name == rhs.name && lhs.unique_name == rhs.unique_name && lhs.texture_name == rhs.texture_name;
+}
+static bool equal_uniform(const reshadefx::uniform &lhs, const reshadefx::uniform &rhs)
+{
+	return
+		lhs.type == rhs.type && lhs.name == rhs.name && lhs.unique_name == rhs.unique_name && lhs.size == rhs.size && lhs.offset == rhs.offset && equal_elements(lhs.annotations, rhs.annotations, equal_annotation) &&
+		lhs.has_initializer_value == rhs.has_initializer_value && equal_constant(lhs.initializer_value, rhs.initializer_value);
+}
+static bool equal_pass(const reshadefx::pass &lhs, const reshadefx::pass &rhs)
+{
+	for (int i = 0; i < 8; ++i)
+	{
+		if (lhs.render_target_names[i] != rhs.render_target_names[i] ||
+			lhs.blend_enable[i] != rhs.blend_enable[i] ||
+			lhs.source_color_blend_factor[i] != rhs.source_color_blend_factor[i] ||
+			lhs.dest_color_blend_factor[i] != rhs.dest_color_blend_factor[i] ||
+			lhs.color_blend_op[i] != rhs.color_blend_op[i] ||
+			lhs.source_alpha_blend_factor[i] != rhs.source_alpha_blend_factor[i] ||
+			lhs.dest_alpha_blend_factor[i] != rhs.dest_alpha_blend_factor[i] ||
+			lhs.alpha_blend_op[i] != rhs.alpha_blend_op[i] ||
+			lhs.render_target_write_mask[i] != rhs.render_target_write_mask[i])
+			return false;
+	}
+
+	return
+		lhs.name == rhs.name && lhs.vs_entry_point == rhs.vs_entry_point && lhs.ps_entry_point == rhs.ps_entry_point && lhs.cs_entry_point == rhs.cs_entry_point &&
+		lhs.generate_mipmaps == rhs.generate_mipmaps && lhs.clear_render_targets == rhs.clear_render_targets && lhs.srgb_write_enable == rhs.srgb_write_enable &&
+		lhs.stencil_enable == rhs.stencil_enable && lhs.stencil_read_mask == rhs.stencil_read_mask && lhs.stencil_write_mask == rhs.stencil_write_mask && lhs.stencil_reference_value == rhs.stencil_reference_value &&
+		lhs.stencil_comparison_func == rhs.stencil_comparison_func && lhs.stencil_pass_op == rhs.stencil_pass_op && lhs.stencil_fail_op == rhs.stencil_fail_op && lhs.stencil_depth_fail_op == rhs.stencil_depth_fail_op &&
+		lhs.topology == rhs.topology && lhs.num_vertices == rhs.num_vertices && lhs.viewport_width == rhs.viewport_width && lhs.viewport_height == rhs.viewport_height && lhs.viewport_dispatch_z == rhs.viewport_dispatch_z &&
+		equal_elements(lhs.texture_bindings, rhs.texture_bindings, [](const reshadefx::texture_binding &a, const reshadefx::texture_binding &b) { return a.index == b.index && a.entry_point_binding == b.entry_point_binding && a.srgb == b.srgb; }) &&
+		equal_elements(lhs.sampler_bindings, rhs.sampler_bindings, [](const reshadefx::sampler_binding &a, const reshadefx::sampler_binding &b) { return a.index == b.index && a.entry_point_binding == b.entry_point_binding; }) &&
+		equal_elements(lhs.storage_bindings, rhs.storage_bindings, [](const reshadefx::storage_binding &a, const reshadefx::storage_binding &b) { return a.index == b.index && a.entry_point_binding == b.entry_point_binding; });
+}
+static bool equal_technique(const reshadefx::technique &lhs, const reshadefx::technique &rhs)
+{
+	return lhs.name == rhs.name && equal_elements(lhs.passes, rhs.passes, equal_pass) && equal_elements(lhs.annotations, rhs.annotations, equal_annotation);
+}
+
+// Serializes the module, reads it back and compares the result with the original, returning a description of the first part that differs, or an empty string if they are equal
+static std::string check_module_round_trip(const reshadefx::effect_module &module)
+{
+	std::string module_data;
+	reshadefx::serialize_module(module, module_data);
+
+	reshadefx::effect_module loaded_module;
+	if (!reshadefx::deserialize_module(module_data, loaded_module))
+		return "could not be deserialized";
+
+	if (!equal_elements(loaded_module.uniforms, module.uniforms, equal_uniform))
+		return "uniforms differ";
+	if (!equal_elements(loaded_module.spec_constants, module.spec_constants, equal_uniform) || loaded_module.total_uniform_size != module.total_uniform_size)
+		return "specialization constants differ";
+	if (!equal_elements(loaded_module.textures, module.textures, equal_texture))
+		return "textures differ";
+	if (!equal_elements(loaded_module.samplers, module.samplers, equal_sampler))
+		return "samplers differ";
+	if (!equal_elements(loaded_module.storages, module.storages, equal_storage))
+		return "storages differ";
+	if (!equal_elements(loaded_module.techniques, module.techniques, equal_technique))
+		return "techniques differ";
+	if (loaded_module.entry_points != module.entry_points)
+		return "entry points differ";
+
+	// Also catch anything the comparisons above do not cover (like type qualifiers), by checking that serializing the result again reproduces the exact same data
+	std::string loaded_module_data;
+	reshadefx::serialize_module(loaded_module, loaded_module_data);
+	if (loaded_module_data != module_data)
+		return "serialized data differs";
+
+	return std::string();
+}
+
+static case_result run_case(const bench_case &bench, const std::filesystem::path &corpus_path, unsigned int iterations)
+{
+	case_result result;
+	result.name = bench.name;
+
+	std::string source;
+	if (!preprocess(bench, corpus_path, source, result.errors))
+		return result;
+
+	result.preprocessed_size = source.size();
+
+	result.stages.push_back(measure_stage("preprocess", iterations, [&]() {
+		std::string output, errors;
+		preprocess(bench, corpus_path, output, errors);
+		return output.size();
+	}));
+
+	// Use the same lexer settings as the parser
+	const auto lex = [&source]() {
+		reshadefx::lexer lexer(source, true, true, true, false, false, false);
+		size_t num_tokens = 0;
+		while (lexer.lex().id != reshadefx::tokenid::end_of_file)
+			++num_tokens;
+		return num_tokens;
+	};
+
+	result.stages.push_back(measure_stage("lex", iterations, lex));
+
+	reshadefx::lexer::set_vectorized_scanning(false);
+	result.stages.push_back(measure_stage("lex_scalar", iterations, lex));
+	reshadefx::lexer::set_vectorized_scanning(true);
+
+	for (const char *const backend : { "spirv", "glsl", "hlsl" })
+	{
+		// Keep the result of the last parse around for the assemble stage below
+		std::unique_ptr<reshadefx::codegen> codegen;
+		bool parsed = false;
+		std::string parser_errors;
+
+		result.stages.push_back(measure_stage((std::string("parse_") + backend).c_str(), iterations, [&]() {
+			std::unique_ptr<reshadefx::codegen> new_codegen(create_codegen(backend));
+
+			reshadefx::parser parser;
+			parsed = parser.parse(source, new_codegen.get());
+			parser_errors = parser.errors();
+
+			// Only replace the code generator of the previous iteration at the end, so that the peak memory usage is not reduced by destroying it
+			codegen = std::move(new_codegen);
+
+			return codegen->module().entry_points.size();
+		}));
+
+		if (!parsed)
+		{
+			result.errors += parser_errors;
+			return result;
+		}
+
+		result.stages.push_back(measure_stage((std::string("assemble_") + backend).c_str(), iterations, [&]() {
+			size_t code_size = codegen->finalize_code().size();
+
+			for (const std::pair<std::string, reshadefx::shader_type> &entry_point : codegen->module().entry_points)
+			{
+				std::string code, assembly, errors;
+				if (codegen->assemble_code_for_entry_point(entry_point.first, code, assembly, errors))
+					code_size += code.size();
+			}
+
+			return code_size;
+		}));
+
+		// Modules loaded from the effect cache have to be indistinguishable from freshly parsed ones, for every code generator
+		if (const std::string difference = check_module_round_trip(codegen->module()); !difference.empty())
+		{
+			result.errors += "error: Module round trip for " + std::string(backend) + " failed, " + difference + '\n';
+			return result;
+		}
+
+		if (0 == std::strcmp(backend, "spirv"))
+		{
+			std::string module_data;
+			reshadefx::serialize_module(codegen->module(), module_data);
+
+			result.stages.push_back(measure_stage("deserialize_module", iterations, [&]() {
+				reshadefx::effect_module module;
+				reshadefx::deserialize_module(module_data, module);
+				return module_data.size();
+			}));
+		}
+	}
+
+	result.success = true;
+	return result;
+}
+
+// Chains of object-like and function-like macros that each expand to the previous one, and deeply nested conditional blocks
+static std::string generate_deep_macro_nesting()
+{
+	std::string source = "#include \"Common.fxh\"\n";
+
+	source += "#define V0 1\n";
+	source += "#define F0(x) (x)\n";
+	for (int i = 1; i < 128; ++i)
+	{
+		source += "#define V" + std::to_string(i) + " (V" + std::to_string(i - 1) + " + 1)\n";
+		source += "#define F" + std::to_string(i) + "(x) F" + std::to_string(i - 1) + "((x) * 0.5 + " + std::to_string(i) + ".0)\n";
+	}
+
+	// Keep the expressions short enough to fit into the stack of the preprocessor expression evaluator
+	for (int i = 0; i < 64; ++i)
+		source += "#if V" + std::to_string(i % 32) + " > " + std::to_string(i % 32) + "\n";
+	source += "#define NESTED_CONDITIONS 1\n";
+	for (int i = 0; i < 64; ++i)
+		source += "#endif\n";
+
+	source += "float4 MainPS(float4 position : SV_Position, float2 texcoord : TEXCOORD) : SV_Target\n{\n";
+	source += "\tfloat3 color = tex2D(Common::BackBuffer, texcoord).rgb;\n";
+	for (int i = 0; i < 64; ++i)
+		source += "\tcolor = color * F127(texcoord.x) + V" + std::to_string(64 + i) + " * 0.001;\n";
+	source += "\treturn float4(color * NESTED_CONDITIONS, 1.0);\n}\n";
+
+	source += "technique DeepMacroNesting { pass { VertexShader = PostProcessVS; PixelShader = MainPS; } }\n";
+
+	return source;
+}
+
+// Large constant arrays that are indexed dynamically, so that they cannot be folded away
+static std::string generate_huge_constant_arrays()
+{
+	char value[32];
+	std::string source = "#include \"Common.fxh\"\n";
+
+	for (int table = 0; table < 4; ++table)
+	{
+		source += "static const float kTable" + std::to_string(table) + "[4096] = {";
+		for (int i = 0; i < 4096; ++i)
+		{
+			std::snprintf(value, sizeof(value), "%s%.6f", i % 16 == 0 ? "\n\t" : " ", ((i * 7919 + table * 104729) % 10007) / 10007.0);
+			source += value;
+			if (i != 4095)
+				source += ',';
+		}
+		source += "\n};\n";
+	}
+
+	source += "static const float4 kVectors[1024] = {";
+	for (int i = 0; i < 1024; ++i)
+	{
+		std::snprintf(value, sizeof(value), "%s", i % 4 == 0 ? "\n\t" : " ");
+		source += value;
+		source += "float4(";
+		for (int c = 0; c < 4; ++c)
+		{
+			std::snprintf(value, sizeof(value), "%s%.4f", c != 0 ? ", " : "", ((i * 31 + c * 7) % 101) / 101.0);
+			source += value;
+		}
+		source += i != 1023 ? ")," : ")";
+	}
+	source += "\n};\n";
+
+	source += "float4 MainPS(float4 position : SV_Position, float2 texcoord : TEXCOORD) : SV_Target\n{\n";
+	source += "\tconst int index = int(texcoord.x * 4095.0);\n";
+	source += "\tfloat value = kTable0[index] + kTable1[4095 - index];\n";
+	source += "\t[loop] for (int i = 0; i < 16; ++i)\n\t\tvalue += kTable2[i * 256 + index % 256] * kTable3[(index + i) % 4096];\n";
+	source += "\treturn kVectors[index % 1024] * value;\n}\n";
+
+	source += "technique HugeConstantArrays { pass { VertexShader = PostProcessVS; PixelShader = MainPS; } }\n";
+
+	return source;
+}
+
+// Technique with a large number of passes that all use a different pixel shader and render target combination
+static std::string generate_many_passes()
+{
+	std::string source = "#include \"Common.fxh\"\n";
+
+	for (int i = 0; i < 8; ++i)
+	{
+		source += "texture Target" + std::to_string(i) + " { Width = BUFFER_WIDTH >> " + std::to_string(i % 4) + "; Height = BUFFER_HEIGHT >> " + std::to_string(i % 4) + "; Format = RGBA16F; };\n";
+		source += "sampler TargetSampler" + std::to_string(i) + " { Texture = Target" + std::to_string(i) + "; };\n";
+	}
+
+	for (int i = 0; i < 512; ++i)
+	{
+		source += "float4 Pass" + std::to_string(i) + "PS(float4 position : SV_Position, float2 texcoord : TEXCOORD) : SV_Target\n{\n";
+		source += "\tconst float4 color = tex2D(TargetSampler" + std::to_string((i + 1) % 8) + ", texcoord + float2(" + std::to_string(i % 7) + ", " + std::to_string(i % 5) + ") * BUFFER_PIXEL_SIZE);\n";
+		source += "\treturn color * " + std::to_string(i + 1) + ".0 / 512.0 + float4(texcoord, Common::Luma(color.rgb), 1.0);\n}\n";
+	}
+
+	source += "technique ManyPasses\n{\n";
+	for (int i = 0; i < 512; ++i)
+		source += "\tpass { VertexShader = PostProcessVS; PixelShader = Pass" + std::to_string(i) + "PS; RenderTarget = Target" + std::to_string(i % 8) + "; }\n";
+	source += "}\n";
+
+	return source;
+}
+
+// Writes a tree of effect files that each include a number of headers from two search paths to disk, to measure how long it takes to find out whether cached effects are still up to date and to preprocess them all
+static case_result run_cold_start_case(unsigned int iterations)
+{
+	constexpr int num_effects = 300;
+	constexpr int num_headers = 500;
+	constexpr int num_includes_per_effect = 8;
+
+	case_result result;
+	result.name = "synthetic/cold_start";
+
+	std::error_code ec;
+	const std::filesystem::path root_path = std::filesystem::temp_directory_path(ec) / "reshadefx_bench_cold_start";
+	const std::filesystem::path effect_path = root_path / "effects";
+	// Split headers between two search paths, so that headers from the second one are probed for in the first one too
+	const std::filesystem::path header_paths[2] = { root_path / "shaders_a", root_path / "shaders_b" };
+
+	std::filesystem::remove_all(root_path, ec);
+	std::filesystem::create_directories(effect_path, ec);
+	std::filesystem::create_directories(header_paths[0], ec);
+	std::filesystem::create_directories(header_paths[1], ec);
+
+	const auto header_name = [](int index) { return "Header" + std::to_string(index) + ".fxh"; };
+
+	for (int i = 0; i < num_headers; ++i)
+	{
+		std::ofstream file(header_paths[i < num_headers / 2 ? 0 : 1] / header_name(i));
+		file << "#pragma once\n";
+		// Headers include each other in a tree, like effect libraries usually do with their common headers
+		if (i != 0)
+			file << "#include \"" << header_name((i - 1) / 2) << "\"\n";
+		file << "#define HEADER" << i << "_SCALE " << (i % 7 + 1) << "\n";
+		file << "namespace Header" << i << "\n{\n";
+		for (int k = 0; k < 8; ++k)
+			file << "\tfloat Function" << k << "(float x) { return x * HEADER" << i << "_SCALE + " << k << ".0; }\n";
+		file << "}\n";
+	}
+
+	std::vector<std::filesystem::path> effect_files;
+	for (int i = 0; i < num_effects; ++i)
+	{
+		std::filesystem::path &path = effect_files.emplace_back(effect_path / ("Effect" + std::to_string(i) + ".fx"));
+
+		std::ofstream file(path);
+		for (int k = 0; k < num_includes_per_effect; ++k)
+			file << "#include \"" << header_name((i * 37 + k * 101) % num_headers) << "\"\n";
+		file << "float4 MainPS(float4 position : SV_Position, float2 texcoord : TEXCOORD) : SV_Target { return texcoord.x * HEADER" << (i * 37) % num_headers << "_SCALE; }\n";
+		file << "technique Effect" << i << " { pass { PixelShader = MainPS; } }\n";
+	}
+
+	if (ec)
+	{
+		result.errors = "error: Could not write effect files to " + root_path.u8string() + '\n';
+		return result;
+	}
+
+	struct effect_dependencies
+	{
+		std::vector<std::filesystem::path> included_files;
+		std::vector<std::filesystem::path> missing_files;
+	};
+
+	std::vector<effect_dependencies> dependencies(effect_files.size());
+
+	const auto preprocess_all = [&]() {
+		size_t output_size = 0;
+		for (size_t i = 0; i < effect_files.size(); ++i)
+		{
+			reshadefx::preprocessor pp;
+			pp.add_include_path(effect_path);
+			pp.add_include_path(header_paths[0]);
+			pp.add_include_path(header_paths[1]);
+
+			if (!pp.append_file(effect_files[i]))
+				result.errors += pp.errors();
+
+			dependencies[i].included_files = pp.included_files();
+			dependencies[i].missing_files = pp.missing_include_files();
+
+			output_size += pp.output().size();
+		}
+		return output_size;
+	};
+
+	result.stages.push_back(measure_stage("preprocess_cold", iterations, [&]() {
+		reshadefx::preprocessor::clear_include_cache();
+		return preprocess_all();
+	}));
+	result.stages.push_back(measure_stage("preprocess_warm", iterations, preprocess_all));
+
+	result.preprocessed_size = result.stages.back().output_size;
+
+	// Validating a cached effect by looking at the modification time of every header in every search path, which is what the runtime did before it tracked the exact dependencies of each effect
+	result.stages.push_back(measure_stage("validate_header_scan", iterations, [&]() {
+		size_t num_checked_files = 0;
+		for (size_t i = 0; i < effect_files.size(); ++i)
+		{
+			size_t hash = 0;
+			for (const std::filesystem::directory_entry &entry : std::filesystem::recursive_directory_iterator(root_path, std::filesystem::directory_options::skip_permission_denied, ec))
+			{
+				if (entry.path().extension() != ".fxh")
+					continue;
+
+				hash ^= static_cast<size_t>(entry.last_write_time(ec).time_since_epoch().count()) + (hash << 6) + (hash >> 2);
+				num_checked_files++;
+			}
+		}
+		return num_checked_files;
+	}));
+
+	// Validating a cached effect by checking only the files it included and the paths that were probed for them
+	result.stages.push_back(measure_stage("validate_dependencies", iterations, [&]() {
+		size_t num_checked_files = 0;
+		for (const effect_dependencies &effect : dependencies)
+		{
+			size_t hash = 0;
+			for (const std::filesystem::path &included_file : effect.included_files)
+			{
+				hash ^= static_cast<size_t>(std::filesystem::last_write_time(included_file, ec).time_since_epoch().count()) + static_cast<size_t>(std::filesystem::file_size(included_file, ec)) + (hash << 6) + (hash >> 2);
+				num_checked_files++;
+			}
+			for (const std::filesystem::path &missing_file : effect.missing_files)
+			{
+				hash ^= std::filesystem::exists(missing_file, ec) ? 1 : 0;
+				num_checked_files++;
+			}
+		}
+		return num_checked_files;
+	}));
+
+	std::filesystem::remove_all(root_path, ec);
+
+	result.success = result.errors.empty();
+	return result;
+}
+
+static void write_json_string(std::ostream &stream, const std::string_view value)
+{
+	stream << '"';
+	for (const char c : value)
+	{
+		if (c == '"' || c == '\\')
+		{
+			stream << '\\' << c;
+		}
+		else if (c == '\n')
+		{
+			stream << "\\n";
+		}
+		else if (static_cast<unsigned char>(c) < 0x20)
+		{
+			char escaped[8];
+			std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned int>(c));
+			stream << escaped;
+		}
+		else
+		{
+			stream << c;
+		}
+	}
+	stream << '"';
+}
+
+static void write_json_number(std::ostream &stream, double value)
+{
+	// Use a fixed number of decimal places, so that the report does not depend on the stream formatting settings
+	char formatted[64];
+	std::snprintf(formatted, sizeof(formatted), "%.3f", value);
+	stream << formatted;
+}
+
+static void write_report(std::ostream &stream, const std::vector<case_result> &results, unsigned int iterations)
+{
+	// Write one stage per line with a fixed key order, so that reports of different commits can be compared with a line-based diff
+	stream << "{\n";
+	stream << "\"format_version\": " << s_report_format_version << ",\n";
+	stream << "\"iterations\": " << iterations << ",\n";
+	stream << "\"peak_rss_bytes\": " << peak_resident_set_size() << ",\n";
+	stream << "\"cases\": [\n";
+
+	for (size_t i = 0; i < results.size(); ++i)
+	{
+		const case_result &result = results[i];
+		const double preprocessed_size_mb = result.preprocessed_size / (1024.0 * 1024.0);
+
+		stream << "{\"name\": ";
+		write_json_string(stream, result.name);
+		stream << ", \"success\": " << (result.success ? "true" : "false") << ", \"preprocessed_size\": " << result.preprocessed_size << ", \"errors\": ";
+		write_json_string(stream, result.errors);
+		stream << ", \"stages\": [\n";
+
+		for (size_t k = 0; k < result.stages.size(); ++k)
+		{
+			const stage_result &stage = result.stages[k];
+
+			stream << "\t{\"name\": ";
+			write_json_string(stream, stage.name);
+			stream << ", \"time_ms\": ";
+			write_json_number(stream, stage.time * 1000.0);
+			stream << ", \"mb_per_s\": ";
+			write_json_number(stream, stage.time > 0.0 ? preprocessed_size_mb / stage.time : 0.0);
+			stream << ", \"output_size\": " << stage.output_size;
+			stream << ", \"allocations\": " << stage.num_allocations;
+			stream << ", \"allocations_per_mb\": " << static_cast<size_t>(preprocessed_size_mb > 0.0 ? stage.num_allocations / preprocessed_size_mb : 0.0);
+			stream << ", \"allocated_bytes\": " << stage.allocated_bytes;
+			stream << ", \"peak_bytes\": " << stage.peak_bytes;
+			stream << (k + 1 < result.stages.size() ? "},\n" : "}\n");
+		}
+
+		stream << (i + 1 < results.size() ? "]},\n" : "]}\n");
+	}
+
+	stream << "]\n}\n";
+}
+
+int main(int argc, char *argv[])
+{
+	std::filesystem::path corpus_path = std::filesystem::u8path(RESHADEFX_BENCH_CORPUS_PATH);
+	const char *output_file = nullptr;
+	const char *filter = nullptr;
+	unsigned int iterations = 5;
+
+	// Parse command-line arguments
+	for (int i = 1; i < argc; ++i)
+	{
+		const char *arg = argv[i];
+
+		if (0 == std::strcmp(arg, "-h") || 0 == std::strcmp(arg, "--help"))
+		{
+			print_usage(argv[0]);
+			return 0;
+		}
+
+		if (i + 1 >= argc)
+		{
+			print_usage(argv[0]);
+			return 1;
+		}
+		else if (0 == std::strcmp(arg, "--corpus"))
+			corpus_path = std::filesystem::u8path(argv[++i]);
+		else if (0 == std::strcmp(arg, "--iterations"))
+			iterations = std::max(static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10)), 1u);
+		else if (0 == std::strcmp(arg, "--filter"))
+			filter = argv[++i];
+		else if (0 == std::strcmp(arg, "--output"))
+			output_file = argv[++i];
+		else
+		{
+			print_usage(argv[0]);
+			return 1;
+		}
+	}
+
+	std::vector<bench_case> cases;
+
+	std::error_code ec;
+	for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(corpus_path, std::filesystem::directory_options::skip_permission_denied, ec))
+		if (entry.path().extension() == ".fx")
+			cases.push_back({ "corpus/" + entry.path().filename().u8string(), entry.path(), std::string() });
+	if (ec)
+	{
+		std::cerr << "error: Could not read corpus directory " << corpus_path.u8string() << std::endl;
+		return 1;
+	}
+
+	// Directory iteration order is unspecified, so sort to make the report order stable
+	std::sort(cases.begin(), cases.end(),
+		[](const bench_case &lhs, const bench_case &rhs) { return lhs.name < rhs.name; });
+
+	// Synthetic cases are generated in the corpus directory, so that they can include the common header
+	cases.push_back({ "synthetic/deep_macro_nesting", corpus_path / "deep_macro_nesting.fx", generate_deep_macro_nesting() });
+	cases.push_back({ "synthetic/huge_constant_arrays", corpus_path / "huge_constant_arrays.fx", generate_huge_constant_arrays() });
+	cases.push_back({ "synthetic/many_passes", corpus_path / "many_passes.fx", generate_many_passes() });
+
+	std::vector<case_result> results;
+	bool success = true;
+
+	for (const bench_case &bench : cases)
+	{
+		if (filter != nullptr && bench.name.find(filter) == std::string::npos)
+			continue;
+
+		std::cerr << "running " << bench.name << std::endl;
+
+		results.push_back(run_case(bench, corpus_path, iterations));
+
+		if (!results.back().success)
+		{
+			std::cerr << results.back().errors;
+			success = false;
+		}
+	}
+
+	// Cold start case is written to disk separately, since it consists of many files instead of a single effect
+	if (filter == nullptr || std::string_view("synthetic/cold_start").find(filter) != std::string_view::npos)
+	{
+		std::cerr << "running synthetic/cold_start" << std::endl;
+
+		results.push_back(run_cold_start_case(iterations));
+
+		if (!results.back().success)
+		{
+			std::cerr << results.back().errors;
+			success = false;
+		}
+	}
+
+	if (output_file != nullptr)
+	{
+		std::ofstream stream(output_file);
+		write_report(stream, results, iterations);
+
+		if (!stream)
+		{
+			std::cerr << "error: Could not write report to " << output_file << std::endl;
+			return 1;
+		}
+	}
+	else
+	{
+		write_report(std::cout, results, iterations);
+	}
+
+	return success ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2026 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+// Multi-pass effect with a chain of render targets, similar to typical bloom and glow effects
+
+#include "Common.fxh"
+
+#ifndef BLOOM_QUALITY
+	#define BLOOM_QUALITY 2
+#endif
+
+#if BLOOM_QUALITY >= 2
+	#define BLOOM_SAMPLES 13
+#else
+	#define BLOOM_SAMPLES 5
+#endif
+
+uniform float Threshold <
+	ui_type = "slider";
+	ui_min = 0.0; ui_max = 1.0;
+	ui_label = "Threshold";
+	ui_tooltip = "Minimum brightness of pixels that contribute to the bloom.";
+> = 0.8;
+uniform float Intensity <
+	ui_type = "slider";
+	ui_min = 0.0; ui_max = 4.0;
+	ui_label = "Intensity";
+> = 1.0;
+uniform float3 Tint <
+	ui_type = "color";
+	ui_label = "Tint";
+> = float3(1.0, 0.95, 0.9);
+uniform bool Dither <
+	ui_label = "Dither output";
+> = true;
+
+texture BloomTex0 { Width = BUFFER_WIDTH / 2; Height = BUFFER_HEIGHT / 2; Format = RGBA16F; MipLevels = 1; };
+texture BloomTex1 { Width = BUFFER_WIDTH / 4; Height = BUFFER_HEIGHT / 4; Format = RGBA16F; };
+texture BloomTex2 { Width = BUFFER_WIDTH / 8; Height = BUFFER_HEIGHT / 8; Format = RGBA16F; };
+texture BloomTex3 { Width = BUFFER_WIDTH / 16; Height = BUFFER_HEIGHT / 16; Format = RGBA16F; };
+texture BloomTex4 { Width = BUFFER_WIDTH / 32; Height = BUFFER_HEIGHT / 32; Format = RGBA16F; };
+
+sampler BloomSampler0 { Texture = BloomTex0; AddressU = CLAMP; AddressV = CLAMP; };
+sampler BloomSampler1 { Texture = BloomTex1; AddressU = CLAMP; AddressV = CLAMP; };
+sampler BloomSampler2 { Texture = BloomTex2; AddressU = CLAMP; AddressV = CLAMP; };
+sampler BloomSampler3 { Texture = BloomTex3; AddressU = CLAMP; AddressV = CLAMP; };
+sampler BloomSampler4 { Texture = BloomTex4; AddressU = CLAMP; AddressV = CLAMP; };
+
+static const float2 kOffsets[13] = {
+	float2( 0.0,  0.0),
+	float2(-1.0, -1.0), float2( 1.0, -1.0), float2(-1.0,  1.0), float2( 1.0,  1.0),
+	float2(-2.0,  0.0), float2( 2.0,  0.0), float2( 0.0, -2.0), float2( 0.0,  2.0),
+	float2(-2.0, -2.0), float2( 2.0, -2.0), float2(-2.0,  2.0), float2( 2.0,  2.0)
+};
+static const float kWeights[13] = {
+	0.125,
+	0.125, 0.125, 0.125, 0.125,
+	0.0625, 0.0625, 0.0625, 0.0625,
+	0.03125, 0.03125, 0.03125, 0.03125
+};
+
+float3 Prefilter(float3 color)
+{
+	const float brightness = max(color.r, max(color.g, color.b));
+	const float knee = Threshold * 0.5;
+	float soft = clamp(brightness - Threshold + knee, 0.0, 2.0 * knee);
+	soft = soft * soft / (4.0 * knee + 1e-4);
+	const float contribution = max(soft, brightness - Threshold) / max(brightness, 1e-4);
+	return color * contribution;
+}
+
+float3 Downsample(sampler source, float2 texcoord, float2 texel_size)
+{
+	float3 color = 0.0;
+	[unroll] for (int i = 0; i < BLOOM_SAMPLES; ++i)
+		color += tex2D(source, texcoord + kOffsets[i] * texel_size).rgb * kWeights[i];
+	return color * (BLOOM_SAMPLES == 13 ? 1.0 : 13.0 / 5.0 * 0.5);
+}
+
+float3 Upsample(sampler source, float2 texcoord, float2 texel_size)
+{
+	float3 color = tex2D(source, texcoord).rgb * 4.0;
+	color += tex2D(source, texcoord + float2(-1.0,  0.0) * texel_size).rgb * 2.0;
+	color += tex2D(source, texcoord + float2( 1.0,  0.0) * texel_size).rgb * 2.0;
+	color += tex2D(source, texcoord + float2( 0.0, -1.0) * texel_size).rgb * 2.0;
+	color += tex2D(source, texcoord + float2( 0.0,  1.0) * texel_size).rgb * 2.0;
+	color += tex2D(source, texcoord + float2(-1.0, -1.0) * texel_size).rgb;
+	color += tex2D(source, texcoord + float2( 1.0, -1.0) * texel_size).rgb;
+	color += tex2D(source, texcoord + float2(-1.0,  1.0) * texel_size).rgb;
+	color += tex2D(source, texcoord + float2( 1.0,  1.0) * texel_size).rgb;
+	return color / 16.0;
+}
+
+float4 PrefilterPS(float4 position : SV_Position, float2 texcoord : TEXCOORD) : SV_Target
+{
+	const float3 color = Downsample(Common::BackBufferLinear, texcoord, BUFFER_PIXEL_SIZE);
+	return float4(Prefilter(color), 1.0);
+}
+
+float4 Downsample1PS(float4 position : SV_Position, float2 texcoord : TEXCOORD) : SV_Target { return float4(Downsample(BloomSampler0, texcoord, BUFFER_PIXEL_SIZE * 2.0), 1.0); }
+float4 Downsample2PS(float4 position : SV_Position, float2 texcoord : TEXCOORD) : SV_Target { return float4(Downsample(BloomSampler1, texcoord, BUFFER_PIXEL_SIZE * 4.0), 1.0); }
+float4 Downsample3PS(float4 position : SV_Position, float2 texcoord : TEXCOORD) : SV_Target { return float4(Downsample(BloomSampler2, texcoord, BUFFER_PIXEL_SIZE * 8.0), 1.0); }
+float4 Downsample4PS(float4 position : SV_Position, float2 texcoord : TEXCOORD) : SV_Target { return float4(Downsample(BloomSampler3, texcoord, BUFFER_PIXEL_SIZE * 16.0), 1.0); }
+
+float4 Upsample3PS(float4 position : SV_Position, float2 texcoord : TEXCOORD) : SV_Target { return float4(Upsample(BloomSampler4, texcoord, BUFFER_PIXEL_SIZE * 32.0), 1.0); }
+float4 Upsample2PS(float4 position : SV_Position, float2 texcoord : TEXCOORD) : SV_Target { return float4(Upsample(BloomSampler3, texcoord, BUFFER_PIXEL_SIZE * 16.0), 1.0); }
+float4 Upsample1PS(float4 position : SV_Position, float2 texcoord : TEXCOORD) : SV_Target { return float4(Upsample(BloomSampler2, texcoord, BUFFER_PIXEL_SIZE * 8.0), 1.0); }
+float4 Upsample0PS(float4 position : SV_Position, float2 texcoord : TEXCOORD) : SV_Target { return float4(Upsample(BloomSampler1, texcoord, BUFFER_PIXEL_SIZE * 4.0), 1.0); }
+
+float Noise(float2 position)
+{
+	return frac(52.9829189 * frac(dot(position, float2(0.06711056, 0.00583715))));
+}
+
+float3 CombinePS(float4 position : SV_Position, float2 texcoord : TEXCOORD) : SV_Target
+{
+	float3 color = Common::SRGBToLinear(tex2D(Common::BackBuffer, texcoord).rgb);
+	const float3 bloom = Upsample(BloomSampler0, texcoord, BUFFER_PIXEL_SIZE * 2.0);
+	color += bloom * Tint * Intensity;
+
+	// Simple Reinhard tone mapping that preserves the luminance ratio
+	const float luma = Common::Luma(color);
+	color *= (1.0 + luma / 16.0) / (1.0 + luma);
+
+	color = Common::LinearToSRGB(saturate(color));
+
+	if (Dither)
+		color += (Noise(position.xy + (Common::FrameCount % 64)) - 0.5) / 255.0;
+
+	return color;
+}
+
+technique Bloom < ui_tooltip = "Adds a glow around bright areas of the image."; >
+{
+	pass Prefilter { VertexShader = PostProcessVS; PixelShader = PrefilterPS; RenderTarget = BloomTex0; }
+	pass Downsample1 { VertexShader = PostProcessVS; PixelShader = Downsample1PS; RenderTarget = BloomTex1; }
+	pass Downsample2 { VertexShader = PostProcessVS; PixelShader = Downsample2PS; RenderTarget = BloomTex2; }
+	pass Downsample3 { VertexShader = PostProcessVS; PixelShader = Downsample3PS; RenderTarget = BloomTex3; }
+	pass Downsample4 { VertexShader = PostProcessVS; PixelShader = Downsample4PS; RenderTarget = BloomTex4; }
+	pass Upsample3 { VertexShader = PostProcessVS; PixelShader = Upsample3PS; RenderTarget = BloomTex3; BlendEnable = true; SrcBlend = ONE; DestBlend = ONE; }
+	pass Upsample2 { VertexShader = PostProcessVS; PixelShader = Upsample2PS; RenderTarget = BloomTex2; BlendEnable = true; SrcBlend = ONE; DestBlend = ONE; }
+	pass Upsample1 { VertexShader = PostProcessVS; PixelShader = Upsample1PS; RenderTarget = BloomTex1; BlendEnable = true; SrcBlend = ONE; DestBlend = ONE; }
+	pass Upsample0 { VertexShader = PostProcessVS; PixelShader = Upsample0PS; RenderTarget = BloomTex0; BlendEnable = true; SrcBlend = ONE; DestBlend = ONE; }
+	pass Combine { VertexShader = PostProcessVS; PixelShader = CombinePS; }
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2026 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+// Effect using compute shaders with storage objects, shared memory and atomic operations, similar to typical histogram and auto exposure effects
+
+#include "Common.fxh"
+
+#define HISTOGRAM_BINS 256
+#define THREAD_GROUP_SIZE 16
+
+uniform float AdaptationSpeed <
+	ui_type = "slider";
+	ui_min = 0.1; ui_max = 10.0;
+	ui_label = "Adaptation speed";
+> = 2.0;
+uniform float ExposureBias <
+	ui_type = "slider";
+	ui_min = -4.0; ui_max = 4.0;
+	ui_label = "Exposure bias";
+> = 0.0;
+uniform float2 LuminanceRange <
+	ui_type = "drag";
+	ui_min = -16.0; ui_max = 16.0;
+	ui_label = "Luminance range (log2)";
+> = float2(-8.0, 4.0);
+
+texture HistogramTex { Width = HISTOGRAM_BINS; Height = 1; Format = R32U; };
+texture ExposureTex { Width = 1; Height = 1; Format = R32F; };
+
+storage2D<uint> HistogramStorage { Texture = HistogramTex; };
+storage2D<float> ExposureStorage { Texture = ExposureTex; };
+sampler2D<float> ExposureSampler { Texture = ExposureTex; MagFilter = POINT; MinFilter = POINT; MipFilter = POINT; };
+
+groupshared uint s_bins[HISTOGRAM_BINS];
+
+uint LuminanceToBin(float3 color)
+{
+	const float luma = Common::Luma(color);
+	if (luma < 1e-5)
+		return 0;
+
+	const float log_luma = saturate((log2(luma) - LuminanceRange.x) / (LuminanceRange.y - LuminanceRange.x));
+	return uint(log_luma * (HISTOGRAM_BINS - 2) + 1.0);
+}
+
+void ClearCS(uint3 id : SV_DispatchThreadID)
+{
+	tex2Dstore(HistogramStorage, int2(id.x, 0), 0u);
+}
+
+void BuildHistogramCS(uint3 id : SV_DispatchThreadID, uint3 tid : SV_GroupThreadID)
+{
+	const uint local_index = tid.y * THREAD_GROUP_SIZE + tid.x;
+	s_bins[local_index] = 0;
+	barrier();
+
+	if (id.x < BUFFER_WIDTH && id.y < BUFFER_HEIGHT)
+	{
+		const float3 color = tex2Dfetch(Common::BackBuffer, int2(id.xy)).rgb;
+		atomicAdd(s_bins[LuminanceToBin(color)], 1u);
+	}
+	barrier();
+
+	atomicAdd(HistogramStorage, int2(local_index, 0), s_bins[local_index]);
+}
+
+void AverageCS(uint3 id : SV_DispatchThreadID, uint3 tid : SV_GroupThreadID)
+{
+	const uint count = tex2Dfetch(HistogramStorage, int2(tid.x, 0)).x;
+	s_bins[tid.x] = count * tid.x;
+	barrier();
+
+	[unroll] for (uint stride = HISTOGRAM_BINS / 2; stride > 0; stride >>= 1)
+	{
+		if (tid.x < stride)
+			s_bins[tid.x] += s_bins[tid.x + stride];
+		barrier();
+	}
+
+	if (tid.x == 0)
+	{
+		const float pixel_count = float(BUFFER_WIDTH * BUFFER_HEIGHT);
+		const float weighted_log_average = (float(s_bins[0]) / max(pixel_count - float(count), 1.0)) - 1.0;
+		const float average_luma = exp2((weighted_log_average / (HISTOGRAM_BINS - 2)) * (LuminanceRange.y - LuminanceRange.x) + LuminanceRange.x);
+
+		const float previous = tex2Dfetch(ExposureStorage, int2(0, 0)).x;
+		const float adapted = previous + (average_luma - previous) * (1.0 - exp(-Common::FrameTime * 0.001 * AdaptationSpeed));
+		tex2Dstore(ExposureStorage, int2(0, 0), adapted);
+	}
+}
+
+float3 ApplyExposurePS(float4 position : SV_Position, float2 texcoord : TEXCOORD) : SV_Target
+{
+	const float3 color = tex2D(Common::BackBuffer, texcoord).rgb;
+	const float average_luma = tex2Dfetch(ExposureSampler, int2(0, 0)).x;
+	const float exposure = exp2(ExposureBias) * 0.18 / max(average_luma, 1e-4);
+	return saturate(color * exposure);
+}
+
+technique Histogram
+{
+	pass Clear { ComputeShader = ClearCS<HISTOGRAM_BINS, 1>; DispatchSizeX = 1; DispatchSizeY = 1; }
+	pass Build { ComputeShader = BuildHistogramCS<THREAD_GROUP_SIZE, THREAD_GROUP_SIZE>; DispatchSizeX = (BUFFER_WIDTH + THREAD_GROUP_SIZE - 1) / THREAD_GROUP_SIZE; DispatchSizeY = (BUFFER_HEIGHT + THREAD_GROUP_SIZE - 1) / THREAD_GROUP_SIZE; }
+	pass Average { ComputeShader = AverageCS<HISTOGRAM_BINS, 1>; DispatchSizeX = 1; DispatchSizeY = 1; }
+	pass Apply { VertexShader = PostProcessVS; PixelShader = ApplyExposurePS; }
+}
@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2026 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+// Single-pass effect with many user options, preprocessor branches and a large amount of arithmetic, similar to typical sharpening and color grading effects
+
+#include "Common.fxh"
+
+#ifndef SHARPEN_MODE
+	#define SHARPEN_MODE 1 // 0 = Unsharp mask, 1 = Contrast adaptive
+#endif
+#ifndef SHARPEN_DEPTH_MASK
+	#define SHARPEN_DEPTH_MASK 1
+#endif
+#ifndef SHARPEN_DEBUG_VIEW
+	#define SHARPEN_DEBUG_VIEW 0
+#endif
+
+#define SAMPLE_OFFSET(x, y) (texcoord + float2(x, y) * BUFFER_PIXEL_SIZE * Radius)
+#define FETCH(x, y) tex2D(Common::BackBuffer, SAMPLE_OFFSET(x, y)).rgb
+#define MIN3(a, b, c) min(a, min(b, c))
+#define MAX3(a, b, c) max(a, max(b, c))
+
+uniform float Strength <
+	ui_type = "slider";
+	ui_min = 0.0; ui_max = 2.0; ui_step = 0.01;
+	ui_category = "Sharpening";
+	ui_label = "Strength";
+> = 0.6;
+uniform float Radius <
+	ui_type = "slider";
+	ui_min = 0.5; ui_max = 3.0; ui_step = 0.05;
+	ui_category = "Sharpening";
+	ui_label = "Radius";
+> = 1.0;
+uniform float Clamp <
+	ui_type = "slider";
+	ui_min = 0.0; ui_max = 1.0;
+	ui_category = "Sharpening";
+	ui_label = "Clamp";
+	ui_tooltip = "Limits the maximum change of a single pixel.";
+> = 0.1;
+uniform float DepthStart <
+	ui_type = "slider";
+	ui_min = 0.0; ui_max = 1.0;
+	ui_category = "Depth";
+	ui_label = "Fade start";
+> = 0.2;
+uniform float DepthEnd <
+	ui_type = "slider";
+	ui_min = 0.0; ui_max = 1.0;
+	ui_category = "Depth";
+	ui_label = "Fade end";
+> = 0.9;
+uniform float Saturation <
+	ui_type = "slider";
+	ui_min = 0.0; ui_max = 2.0;
+	ui_category = "Color";
+	ui_label = "Saturation";
+> = 1.0;
+uniform float3 Lift <
+	ui_type = "color";
+	ui_category = "Color";
+	ui_label = "Lift";
+> = float3(0.0, 0.0, 0.0);
+uniform float3 Gamma <
+	ui_type = "color";
+	ui_category = "Color";
+	ui_label = "Gamma";
+> = float3(1.0, 1.0, 1.0);
+uniform float3 Gain <
+	ui_type = "color";
+	ui_category = "Color";
+	ui_label = "Gain";
+> = float3(1.0, 1.0, 1.0);
+uniform int ToneCurve <
+	ui_type = "combo";
+	ui_items = "None\0Filmic\0ACES\0Hable\0";
+	ui_category = "Color";
+	ui_label = "Tone curve";
+> = 0;
+
+struct Neighborhood
+{
+	float3 center;
+	float3 north, south, east, west;
+	float3 north_east, north_west, south_east, south_west;
+};
+
+Neighborhood GatherNeighborhood(float2 texcoord)
+{
+	Neighborhood n;
+	n.center = FETCH( 0,  0);
+	n.north  = FETCH( 0, -1);
+	n.south  = FETCH( 0,  1);
+	n.east   = FETCH( 1,  0);
+	n.west   = FETCH(-1,  0);
+	n.north_east = FETCH( 1, -1);
+	n.north_west = FETCH(-1, -1);
+	n.south_east = FETCH( 1,  1);
+	n.south_west = FETCH(-1,  1);
+	return n;
+}
+
+float3 UnsharpMask(Neighborhood n)
+{
+	const float3 blur = (n.north + n.south + n.east + n.west) * 0.125 + (n.north_east + n.north_west + n.south_east + n.south_west) * 0.0625 + n.center * 0.25;
+	const float3 detail = n.center - blur;
+	return n.center + clamp(detail * Strength, -Clamp, Clamp);
+}
+
+float3 ContrastAdaptive(Neighborhood n)
+{
+	const float3 min_cross = MIN3(n.north, n.south, MIN3(n.east, n.west, n.center));
+	const float3 max_cross = MAX3(n.north, n.south, MAX3(n.east, n.west, n.center));
+	const float3 min_diag = MIN3(min_cross, n.north_east, MIN3(n.north_west, n.south_east, n.south_west));
+	const float3 max_diag = MAX3(max_cross, n.north_east, MAX3(n.north_west, n.south_east, n.south_west));
+	const float3 min_rgb = min_cross + min_diag;
+	const float3 max_rgb = max_cross + max_diag;
+
+	const float3 amplitude = saturate(min(min_rgb, 2.0 - max_rgb) * rcp(max(max_rgb, 1e-5)));
+	const float peak = -1.0 / lerp(8.0, 5.0, saturate(Strength * 0.5));
+	const float3 weight = sqrt(amplitude) * peak;
+	const float3 sum = n.north + n.south + n.east + n.west;
+
+	const float3 result = (sum * weight + n.center) / (1.0 + 4.0 * weight);
+	return n.center + clamp(result - n.center, -Clamp, Clamp);
+}
+
+float3 ApplyToneCurve(float3 color)
+{
+	switch (ToneCurve)
+	{
+	case 1:
+	{
+		const float3 x = max(0.0, color - 0.004);
+		return (x * (6.2 * x + 0.5)) / (x * (6.2 * x + 1.7) + 0.06);
+	}
+	case 2:
+		return saturate((color * (2.51 * color + 0.03)) / (color * (2.43 * color + 0.59) + 0.14));
+	case 3:
+	{
+		const float A = 0.15, B = 0.50, C = 0.10, D = 0.20, E = 0.02, F = 0.30;
+		const float3 x = color * 2.0;
+		return ((x * (A * x + C * B) + D * E) / (x * (A * x + B) + D * F)) - E / F;
+	}
+	default:
+		return color;
+	}
+}
+
+float3 ColorGrade(float3 color)
+{
+	color = color * Gain + Lift * (1.0 - color);
+	color = pow(max(color, 0.0), 1.0 / max(Gamma, 0.01));
+
+	const float luma = Common::Luma(color);
+	color = lerp(luma.xxx, color, Saturation);
+
+	return ApplyToneCurve(color);
+}
+
+float3 SharpenPS(float4 position : SV_Position, float2 texcoord : TEXCOORD) : SV_Target
+{
+	const Neighborhood n = GatherNeighborhood(texcoord);
+
+#if SHARPEN_MODE == 0
+	float3 color = UnsharpMask(n);
+#else
+	float3 color = ContrastAdaptive(n);
+#endif
+
+#if SHARPEN_DEPTH_MASK
+	const float depth = Common::GetLinearizedDepth(texcoord);
+	const float mask = 1.0 - smoothstep(DepthStart, DepthEnd, depth);
+	color = lerp(n.center, color, mask);
+#endif
+
+	color = ColorGrade(color);
+
+#if SHARPEN_DEBUG_VIEW
+	return abs(color - n.center) * 10.0;
+#else
+	return saturate(color);
+#endif
+}
+
+technique Sharpen
+{
+	pass
+	{
+		VertexShader = PostProcessVS;
+		PixelShader = SharpenPS;
+	}
+}
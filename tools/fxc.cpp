@@ -7,9 +7,16 @@
 #include "effect_codegen.hpp"
 #include "effect_preprocessor.hpp"
 #include "version.h"
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstdio> // std::snprintf
 #include <cstring>
+#include <cstdlib> // std::strtol
 #include <fstream>
 #include <iostream>
+#include <algorithm> // std::sort
 
 static void print_usage(const char *path)
 {
@@ -37,17 +44,24 @@ Options:
   --vulkan-semantics        Generate GLSL/SPIR-V code under Vulkan semantics, instead of OpenGL semantics.
 
   -Zi                       Enable debug information.
+  -O <level>                Optimization level. 0 disables optimizations (default), 1 reuses values within basic blocks, 2 additionally hoists uniform loads and removes dead code (SPIR-V only).
+
+Batch mode:
+  --batch <path>            Compile all effect files in the given directory, or all effect files listed in the given manifest file (one path per line), in parallel.
+  --server                  Keep running and compile the effect files whose paths are read from standard input (one path per line), until an empty line or end of input.
+                            A JSON object describing the result is written to standard output in a single line for each of them.
+  -o <directory>            Write the code for every entry point to a separate file in '<directory>/<effect file name>/'. Uses the code format selected with '--glsl' or '--hlsl', or SPIR-V by default.
+  -j <count>                Number of effect files to compile in parallel. Defaults to the number of processor cores.
+  --report <file>           Write a JSON report with timings, output sizes and errors of all effect files to the given file. If <file> is "-", then it is written to standard output instead.
 	)", path);
 }
 
-int main(int argc, char *argv[])
+struct compile_options
 {
-	const char *source_file = nullptr;
-	const char *preprocess_file = nullptr;
-	const char *error_file = nullptr;
-	const char *object_file = nullptr;
-	const char *buffer_width = "800";
-	const char *buffer_height = "600";
+	std::vector<std::pair<std::string, std::string>> macro_definitions;
+	std::vector<std::filesystem::path> include_paths;
+	std::string buffer_width = "800";
+	std::string buffer_height = "600";
 	bool print_glsl = false;
 	bool print_hlsl = false;
 	bool debug_info = false;
@@ -55,11 +69,403 @@ int main(int argc, char *argv[])
 	bool spec_constants = false;
 	bool vulkan_semantics = false;
 	unsigned int shader_model = 50;
+	int optimization_level = 0;
+};
 
-	reshadefx::preprocessor pp;
+struct compile_result
+{
+	struct entry_point
+	{
+		std::string name;
+		reshadefx::shader_type type = reshadefx::shader_type::unknown;
+		size_t code_size = 0;
+		size_t instruction_count = 0;
+		double assemble_time = 0.0;
+	};
+
+	std::filesystem::path source_file;
+	bool success = false;
+	std::string errors;
+	size_t preprocessed_size = 0;
+	size_t include_cache_hits = 0;
+	size_t include_cache_misses = 0;
+	// Times are in seconds, with code generation happening during parsing (the parser drives the code generator), so it is included in the parse time
+	double preprocess_time = 0.0;
+	double parse_time = 0.0;
+	double assemble_time = 0.0;
+	std::vector<entry_point> entry_points;
+};
+
+static void setup_preprocessor(reshadefx::preprocessor &pp, const compile_options &options)
+{
 	pp.add_macro_definition("__RESHADE__", std::to_string(VERSION_MAJOR * 10000 + VERSION_MINOR * 100 + VERSION_REVISION));
 	pp.add_macro_definition("__RESHADE_PERFORMANCE_MODE__", "0");
 
+	for (const std::pair<std::string, std::string> &definition : options.macro_definitions)
+		pp.add_macro_definition(definition.first, definition.second);
+	for (const std::filesystem::path &include_path : options.include_paths)
+		pp.add_include_path(include_path);
+
+	pp.add_macro_definition("BUFFER_WIDTH", options.buffer_width);
+	pp.add_macro_definition("BUFFER_HEIGHT", options.buffer_height);
+	pp.add_macro_definition("BUFFER_RCP_WIDTH", "(1.0 / BUFFER_WIDTH)");
+	pp.add_macro_definition("BUFFER_RCP_HEIGHT", "(1.0 / BUFFER_HEIGHT)");
+}
+
+static reshadefx::codegen *create_codegen(const compile_options &options)
+{
+	reshadefx::codegen *backend;
+	if (options.print_glsl)
+		backend = reshadefx::create_codegen_glsl(options.vulkan_semantics, options.debug_info, options.spec_constants, options.invert_y_axis);
+	else if (options.print_hlsl)
+		backend = reshadefx::create_codegen_hlsl(options.shader_model, options.debug_info, options.spec_constants);
+	else
+		backend = reshadefx::create_codegen_spirv(options.vulkan_semantics, options.debug_info, options.spec_constants, options.invert_y_axis);
+
+	backend->set_optimization_level(options.optimization_level);
+	return backend;
+}
+
+static size_t count_instructions(const std::string &code, bool is_spirv)
+{
+	size_t count = 0;
+
+	if (is_spirv)
+	{
+		// Count instructions in function bodies (skipping the header and all declarations before the first function), excluding debug line information
+		const uint32_t *const words = reinterpret_cast<const uint32_t *>(code.data());
+		const size_t num_words = code.size() / sizeof(uint32_t);
+
+		bool in_function = false;
+		for (size_t i = 5, word_count; i < num_words; i += word_count)
+		{
+			word_count = words[i] >> 16;
+			if (word_count == 0)
+				break;
+
+			const uint32_t op = words[i] & 0xFFFF;
+			if (op == 54 /* OpFunction */)
+				in_function = true;
+			if (in_function && op != 8 /* OpLine */ && op != 317 /* OpNoLine */)
+				count++;
+		}
+	}
+	else
+	{
+		// Count statements, which is every line ending in a semicolon
+		for (size_t offset = 0; (offset = code.find(";\n", offset)) != std::string::npos; offset += 2)
+			count++;
+	}
+
+	return count;
+}
+
+static compile_result compile_effect(const std::filesystem::path &source_file, const compile_options &options, const std::filesystem::path &output_path)
+{
+	typedef std::chrono::high_resolution_clock clock;
+
+	compile_result result;
+	result.source_file = source_file;
+
+	const clock::time_point time_start = clock::now();
+
+	reshadefx::preprocessor pp;
+	setup_preprocessor(pp, options);
+
+	const bool preprocessed = pp.append_file(source_file);
+
+	const clock::time_point time_preprocess_finished = clock::now();
+	result.preprocess_time = std::chrono::duration<double>(time_preprocess_finished - time_start).count();
+	result.preprocessed_size = pp.output().size();
+	result.include_cache_hits = pp.include_cache_hits();
+	result.include_cache_misses = pp.include_cache_misses();
+	result.errors = pp.errors();
+
+	if (!preprocessed)
+	{
+		if (result.errors.empty())
+			result.errors = "error: " + source_file.u8string() + ": could not open file\n";
+		return result;
+	}
+
+	const std::unique_ptr<reshadefx::codegen> backend(create_codegen(options));
+
+	reshadefx::parser parser;
+	const bool parsed = parser.parse(pp.output(), backend.get());
+
+	const clock::time_point time_parse_finished = clock::now();
+	result.parse_time = std::chrono::duration<double>(time_parse_finished - time_preprocess_finished).count();
+	result.errors += parser.errors();
+
+	if (!parsed)
+		return result;
+
+	const char *const extension = options.print_glsl ? ".glsl" : options.print_hlsl ? ".hlsl" : ".spv";
+
+	std::error_code ec;
+	if (!output_path.empty() && !std::filesystem::create_directories(output_path, ec) && ec)
+	{
+		result.errors += "error: " + output_path.u8string() + ": could not create output directory\n";
+		return result;
+	}
+
+	result.success = true;
+
+	for (const std::pair<std::string, reshadefx::shader_type> &entry_point : backend->module().entry_points)
+	{
+		const clock::time_point time_assemble_started = clock::now();
+
+		std::string code, assembly;
+		if (!backend->assemble_code_for_entry_point(entry_point.first, code, assembly, result.errors))
+		{
+			result.success = false;
+			continue;
+		}
+
+		const double assemble_time = std::chrono::duration<double>(clock::now() - time_assemble_started).count();
+		result.assemble_time += assemble_time;
+		result.entry_points.push_back({ entry_point.first, entry_point.second, code.size(), count_instructions(code, !options.print_glsl && !options.print_hlsl), assemble_time });
+
+		if (!output_path.empty() && !std::ofstream(output_path / (entry_point.first + extension), std::ios::binary).write(code.data(), code.size()))
+		{
+			result.errors += "error: " + (output_path / (entry_point.first + extension)).u8string() + ": could not write output file\n";
+			result.success = false;
+		}
+	}
+
+	return result;
+}
+
+static void write_json_string(std::ostream &stream, const std::string_view value)
+{
+	stream << '"';
+	for (const char c : value)
+	{
+		switch (c)
+		{
+		case '"':
+			stream << "\\\"";
+			break;
+		case '\\':
+			stream << "\\\\";
+			break;
+		case '\n':
+			stream << "\\n";
+			break;
+		case '\r':
+			stream << "\\r";
+			break;
+		case '\t':
+			stream << "\\t";
+			break;
+		default:
+			if (static_cast<unsigned char>(c) < 0x20)
+			{
+				char escaped[8];
+				std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned int>(c));
+				stream << escaped;
+			}
+			else
+			{
+				stream << c;
+			}
+			break;
+		}
+	}
+	stream << '"';
+}
+
+static void write_json_result(std::ostream &stream, const compile_result &result)
+{
+	stream << "{\"file\":";
+	write_json_string(stream, result.source_file.u8string());
+	stream << ",\"success\":" << (result.success ? "true" : "false");
+	stream << ",\"preprocess_ms\":" << result.preprocess_time * 1000.0;
+	stream << ",\"parse_ms\":" << result.parse_time * 1000.0;
+	stream << ",\"assemble_ms\":" << result.assemble_time * 1000.0;
+	stream << ",\"preprocessed_size\":" << result.preprocessed_size;
+	stream << ",\"include_cache_hits\":" << result.include_cache_hits;
+	stream << ",\"include_cache_misses\":" << result.include_cache_misses;
+	stream << ",\"entry_points\":[";
+	for (size_t i = 0; i < result.entry_points.size(); ++i)
+	{
+		const compile_result::entry_point &entry_point = result.entry_points[i];
+
+		if (i != 0)
+			stream << ',';
+		stream << "{\"name\":";
+		write_json_string(stream, entry_point.name);
+		stream << ",\"type\":";
+		switch (entry_point.type)
+		{
+		case reshadefx::shader_type::vertex:
+			stream << "\"vertex\"";
+			break;
+		case reshadefx::shader_type::pixel:
+			stream << "\"pixel\"";
+			break;
+		case reshadefx::shader_type::compute:
+			stream << "\"compute\"";
+			break;
+		default:
+			stream << "\"unknown\"";
+			break;
+		}
+		stream << ",\"size\":" << entry_point.code_size;
+		stream << ",\"instructions\":" << entry_point.instruction_count;
+		stream << ",\"assemble_ms\":" << entry_point.assemble_time * 1000.0;
+		stream << '}';
+	}
+	stream << "],\"errors\":";
+	write_json_string(stream, result.errors);
+	stream << '}';
+}
+
+static bool find_effect_files(const std::filesystem::path &path, std::vector<std::filesystem::path> &source_files)
+{
+	std::error_code ec;
+	if (std::filesystem::is_directory(path, ec))
+	{
+		for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(path, std::filesystem::directory_options::skip_permission_denied, ec))
+		{
+			if (entry.is_regular_file(ec) && (entry.path().extension() == ".fx" || entry.path().extension() == ".addonfx"))
+				source_files.push_back(entry.path());
+		}
+
+		// Directory iteration order is unspecified, so sort to make the report order stable
+		std::sort(source_files.begin(), source_files.end());
+		return !ec;
+	}
+
+	std::ifstream manifest(path);
+	if (!manifest)
+		return false;
+
+	// Relative paths in the manifest are relative to the manifest itself
+	const std::filesystem::path base_path = path.parent_path();
+
+	for (std::string line; std::getline(manifest, line);)
+	{
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		source_files.push_back(base_path / std::filesystem::u8path(line));
+	}
+
+	return true;
+}
+
+static int run_batch(const std::filesystem::path &batch_path, const compile_options &options, const std::filesystem::path &output_path, const char *report_file, size_t num_threads)
+{
+	std::vector<std::filesystem::path> source_files;
+	if (!find_effect_files(batch_path, source_files))
+	{
+		std::cout << "error: Could not read effect files from " << batch_path.u8string() << std::endl;
+		return 1;
+	}
+
+	const std::chrono::high_resolution_clock::time_point time_start = std::chrono::high_resolution_clock::now();
+
+	// Compile effect files in parallel, with each thread taking the next file from the list when it is done with the previous one
+	// Included files are read through the include cache shared between all preprocessor instances, so common headers are only read from disk once
+	std::vector<compile_result> results(source_files.size());
+	std::atomic<size_t> next_index = 0;
+	std::mutex output_mutex;
+
+	// Keep standard output free for the report if it is written there
+	std::ostream &output = report_file != nullptr && std::strcmp(report_file, "-") == 0 ? std::cerr : std::cout;
+
+	const auto compile_effects = [&]() {
+		for (size_t i; (i = next_index++) < source_files.size();)
+		{
+			results[i] = compile_effect(source_files[i], options, output_path.empty() ? output_path : output_path / source_files[i].filename());
+
+			const std::unique_lock<std::mutex> lock(output_mutex);
+			if (!results[i].errors.empty())
+				output << results[i].errors;
+			output << (results[i].success ? "compiled " : "failed ") << source_files[i].u8string() << std::endl;
+		}
+	};
+
+	if (num_threads == 0)
+		num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+	num_threads = std::min(num_threads, source_files.size());
+
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < num_threads; ++i)
+		threads.emplace_back(compile_effects);
+	compile_effects();
+	for (std::thread &thread : threads)
+		thread.join();
+
+	const double total_time = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - time_start).count();
+
+	size_t num_failed = 0;
+	for (const compile_result &result : results)
+		num_failed += result.success ? 0 : 1;
+
+	output << (source_files.size() - num_failed) << " of " << source_files.size() << " effect files compiled successfully in " << total_time << " seconds" << std::endl;
+
+	if (report_file != nullptr)
+	{
+		std::ofstream report_file_stream;
+		std::ostream &report = std::strcmp(report_file, "-") == 0 ? std::cout : (report_file_stream.open(report_file), report_file_stream);
+
+		report << "{\"total_ms\":" << total_time * 1000.0 << ",\"threads\":" << num_threads << ",\"effects\":[\n";
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			write_json_result(report, results[i]);
+			report << (i + 1 < results.size() ? ",\n" : "\n");
+		}
+		report << "]}" << std::endl;
+
+		if (!report)
+		{
+			output << "error: Could not write report to " << report_file << std::endl;
+			return 1;
+		}
+	}
+
+	return num_failed == 0 ? 0 : 1;
+}
+
+static int run_server(const compile_options &options, const std::filesystem::path &output_path)
+{
+	// Process stays alive between requests, so included files are only read from disk again when they changed
+	for (std::string line; std::getline(std::cin, line);)
+	{
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+		if (line.empty())
+			break;
+
+		const std::filesystem::path source_file = std::filesystem::u8path(line);
+
+		const compile_result result = compile_effect(source_file, options, output_path.empty() ? output_path : output_path / source_file.filename());
+
+		write_json_result(std::cout, result);
+		std::cout << std::endl;
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *source_file = nullptr;
+	const char *preprocess_file = nullptr;
+	const char *error_file = nullptr;
+	const char *object_file = nullptr;
+	const char *batch_path = nullptr;
+	const char *output_path = nullptr;
+	const char *report_file = nullptr;
+	bool server_mode = false;
+	size_t num_threads = 0;
+
+	compile_options options;
+
 	// Parse command-line arguments
 	for (int i = 1; i < argc; ++i)
 	{
@@ -81,28 +487,30 @@ int main(int argc, char *argv[])
 				char *name = argv[++i];
 				char *value = std::strchr(name, '=');
 				if (value) *value++ = '\0';
-				pp.add_macro_definition(name, value ? value : "1");
+				options.macro_definitions.emplace_back(name, value ? value : "1");
 				continue;
 			}
 
 			if (0 == std::strcmp(arg, "-I"))
 			{
-				pp.add_include_path(argv[++i]);
+				options.include_paths.push_back(argv[++i]);
 				continue;
 			}
 
 			if (0 == std::strcmp(arg, "-Zi"))
-				debug_info = true;
+				options.debug_info = true;
 			else if (0 == std::strcmp(arg, "--glsl"))
-				print_glsl = true;
+				options.print_glsl = true;
 			else if (0 == std::strcmp(arg, "--hlsl"))
-				print_hlsl = true;
+				options.print_hlsl = true;
 			else if (0 == std::strcmp(arg, "--invert-y"))
-				invert_y_axis = true;
+				options.invert_y_axis = true;
 			else if (0 == std::strcmp(arg, "--spec-constants"))
-				spec_constants = true;
+				options.spec_constants = true;
 			else if (0 == std::strcmp(arg, "--vulkan-semantics"))
-				vulkan_semantics = true;
+				options.vulkan_semantics = true;
+			else if (0 == std::strcmp(arg, "--server"))
+				server_mode = true;
 
 			if (i + 1 >= argc)
 				continue;
@@ -112,12 +520,22 @@ int main(int argc, char *argv[])
 				error_file = argv[++i];
 			else if (0 == std::strcmp(arg, "-Fo"))
 				object_file = argv[++i];
+			else if (0 == std::strcmp(arg, "-O"))
+				options.optimization_level = static_cast<int>(std::strtol(argv[++i], nullptr, 10));
 			else if (0 == std::strcmp(arg, "--shader-model"))
-				shader_model = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+				options.shader_model = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
 			else if (0 == std::strcmp(arg, "--width"))
-				buffer_width = argv[++i];
+				options.buffer_width = argv[++i];
 			else if (0 == std::strcmp(arg, "--height"))
-				buffer_height = argv[++i];
+				options.buffer_height = argv[++i];
+			else if (0 == std::strcmp(arg, "--batch"))
+				batch_path = argv[++i];
+			else if (0 == std::strcmp(arg, "-o"))
+				output_path = argv[++i];
+			else if (0 == std::strcmp(arg, "-j"))
+				num_threads = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+			else if (0 == std::strcmp(arg, "--report"))
+				report_file = argv[++i];
 		}
 		else
 		{
@@ -131,16 +549,34 @@ int main(int argc, char *argv[])
 		}
 	}
 
-	if (source_file == nullptr || (print_glsl && print_hlsl) || (print_glsl && object_file) || (print_hlsl && object_file))
+	if (options.print_glsl && options.print_hlsl)
 	{
 		print_usage(argv[0]);
 		return 1;
 	}
 
-	pp.add_macro_definition("BUFFER_WIDTH", buffer_width);
-	pp.add_macro_definition("BUFFER_HEIGHT", buffer_height);
-	pp.add_macro_definition("BUFFER_RCP_WIDTH", "(1.0 / BUFFER_WIDTH)");
-	pp.add_macro_definition("BUFFER_RCP_HEIGHT", "(1.0 / BUFFER_HEIGHT)");
+	if (batch_path != nullptr || server_mode)
+	{
+		if (source_file != nullptr || (batch_path != nullptr && server_mode) || preprocess_file || error_file || object_file)
+		{
+			print_usage(argv[0]);
+			return 1;
+		}
+
+		if (server_mode)
+			return run_server(options, output_path != nullptr ? std::filesystem::u8path(output_path) : std::filesystem::path());
+		else
+			return run_batch(std::filesystem::u8path(batch_path), options, output_path != nullptr ? std::filesystem::u8path(output_path) : std::filesystem::path(), report_file, num_threads);
+	}
+
+	if (source_file == nullptr || (options.print_glsl && object_file) || (options.print_hlsl && object_file))
+	{
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	reshadefx::preprocessor pp;
+	setup_preprocessor(pp, options);
 
 	if (!pp.append_file(source_file))
 	{
@@ -160,13 +596,7 @@ int main(int argc, char *argv[])
 		return 0;
 	}
 
-	std::unique_ptr<reshadefx::codegen> backend;
-	if (print_glsl)
-		backend.reset(reshadefx::create_codegen_glsl(vulkan_semantics, debug_info, spec_constants, invert_y_axis));
-	else if (print_hlsl)
-		backend.reset(reshadefx::create_codegen_hlsl(shader_model, debug_info, spec_constants));
-	else
-		backend.reset(reshadefx::create_codegen_spirv(vulkan_semantics, debug_info, spec_constants, invert_y_axis));
+	std::unique_ptr<reshadefx::codegen> backend(create_codegen(options));
 
 	reshadefx::parser parser;
 	if (!parser.parse(pp.output(), backend.get()))
@@ -180,7 +610,7 @@ int main(int argc, char *argv[])
 
 	std::basic_string<char> code = backend->finalize_code();
 
-	if (print_glsl || print_hlsl)
+	if (options.print_glsl || options.print_hlsl)
 	{
 		std::cout.write(code.data(), code.size()).flush();
 	}
@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2026 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "ini_file.hpp"
+#include <chrono>
+#include <limits>
+#include <cstdio> // std::snprintf
+#include <cstdlib> // std::strtoul
+#include <cstring> // std::strcmp
+#include <fstream>
+#include <iostream>
+#include <algorithm> // std::max, std::min
+
+std::filesystem::path g_reshade_dll_path;
+std::filesystem::path g_reshade_base_path;
+std::filesystem::path g_target_executable_path;
+
+static void print_usage(const char *path)
+{
+	printf(R"(usage: %s [options]
+
+Generates a large preset file and measures loading, looking up, reading and saving it through the INI file cache, then writes a JSON report with the fastest time of every stage.
+
+Options:
+  -h, --help                Print this help.
+
+  --keys <count>            Number of keys in the generated preset. Defaults to 5000.
+  --iterations <count>      Number of times every stage is run, of which the fastest time is reported. Defaults to 5.
+  --output <file>           Write the report to the given file instead of standard output.
+	)", path);
+}
+
+struct stage_result
+{
+	std::string name;
+	// Fastest time of all iterations, in seconds
+	double time = 0.0;
+	// Number of operations performed in a single iteration
+	size_t count = 0;
+};
+
+template <typename F>
+static stage_result measure_stage(const char *name, unsigned int iterations, F &&run)
+{
+	stage_result result;
+	result.name = name;
+	result.time = std::numeric_limits<double>::max();
+
+	for (unsigned int i = 0; i < iterations; ++i)
+	{
+		const std::chrono::high_resolution_clock::time_point time_start = std::chrono::high_resolution_clock::now();
+		result.count = run();
+		const std::chrono::high_resolution_clock::time_point time_finished = std::chrono::high_resolution_clock::now();
+
+		result.time = std::min(result.time, std::chrono::duration<double>(time_finished - time_start).count());
+	}
+
+	return result;
+}
+
+// Generates a preset similar to what the runtime writes, with one section per effect and a mix of scalar, vector and string values
+static std::string generate_preset(size_t num_keys, std::vector<std::pair<std::string, std::string>> &keys)
+{
+	const size_t keys_per_section = 100;
+
+	std::string data = "PreprocessorDefinitions=BUFFER_COLOR_SPACE=1,RESHADE_DEPTH_INPUT_IS_REVERSED=0\nTechniques=";
+	for (size_t section = 0; section * keys_per_section < num_keys; ++section)
+		data += (section != 0 ? "," : "") + std::string("Technique") + std::to_string(section) + "@Effect" + std::to_string(section) + ".fx";
+	data += "\n\n";
+
+	for (size_t i = 0; i < num_keys; ++i)
+	{
+		const std::string section = "Effect" + std::to_string(i / keys_per_section) + ".fx";
+		if (i % keys_per_section == 0)
+			data += '[' + section + "]\n";
+
+		char value[128];
+		switch (i % 4)
+		{
+		case 0:
+			std::snprintf(value, sizeof(value), "%f", (i % 1000) / 1000.0);
+			break;
+		case 1:
+			std::snprintf(value, sizeof(value), "%f,%f,%f", (i % 7) / 7.0, (i % 11) / 11.0, (i % 13) / 13.0);
+			break;
+		case 2:
+			std::snprintf(value, sizeof(value), "%zu", i % 16);
+			break;
+		case 3:
+			std::snprintf(value, sizeof(value), "Text with an escaped,, comma %zu", i);
+			break;
+		}
+
+		std::string key = "Uniform" + std::to_string(i);
+		data += key + '=' + value + '\n';
+		keys.emplace_back(section, std::move(key));
+	}
+
+	return data;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *output_file = nullptr;
+	size_t num_keys = 5000;
+	unsigned int iterations = 5;
+
+	// Parse command-line arguments
+	for (int i = 1; i < argc; ++i)
+	{
+		const char *arg = argv[i];
+
+		if (0 == std::strcmp(arg, "-h") || 0 == std::strcmp(arg, "--help"))
+		{
+			print_usage(argv[0]);
+			return 0;
+		}
+
+		if (i + 1 >= argc)
+		{
+			print_usage(argv[0]);
+			return 1;
+		}
+		else if (0 == std::strcmp(arg, "--keys"))
+			num_keys = std::max(static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10)), static_cast<size_t>(1));
+		else if (0 == std::strcmp(arg, "--iterations"))
+			iterations = std::max(static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10)), 1u);
+		else if (0 == std::strcmp(arg, "--output"))
+			output_file = argv[++i];
+		else
+		{
+			print_usage(argv[0]);
+			return 1;
+		}
+	}
+
+	std::error_code ec;
+	const std::filesystem::path preset_path = std::filesystem::absolute(std::filesystem::temp_directory_path(ec) / "ReShadeINI_bench.ini");
+
+	std::vector<std::pair<std::string, std::string>> keys;
+	{
+		std::ofstream file(preset_path, std::ios::binary);
+		file << generate_preset(num_keys, keys);
+		if (!file)
+		{
+			std::cerr << "error: Could not write " << preset_path.u8string() << std::endl;
+			return 1;
+		}
+	}
+
+	std::vector<stage_result> stages;
+
+	// Parse the entire file into a new instance
+	stages.push_back(measure_stage("load", iterations, [&]() {
+		reshade::ini_file preset(preset_path);
+		return preset.has({}, "Techniques") ? num_keys : 0;
+	}));
+
+	// Look up the cached file like the runtime does every frame during preset transitions
+	reshade::ini_file::load_cache(preset_path);
+	stages.push_back(measure_stage("load_cache", iterations, [&]() {
+		size_t count = 0;
+		for (; count < 1000; ++count)
+			reshade::ini_file::load_cache(preset_path);
+		return count;
+	}));
+
+	// Read every value like 'load_current_preset' does
+	stages.push_back(measure_stage("get", iterations, [&]() {
+		const reshade::ini_file &preset = reshade::ini_file::load_cache(preset_path);
+		std::vector<std::string> values;
+		size_t count = 0;
+		for (const std::pair<std::string, std::string> &key : keys)
+			count += preset.get(key.first, key.second, values);
+		return count;
+	}));
+
+	// Serialize all values after a modification
+	stages.push_back(measure_stage("save", iterations, [&]() {
+		reshade::ini_file &preset = reshade::ini_file::load_cache(preset_path);
+		preset.set(keys.front().first, keys.front().second, 1);
+		return preset.save() ? num_keys : 0;
+	}));
+
+	reshade::ini_file::clear_cache();
+	std::filesystem::remove(preset_path, ec);
+
+	std::ofstream output_stream;
+	if (output_file != nullptr)
+		output_stream.open(output_file);
+	std::ostream &stream = output_file != nullptr ? output_stream : std::cout;
+
+	stream << "{\n  \"keys\": " << num_keys << ",\n  \"iterations\": " << iterations << ",\n  \"stages\": [\n";
+	for (size_t i = 0; i < stages.size(); ++i)
+	{
+		char time_ms[32];
+		std::snprintf(time_ms, sizeof(time_ms), "%.3f", stages[i].time * 1000.0);
+		stream << "    { \"name\": \"" << stages[i].name << "\", \"time_ms\": " << time_ms << ", \"count\": " << stages[i].count << " }" << (i + 1 < stages.size() ? "," : "") << '\n';
+	}
+	stream << "  ]\n}\n";
+
+	return stream ? 0 : 1;
+}
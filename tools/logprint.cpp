@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2026 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause OR MIT
+ */
+
+#include "dll_log.hpp"
+#include <ctime>
+#include <cstdio> // std::fopen, std::fread, std::fprintf
+#include <cstring> // std::strcmp
+
+static void print_usage(const char *path)
+{
+	printf(R"(usage: %s [options] <filename>
+
+Converts a ReShade log file written in the binary format (see 'BinaryLogging' option) to text.
+
+Options:
+  -h, --help                Print this help.
+  -o <file>                 Write text to the given file instead of standard output.
+  --utc                     Print times in UTC instead of local time.
+	)", path);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *input_file = nullptr;
+	const char *output_file = nullptr;
+	bool utc = false;
+
+	// Parse command-line arguments
+	for (int i = 1; i < argc; ++i)
+	{
+		if (const char *arg = argv[i]; arg[0] == '-')
+		{
+			if (0 == std::strcmp(arg, "-h") || 0 == std::strcmp(arg, "--help"))
+			{
+				print_usage(argv[0]);
+				return 0;
+			}
+			if (0 == std::strcmp(arg, "--utc"))
+			{
+				utc = true;
+				continue;
+			}
+			if (0 == std::strcmp(arg, "-o") && i + 1 < argc)
+			{
+				output_file = argv[++i];
+				continue;
+			}
+
+			print_usage(argv[0]);
+			return 1;
+		}
+		else
+		{
+			input_file = arg;
+		}
+	}
+
+	if (input_file == nullptr)
+	{
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	FILE *const input = std::fopen(input_file, "rb");
+	if (input == nullptr)
+	{
+		std::fprintf(stderr, "error: could not open '%s'\n", input_file);
+		return 1;
+	}
+
+	reshade::log::binary_file_header file_header;
+	if (std::fread(&file_header, sizeof(file_header), 1, input) != 1 ||
+		file_header.magic != reshade::log::binary_file_header::magic_value)
+	{
+		std::fprintf(stderr, "error: '%s' is not a binary ReShade log file\n", input_file);
+		std::fclose(input);
+		return 1;
+	}
+	if (file_header.version != reshade::log::binary_file_header::version_value)
+	{
+		std::fprintf(stderr, "error: '%s' has unsupported version %u\n", input_file, file_header.version);
+		std::fclose(input);
+		return 1;
+	}
+
+	FILE *const output = output_file != nullptr ? std::fopen(output_file, "w") : stdout;
+	if (output == nullptr)
+	{
+		std::fprintf(stderr, "error: could not open '%s' for writing\n", output_file);
+		std::fclose(input);
+		return 1;
+	}
+
+	static constexpr char level_names[][6] = { "ERROR", "WARN ", "INFO ", "DEBUG" };
+	// Difference between the Windows file time epoch (January 1, 1601) and the Unix epoch (January 1, 1970) in 100-nanosecond intervals
+	static constexpr uint64_t unix_epoch_offset = 116444736000000000ull;
+
+	std::string text;
+	reshade::log::binary_record_header header;
+	size_t num_records = 0;
+
+	while (std::fread(&header, sizeof(header), 1, input) == 1)
+	{
+		text.resize(header.length);
+		if (header.length != 0 && std::fread(text.data(), header.length, 1, input) != 1)
+		{
+			// Process may have been terminated while writing the last batch
+			std::fprintf(stderr, "warning: log file ends with a truncated message\n");
+			break;
+		}
+
+		const std::time_t seconds = static_cast<std::time_t>((header.time - unix_epoch_offset) / 10000000);
+		const unsigned int milliseconds = static_cast<unsigned int>((header.time / 10000) % 1000);
+
+		std::tm time = {};
+#ifdef _WIN32
+		utc ? gmtime_s(&time, &seconds) : localtime_s(&time, &seconds);
+#else
+		utc ? gmtime_r(&seconds, &time) : localtime_r(&seconds, &time);
+#endif
+
+		const uint32_t level = header.level - 1 < std::size(level_names) ? header.level - 1 : std::size(level_names) - 1;
+
+		std::fprintf(output, "%04d-%02d-%02dT%02d:%02d:%02d:%03u [%5u] | %.5s | %s\n",
+			time.tm_year + 1900, time.tm_mon + 1, time.tm_mday, time.tm_hour, time.tm_min, time.tm_sec, milliseconds, header.thread_id, level_names[level], text.c_str());
+
+		num_records++;
+	}
+
+	if (output != stdout)
+		std::fclose(output);
+	std::fclose(input);
+
+	std::fprintf(stderr, "%zu message(s) converted\n", num_records);
+	return 0;
+}
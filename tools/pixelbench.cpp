@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2026 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "pixel_conversion.hpp"
+#include <chrono>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm> // std::min
+#include <cstdio> // std::snprintf
+#include <cstdlib> // std::strtoul
+#include <cstring> // std::memcpy, std::strcmp
+#include <fstream>
+#include <iostream>
+
+using namespace reshade::pixel_conversion;
+
+static void print_usage(const char *path)
+{
+	printf(R"(usage: %s [options]
+
+Runs every pixel conversion kernel with every instruction set supported by this processor, checks the results against the scalar reference implementation and writes a JSON report with the fastest time of every kernel.
+Exits with a non-zero code if any result does not match the reference.
+
+Options:
+  -h, --help                Print this help.
+
+  --pixels <count>          Number of pixels converted per iteration. Defaults to 2073600 (1920x1080).
+  --iterations <count>      Number of times every kernel is run, of which the fastest time is reported. Defaults to 5.
+  --output <file>           Write the report to the given file instead of standard output.
+	)", path);
+}
+
+struct stage_result
+{
+	std::string name;
+	// Fastest time of all iterations, in seconds
+	double time = 0.0;
+	// Number of operations performed in a single iteration
+	size_t count = 0;
+	// Number of output values that do not match the scalar reference
+	size_t mismatches = 0;
+};
+
+template <typename F>
+static stage_result measure_stage(const char *name, unsigned int iterations, F &&run)
+{
+	stage_result result;
+	result.name = name;
+	result.time = std::numeric_limits<double>::max();
+
+	for (unsigned int i = 0; i < iterations; ++i)
+	{
+		const std::chrono::high_resolution_clock::time_point time_start = std::chrono::high_resolution_clock::now();
+		result.count = run();
+		const std::chrono::high_resolution_clock::time_point time_finished = std::chrono::high_resolution_clock::now();
+
+		result.time = std::min(result.time, std::chrono::duration<double>(time_finished - time_start).count());
+	}
+
+	return result;
+}
+
+enum class compare_mode
+{
+	exact,
+	// Compares 32-bit floating-point values bit by bit, but treats all NaNs as equal (hardware conversions may quiet signaling NaNs)
+	float_bits,
+	// Compares 16-bit values and allows them to differ by one
+	uint16_within_one,
+};
+
+struct kernel
+{
+	const char *name;
+	size_t src_stride;
+	size_t dst_stride;
+	compare_mode compare;
+	bool in_place;
+	void(*run)(uint8_t *dst, const uint8_t *src, size_t count);
+};
+
+static const kernel s_kernels[] = {
+	{ "convert_rgba8", 4, 4, compare_mode::exact, true, [](uint8_t *dst, const uint8_t *src, size_t count) { convert_rgba8(dst, src, count, false, false); } },
+	{ "convert_rgba8_swap_rb_opaque", 4, 4, compare_mode::exact, true, [](uint8_t *dst, const uint8_t *src, size_t count) { convert_rgba8(dst, src, count, true, true); } },
+	{ "expand_r8_to_rgba8", 1, 4, compare_mode::exact, false, [](uint8_t *dst, const uint8_t *src, size_t count) { expand_r8_to_rgba8(dst, src, count); } },
+	{ "expand_rg8_to_rgba8", 2, 4, compare_mode::exact, false, [](uint8_t *dst, const uint8_t *src, size_t count) { expand_rg8_to_rgba8(dst, src, count); } },
+	{ "pack_rgba8_to_rgb8", 4, 3, compare_mode::exact, true, [](uint8_t *dst, const uint8_t *src, size_t count) { pack_rgba8_to_rgb8(dst, src, count); } },
+	{ "pack_rgba8_to_r8", 4, 1, compare_mode::exact, true, [](uint8_t *dst, const uint8_t *src, size_t count) { pack_rgba8_to_r8(dst, src, count); } },
+	{ "pack_rgba8_to_rg8", 4, 2, compare_mode::exact, true, [](uint8_t *dst, const uint8_t *src, size_t count) { pack_rgba8_to_rg8(dst, src, count); } },
+	{ "pack_rgba32f_to_r32f", 16, 4, compare_mode::exact, true, [](uint8_t *dst, const uint8_t *src, size_t count) { pack_rgba32f_to_r32f(reinterpret_cast<float *>(dst), reinterpret_cast<const float *>(src), count); } },
+	{ "pack_rgba32f_to_rg32f", 16, 8, compare_mode::exact, true, [](uint8_t *dst, const uint8_t *src, size_t count) { pack_rgba32f_to_rg32f(reinterpret_cast<float *>(dst), reinterpret_cast<const float *>(src), count); } },
+	{ "pack_rgba16_to_rgb16", 8, 6, compare_mode::exact, true, [](uint8_t *dst, const uint8_t *src, size_t count) { pack_rgba16_to_rgb16(reinterpret_cast<uint16_t *>(dst), reinterpret_cast<const uint16_t *>(src), count); } },
+	{ "unpack_rgb10a2_to_rgba8", 4, 4, compare_mode::exact, false, [](uint8_t *dst, const uint8_t *src, size_t count) { unpack_rgb10a2_to_rgba8(dst, reinterpret_cast<const uint32_t *>(src), count, false); } },
+	{ "unpack_bgr10a2_to_rgba8", 4, 4, compare_mode::exact, false, [](uint8_t *dst, const uint8_t *src, size_t count) { unpack_rgb10a2_to_rgba8(dst, reinterpret_cast<const uint32_t *>(src), count, true); } },
+	{ "unpack_rgb10a2_to_rgb16", 4, 6, compare_mode::exact, false, [](uint8_t *dst, const uint8_t *src, size_t count) { unpack_rgb10a2_to_rgb16(reinterpret_cast<uint16_t *>(dst), reinterpret_cast<const uint32_t *>(src), count, true); } },
+	{ "swap_rb_rgb10a2", 4, 4, compare_mode::exact, true, [](uint8_t *dst, const uint8_t *src, size_t count) { swap_rb_rgb10a2(reinterpret_cast<uint32_t *>(dst), reinterpret_cast<const uint32_t *>(src), count); } },
+	{ "convert_half_to_float", 2, 4, compare_mode::float_bits, false, [](uint8_t *dst, const uint8_t *src, size_t count) { convert_half_to_float(reinterpret_cast<float *>(dst), reinterpret_cast<const uint16_t *>(src), count); } },
+	{ "encode_scrgb_half_to_hdr10_pq", 6, 6, compare_mode::uint16_within_one, true, [](uint8_t *dst, const uint8_t *src, size_t count) { encode_scrgb_half_to_hdr10_pq(reinterpret_cast<uint16_t *>(dst), reinterpret_cast<const uint16_t *>(src), count); } },
+};
+
+static const char *const s_instruction_set_names[] = { "scalar", "sse2", "avx2", "neon" };
+
+// Inputs of the kernels that take floating-point halves cycle through every possible 16-bit pattern, so that all special values are covered, everything else is random
+static std::vector<uint8_t> generate_input(const kernel &kernel, size_t num_pixels)
+{
+	std::vector<uint8_t> data(kernel.src_stride * num_pixels + 16);
+
+	if (kernel.compare != compare_mode::exact)
+	{
+		for (size_t i = 0; i < data.size() / 2; ++i)
+		{
+			// Step by an odd number to not always put the same values into the same channel
+			const uint16_t value = static_cast<uint16_t>(i * 0x9E37u);
+			std::memcpy(data.data() + i * 2, &value, sizeof(value));
+		}
+	}
+	else
+	{
+		std::mt19937 random(1234);
+		for (uint8_t &value : data)
+			value = static_cast<uint8_t>(random());
+	}
+
+	return data;
+}
+
+static size_t count_mismatches(const kernel &kernel, const uint8_t *result, const uint8_t *reference, size_t num_pixels)
+{
+	const size_t size = kernel.dst_stride * num_pixels;
+
+	size_t mismatches = 0;
+	switch (kernel.compare)
+	{
+	case compare_mode::exact:
+		for (size_t i = 0; i < size; ++i)
+			mismatches += result[i] != reference[i];
+		break;
+	case compare_mode::float_bits:
+		for (size_t i = 0; i < size; i += 4)
+		{
+			uint32_t a, b;
+			std::memcpy(&a, result + i, sizeof(a));
+			std::memcpy(&b, reference + i, sizeof(b));
+			const bool a_is_nan = (a & 0x7F800000) == 0x7F800000 && (a & 0x007FFFFF) != 0;
+			const bool b_is_nan = (b & 0x7F800000) == 0x7F800000 && (b & 0x007FFFFF) != 0;
+			mismatches += a_is_nan != b_is_nan || (!a_is_nan && a != b);
+		}
+		break;
+	case compare_mode::uint16_within_one:
+		for (size_t i = 0; i < size; i += 2)
+		{
+			uint16_t a, b;
+			std::memcpy(&a, result + i, sizeof(a));
+			std::memcpy(&b, reference + i, sizeof(b));
+			mismatches += (a > b ? a - b : b - a) > 1;
+		}
+		break;
+	}
+
+	return mismatches;
+}
+
+// Converts the input with the current instruction set and compares against the reference, both for a large count and for every small count (to cover the scalar tails), and in place if the kernel supports that
+static size_t validate_kernel(const kernel &kernel, const std::vector<uint8_t> &input, const std::vector<uint8_t> &reference, size_t num_pixels)
+{
+	std::vector<uint8_t> output(kernel.dst_stride * num_pixels + 16);
+
+	kernel.run(output.data(), input.data(), num_pixels);
+	size_t mismatches = count_mismatches(kernel, output.data(), reference.data(), num_pixels);
+
+	for (size_t count = 0; count < std::min(num_pixels, static_cast<size_t>(67)); ++count)
+	{
+		// Guard bytes after the output must not be touched
+		std::fill(output.begin(), output.end(), static_cast<uint8_t>(0xCD));
+		kernel.run(output.data(), input.data(), count);
+		mismatches += count_mismatches(kernel, output.data(), reference.data(), count);
+		for (size_t i = kernel.dst_stride * count; i < kernel.dst_stride * count + 16; ++i)
+			mismatches += output[i] != 0xCD;
+	}
+
+	if (kernel.in_place)
+	{
+		std::vector<uint8_t> in_place = input;
+		kernel.run(in_place.data(), in_place.data(), num_pixels);
+		mismatches += count_mismatches(kernel, in_place.data(), reference.data(), num_pixels);
+	}
+
+	return mismatches;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *output_file = nullptr;
+	size_t num_pixels = 1920 * 1080;
+	unsigned int iterations = 5;
+
+	// Parse command-line arguments
+	for (int i = 1; i < argc; ++i)
+	{
+		const char *arg = argv[i];
+
+		if (0 == std::strcmp(arg, "-h") || 0 == std::strcmp(arg, "--help"))
+		{
+			print_usage(argv[0]);
+			return 0;
+		}
+
+		if (i + 1 >= argc)
+		{
+			print_usage(argv[0]);
+			return 1;
+		}
+		else if (0 == std::strcmp(arg, "--pixels"))
+			num_pixels = std::max(static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10)), static_cast<size_t>(1));
+		else if (0 == std::strcmp(arg, "--iterations"))
+			iterations = std::max(static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10)), 1u);
+		else if (0 == std::strcmp(arg, "--output"))
+			output_file = argv[++i];
+		else
+		{
+			print_usage(argv[0]);
+			return 1;
+		}
+	}
+
+	const instruction_set default_set = get_instruction_set();
+
+	std::vector<stage_result> stages;
+	size_t total_mismatches = 0;
+
+	for (const kernel &kernel : s_kernels)
+	{
+		const std::vector<uint8_t> input = generate_input(kernel, num_pixels);
+
+		set_instruction_set(instruction_set::scalar);
+		std::vector<uint8_t> reference(kernel.dst_stride * num_pixels);
+		kernel.run(reference.data(), input.data(), num_pixels);
+
+		for (const instruction_set set : { instruction_set::scalar, instruction_set::sse2, instruction_set::avx2, instruction_set::neon })
+		{
+			if (!set_instruction_set(set))
+				continue;
+
+			std::vector<uint8_t> output(kernel.dst_stride * num_pixels);
+			const std::string name = std::string(kernel.name) + '/' + s_instruction_set_names[static_cast<int>(set)];
+			stage_result &stage = stages.emplace_back(measure_stage(name.c_str(), iterations, [&]() {
+				kernel.run(output.data(), input.data(), num_pixels);
+				return num_pixels;
+			}));
+
+			stage.mismatches = validate_kernel(kernel, input, reference, num_pixels);
+			total_mismatches += stage.mismatches;
+		}
+	}
+
+	set_instruction_set(default_set);
+
+	std::ofstream output_stream;
+	if (output_file != nullptr)
+		output_stream.open(output_file);
+	std::ostream &stream = output_file != nullptr ? output_stream : std::cout;
+
+	stream << "{\n  \"pixels\": " << num_pixels << ",\n  \"iterations\": " << iterations << ",\n  \"default_instruction_set\": \"" << s_instruction_set_names[static_cast<int>(default_set)] << "\",\n  \"stages\": [\n";
+	for (size_t i = 0; i < stages.size(); ++i)
+	{
+		char time_ms[32];
+		std::snprintf(time_ms, sizeof(time_ms), "%.3f", stages[i].time * 1000.0);
+		char throughput[32];
+		std::snprintf(throughput, sizeof(throughput), "%.1f", stages[i].count / stages[i].time / 1000000.0);
+		stream << "    { \"name\": \"" << stages[i].name << "\", \"time_ms\": " << time_ms << ", \"count\": " << stages[i].count << ", \"mpixels_per_second\": " << throughput << ", \"mismatches\": " << stages[i].mismatches << " }" << (i + 1 < stages.size() ? "," : "") << '\n';
+	}
+	stream << "  ]\n}\n";
+
+	if (total_mismatches != 0)
+	{
+		std::cerr << total_mismatches << " results do not match the scalar reference implementation." << std::endl;
+		return 1;
+	}
+
+	return stream ? 0 : 1;
+}
@@ -0,0 +1,462 @@
+/*
+ * Copyright (C) 2026 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "runtime_special_uniforms.hpp"
+#include <chrono>
+#include <filesystem>
+#include <unordered_map>
+#include <cmath> // std::fmod
+#include <cstdio> // std::snprintf
+#include <cstdlib> // std::rand, std::strtoul
+#include <cstring> // std::memcpy, std::strcmp
+#include <fstream>
+#include <iostream>
+
+using namespace reshade;
+
+static void print_usage(const char *path)
+{
+	printf(R"(usage: %s [options]
+
+Generates a large set of special uniform variables and measures updating them the way the runtime does every frame, once by looking up their annotations and once through a precompiled update plan, then writes a JSON report with the fastest time of every stage.
+
+Options:
+  -h, --help                Print this help.
+
+  --uniforms <count>        Number of special uniform variables. Defaults to 4096.
+  --frames <count>          Number of frames simulated per iteration. Defaults to 100.
+  --iterations <count>      Number of times every stage is run, of which the fastest time is reported. Defaults to 5.
+  --output <file>           Write the report to the given file instead of standard output.
+	)", path);
+}
+
+struct stage_result
+{
+	std::string name;
+	// Fastest time of all iterations, in seconds
+	double time = 0.0;
+	// Number of operations performed in a single iteration
+	size_t count = 0;
+};
+
+template <typename F>
+static stage_result measure_stage(const char *name, unsigned int iterations, F &&run)
+{
+	stage_result result;
+	result.name = name;
+	result.time = std::numeric_limits<double>::max();
+
+	for (unsigned int i = 0; i < iterations; ++i)
+	{
+		const std::chrono::high_resolution_clock::time_point time_start = std::chrono::high_resolution_clock::now();
+		result.count = run();
+		const std::chrono::high_resolution_clock::time_point time_finished = std::chrono::high_resolution_clock::now();
+
+		result.time = std::min(result.time, std::chrono::duration<double>(time_finished - time_start).count());
+	}
+
+	return result;
+}
+
+static reshadefx::annotation make_annotation(const char *name, reshadefx::type::datatype base, float value)
+{
+	reshadefx::annotation annotation;
+	annotation.name = name;
+	annotation.type.base = base;
+	annotation.type.rows = 1;
+	annotation.type.cols = 1;
+	if (base == reshadefx::type::t_float)
+		annotation.value.as_float[0] = value;
+	else
+		annotation.value.as_int[0] = static_cast<int>(value);
+	return annotation;
+}
+static reshadefx::annotation make_annotation(const char *name, const char *value)
+{
+	reshadefx::annotation annotation;
+	annotation.name = name;
+	annotation.type.base = reshadefx::type::t_string;
+	annotation.value.string_data = value;
+	return annotation;
+}
+
+// Generates uniform variables with the annotations effects typically declare, cycling through all special sources that are updated every frame
+static std::vector<uniform> generate_uniforms(size_t num_uniforms, size_t &storage_size)
+{
+	static const special_uniform sources[] = {
+		special_uniform::frame_time,
+		special_uniform::frame_count,
+		special_uniform::random,
+		special_uniform::ping_pong,
+		special_uniform::date,
+		special_uniform::timer,
+		special_uniform::key,
+		special_uniform::mouse_point,
+		special_uniform::mouse_delta,
+		special_uniform::mouse_button,
+		special_uniform::mouse_wheel,
+		special_uniform::screenshot,
+	};
+
+	std::vector<uniform> uniforms;
+	uniforms.reserve(num_uniforms);
+	storage_size = 0;
+
+	for (size_t i = 0; i < num_uniforms; ++i)
+	{
+		reshadefx::uniform info;
+		info.name = "Uniform" + std::to_string(i);
+		info.offset = static_cast<uint32_t>(storage_size);
+		info.size = 16;
+		info.type.rows = 4;
+		info.type.cols = 1;
+		storage_size += info.size;
+
+		// Annotations that are only used by the overlay come first, so lookups have to skip over them like in real effects
+		info.annotations.push_back(make_annotation("ui_category", "Category"));
+		info.annotations.push_back(make_annotation("ui_label", "Label"));
+		info.annotations.push_back(make_annotation("ui_tooltip", "Tooltip"));
+
+		const special_uniform source = sources[i % std::size(sources)];
+		switch (source)
+		{
+		case special_uniform::frame_time:
+		case special_uniform::ping_pong:
+		case special_uniform::mouse_point:
+		case special_uniform::mouse_delta:
+		case special_uniform::mouse_wheel:
+			info.type.base = reshadefx::type::t_float;
+			break;
+		case special_uniform::frame_count:
+		case special_uniform::timer:
+			info.type.base = reshadefx::type::t_uint;
+			break;
+		case special_uniform::random:
+		case special_uniform::date:
+			info.type.base = reshadefx::type::t_int;
+			break;
+		default:
+			info.type.base = reshadefx::type::t_bool;
+			break;
+		}
+
+		switch (source)
+		{
+		case special_uniform::random:
+			info.annotations.push_back(make_annotation("min", reshadefx::type::t_int, 0));
+			info.annotations.push_back(make_annotation("max", reshadefx::type::t_int, 100));
+			break;
+		case special_uniform::ping_pong:
+			info.annotations.push_back(make_annotation("min", reshadefx::type::t_float, 0.0f));
+			info.annotations.push_back(make_annotation("max", reshadefx::type::t_float, 10.0f));
+			info.annotations.push_back(make_annotation("step", reshadefx::type::t_float, 2.0f));
+			info.annotations.push_back(make_annotation("smoothing", reshadefx::type::t_float, 0.5f));
+			break;
+		case special_uniform::key:
+			info.annotations.push_back(make_annotation("keycode", reshadefx::type::t_int, static_cast<float>(0x41 + (i % 26))));
+			info.annotations.push_back(make_annotation("mode", (i % 3) == 0 ? "toggle" : (i % 3) == 1 ? "press" : ""));
+			break;
+		case special_uniform::mouse_button:
+			info.annotations.push_back(make_annotation("keycode", reshadefx::type::t_int, static_cast<float>(i % 5)));
+			info.annotations.push_back(make_annotation("mode", (i % 3) == 0 ? "toggle" : (i % 3) == 1 ? "press" : ""));
+			break;
+		case special_uniform::mouse_wheel:
+			info.annotations.push_back(make_annotation("min", reshadefx::type::t_float, -10.0f));
+			info.annotations.push_back(make_annotation("max", reshadefx::type::t_float, 10.0f));
+			info.annotations.push_back(make_annotation("step", reshadefx::type::t_float, 0.5f));
+			break;
+default:
+			break;
+		}
+
+		uniform &variable = uniforms.emplace_back(info);
+		variable.special = source;
+	}
+
+	return uniforms;
+}
+
+// Stand-in for the runtime uniform accessors, which copy values into the uniform storage area
+template <typename T>
+static void set_value(std::vector<uint8_t> &storage, const uniform &variable, const T *values, size_t count)
+{
+	std::memcpy(storage.data() + variable.offset, values, std::min(count * sizeof(T), static_cast<size_t>(variable.size)));
+}
+template <typename T>
+static void set_value(std::vector<uint8_t> &storage, const uniform &variable, T value)
+{
+	set_value(storage, variable, &value, 1);
+}
+template <typename T>
+static void get_value(const std::vector<uint8_t> &storage, const uniform &variable, T *values, size_t count)
+{
+	std::memcpy(values, storage.data() + variable.offset, std::min(count * sizeof(T), static_cast<size_t>(variable.size)));
+}
+
+// Stand-in for the input state, so that both stages perform the same work
+struct input_state
+{
+	bool is_down(int keycode) const { return (keycode & 1) != 0; }
+	bool is_pressed(int keycode) const { return (keycode & 2) != 0; }
+	float mouse_position_x = 100.0f, mouse_position_y = 200.0f;
+	float mouse_delta_x = 1.0f, mouse_delta_y = -1.0f;
+	float mouse_wheel_delta = 1.0f;
+};
+
+static void update_input(std::vector<uint8_t> &storage, const uniform &variable, const input_state &input, int keycode, special_uniform_plan::input_mode mode)
+{
+	switch (mode)
+	{
+	case special_uniform_plan::input_mode::toggle:
+		if (input.is_pressed(keycode))
+		{
+			bool current_value = false;
+			get_value(storage, variable, &current_value, 1);
+			set_value(storage, variable, !current_value);
+		}
+		break;
+	case special_uniform_plan::input_mode::press:
+		set_value(storage, variable, input.is_pressed(keycode));
+		break;
+	case special_uniform_plan::input_mode::down:
+		set_value(storage, variable, input.is_down(keycode));
+		break;
+	}
+}
+
+static void update_ping_pong(std::vector<uint8_t> &storage, const uniform &variable, float min, float max, float step_min, float step_max, float smoothing, float frame_time_seconds)
+{
+	float increment = step_max == 0 ? step_min : (step_min + std::fmod(static_cast<float>(std::rand()), step_max - step_min + 1));
+
+	float value[2] = { 0, 0 };
+	get_value(storage, variable, value, 2);
+	if (value[1] >= 0)
+	{
+		increment = std::max(increment - std::max(0.0f, smoothing - (max - value[0])), 0.05f);
+		if ((value[0] += increment * frame_time_seconds) >= max)
+			value[0] = max, value[1] = -1;
+	}
+	else
+	{
+		increment = std::max(increment - std::max(0.0f, smoothing - (value[0] - min)), 0.05f);
+		if ((value[0] -= increment * frame_time_seconds) <= min)
+			value[0] = min, value[1] = +1;
+	}
+	set_value(storage, variable, value, 2);
+}
+
+static void update_mouse_wheel(std::vector<uint8_t> &storage, const uniform &variable, float min, float max, float step, const input_state &input)
+{
+	float value[2] = { 0, 0 };
+	get_value(storage, variable, value, 2);
+	value[1] = input.mouse_wheel_delta;
+	value[0] = value[0] + value[1] * step;
+	if (min != max)
+		value[0] = std::min(std::max(value[0], min), max);
+	set_value(storage, variable, value, 2);
+}
+
+// Updates all variables by resolving their annotations every frame, which is what the runtime did before update plans were introduced
+static void update_with_annotation_lookup(std::vector<uint8_t> &storage, const std::vector<uniform> &uniforms, const input_state &input, unsigned int frame_count)
+{
+	const int date[4] = { 2026, 1, 1, 0 };
+
+	for (const uniform &variable : uniforms)
+	{
+		switch (variable.special)
+		{
+		case special_uniform::frame_time:
+			set_value(storage, variable, 16.6f);
+			break;
+		case special_uniform::frame_count:
+			if (variable.type.is_boolean())
+				set_value(storage, variable, (frame_count % 2) == 0);
+			else
+				set_value(storage, variable, frame_count);
+			break;
+		case special_uniform::random:
+			{
+				const int min = variable.annotation_as_int("min", 0, 0);
+				const int max = variable.annotation_as_int("max", 0, RAND_MAX);
+				set_value(storage, variable, min + (std::rand() % (std::abs(max - min) + 1)));
+			}
+			break;
+		case special_uniform::ping_pong:
+			update_ping_pong(storage, variable,
+				variable.annotation_as_float("min", 0, 0.0f),
+				variable.annotation_as_float("max", 0, 1.0f),
+				variable.annotation_as_float("step", 0),
+				variable.annotation_as_float("step", 1),
+				variable.annotation_as_float("smoothing"),
+				0.0166f);
+			break;
+		case special_uniform::date:
+			set_value(storage, variable, date, 4);
+			break;
+		case special_uniform::timer:
+			set_value(storage, variable, frame_count * 16u);
+			break;
+		case special_uniform::key:
+		case special_uniform::mouse_button:
+			{
+				const int keycode = variable.annotation_as_int("keycode");
+				if (variable.special == special_uniform::key ? (keycode <= 7 || keycode >= 256) : (keycode < 0 || keycode >= 5))
+					break;
+
+				const std::string_view mode = variable.annotation_as_string("mode");
+				update_input(storage, variable, input, keycode,
+					mode == "toggle" || variable.annotation_as_int("toggle") ? special_uniform_plan::input_mode::toggle :
+					mode == "press" ? special_uniform_plan::input_mode::press : special_uniform_plan::input_mode::down);
+			}
+			break;
+		case special_uniform::mouse_point:
+			{
+				const float value[2] = { input.mouse_position_x, input.mouse_position_y };
+				set_value(storage, variable, value, 2);
+			}
+			break;
+		case special_uniform::mouse_delta:
+			{
+				const float value[2] = { input.mouse_delta_x, input.mouse_delta_y };
+				set_value(storage, variable, value, 2);
+			}
+			break;
+		case special_uniform::mouse_wheel:
+			{
+				float step = variable.annotation_as_float("step");
+				if (step == 0.0f)
+					step = 1.0f;
+				update_mouse_wheel(storage, variable, variable.annotation_as_float("min"), variable.annotation_as_float("max"), step, input);
+			}
+			break;
+		case special_uniform::screenshot:
+			set_value(storage, variable, false);
+			break;
+default:
+			break;
+		}
+	}
+}
+
+// Updates all variables through the precompiled plan, mirroring 'runtime::render_effects'
+static void update_with_plan(std::vector<uint8_t> &storage, const std::vector<uniform> &uniforms, const special_uniform_plan &plan, const input_state &input, unsigned int frame_count)
+{
+	const int date[4] = { 2026, 1, 1, 0 };
+
+	for (const uint32_t index : plan.frame_time)
+		set_value(storage, uniforms[index], 16.6f);
+	for (const uint32_t index : plan.frame_count)
+		set_value(storage, uniforms[index], frame_count);
+	for (const uint32_t index : plan.frame_parity)
+		set_value(storage, uniforms[index], (frame_count % 2) == 0);
+
+	for (size_t i = 0; i < plan.random.index.size(); ++i)
+		set_value(storage, uniforms[plan.random.index[i]], plan.random.min[i] + (std::rand() % plan.random.range[i]));
+	for (size_t i = 0; i < plan.ping_pong.index.size(); ++i)
+		update_ping_pong(storage, uniforms[plan.ping_pong.index[i]], plan.ping_pong.min[i], plan.ping_pong.max[i], plan.ping_pong.step_min[i], plan.ping_pong.step_max[i], plan.ping_pong.smoothing[i], 0.0166f);
+
+	for (const uint32_t index : plan.date)
+		set_value(storage, uniforms[index], date, 4);
+	for (const uint32_t index : plan.timer)
+		set_value(storage, uniforms[index], frame_count * 16u);
+
+	for (size_t i = 0; i < plan.key.index.size(); ++i)
+		update_input(storage, uniforms[plan.key.index[i]], input, plan.key.keycode[i], plan.key.mode[i]);
+	for (size_t i = 0; i < plan.mouse_button.index.size(); ++i)
+		update_input(storage, uniforms[plan.mouse_button.index[i]], input, plan.mouse_button.keycode[i], plan.mouse_button.mode[i]);
+
+	const float mouse_point[2] = { input.mouse_position_x, input.mouse_position_y };
+	for (const uint32_t index : plan.mouse_point)
+		set_value(storage, uniforms[index], mouse_point, 2);
+	const float mouse_delta[2] = { input.mouse_delta_x, input.mouse_delta_y };
+	for (const uint32_t index : plan.mouse_delta)
+		set_value(storage, uniforms[index], mouse_delta, 2);
+	for (size_t i = 0; i < plan.mouse_wheel.index.size(); ++i)
+		update_mouse_wheel(storage, uniforms[plan.mouse_wheel.index[i]], plan.mouse_wheel.min[i], plan.mouse_wheel.max[i], plan.mouse_wheel.step[i], input);
+
+	for (const uint32_t index : plan.screenshot)
+		set_value(storage, uniforms[index], false);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *output_file = nullptr;
+	size_t num_uniforms = 4096;
+	unsigned int num_frames = 100;
+	unsigned int iterations = 5;
+
+	// Parse command-line arguments
+	for (int i = 1; i < argc; ++i)
+	{
+		const char *arg = argv[i];
+
+		if (0 == std::strcmp(arg, "-h") || 0 == std::strcmp(arg, "--help"))
+		{
+			print_usage(argv[0]);
+			return 0;
+		}
+
+		if (i + 1 >= argc)
+		{
+			print_usage(argv[0]);
+			return 1;
+		}
+		else if (0 == std::strcmp(arg, "--uniforms"))
+			num_uniforms = std::max(static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10)), static_cast<size_t>(1));
+		else if (0 == std::strcmp(arg, "--frames"))
+			num_frames = std::max(static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10)), 1u);
+		else if (0 == std::strcmp(arg, "--iterations"))
+			iterations = std::max(static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10)), 1u);
+		else if (0 == std::strcmp(arg, "--output"))
+			output_file = argv[++i];
+		else
+		{
+			print_usage(argv[0]);
+			return 1;
+		}
+	}
+
+	size_t storage_size = 0;
+	const std::vector<uniform> uniforms = generate_uniforms(num_uniforms, storage_size);
+	std::vector<uint8_t> storage(storage_size);
+	const input_state input;
+
+	std::vector<stage_result> stages;
+
+	// Resolve all annotations once, like 'load_effect' does
+	special_uniform_plan plan;
+	stages.push_back(measure_stage("build_plan", iterations, [&]() {
+		plan.build(uniforms);
+		return num_uniforms;
+	}));
+
+	stages.push_back(measure_stage("annotation_lookup", iterations, [&]() {
+		for (unsigned int frame = 0; frame < num_frames; ++frame)
+			update_with_annotation_lookup(storage, uniforms, input, frame);
+		return num_uniforms * num_frames;
+	}));
+
+	stages.push_back(measure_stage("update_plan", iterations, [&]() {
+		for (unsigned int frame = 0; frame < num_frames; ++frame)
+			update_with_plan(storage, uniforms, plan, input, frame);
+		return num_uniforms * num_frames;
+	}));
+
+	std::ofstream output_stream;
+	if (output_file != nullptr)
+		output_stream.open(output_file);
+	std::ostream &stream = output_file != nullptr ? output_stream : std::cout;
+
+	stream << "{\n  \"uniforms\": " << num_uniforms << ",\n  \"frames\": " << num_frames << ",\n  \"iterations\": " << iterations << ",\n  \"stages\": [\n";
+	for (size_t i = 0; i < stages.size(); ++i)
+	{
+		char time_ms[32];
+		std::snprintf(time_ms, sizeof(time_ms), "%.3f", stages[i].time * 1000.0);
+		stream << "    { \"name\": \"" << stages[i].name << "\", \"time_ms\": " << time_ms << ", \"count\": " << stages[i].count << " }" << (i + 1 < stages.size() ? "," : "") << '\n';
+	}
+	stream << "  ]\n}\n";
+
+	return stream ? 0 : 1;
+}